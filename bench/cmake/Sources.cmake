@@ -0,0 +1,14 @@
+set(AMBER_BENCH_SOURCES
+    coroutine_frame_bench.cpp
+    epoch_domain_bench.cpp
+    malloc_scalability_bench.cpp
+    pool_allocator_bench.cpp
+    prefault_bench.cpp
+    trace_replay_bench.cpp
+)
+
+prepend_paths(
+    "${AMBER_BENCH_SOURCES}"
+    "src/amber_bench"
+    "AMBER_BENCH_SOURCES"
+)
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <amber/coroutine_frame.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/stack_allocator.hpp>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t task_count = 200'000;
+
+constexpr int nesting_depth = 4;
+
+struct default_frames {};
+
+// Lazily started coroutine, awaiting one resumes it and transfers back to the
+// awaiter when it finishes. Frames come from Frames::operator new when it has
+// one, the global operator new otherwise.
+template<typename Frames>
+class task {
+public:
+    struct promise_type : Frames {
+    public:
+        task get_return_object() noexcept
+        {
+            return task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        auto final_suspend() noexcept
+        {
+            struct final_awaiter {
+            public:
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    std::coroutine_handle<> continuation = handle.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+
+                void await_resume() noexcept
+                {}
+            };
+            return final_awaiter{};
+        }
+
+        void return_value(std::uint64_t v) noexcept
+        {
+            value = v;
+        }
+
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+
+        std::uint64_t value = 0;
+        std::coroutine_handle<> continuation;
+    };
+
+    task(const task&) = delete;
+
+    task(task&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr))
+    {}
+
+    task& operator=(const task&) = delete;
+
+    task& operator=(task&&) = delete;
+
+    ~task() noexcept
+    {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+
+    std::uint64_t await_resume() noexcept
+    {
+        return handle_.promise().value;
+    }
+
+    std::uint64_t run() noexcept
+    {
+        handle_.resume();
+        return handle_.promise().value;
+    }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept
+        : handle_(handle)
+    {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// A request handler awaiting a chain of nested helpers, each with its own frame
+template<typename Frames>
+task<Frames> handler(std::uint64_t id, int depth)
+{
+    if (depth == 0) {
+        co_return id;
+    }
+    std::uint64_t inner = co_await handler<Frames>(id + 1, depth - 1);
+    co_return inner + id;
+}
+
+template<typename Frames>
+task<Frames> handler(std::allocator_arg_t, amber::stack_allocator& stack, std::uint64_t id, int depth)
+{
+    if (depth == 0) {
+        co_return id;
+    }
+    std::uint64_t inner = co_await handler<Frames>(std::allocator_arg, stack, id + 1, depth - 1);
+    co_return inner + id;
+}
+
+enum class frame_source {
+    heap,
+    pool,
+    stack,
+};
+
+// Frames created and destroyed per second over all threads
+double frame_bench(frame_source source, std::size_t thread_count)
+{
+    std::atomic<bool> start(false);
+    std::atomic<std::uint64_t> checksum(0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&start, &checksum, source]() {
+            auto exp_buffer = amber::malloc_buffer::create(1 << 16);
+            if (!exp_buffer.has_value()) {
+                std::fprintf(stderr, "malloc_buffer::create failed: %s\n", exp_buffer.error().c_str());
+                return;
+            }
+            amber::malloc_buffer buffer = std::move(exp_buffer).value();
+            auto exp_stack = amber::stack_allocator::create(buffer);
+            if (!exp_stack.has_value()) {
+                std::fprintf(stderr, "stack_allocator::create failed: %s\n", exp_stack.error().c_str());
+                return;
+            }
+            amber::stack_allocator stack = std::move(exp_stack).value();
+            std::uint64_t sum = 0;
+            while (!start.load(std::memory_order_acquire)) {}
+            for (std::size_t i = 0; i < task_count; ++i) {
+                switch (source) {
+                case frame_source::heap:
+                    sum += handler<default_frames>(i, nesting_depth).run();
+                    break;
+                case frame_source::pool:
+                    sum += handler<amber::coroutine_frame_promise>(i, nesting_depth).run();
+                    break;
+                case frame_source::stack:
+                    sum += handler<amber::coroutine_frame_promise>(
+                        std::allocator_arg, stack, i, nesting_depth).run();
+                    break;
+                }
+            }
+            checksum.fetch_add(sum, std::memory_order_relaxed);
+        });
+    }
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    volatile std::uint64_t sink = checksum.load();
+    (void)sink;
+    std::chrono::duration<double> elapsed = end - begin;
+    double frames = static_cast<double>(task_count * (nesting_depth + 1) * thread_count);
+    return frames / elapsed.count();
+}
+
+} // unnamed namespace
+
+int main()
+{
+    std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("coroutine frames, %zu tasks per thread, nesting depth %d\n", task_count, nesting_depth);
+    std::printf("  %8s %16s %16s %16s\n", "threads", "heap Mframes/s", "pool Mframes/s", "stack Mframes/s");
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double heap = frame_bench(frame_source::heap, threads);
+        double pool = frame_bench(frame_source::pool, threads);
+        double stack = frame_bench(frame_source::stack, threads);
+        std::printf("  %8zu %16.2f %16.2f %16.2f\n", threads, heap / 1e6, pool / 1e6, stack / 1e6);
+    }
+    return 0;
+}
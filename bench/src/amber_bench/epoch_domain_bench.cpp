@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <amber/epoch_domain.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t slot_count = 64;
+constexpr std::size_t node_count = 64 * 1024;
+
+struct node {
+public:
+    node(std::uint64_t value) noexcept
+        : value(value)
+    {}
+
+    std::uint64_t value;
+    std::uint64_t padding[7];
+};
+
+struct result {
+public:
+    double reads_per_second;
+    double writes_per_second;
+};
+
+// Readers scan every slot while one writer keeps replacing nodes. With
+// reclaim_batch == 0 retired nodes go to a mutex protected garbage list that
+// is never freed until the end, the pattern epoch reclamation replaces.
+result replace_bench(std::size_t reader_count, std::size_t reclaim_batch, std::chrono::milliseconds duration)
+{
+    auto exp_buffer = amber::malloc_buffer::create(node_count * sizeof(node));
+    if (!exp_buffer.has_value()) {
+        std::fprintf(stderr, "malloc_buffer::create failed: %s\n", exp_buffer.error().c_str());
+        return {};
+    }
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_pool = amber::pool_allocator::create(buffer, sizeof(node));
+    if (!exp_pool.has_value()) {
+        std::fprintf(stderr, "pool_allocator::create failed: %s\n", exp_pool.error().c_str());
+        return {};
+    }
+    amber::pool_allocator pool = std::move(exp_pool).value();
+    auto exp_domain = amber::epoch_domain<amber::pool_allocator>::create(
+        pool, reader_count + 1, std::max<std::size_t>(reclaim_batch, 1));
+    if (!exp_domain.has_value()) {
+        std::fprintf(stderr, "epoch_domain::create failed: %s\n", exp_domain.error().c_str());
+        return {};
+    }
+    amber::epoch_domain<amber::pool_allocator> domain = std::move(exp_domain).value();
+
+    std::vector<std::atomic<node*>> slots(slot_count);
+    for (std::atomic<node*>& slot : slots) {
+        slot.store(domain.allocate<node>(0u).value());
+    }
+    std::mutex garbage_mutex;
+    std::vector<node*> garbage;
+
+    std::atomic<bool> start(false);
+    std::atomic<bool> stop(false);
+    std::atomic<std::uint64_t> reads(0);
+    std::uint64_t writes = 0;
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < reader_count; ++i) {
+        threads.emplace_back([&]() {
+            auto handle = domain.attach().value();
+            std::uint64_t local_reads = 0;
+            std::uint64_t sum = 0;
+            while (!start.load(std::memory_order_acquire)) {}
+            while (!stop.load(std::memory_order_relaxed)) {
+                amber::epoch_guard guard = handle.pin();
+                for (std::atomic<node*>& slot : slots) {
+                    sum += slot.load(std::memory_order_acquire)->value;
+                }
+                local_reads += slot_count;
+            }
+            volatile std::uint64_t sink = sum;
+            (void)sink;
+            reads.fetch_add(local_reads, std::memory_order_relaxed);
+        });
+    }
+    threads.emplace_back([&]() {
+        auto handle = domain.attach().value();
+        while (!start.load(std::memory_order_acquire)) {}
+        while (!stop.load(std::memory_order_relaxed)) {
+            auto exp_node = domain.allocate<node>(writes);
+            if (!exp_node.has_value()) {
+                if (reclaim_batch == 0) {
+                    // The leaking baseline ran out of nodes
+                    break;
+                }
+                handle.collect();
+                continue;
+            }
+            node* old = slots[writes % slot_count].exchange(exp_node.value(), std::memory_order_acq_rel);
+            if (reclaim_batch == 0) {
+                std::lock_guard<std::mutex> lock(garbage_mutex);
+                garbage.push_back(old);
+            } else {
+                while (!handle.retire(old).has_value()) {
+                    handle.collect();
+                }
+            }
+            ++writes;
+        }
+    });
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(duration);
+    stop.store(true);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (node* n : garbage) {
+        domain.free(n);
+    }
+    for (std::atomic<node*>& slot : slots) {
+        domain.free(slot.load());
+    }
+    std::chrono::duration<double> elapsed = end - begin;
+    return result{
+        static_cast<double>(reads.load()) / elapsed.count(),
+        static_cast<double>(writes) / elapsed.count(),
+    };
+}
+
+} // unnamed namespace
+
+int main()
+{
+    constexpr std::chrono::milliseconds duration(500);
+    std::size_t reader_count = std::max(1u, std::thread::hardware_concurrency() - 1);
+    std::printf("replace workload, readers: %zu, slots: %zu\n", reader_count, slot_count);
+    result leak = replace_bench(reader_count, 0, duration);
+    std::printf("  garbage list:     %12.0f reads/s %12.0f writes/s (until pool exhausted)\n",
+        leak.reads_per_second, leak.writes_per_second);
+    for (std::size_t batch : {8, 64, 512}) {
+        result r = replace_bench(reader_count, batch, duration);
+        std::printf("  epoch batch %4zu: %12.0f reads/s %12.0f writes/s\n",
+            batch, r.reads_per_second, r.writes_per_second);
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Calls malloc and free directly, run it with and without
+// LD_PRELOAD=libamber_malloc.so to compare amber_malloc against the C library
+
+namespace {
+
+constexpr std::size_t operation_count = 1'000'000;
+
+constexpr std::size_t window_size = 256;
+
+constexpr std::size_t ring_size = 1024;
+
+std::uint64_t next_random(std::uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Mostly small sizes with a tail up to 4 KiB
+std::size_t random_size(std::uint64_t& state)
+{
+    std::uint64_t r = next_random(state);
+    if ((r % 16) != 0) {
+        return 16 + ((r >> 8) % 497);
+    }
+    return 513 + ((r >> 8) % 3584);
+}
+
+void* must_malloc(std::size_t size)
+{
+    void* ptr = std::malloc(size);
+    if (ptr == nullptr) {
+        std::fprintf(stderr, "malloc failed, size: %zu\n", size);
+        std::abort();
+    }
+    // Touch the first byte so the allocation is not optimized away
+    *static_cast<volatile char*>(ptr) = 1;
+    return ptr;
+}
+
+// Every thread replaces random entries of its own window of allocations
+double churn_bench(std::size_t thread_count)
+{
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&start, t]() {
+            std::uint64_t state = 0x9e3779b97f4a7c15 + t;
+            void* window[window_size];
+            for (void*& ptr : window) {
+                ptr = must_malloc(random_size(state));
+            }
+            while (!start.load(std::memory_order_acquire)) {}
+            for (std::size_t i = 0; i < operation_count; ++i) {
+                std::size_t index = next_random(state) % window_size;
+                std::free(window[index]);
+                window[index] = must_malloc(random_size(state));
+            }
+            for (void* ptr : window) {
+                std::free(ptr);
+            }
+        });
+    }
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = end - begin;
+    return static_cast<double>(operation_count * thread_count) / elapsed.count();
+}
+
+// Single producer single consumer ring of allocations
+struct ring {
+public:
+    alignas(64) std::atomic<std::size_t> head;
+    alignas(64) std::atomic<std::size_t> tail;
+    void* entries[ring_size];
+};
+
+// Half the threads allocate and hand each allocation to a partner thread,
+// which frees it, so every free crosses threads
+double handoff_bench(std::size_t thread_count)
+{
+    std::size_t pair_count = std::max<std::size_t>(thread_count / 2, 1);
+    std::vector<ring> rings(pair_count);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p < pair_count; ++p) {
+        ring& r = rings[p];
+        r.head.store(0);
+        r.tail.store(0);
+        threads.emplace_back([&start, &r, p]() {
+            std::uint64_t state = 0x2545f4914f6cdd1d + p;
+            while (!start.load(std::memory_order_acquire)) {}
+            for (std::size_t i = 0; i < operation_count; ++i) {
+                void* ptr = must_malloc(random_size(state));
+                std::size_t tail = r.tail.load(std::memory_order_relaxed);
+                while (tail - r.head.load(std::memory_order_acquire) == ring_size) {
+                    std::this_thread::yield();
+                }
+                r.entries[tail % ring_size] = ptr;
+                r.tail.store(tail + 1, std::memory_order_release);
+            }
+        });
+        threads.emplace_back([&start, &r]() {
+            while (!start.load(std::memory_order_acquire)) {}
+            for (std::size_t i = 0; i < operation_count; ++i) {
+                std::size_t head = r.head.load(std::memory_order_relaxed);
+                while (r.tail.load(std::memory_order_acquire) == head) {
+                    std::this_thread::yield();
+                }
+                std::free(r.entries[head % ring_size]);
+                r.head.store(head + 1, std::memory_order_release);
+            }
+        });
+    }
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = end - begin;
+    return static_cast<double>(operation_count * pair_count) / elapsed.count();
+}
+
+} // unnamed namespace
+
+int main()
+{
+    const char* preload = std::getenv("LD_PRELOAD");
+    std::printf("malloc scalability, LD_PRELOAD: %s\n", preload == nullptr ? "(none)" : preload);
+    std::size_t max_threads = std::max(2u, std::thread::hardware_concurrency());
+    std::printf("  %8s %16s %16s\n", "threads", "churn Mops/s", "handoff Mops/s");
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double churn = churn_bench(threads);
+        double handoff = handoff_bench(std::max<std::size_t>(threads, 2));
+        std::printf("  %8zu %16.2f %16.2f\n", threads, churn / 1e6, handoff / 1e6);
+    }
+    return 0;
+}
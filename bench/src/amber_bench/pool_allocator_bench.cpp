@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <amber/aligned_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <amber/util.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t page_size = 4096;
+
+struct counter {
+public:
+    counter() noexcept
+        : value(0)
+    {}
+
+    std::atomic<std::uint64_t> value;
+};
+
+// Each thread increments its own counter, all counters come from one pool
+double counter_bench(std::size_t entry_alignment, std::size_t thread_count, std::size_t iterations)
+{
+    auto exp_buffer = amber::aligned_buffer::create(page_size, page_size);
+    if (!exp_buffer.has_value()) {
+        std::fprintf(stderr, "aligned_buffer::create failed: %s\n", exp_buffer.error().c_str());
+        return 0.0;
+    }
+    amber::aligned_buffer buffer = std::move(exp_buffer).value();
+    auto exp_pool = amber::pool_allocator::create(buffer, sizeof(counter), entry_alignment);
+    if (!exp_pool.has_value()) {
+        std::fprintf(stderr, "pool_allocator::create failed: %s\n", exp_pool.error().c_str());
+        return 0.0;
+    }
+    amber::pool_allocator pool = std::move(exp_pool).value();
+
+    std::vector<counter*> counters;
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        auto exp_counter = pool.allocate<counter>();
+        if (!exp_counter.has_value()) {
+            std::fprintf(stderr, "pool_allocator::allocate failed: %s\n", exp_counter.error().c_str());
+            return 0.0;
+        }
+        counters.push_back(exp_counter.value());
+    }
+
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&start, c = counters[i], iterations]() {
+            while (!start.load(std::memory_order_acquire)) {}
+            for (std::size_t j = 0; j < iterations; ++j) {
+                c->value.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (counter* c : counters) {
+        pool.free(c);
+    }
+    std::chrono::duration<double, std::nano> elapsed = end - begin;
+    return elapsed.count() / static_cast<double>(iterations);
+}
+
+// Walks the first entry of many pools whose buffers are page aligned,
+// without coloring every entry maps onto the same cache sets
+double color_bench(bool colored, std::size_t pool_count, std::size_t iterations)
+{
+    std::vector<amber::aligned_buffer> buffers;
+    std::vector<amber::pool_allocator> pools;
+    std::vector<std::uint64_t*> entries;
+    std::size_t color_count = page_size / amber::cache_line_size;
+    for (std::size_t i = 0; i < pool_count; ++i) {
+        auto exp_buffer = amber::aligned_buffer::create(page_size, 4 * page_size);
+        if (!exp_buffer.has_value()) {
+            std::fprintf(stderr, "aligned_buffer::create failed: %s\n", exp_buffer.error().c_str());
+            return 0.0;
+        }
+        buffers.push_back(std::move(exp_buffer).value());
+        std::size_t color_offset = colored ? (i % color_count) * amber::cache_line_size : 0;
+        auto exp_pool = amber::pool_allocator::create(
+            buffers.back(), page_size, amber::cache_line_size, color_offset);
+        if (!exp_pool.has_value()) {
+            std::fprintf(stderr, "pool_allocator::create failed: %s\n", exp_pool.error().c_str());
+            return 0.0;
+        }
+        pools.push_back(std::move(exp_pool).value());
+        auto exp_entry = pools.back().allocate<std::uint64_t>(0);
+        if (!exp_entry.has_value()) {
+            std::fprintf(stderr, "pool_allocator::allocate failed: %s\n", exp_entry.error().c_str());
+            return 0.0;
+        }
+        entries.push_back(exp_entry.value());
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        for (std::uint64_t* entry : entries) {
+            volatile std::uint64_t* value = entry;
+            *value = *value + 1;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double, std::nano> elapsed = end - begin;
+    return elapsed.count() / static_cast<double>(iterations * pool_count);
+}
+
+} // unnamed namespace
+
+int main()
+{
+    constexpr std::size_t counter_iterations = 10'000'000;
+    std::size_t thread_count = std::max(2u, std::thread::hardware_concurrency());
+    thread_count = std::min(thread_count, page_size / (2 * amber::cache_line_size));
+    std::printf("counter workload, threads: %zu\n", thread_count);
+    for (std::size_t alignment : {alignof(counter), amber::cache_line_size, 2 * amber::cache_line_size}) {
+        double ns = counter_bench(alignment, thread_count, counter_iterations);
+        std::printf("  entry alignment %4zu: %8.3f ns/increment\n", alignment, ns);
+    }
+
+    constexpr std::size_t pool_count = 256;
+    constexpr std::size_t color_iterations = 100'000;
+    std::printf("slab coloring workload, pools: %zu\n", pool_count);
+    std::printf("  uncolored: %8.3f ns/access\n", color_bench(false, pool_count, color_iterations));
+    std::printf("  colored:   %8.3f ns/access\n", color_bench(true, pool_count, color_iterations));
+    return 0;
+}
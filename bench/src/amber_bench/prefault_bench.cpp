@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <amber/mmap_buffer.hpp>
+#include <amber/prefault.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+#include <utility>
+
+namespace {
+
+constexpr std::size_t buffer_size = std::size_t(1) << 30;
+
+// Time until the whole buffer is populated with MAP_POPULATE
+double populate_bench()
+{
+    auto begin = std::chrono::steady_clock::now();
+    auto exp_buffer = amber::mmap_buffer::create(buffer_size);
+    auto end = std::chrono::steady_clock::now();
+    if (!exp_buffer.has_value()) {
+        std::fprintf(stderr, "mmap_buffer::create failed: %s\n", exp_buffer.error().c_str());
+        return 0.0;
+    }
+    std::chrono::duration<double, std::milli> elapsed = end - begin;
+    return elapsed.count();
+}
+
+// Time until the first page is usable and until the whole buffer is
+// populated with thread_count prefault workers
+std::pair<double, double> prefault_bench(std::size_t thread_count)
+{
+    auto begin = std::chrono::steady_clock::now();
+    auto exp_buffer = amber::mmap_buffer::create_lazy(buffer_size);
+    if (!exp_buffer.has_value()) {
+        std::fprintf(stderr, "mmap_buffer::create_lazy failed: %s\n", exp_buffer.error().c_str());
+        return {0.0, 0.0};
+    }
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+    auto exp_task = amber::prefault_task::create(buffer.buffer(), thread_count);
+    if (!exp_task.has_value()) {
+        std::fprintf(stderr, "prefault_task::create failed: %s\n", exp_task.error().c_str());
+        return {0.0, 0.0};
+    }
+    amber::prefault_task task = std::move(exp_task).value();
+    task.wait_ready(1);
+    auto ready = std::chrono::steady_clock::now();
+    auto exp_wait = task.wait();
+    auto end = std::chrono::steady_clock::now();
+    if (!exp_wait.has_value()) {
+        std::fprintf(stderr, "prefault_task::wait failed: %s\n", exp_wait.error().c_str());
+        return {0.0, 0.0};
+    }
+    std::chrono::duration<double, std::milli> ready_elapsed = ready - begin;
+    std::chrono::duration<double, std::milli> elapsed = end - begin;
+    return {ready_elapsed.count(), elapsed.count()};
+}
+
+} // unnamed namespace
+
+int main()
+{
+    std::printf("populate %zu MiB\n", buffer_size >> 20);
+    std::printf("  MAP_POPULATE:         %10.3f ms\n", populate_bench());
+    std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+        auto [ready_ms, total_ms] = prefault_bench(thread_count);
+        std::printf("  prefault threads %3zu: %10.3f ms, first page %8.3f ms\n", thread_count, total_ms, ready_ms);
+    }
+    return 0;
+}
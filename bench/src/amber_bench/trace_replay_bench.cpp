@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <amber/alloc_trace.hpp>
+#include <amber/bucketizer.hpp>
+#include <amber/concept.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_allocator.hpp>
+#include <amber/mmap_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <amber/segregator.hpp>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <sys/wait.h>
+#include <unistd.h>
+}
+
+namespace {
+
+using size_class_buckets = amber::bucketizer<amber::pool_allocator, 0, 256, 64>;
+
+// Address space reserved for each size class pool
+constexpr std::size_t pool_region_size = std::size_t(32) << 20;
+
+// A pool threads its free list through every entry it is given, so pools are
+// extended a chunk at a time and only the pages the replay needs get touched
+constexpr std::size_t pool_chunk_size = std::size_t(256) << 10;
+
+// Leading part of a lazily mapped region that a pool has been given so far
+class pool_region {
+public:
+    pool_region() = delete;
+
+    pool_region(const pool_region&) = delete;
+
+    pool_region(pool_region&& other) noexcept = default;
+
+    pool_region& operator=(const pool_region&) = delete;
+
+    pool_region& operator=(pool_region&& other) noexcept = default;
+
+    ~pool_region() noexcept = default;
+
+    explicit pool_region(amber::mmap_buffer&& region) noexcept
+        : region_(std::move(region)),
+        committed_(std::min(pool_chunk_size, region_.size()))
+    {}
+
+    std::span<std::byte> buffer() noexcept
+    {
+        return region_.buffer().first(committed_);
+    }
+
+    const std::span<std::byte> buffer() const noexcept
+    {
+        return region_.buffer().first(committed_);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return committed_;
+    }
+
+    // False once the whole region is committed
+    bool grow() noexcept
+    {
+        if (committed_ == region_.size()) {
+            return false;
+        }
+        committed_ = std::min(committed_ + pool_chunk_size, region_.size());
+        return true;
+    }
+
+private:
+    amber::mmap_buffer region_;
+    std::size_t committed_;
+};
+
+static_assert(amber::Buffer<pool_region>);
+
+// Pools per 64 byte size class up to 256 bytes, each extended over its region
+// when it runs out
+class lazy_pools {
+public:
+    lazy_pools() = delete;
+
+    lazy_pools(const lazy_pools&) = delete;
+
+    lazy_pools(lazy_pools&& other) noexcept = default;
+
+    lazy_pools& operator=(const lazy_pools&) = delete;
+
+    lazy_pools& operator=(lazy_pools&& other) noexcept = default;
+
+    ~lazy_pools() noexcept = default;
+
+    static
+    std::expected<lazy_pools, std::string> create() noexcept
+    {
+        std::vector<pool_region> regions;
+        std::vector<amber::pool_allocator> pools;
+        for (std::size_t i = 0; i < size_class_buckets::bucket_count; ++i) {
+            auto exp_region = amber::mmap_buffer::create_lazy(pool_region_size, amber::mmap_flag::no_reserve);
+            if (!exp_region.has_value()) {
+                return std::unexpected(std::move(exp_region).error());
+            }
+            regions.emplace_back(std::move(exp_region).value());
+            auto exp_pool = amber::pool_allocator::create(regions.back(), size_class_buckets::bucket_size(i), 16);
+            if (!exp_pool.has_value()) {
+                return std::unexpected(std::move(exp_pool).error());
+            }
+            pools.push_back(std::move(exp_pool).value());
+        }
+        auto exp_buckets = size_class_buckets::create({
+            std::move(pools[0]), std::move(pools[1]), std::move(pools[2]), std::move(pools[3])});
+        if (!exp_buckets.has_value()) {
+            return std::unexpected(std::move(exp_buckets).error());
+        }
+        return lazy_pools(std::move(regions), std::move(exp_buckets).value());
+    }
+
+    std::expected<void*, std::string> allocate(std::size_t alignment, std::size_t size) noexcept
+    {
+        auto exp_ptr = buckets_.allocate(alignment, size);
+        if (exp_ptr.has_value() || exp_ptr.error() != "out of capacity") {
+            return exp_ptr;
+        }
+        std::size_t index = (size - 1) / 64;
+        amber::pool_allocator& pool = buckets_.bucket(index);
+        while (!exp_ptr.has_value() && regions_[index].grow() && pool.extend(regions_[index]).has_value()) {
+            exp_ptr = pool.allocate(alignment, size);
+        }
+        return exp_ptr;
+    }
+
+    void free(void* ptr) noexcept
+    {
+        buckets_.free(ptr);
+    }
+
+    bool owns(const void* ptr) const noexcept
+    {
+        return buckets_.owns(ptr);
+    }
+
+    // Bytes handed to the pools, the pages they have touched
+    std::size_t committed_size() const noexcept
+    {
+        std::size_t total = 0;
+        for (const pool_region& region : regions_) {
+            total += region.size();
+        }
+        return total;
+    }
+
+private:
+    lazy_pools(std::vector<pool_region>&& regions, size_class_buckets&& buckets) noexcept
+        : regions_(std::move(regions)),
+        buckets_(std::move(buckets))
+    {}
+
+    // Pools keep pointers into the regions, which do not move with the vector
+    std::vector<pool_region> regions_;
+    size_class_buckets buckets_;
+};
+
+using size_class_allocator = amber::segregator<256, lazy_pools, amber::malloc_allocator>;
+
+constexpr std::size_t synthetic_operation_count = 1'000'000;
+
+std::uint64_t next_random(std::uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+std::size_t random_size(std::uint64_t& state)
+{
+    std::uint64_t r = next_random(state) % 100;
+    if (r < 80) {
+        return 16 + (next_random(state) % 241);
+    }
+    if (r < 98) {
+        return 257 + (next_random(state) % 3840);
+    }
+    return 4097 + (next_random(state) % 61440);
+}
+
+// Mostly small allocations freed in random order, with occasional
+// reallocations and phases that release most of what is live
+bool write_synthetic_trace(const std::string& path)
+{
+    auto exp_writer = amber::trace_writer::create(path);
+    if (!exp_writer.has_value()) {
+        std::fprintf(stderr, "trace_writer::create failed: %s\n", exp_writer.error().c_str());
+        return false;
+    }
+    amber::trace_writer writer = std::move(exp_writer).value();
+    amber::malloc_allocator heap;
+    std::vector<std::pair<void*, std::size_t>> live;
+    std::uint64_t state = 0x2545f4914f6cdd1d;
+    for (std::size_t i = 0; i < synthetic_operation_count; ++i) {
+        std::uint64_t r = next_random(state) % 100;
+        if ((i % 100'000) == 99'999) {
+            while (live.size() > 64) {
+                writer.free(live.back().first);
+                heap.free(live.back().first);
+                live.pop_back();
+            }
+        } else if (live.empty() || r < 55) {
+            std::size_t size = random_size(state);
+            void* ptr = heap.allocate(16, size).value_or(nullptr);
+            if (ptr != nullptr) {
+                writer.allocate(ptr, 16, size);
+                live.emplace_back(ptr, size);
+            }
+        } else if (r < 60) {
+            auto& [ptr, size] = live[next_random(state) % live.size()];
+            std::size_t new_size = size * 2;
+            void* new_ptr = heap.allocate(16, new_size).value_or(nullptr);
+            if (new_ptr != nullptr) {
+                std::memcpy(new_ptr, ptr, size);
+                writer.reallocate(ptr, new_ptr, 16, new_size);
+                heap.free(ptr);
+                ptr = new_ptr;
+                size = new_size;
+            }
+        } else {
+            std::size_t index = next_random(state) % live.size();
+            writer.free(live[index].first);
+            heap.free(live[index].first);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+    for (auto& [ptr, size] : live) {
+        writer.free(ptr);
+        heap.free(ptr);
+    }
+    auto exp_finish = writer.finish();
+    if (!exp_finish.has_value()) {
+        std::fprintf(stderr, "trace_writer::finish failed: %s\n", exp_finish.error().c_str());
+        return false;
+    }
+    return true;
+}
+
+void print_result(const char* name, const std::expected<amber::replay_result, std::string>& exp_result)
+{
+    if (!exp_result.has_value()) {
+        std::fprintf(stderr, "%s replay failed: %s\n", name, exp_result.error().c_str());
+        return;
+    }
+    const amber::replay_result& result = exp_result.value();
+    double ns = static_cast<double>(result.elapsed.count());
+    double per_op = result.operation_count == 0 ? 0.0 : ns / static_cast<double>(result.operation_count);
+    std::printf("  %-12s %10.3f ms %8.2f ns/op  failed: %8zu  rss added: %8.2f MiB  fragmentation: %5.1f%%\n",
+        name, ns / 1e6, per_op, result.failed_count,
+        static_cast<double>(result.peak_rss - result.baseline_rss) / (1024.0 * 1024.0),
+        result.fragmentation * 100.0);
+}
+
+void replay_malloc(const amber::trace_file& trace)
+{
+    amber::malloc_allocator heap;
+    print_result("malloc", amber::replay_trace(trace, heap));
+}
+
+void replay_malloc_threaded(const amber::trace_file& trace)
+{
+    amber::malloc_allocator heap;
+    print_result("malloc mt", amber::replay_trace_threaded(trace, heap));
+}
+
+// Pools per 64 byte size class up to 256 bytes, malloc above
+void replay_size_classes(const amber::trace_file& trace)
+{
+    auto exp_pools = lazy_pools::create();
+    if (!exp_pools.has_value()) {
+        std::fprintf(stderr, "lazy_pools::create failed: %s\n", exp_pools.error().c_str());
+        return;
+    }
+    auto exp_allocator = size_class_allocator::create(std::move(exp_pools).value(), amber::malloc_allocator());
+    if (!exp_allocator.has_value()) {
+        std::fprintf(stderr, "segregator::create failed: %s\n", exp_allocator.error().c_str());
+        return;
+    }
+    size_class_allocator allocator = std::move(exp_allocator).value();
+    print_result("size classes", amber::replay_trace(trace, allocator));
+    std::printf("  size classes grew their pools to %.2f MiB\n",
+        static_cast<double>(allocator.small().committed_size()) / (1024.0 * 1024.0));
+}
+
+// Never frees, the upper bound on memory for an arena per request
+void replay_linear(const amber::trace_file& trace)
+{
+    std::size_t total = 0;
+    for (const amber::trace_record& record : trace.records()) {
+        total += record.size + (std::size_t(1) << record.alignment_shift);
+    }
+    auto exp_buffer = amber::mmap_buffer::create_lazy(std::max(total, std::size_t(1)));
+    if (!exp_buffer.has_value()) {
+        std::fprintf(stderr, "mmap_buffer::create_lazy failed: %s\n", exp_buffer.error().c_str());
+        return;
+    }
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+    auto exp_arena = amber::linear_allocator::create(buffer);
+    if (!exp_arena.has_value()) {
+        std::fprintf(stderr, "linear_allocator::create failed: %s\n", exp_arena.error().c_str());
+        return;
+    }
+    amber::linear_allocator arena = std::move(exp_arena).value();
+    print_result("linear", amber::replay_trace(trace, arena));
+}
+
+// Runs this binary again on the trace with only the named allocator, so each
+// replay starts from a fresh process whose resident set and heap hold nothing
+// left over from the others
+bool replay_in_child(const std::string& path, const char* name)
+{
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        std::fprintf(stderr, "fork failed: %s\n", std::strerror(errno));
+        return false;
+    }
+    if (pid == 0) {
+        const char* args[] = {"trace_replay_bench", path.c_str(), name, "--no-header", nullptr};
+        execv("/proc/self/exe", const_cast<char* const*>(args));
+        std::fprintf(stderr, "execv failed: %s\n", std::strerror(errno));
+        _exit(127);
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            std::fprintf(stderr, "waitpid failed: %s\n", std::strerror(errno));
+            return false;
+        }
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // unnamed namespace
+
+// Usage: trace_replay_bench [trace [malloc|size_classes|linear|threaded]]
+// Without a trace a synthetic one is written to the temporary directory.
+// Without an allocator each one is replayed in its own child process.
+int main(int argc, char** argv)
+{
+    std::string path;
+    bool synthetic = argc < 2;
+    if (synthetic) {
+        path = (std::filesystem::temp_directory_path() / "amber_trace_replay_bench.bin").string();
+        if (!write_synthetic_trace(path)) {
+            return 1;
+        }
+    } else {
+        path = argv[1];
+    }
+    std::string only = argc > 2 ? argv[2] : "";
+    bool header = argc <= 3 || std::strcmp(argv[3], "--no-header") != 0;
+
+    auto exp_trace = amber::trace_file::create(path);
+    if (!exp_trace.has_value()) {
+        std::fprintf(stderr, "trace_file::create failed: %s\n", exp_trace.error().c_str());
+        return 1;
+    }
+    amber::trace_file trace = std::move(exp_trace).value();
+    if (header) {
+        std::printf("trace: %s, operations: %zu, threads: %u, peak live: %.2f MiB\n",
+            path.c_str(), trace.records().size(), trace.header().thread_count,
+            static_cast<double>(trace.peak_live_size()) / (1024.0 * 1024.0));
+    }
+    if (only.empty()) {
+        bool succeeded = replay_in_child(path, "malloc")
+            && replay_in_child(path, "size_classes")
+            && replay_in_child(path, "linear")
+            && (trace.header().thread_count <= 1 || replay_in_child(path, "threaded"));
+        if (synthetic) {
+            std::filesystem::remove(path);
+        }
+        return succeeded ? 0 : 1;
+    }
+    if (only == "malloc") {
+        replay_malloc(trace);
+    } else if (only == "size_classes") {
+        replay_size_classes(trace);
+    } else if (only == "linear") {
+        replay_linear(trace);
+    } else if (only == "threaded") {
+        replay_malloc_threaded(trace);
+    } else {
+        std::fprintf(stderr, "unknown allocator: %s\n", only.c_str());
+        return 1;
+    }
+    return 0;
+}
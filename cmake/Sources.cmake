@@ -1,14 +1,63 @@
 set(AMBER_HEADERS
+    affix_allocator.hpp
+    affix_allocator.inl
     aligned_buffer.hpp
+    alloc_trace.hpp
+    alloc_trace.inl
     amber.hpp
+    arena_hash_map.hpp
+    arena_hash_map.inl
+    arena_new_delete.hpp
+    arena_scope.hpp
+    arena_scope.inl
+    arena_string.hpp
+    arena_string.inl
+    arena_vector.hpp
+    arena_vector.inl
     bitwise_enum.hpp
+    bucketizer.hpp
+    bucketizer.inl
+    compact_pool_allocator.hpp
+    compact_pool_allocator.inl
     concept.hpp
+    coroutine_frame.hpp
+    coroutine_frame.inl
+    double_stack_allocator.hpp
+    double_stack_allocator.inl
+    epoch_domain.hpp
+    epoch_domain.inl
+    fallback_allocator.hpp
+    fallback_allocator.inl
+    fiber_stack_pool.hpp
+    frame_allocator.hpp
+    frame_allocator.inl
+    heap_profiler.hpp
+    lifetime_analyzer.hpp
+    lifetime_recorder.hpp
+    lifetime_recorder.inl
     linear_allocator.hpp
     linear_allocator.inl
+    malloc_allocator.hpp
+    malloc_allocator.inl
     malloc_buffer.hpp
+    mirrored_buffer.hpp
     mmap_buffer.hpp
+    owned_pool_allocator.hpp
+    owned_pool_allocator.inl
     pool_allocator.hpp
     pool_allocator.inl
+    prefault.hpp
+    purge.hpp
+    segregator.hpp
+    segregator.inl
+    shared_buffer.hpp
+    shared_pool_allocator.hpp
+    shared_pool_allocator.inl
+    snapshot.hpp
+    span_buffer.hpp
+    span_buffer.inl
+    spsc_ring_allocator.hpp
+    spsc_ring_allocator.inl
     stack_allocator.hpp
     stack_allocator.inl
     util.hpp
@@ -17,10 +66,29 @@ set(AMBER_HEADERS
 
 set(AMBER_SOURCES
     aligned_buffer.cpp
+    alloc_trace.cpp
+    arena_scope.cpp
+    compact_pool_allocator.cpp
+    coroutine_frame.cpp
+    double_stack_allocator.cpp
+    epoch_domain.cpp
+    fiber_stack_pool.cpp
+    heap_profiler.cpp
+    lifetime_analyzer.cpp
     linear_allocator.cpp
+    malloc_allocator.cpp
     malloc_buffer.cpp
+    mirrored_buffer.cpp
     mmap_buffer.cpp
+    owned_pool_allocator.cpp
     pool_allocator.cpp
+    prefault.cpp
+    purge.cpp
+    shared_buffer.cpp
+    shared_pool_allocator.cpp
+    snapshot.cpp
+    span_buffer.cpp
+    spsc_ring_allocator.cpp
     stack_allocator.cpp
     util.cpp
 )
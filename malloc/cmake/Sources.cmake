@@ -0,0 +1,9 @@
+set(AMBER_MALLOC_SOURCES
+    amber_malloc.cpp
+)
+
+prepend_paths(
+    "${AMBER_MALLOC_SOURCES}"
+    "src/amber_malloc"
+    "AMBER_MALLOC_SOURCES"
+)
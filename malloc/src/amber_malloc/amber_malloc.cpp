@@ -0,0 +1,574 @@
+extern "C" {
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+}
+#include <algorithm>
+#include <amber/mmap_buffer.hpp>
+#include <amber/shared_pool_allocator.hpp>
+#include <amber/span_buffer.hpp>
+#include <amber/util.hpp>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+// Replacement for the C allocation functions, loaded with LD_PRELOAD. Sizes up
+// to max_small_size are served from size class pools, each a
+// shared_pool_allocator over a chunk of one reserved region, with
+// a per thread cache in front. Larger blocks get their own mmap_buffer, kept
+// in a header in front of the block.
+//
+// The pools and buffers are created in place rather than with malloc. Error
+// strings built on failed paths do come back into malloc, so init, which runs
+// inside call_once where that would deadlock, maps the region directly.
+
+namespace {
+
+constexpr std::size_t min_alignment = 16;
+
+constexpr std::size_t max_small_size = 32768;
+
+// Classes step by 16 bytes up to 128, then by a quarter of the power of two
+constexpr std::size_t linear_class_count = 8;
+
+constexpr std::size_t class_count = linear_class_count + (4 * 8);
+
+constexpr std::size_t chunk_size = std::size_t(1) << 20;
+
+// Address space only, pages are committed as chunks are used
+constexpr std::size_t region_size = std::size_t(64) << 30;
+
+constexpr std::size_t chunk_count = region_size / chunk_size;
+
+constexpr std::uint32_t no_chunk = UINT32_MAX;
+
+// Entries each thread keeps per class before returning half to the pools
+constexpr std::uint32_t cache_capacity = 32;
+
+constexpr std::size_t class_size(std::size_t size_class) noexcept
+{
+    if (size_class < linear_class_count) {
+        return (size_class + 1) * 16;
+    }
+    std::size_t group = (size_class - linear_class_count) / 4;
+    std::size_t step = (size_class - linear_class_count) % 4;
+    std::size_t base = std::size_t(128) << group;
+    return base + ((step + 1) * (base / 4));
+}
+
+constexpr std::size_t size_class_of(std::size_t size) noexcept
+{
+    if (size <= 128) {
+        return size == 0 ? 0 : (size - 1) / 16;
+    }
+    std::size_t group = static_cast<std::size_t>(std::bit_width(size - 1)) - 8;
+    std::size_t base = std::size_t(128) << group;
+    std::size_t step = ((size - base - 1) * 4) / base;
+    return linear_class_count + (group * 4) + step;
+}
+
+// Largest power of two dividing the class size, entries are placed on it
+constexpr std::size_t class_alignment(std::size_t size_class) noexcept
+{
+    std::size_t size = class_size(size_class);
+    return std::min(size & (~size + 1), std::size_t(4096));
+}
+
+static_assert(class_size(class_count - 1) == max_small_size);
+static_assert(size_class_of(max_small_size) == class_count - 1);
+static_assert(size_class_of(129) == linear_class_count);
+static_assert(size_class_of(160) == linear_class_count);
+static_assert(size_class_of(161) == linear_class_count + 1);
+
+struct size_class_state {
+public:
+    std::mutex mutex;
+    // Chunk refills are taken from first, no_chunk before the first refill
+    std::atomic<std::uint32_t> current{no_chunk};
+    // Chunks other than current that got entries back, linked through
+    // chunk_next, so a refill never walks the class' full chunks
+    std::uint32_t available = no_chunk;
+};
+
+// Header in front of a large block, on the page before it
+struct large_header {
+public:
+    amber::mmap_buffer buffer;
+    std::size_t size;
+};
+
+struct thread_cache {
+public:
+    std::uint32_t count[class_count];
+    void* entries[class_count][cache_capacity];
+    bool registered;
+};
+
+// Trivially constructed and destroyed so that no TLS initializer or
+// destructor registration runs on a thread's first allocation
+[[gnu::tls_model("initial-exec")]] constinit thread_local thread_cache cache{};
+
+// Everything below is constant initialized, other libraries may allocate
+// from their constructors before this one's would have run
+
+constinit std::once_flag init_flag;
+
+constinit bool init_ok = false;
+
+constinit pthread_key_t cache_key{};
+
+constinit std::byte* region_begin = nullptr;
+
+constinit std::atomic<std::uint32_t> next_chunk(0);
+
+alignas(amber::shared_pool_allocator)
+constinit std::byte pool_storage[chunk_count][sizeof(amber::shared_pool_allocator)]{};
+
+// Class of each chunk plus one, zero while unused
+constinit std::atomic<std::uint8_t> chunk_class[chunk_count]{};
+
+constinit std::uint32_t chunk_next[chunk_count]{};
+
+// Whether each chunk is its class' current chunk or on its available list
+constinit std::atomic<bool> chunk_listed[chunk_count]{};
+
+constinit size_class_state class_state[class_count]{};
+
+// Held while a large block's header is written or moved, so a fork never
+// copies one half rewritten into the child
+constinit std::mutex large_mutex;
+
+amber::shared_pool_allocator& chunk_pool(std::size_t chunk) noexcept
+{
+    return *std::launder(reinterpret_cast<amber::shared_pool_allocator*>(pool_storage[chunk]));
+}
+
+bool is_small(const void* ptr) noexcept
+{
+    const std::byte* byte_ptr = static_cast<const std::byte*>(ptr);
+    return region_begin != nullptr && byte_ptr >= region_begin && byte_ptr < region_begin + region_size;
+}
+
+std::size_t chunk_of(const void* ptr) noexcept
+{
+    return static_cast<std::size_t>(static_cast<const std::byte*>(ptr) - region_begin) / chunk_size;
+}
+
+void release_entry(void* ptr) noexcept
+{
+    std::size_t chunk = chunk_of(ptr);
+    chunk_pool(chunk).free(ptr);
+    // Pairs with the fence in unlist_chunk, either the refill dropping the
+    // chunk sees this entry or this sees the chunk dropped and lists it again
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (chunk_listed[chunk].load(std::memory_order_relaxed)
+        || chunk_listed[chunk].exchange(true, std::memory_order_relaxed)) [[likely]]
+    {
+        return;
+    }
+    size_class_state& state = class_state[chunk_class[chunk].load(std::memory_order_relaxed) - 1];
+    std::lock_guard lock(state.mutex);
+    chunk_next[chunk] = state.available;
+    state.available = static_cast<std::uint32_t>(chunk);
+}
+
+void flush_cache(void*) noexcept
+{
+    for (std::size_t c = 0; c < class_count; ++c) {
+        for (std::uint32_t i = 0; i < cache.count[c]; ++i) {
+            release_entry(cache.entries[c][i]);
+        }
+        cache.count[c] = 0;
+    }
+    cache.registered = false;
+}
+
+void init() noexcept
+{
+    // Never unmapped, so it needs no mmap_buffer, whose errors are formatted
+    void* region = mmap(
+        nullptr, region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region == MAP_FAILED) [[unlikely]] {
+        return;
+    }
+    if (pthread_key_create(&cache_key, flush_cache) != 0) [[unlikely]] {
+        munmap(region, region_size);
+        return;
+    }
+    region_begin = static_cast<std::byte*>(region);
+    init_ok = true;
+}
+
+bool ensure_init() noexcept
+{
+    std::call_once(init_flag, init);
+    return init_ok;
+}
+
+// Taken around fork in the order refill takes them, so the child never
+// inherits a lock held by a thread it does not have
+void lock_all() noexcept
+{
+    for (size_class_state& state : class_state) {
+        state.mutex.lock();
+    }
+    large_mutex.lock();
+}
+
+void unlock_all() noexcept
+{
+    large_mutex.unlock();
+    for (std::size_t c = class_count; c > 0; --c) {
+        class_state[c - 1].mutex.unlock();
+    }
+}
+
+// Registered at load rather than from init, pthread_atfork may allocate and
+// init runs inside call_once
+[[gnu::constructor]] void register_fork_handlers() noexcept
+{
+    pthread_atfork(lock_all, unlock_all, unlock_all);
+}
+
+// Takes entries from chunk into the cache, returns one of them
+void* take_entries(std::size_t size_class, std::uint32_t chunk) noexcept
+{
+    amber::shared_pool_allocator& pool = chunk_pool(chunk);
+    // Not zeroed, calloc clears what it hands out itself
+    auto exp_ptr = pool.allocate_uninitialized();
+    if (!exp_ptr.has_value()) {
+        return nullptr;
+    }
+    std::uint32_t& count = cache.count[size_class];
+    while (count < cache_capacity / 2) {
+        auto exp_extra = pool.allocate_uninitialized();
+        if (!exp_extra.has_value()) {
+            break;
+        }
+        cache.entries[size_class][count] = exp_extra.value();
+        count += 1;
+    }
+    return exp_ptr.value();
+}
+
+// Drops a drained chunk from its class, false when entries were freed into
+// it meanwhile and the caller keeps it. Called with the class mutex held.
+bool unlist_chunk(std::uint32_t chunk) noexcept
+{
+    chunk_listed[chunk].store(false, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (chunk_pool(chunk).entry_free_count() == 0) {
+        return true;
+    }
+    // Whichever of this and a freeing thread sets the flag back lists it
+    return chunk_listed[chunk].exchange(true, std::memory_order_relaxed);
+}
+
+// Finds a chunk of the class with free entries once exhausted ran out,
+// creating one when no chunk has any. Called with the class mutex held.
+std::uint32_t next_class_chunk(std::size_t size_class, std::uint32_t exhausted) noexcept
+{
+    size_class_state& state = class_state[size_class];
+    if (exhausted != no_chunk && !unlist_chunk(exhausted)) {
+        return exhausted;
+    }
+    while (state.available != no_chunk) {
+        // A refill that read current before it changed may have drained it
+        std::uint32_t chunk = state.available;
+        state.available = chunk_next[chunk];
+        if (chunk_pool(chunk).entry_free_count() > 0 || !unlist_chunk(chunk)) {
+            return chunk;
+        }
+    }
+    std::uint32_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+    if (chunk >= chunk_count) [[unlikely]] {
+        return no_chunk;
+    }
+    amber::span_buffer chunk_buffer(std::span<std::byte>(region_begin + (chunk * chunk_size), chunk_size));
+    auto exp_pool = amber::shared_pool_allocator::create(
+        chunk_buffer, class_size(size_class), class_alignment(size_class));
+    if (!exp_pool.has_value()) [[unlikely]] {
+        return no_chunk;
+    }
+    std::construct_at(
+        reinterpret_cast<amber::shared_pool_allocator*>(pool_storage[chunk]), std::move(exp_pool).value());
+    chunk_listed[chunk].store(true, std::memory_order_relaxed);
+    chunk_class[chunk].store(static_cast<std::uint8_t>(size_class + 1), std::memory_order_release);
+    return chunk;
+}
+
+void* refill(std::size_t size_class) noexcept
+{
+    size_class_state& state = class_state[size_class];
+    while (true) {
+        std::uint32_t chunk = state.current.load(std::memory_order_acquire);
+        if (chunk != no_chunk) {
+            void* ptr = take_entries(size_class, chunk);
+            if (ptr != nullptr) {
+                return ptr;
+            }
+        }
+        std::lock_guard lock(state.mutex);
+        if (state.current.load(std::memory_order_relaxed) != chunk) {
+            continue;
+        }
+        std::uint32_t next = next_class_chunk(size_class, chunk);
+        if (next == no_chunk) [[unlikely]] {
+            return nullptr;
+        }
+        state.current.store(next, std::memory_order_release);
+    }
+}
+
+void* allocate_small(std::size_t size_class) noexcept
+{
+    if (!cache.registered) [[unlikely]] {
+        // Returns the cache to the pools when the thread exits
+        cache.registered = true;
+        pthread_setspecific(cache_key, &cache);
+    }
+    std::uint32_t& count = cache.count[size_class];
+    if (count > 0) [[likely]] {
+        count -= 1;
+        return cache.entries[size_class][count];
+    }
+    return refill(size_class);
+}
+
+void free_small(void* ptr) noexcept
+{
+    std::size_t size_class = chunk_class[chunk_of(ptr)].load(std::memory_order_relaxed) - 1;
+    std::uint32_t& count = cache.count[size_class];
+    if (count == cache_capacity) [[unlikely]] {
+        for (std::uint32_t i = cache_capacity / 2; i < cache_capacity; ++i) {
+            release_entry(cache.entries[size_class][i]);
+        }
+        count = cache_capacity / 2;
+    }
+    cache.entries[size_class][count] = ptr;
+    count += 1;
+}
+
+large_header* header_of(void* ptr) noexcept
+{
+    return std::launder(reinterpret_cast<large_header*>(static_cast<std::byte*>(ptr) - sizeof(large_header)));
+}
+
+void* allocate_large(std::size_t alignment, std::size_t size) noexcept
+{
+    // mmap only aligns to a page, larger alignments map enough to skip ahead
+    std::size_t page_size = amber::page_size();
+    std::size_t padding = alignment > page_size ? alignment - page_size : 0;
+    if (size > SIZE_MAX - (2 * page_size) - padding) [[unlikely]] {
+        return nullptr;
+    }
+    auto exp_buffer = amber::mmap_buffer::create_lazy(
+        page_size + padding + amber::align_forward(page_size, size));
+    if (!exp_buffer.has_value()) [[unlikely]] {
+        return nullptr;
+    }
+    std::byte* mapping = exp_buffer.value().buffer().data();
+    std::byte* block = mapping + page_size;
+    block += amber::align_forward(alignment, reinterpret_cast<std::uintptr_t>(block))
+        - reinterpret_cast<std::uintptr_t>(block);
+    std::lock_guard lock(large_mutex);
+    std::construct_at(
+        reinterpret_cast<large_header*>(block - sizeof(large_header)),
+        large_header{std::move(exp_buffer).value(), size});
+    return block;
+}
+
+void free_large(void* ptr) noexcept
+{
+    // Moved out first, the destructor unmaps the header with the block
+    large_header* header = header_of(ptr);
+    std::unique_lock lock(large_mutex);
+    amber::mmap_buffer buffer = std::move(header->buffer);
+    std::destroy_at(header);
+    lock.unlock();
+}
+
+std::size_t usable_size(void* ptr) noexcept
+{
+    if (is_small(ptr)) {
+        return class_size(chunk_class[chunk_of(ptr)].load(std::memory_order_relaxed) - 1);
+    }
+    large_header* header = header_of(ptr);
+    std::span<std::byte> mapping = header->buffer.buffer();
+    return static_cast<std::size_t>(mapping.data() + mapping.size() - static_cast<std::byte*>(ptr));
+}
+
+void* allocate(std::size_t alignment, std::size_t size) noexcept
+{
+    if (!ensure_init()) [[unlikely]] {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    void* ptr = nullptr;
+    if (size <= max_small_size && alignment <= 4096) [[likely]] {
+        std::size_t size_class = size_class_of(std::max(size, alignment));
+        while (size_class < class_count && class_alignment(size_class) < alignment) {
+            ++size_class;
+        }
+        if (size_class < class_count) [[likely]] {
+            ptr = allocate_small(size_class);
+        } else {
+            ptr = allocate_large(alignment, size);
+        }
+    } else {
+        ptr = allocate_large(alignment, size);
+    }
+    if (ptr == nullptr) [[unlikely]] {
+        errno = ENOMEM;
+    }
+    return ptr;
+}
+
+void release(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    if (is_small(ptr)) [[likely]] {
+        free_small(ptr);
+    } else {
+        free_large(ptr);
+    }
+}
+
+void* reallocate(void* ptr, std::size_t size) noexcept
+{
+    if (ptr == nullptr) {
+        return allocate(min_alignment, size);
+    }
+    if (size == 0) {
+        release(ptr);
+        return nullptr;
+    }
+    std::size_t old_size = usable_size(ptr);
+    if (is_small(ptr)) {
+        // Keep the entry unless it is more than twice what is needed
+        if (size <= old_size && (size > old_size / 2 || old_size <= 16)) {
+            return ptr;
+        }
+    } else {
+        large_header* header = header_of(ptr);
+        std::byte* mapping = header->buffer.buffer().data();
+        std::size_t offset = static_cast<std::size_t>(static_cast<std::byte*>(ptr) - mapping);
+        if (size <= old_size && size > old_size / 2) {
+            header->size = size;
+            return ptr;
+        }
+        if (size > max_small_size) {
+            // Resized with mremap, the header moves along with the block. A
+            // moved mapping only keeps page alignment, all realloc promises.
+            std::lock_guard lock(large_mutex);
+            amber::mmap_buffer buffer = std::move(header->buffer);
+            std::size_t mapping_size = amber::align_forward(amber::page_size(), offset + size);
+            auto exp_resize = mapping_size > buffer.size() ? buffer.grow(mapping_size) : buffer.shrink(mapping_size);
+            std::byte* block = buffer.buffer().data() + offset;
+            std::construct_at(
+                reinterpret_cast<large_header*>(block - sizeof(large_header)),
+                large_header{std::move(buffer), exp_resize.has_value() ? size : old_size});
+            if (!exp_resize.has_value()) [[unlikely]] {
+                errno = ENOMEM;
+                return nullptr;
+            }
+            return block;
+        }
+    }
+    void* new_ptr = allocate(min_alignment, size);
+    if (new_ptr == nullptr) [[unlikely]] {
+        return nullptr;
+    }
+    std::memcpy(new_ptr, ptr, std::min(old_size, size));
+    release(ptr);
+    return new_ptr;
+}
+
+} // unnamed namespace
+
+extern "C" {
+
+[[gnu::visibility("default")]] void* malloc(std::size_t size) noexcept
+{
+    return allocate(min_alignment, size);
+}
+
+[[gnu::visibility("default")]] void free(void* ptr) noexcept
+{
+    release(ptr);
+}
+
+[[gnu::visibility("default")]] void* calloc(std::size_t count, std::size_t size) noexcept
+{
+    std::size_t total = 0;
+    if (__builtin_mul_overflow(count, size, &total)) [[unlikely]] {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    void* ptr = allocate(min_alignment, total);
+    // Fresh large mappings are already zero, cached entries are not
+    if (ptr != nullptr && is_small(ptr)) {
+        std::memset(ptr, 0, total);
+    }
+    return ptr;
+}
+
+[[gnu::visibility("default")]] void* realloc(void* ptr, std::size_t size) noexcept
+{
+    return reallocate(ptr, size);
+}
+
+[[gnu::visibility("default")]] int posix_memalign(void** out, std::size_t alignment, std::size_t size) noexcept
+{
+    if (!std::has_single_bit(alignment) || (alignment % sizeof(void*)) != 0) [[unlikely]] {
+        return EINVAL;
+    }
+    void* ptr = allocate(std::max(alignment, min_alignment), size);
+    if (ptr == nullptr) [[unlikely]] {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+[[gnu::visibility("default")]] void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+    if (!std::has_single_bit(alignment)) [[unlikely]] {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return allocate(std::max(alignment, min_alignment), size);
+}
+
+[[gnu::visibility("default")]] void* memalign(std::size_t alignment, std::size_t size) noexcept
+{
+    return aligned_alloc(alignment, size);
+}
+
+[[gnu::visibility("default")]] void* valloc(std::size_t size) noexcept
+{
+    return allocate(amber::page_size(), size);
+}
+
+[[gnu::visibility("default")]] void* pvalloc(std::size_t size) noexcept
+{
+    return allocate(amber::page_size(), amber::align_forward(amber::page_size(), size));
+}
+
+[[gnu::visibility("default")]] std::size_t malloc_usable_size(void* ptr) noexcept
+{
+    return ptr == nullptr ? 0 : usable_size(ptr);
+}
+
+} // extern "C"
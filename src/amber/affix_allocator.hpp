@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <amber/concept.hpp>
+#include <amber/util.hpp>
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+namespace internal {
+
+template<typename T>
+struct affix_traits {
+public:
+    static constexpr std::size_t size = sizeof(T);
+    static constexpr std::size_t alignment = alignof(T);
+};
+
+template<>
+struct affix_traits<void> {
+public:
+    static constexpr std::size_t size = 0;
+    static constexpr std::size_t alignment = 1;
+};
+
+template<typename T>
+concept AffixPrefix =
+    std::is_void_v<T>
+    || (std::is_nothrow_default_constructible_v<T> && std::is_nothrow_destructible_v<T>);
+
+// The suffix cannot be destroyed by free since the size is not passed back
+template<typename T>
+concept AffixSuffix =
+    std::is_void_v<T>
+    || (std::is_nothrow_default_constructible_v<T> && std::is_trivially_destructible_v<T>);
+
+} // namespace amber::internal
+
+// Wraps every allocation of Parent with a default constructed Prefix placed
+// directly before the returned pointer and a Suffix placed after size bytes,
+// e.g. a size or tag header, or a guard value for overrun checks. Either may
+// be void. With a prefix, alignments above block_alignment are rejected.
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix = void>
+class affix_allocator {
+public:
+    static constexpr std::size_t block_alignment = std::max({
+        alignof(std::max_align_t),
+        internal::affix_traits<Prefix>::alignment,
+        internal::affix_traits<Suffix>::alignment,
+    });
+
+    static constexpr std::size_t prefix_size = std::is_void_v<Prefix>
+        ? 0
+        : align_forward(block_alignment, internal::affix_traits<Prefix>::size);
+
+    affix_allocator() = delete;
+
+    affix_allocator(const affix_allocator&) = delete;
+
+    affix_allocator(affix_allocator&& other) noexcept = default;
+
+    affix_allocator& operator=(const affix_allocator&) = delete;
+
+    affix_allocator& operator=(affix_allocator&& other) noexcept = default;
+
+    ~affix_allocator() noexcept = default;
+
+    static
+    std::expected<affix_allocator, std::string> create(Parent&& parent) noexcept;
+
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    void free(void* ptr) noexcept;
+
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T>
+    void free(T* ptr) noexcept;
+
+    bool owns(const void* ptr) const noexcept
+    requires OwningAllocator<Parent>;
+
+    // Prefix of an allocation returned by allocate
+    Prefix* prefix(void* ptr) noexcept
+    requires (!std::is_void_v<Prefix>);
+
+    const Prefix* prefix(const void* ptr) const noexcept
+    requires (!std::is_void_v<Prefix>);
+
+    // Suffix of an allocation of size bytes returned by allocate
+    Suffix* suffix(void* ptr, std::size_t size) noexcept
+    requires (!std::is_void_v<Suffix>);
+
+    const Suffix* suffix(const void* ptr, std::size_t size) const noexcept
+    requires (!std::is_void_v<Suffix>);
+
+    Parent& parent() noexcept;
+
+    const Parent& parent() const noexcept;
+
+private:
+    static constexpr std::size_t suffix_offset(std::size_t size) noexcept;
+
+    affix_allocator(Parent&& parent) noexcept;
+
+    Parent parent_;
+};
+
+} // namespace amber
+
+#include <amber/affix_allocator.inl>
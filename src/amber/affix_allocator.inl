@@ -0,0 +1,158 @@
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+std::expected<affix_allocator<Parent, Prefix, Suffix>, std::string>
+affix_allocator<Parent, Prefix, Suffix>::create(Parent&& parent) noexcept
+{
+    static_assert(std::is_nothrow_move_constructible_v<Parent>);
+    return affix_allocator(std::move(parent));
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+std::expected<void*, std::string> affix_allocator<Parent, Prefix, Suffix>::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    std::size_t parent_alignment;
+    if constexpr (std::is_void_v<Prefix>) {
+        parent_alignment = std::max(alignment, internal::affix_traits<Suffix>::alignment);
+    } else {
+        if (alignment > block_alignment) [[unlikely]] {
+            return std::unexpected("alignment too large");
+        }
+        parent_alignment = block_alignment;
+    }
+    constexpr std::size_t overhead =
+        prefix_size + internal::affix_traits<Suffix>::alignment + internal::affix_traits<Suffix>::size;
+    if (size > std::numeric_limits<std::size_t>::max() - overhead) [[unlikely]] {
+        return std::unexpected("size too large");
+    }
+    std::size_t total_size = prefix_size + suffix_offset(size) + internal::affix_traits<Suffix>::size;
+    auto exp_block = parent_.allocate(parent_alignment, total_size);
+    if (!exp_block.has_value()) [[unlikely]] {
+        return exp_block;
+    }
+    std::byte* ptr = static_cast<std::byte*>(exp_block.value()) + prefix_size;
+    if constexpr (!std::is_void_v<Prefix>) {
+        Prefix* prefix_ptr = reinterpret_cast<Prefix*>(ptr - prefix_size);
+        prefix_ptr = std::assume_aligned<alignof(Prefix)>(prefix_ptr);
+        std::construct_at(prefix_ptr);
+    }
+    if constexpr (!std::is_void_v<Suffix>) {
+        Suffix* suffix_ptr = reinterpret_cast<Suffix*>(ptr + suffix_offset(size));
+        suffix_ptr = std::assume_aligned<alignof(Suffix)>(suffix_ptr);
+        std::construct_at(suffix_ptr);
+    }
+    return static_cast<void*>(ptr);
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+template<typename T, typename... Args>
+requires std::is_nothrow_constructible_v<T, Args...>
+std::expected<T*, std::string> affix_allocator<Parent, Prefix, Suffix>::allocate(Args&&... args) noexcept
+{
+    auto exp_ptr = allocate(alignof(T), sizeof(T));
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    T* ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(std::move(exp_ptr).value()));
+    return std::launder(std::construct_at(ptr, std::forward<Args>(args)...));
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+void affix_allocator<Parent, Prefix, Suffix>::free(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    if constexpr (!std::is_void_v<Prefix>) {
+        std::destroy_at(prefix(ptr));
+    }
+    if constexpr (DeallocatingAllocator<Parent>) {
+        parent_.free(static_cast<void*>(static_cast<std::byte*>(ptr) - prefix_size));
+    }
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+template<typename T>
+requires std::is_nothrow_destructible_v<T>
+void affix_allocator<Parent, Prefix, Suffix>::free(T* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::destroy_at(ptr);
+    free(static_cast<void*>(ptr));
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+bool affix_allocator<Parent, Prefix, Suffix>::owns(const void* ptr) const noexcept
+requires OwningAllocator<Parent>
+{
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    return parent_.owns(reinterpret_cast<const void*>(addr - prefix_size));
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+Prefix* affix_allocator<Parent, Prefix, Suffix>::prefix(void* ptr) noexcept
+requires (!std::is_void_v<Prefix>)
+{
+    Prefix* prefix_ptr = reinterpret_cast<Prefix*>(static_cast<std::byte*>(ptr) - prefix_size);
+    return std::launder(std::assume_aligned<alignof(Prefix)>(prefix_ptr));
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+const Prefix* affix_allocator<Parent, Prefix, Suffix>::prefix(const void* ptr) const noexcept
+requires (!std::is_void_v<Prefix>)
+{
+    const Prefix* prefix_ptr = reinterpret_cast<const Prefix*>(
+        static_cast<const std::byte*>(ptr) - prefix_size);
+    return std::launder(std::assume_aligned<alignof(Prefix)>(prefix_ptr));
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+Suffix* affix_allocator<Parent, Prefix, Suffix>::suffix(void* ptr, std::size_t size) noexcept
+requires (!std::is_void_v<Suffix>)
+{
+    Suffix* suffix_ptr = reinterpret_cast<Suffix*>(static_cast<std::byte*>(ptr) + suffix_offset(size));
+    return std::launder(std::assume_aligned<alignof(Suffix)>(suffix_ptr));
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+const Suffix* affix_allocator<Parent, Prefix, Suffix>::suffix(const void* ptr, std::size_t size) const noexcept
+requires (!std::is_void_v<Suffix>)
+{
+    const Suffix* suffix_ptr = reinterpret_cast<const Suffix*>(
+        static_cast<const std::byte*>(ptr) + suffix_offset(size));
+    return std::launder(std::assume_aligned<alignof(Suffix)>(suffix_ptr));
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+Parent& affix_allocator<Parent, Prefix, Suffix>::parent() noexcept
+{
+    return parent_;
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+const Parent& affix_allocator<Parent, Prefix, Suffix>::parent() const noexcept
+{
+    return parent_;
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+constexpr std::size_t affix_allocator<Parent, Prefix, Suffix>::suffix_offset(std::size_t size) noexcept
+{
+    return align_forward(internal::affix_traits<Suffix>::alignment, size);
+}
+
+template<Allocator Parent, internal::AffixPrefix Prefix, internal::AffixSuffix Suffix>
+affix_allocator<Parent, Prefix, Suffix>::affix_allocator(Parent&& parent) noexcept
+    : parent_(std::move(parent))
+{}
+
+} // namespace amber
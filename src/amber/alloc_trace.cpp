@@ -0,0 +1,868 @@
+extern "C" {
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+}
+#include <algorithm>
+#include <amber/alloc_trace.hpp>
+#include <amber/util.hpp>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace amber {
+
+namespace {
+
+constexpr std::array<char, 8> trace_magic{'A', 'M', 'B', 'E', 'R', 'T', 'R', 'C'};
+
+constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+constexpr std::size_t initial_address_capacity = 1024;
+
+constexpr std::size_t initial_free_object_capacity = 256;
+
+constexpr std::size_t max_thread_count = std::size_t(std::numeric_limits<std::uint16_t>::max()) + 1;
+
+constexpr std::size_t max_object_count = std::size_t(std::numeric_limits<std::uint32_t>::max()) + 1;
+
+std::atomic<std::uint64_t> next_trace_serial(1);
+
+// Trace thread index of the calling thread in the writer it recorded into last
+struct trace_thread {
+public:
+    std::uint64_t serial;
+    std::uint16_t index;
+};
+
+thread_local trace_thread current_trace_thread{0, 0};
+
+std::string trace_error(const char* call, int error, const std::string& path) noexcept
+{
+    auto&& exp_msg = mica::format("{} failed, error: {}, path: {}", call, std::strerror(error), path);
+    if (!exp_msg.has_value()) [[unlikely]] {
+        return "formatting failed while handling trace error";
+    }
+    return std::move(exp_msg).value();
+}
+
+void set_error(internal::trace_writer_control* control, std::string&& error) noexcept
+{
+    if (control->error.empty()) {
+        control->error = std::move(error);
+    }
+}
+
+bool write_all(int fd, const std::byte* data, std::size_t size) noexcept
+{
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+std::uint8_t alignment_shift(std::size_t alignment) noexcept
+{
+    return alignment == 0 ? 0 : static_cast<std::uint8_t>(std::countr_zero(alignment));
+}
+
+std::size_t address_hash(std::uintptr_t address, std::size_t capacity) noexcept
+{
+    // Fibonacci hashing, the low bits of addresses are mostly zero
+    std::uint64_t hash = static_cast<std::uint64_t>(address >> 4) * 0x9e3779b97f4a7c15;
+    return static_cast<std::size_t>(hash >> (64 - std::countr_zero(capacity)));
+}
+
+std::size_t find_address(const internal::trace_writer_control* control, std::uintptr_t address) noexcept
+{
+    std::size_t mask = control->address_capacity - 1;
+    for (std::size_t i = address_hash(address, control->address_capacity);; i = (i + 1) & mask) {
+        if (control->addresses[i].address == address) {
+            return i;
+        }
+        if (control->addresses[i].address == 0) {
+            return npos;
+        }
+    }
+}
+
+void place_address(internal::trace_writer_control* control, const internal::trace_address& entry) noexcept
+{
+    std::size_t mask = control->address_capacity - 1;
+    std::size_t i = address_hash(entry.address, control->address_capacity);
+    while (control->addresses[i].address != 0) {
+        i = (i + 1) & mask;
+    }
+    control->addresses[i] = entry;
+}
+
+bool insert_address(internal::trace_writer_control* control, const internal::trace_address& entry) noexcept
+{
+    // Keep the table at most half full so probe sequences stay short
+    if ((control->address_count + 1) * 2 > control->address_capacity) {
+        std::size_t capacity = control->address_capacity * 2;
+        auto exp_table = aligned_alloc(alignof(internal::trace_address), capacity * sizeof(internal::trace_address));
+        if (!exp_table.has_value()) [[unlikely]] {
+            set_error(control, std::move(exp_table).error());
+            return false;
+        }
+        internal::trace_address* old_table = std::exchange(
+            control->addresses, static_cast<internal::trace_address*>(exp_table.value()));
+        std::size_t old_capacity = std::exchange(control->address_capacity, capacity);
+        std::memset(static_cast<void*>(control->addresses), 0, capacity * sizeof(internal::trace_address));
+        for (std::size_t i = 0; i < old_capacity; ++i) {
+            if (old_table[i].address != 0) {
+                place_address(control, old_table[i]);
+            }
+        }
+        aligned_free(old_table);
+    }
+    place_address(control, entry);
+    control->address_count += 1;
+    return true;
+}
+
+// Backward shift deletion, linear probing needs no tombstones
+void erase_address(internal::trace_writer_control* control, std::size_t index) noexcept
+{
+    std::size_t mask = control->address_capacity - 1;
+    std::size_t hole = index;
+    for (std::size_t i = (index + 1) & mask; control->addresses[i].address != 0; i = (i + 1) & mask) {
+        std::size_t home = address_hash(control->addresses[i].address, control->address_capacity);
+        // Move the entry into the hole unless its home lies cyclically in (hole, i]
+        bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (!stays) {
+            control->addresses[hole] = control->addresses[i];
+            hole = i;
+        }
+    }
+    control->addresses[hole].address = 0;
+    control->address_count -= 1;
+}
+
+std::optional<std::uint32_t> acquire_object(internal::trace_writer_control* control) noexcept
+{
+    if (control->free_object_count > 0) {
+        control->free_object_count -= 1;
+        return control->free_objects[control->free_object_count];
+    }
+    if (control->object_count == max_object_count - 1) [[unlikely]] {
+        set_error(control, "too many live trace objects");
+        return std::nullopt;
+    }
+    return control->object_count++;
+}
+
+void release_object(internal::trace_writer_control* control, std::uint32_t object) noexcept
+{
+    if (control->free_object_count == control->free_object_capacity) {
+        std::size_t capacity = control->free_object_capacity * 2;
+        auto exp_stack = aligned_alloc(alignof(std::uint32_t), capacity * sizeof(std::uint32_t));
+        if (!exp_stack.has_value()) [[unlikely]] {
+            // The id is not reused, the trace stays valid
+            set_error(control, std::move(exp_stack).error());
+            return;
+        }
+        std::uint32_t* stack = static_cast<std::uint32_t*>(exp_stack.value());
+        std::memcpy(stack, control->free_objects, control->free_object_count * sizeof(std::uint32_t));
+        aligned_free(std::exchange(control->free_objects, stack));
+        control->free_object_capacity = capacity;
+    }
+    control->free_objects[control->free_object_count] = object;
+    control->free_object_count += 1;
+}
+
+std::optional<std::uint16_t> thread_index(internal::trace_writer_control* control) noexcept
+{
+    if (current_trace_thread.serial == control->serial) {
+        return current_trace_thread.index;
+    }
+    if (control->thread_count == max_thread_count) [[unlikely]] {
+        set_error(control, "too many trace threads");
+        return std::nullopt;
+    }
+    current_trace_thread.serial = control->serial;
+    current_trace_thread.index = static_cast<std::uint16_t>(control->thread_count);
+    control->thread_count += 1;
+    return current_trace_thread.index;
+}
+
+void flush_records(internal::trace_writer_control* control) noexcept
+{
+    if (control->pending_count == 0) {
+        return;
+    }
+    const std::byte* data = reinterpret_cast<const std::byte*>(control->pending);
+    if (!write_all(control->fd, data, control->pending_count * sizeof(trace_record))) [[unlikely]] {
+        set_error(control, trace_error("write", errno, control->tmp_path));
+    }
+    control->pending_count = 0;
+}
+
+void append_record(internal::trace_writer_control* control, const trace_record& record) noexcept
+{
+    control->pending[control->pending_count] = record;
+    control->pending_count += 1;
+    control->record_count += 1;
+    if (control->pending_count == internal::trace_batch_size) {
+        flush_records(control);
+    }
+}
+
+// Records a free of the object at index, for addresses reused without a free
+void retire_address(internal::trace_writer_control* control, std::size_t index, std::uint16_t thread) noexcept
+{
+    std::uint32_t object = control->addresses[index].object;
+    erase_address(control, index);
+    append_record(control, trace_record{
+        .size = 0,
+        .object = object,
+        .thread = thread,
+        .op = trace_op::free,
+        .alignment_shift = 0,
+    });
+    release_object(control, object);
+}
+
+void record_allocate(
+    internal::trace_writer_control* control, const void* ptr, std::uint8_t shift, std::size_t size) noexcept
+{
+    std::optional<std::uint16_t> thread = thread_index(control);
+    if (!thread.has_value()) [[unlikely]] {
+        return;
+    }
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(ptr);
+    std::size_t stale = find_address(control, address);
+    if (stale != npos) [[unlikely]] {
+        retire_address(control, stale, thread.value());
+    }
+    std::optional<std::uint32_t> object = acquire_object(control);
+    if (!object.has_value()) [[unlikely]] {
+        return;
+    }
+    if (!insert_address(control, internal::trace_address{address, object.value(), shift})) [[unlikely]] {
+        release_object(control, object.value());
+        return;
+    }
+    append_record(control, trace_record{
+        .size = size,
+        .object = object.value(),
+        .thread = thread.value(),
+        .op = trace_op::allocate,
+        .alignment_shift = shift,
+    });
+}
+
+void release_control(internal::trace_writer_control* control) noexcept
+{
+    if (control->fd != -1) {
+        close(control->fd);
+        unlink(control->tmp_path.c_str());
+    }
+    aligned_free(control->addresses);
+    aligned_free(control->free_objects);
+    std::destroy_at(control);
+    aligned_free(control);
+}
+
+std::size_t read_proc_file(const char* path, char* buffer, std::size_t size) noexcept
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return 0;
+    }
+    std::size_t length = 0;
+    while (length + 1 < size) {
+        ssize_t count = read(fd, buffer + length, size - length - 1);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            break;
+        }
+        length += static_cast<std::size_t>(count);
+    }
+    close(fd);
+    buffer[length] = '\0';
+    return length;
+}
+
+// Set by run_replay_threads once every thread exists, or to abort
+constexpr int replay_run = 1;
+constexpr int replay_abort = 2;
+
+// Resident set size sampling period while replay threads run
+constexpr long replay_sample_period_ns = 200'000;
+
+struct replay_run_state {
+public:
+    std::atomic<int> start;
+    // Threads that have not finished yet
+    std::atomic<std::size_t> running_count;
+    // Written by the last thread to finish
+    std::chrono::steady_clock::time_point end;
+};
+
+struct replay_thread_arg {
+public:
+    void (*fn)(void*, std::size_t);
+    void* context;
+    std::size_t index;
+    replay_run_state* state;
+};
+
+void* replay_thread_main(void* arg) noexcept
+{
+    replay_thread_arg* thread_arg = static_cast<replay_thread_arg*>(arg);
+    replay_run_state* state = thread_arg->state;
+    state->start.wait(0, std::memory_order_acquire);
+    if (state->start.load(std::memory_order_acquire) == replay_run) {
+        thread_arg->fn(thread_arg->context, thread_arg->index);
+    }
+    if (state->running_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        state->end = std::chrono::steady_clock::now();
+    }
+    return nullptr;
+}
+
+} // unnamed namespace
+
+namespace internal {
+
+trace_writer_control::trace_writer_control(
+    int fd, std::string&& path, std::string&& tmp_path, std::uint64_t serial) noexcept
+    : mutex(),
+    fd(fd),
+    path(std::move(path)),
+    tmp_path(std::move(tmp_path)),
+    serial(serial),
+    thread_count(0),
+    record_count(0),
+    object_count(0),
+    addresses(nullptr),
+    address_capacity(0),
+    address_count(0),
+    free_objects(nullptr),
+    free_object_capacity(0),
+    free_object_count(0),
+    error(),
+    pending_count(0),
+    pending()
+{}
+
+std::size_t resident_size() noexcept
+{
+    char buffer[128];
+    std::size_t length = read_proc_file("/proc/self/statm", buffer, sizeof(buffer));
+    // Total program size, then resident pages
+    const char* field = std::find(buffer, buffer + length, ' ');
+    if (field == buffer + length) {
+        return 0;
+    }
+    std::size_t pages = 0;
+    std::from_chars(field + 1, buffer + length, pages);
+    return pages * page_size();
+}
+
+bool reset_peak_resident_size() noexcept
+{
+    int fd = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    bool reset = write(fd, "5", 1) == 1;
+    close(fd);
+    return reset;
+}
+
+std::size_t peak_resident_size() noexcept
+{
+    char buffer[4096];
+    std::size_t length = read_proc_file("/proc/self/status", buffer, sizeof(buffer));
+    const char* line = std::strstr(buffer, "VmHWM:");
+    if (line == nullptr) {
+        return 0;
+    }
+    const char* digits = line + 6;
+    while (*digits == ' ' || *digits == '\t') {
+        ++digits;
+    }
+    std::size_t kib = 0;
+    std::from_chars(digits, buffer + length, kib);
+    return kib * 1024;
+}
+
+void touch_pages(void* ptr, std::size_t size) noexcept
+{
+    if (size == 0) {
+        return;
+    }
+    volatile std::byte* bytes = static_cast<std::byte*>(ptr);
+    std::size_t page = page_size();
+    for (std::size_t offset = 0; offset < size; offset += page) {
+        bytes[offset] = std::byte(0);
+    }
+    bytes[size - 1] = std::byte(0);
+}
+
+std::expected<mmap_buffer, std::string> create_replay_slots(std::size_t object_count) noexcept
+{
+    // Populated up front so the table is part of the baseline resident set
+    auto exp_buffer = mmap_buffer::create(std::max(object_count * sizeof(replay_slot), page_size()));
+    if (!exp_buffer.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_buffer).error());
+    }
+    mmap_buffer buffer = std::move(exp_buffer).value();
+    replay_slot* slots = reinterpret_cast<replay_slot*>(buffer.buffer().data());
+    for (std::size_t i = 0; i < object_count; ++i) {
+        std::construct_at(slots + i);
+        slots[i].version.store(0, std::memory_order_relaxed);
+        slots[i].ptr = nullptr;
+        slots[i].size = 0;
+    }
+    return buffer;
+}
+
+std::expected<replay_schedule, std::string> create_replay_schedule(
+    std::span<const trace_record> records, std::size_t object_count, std::size_t thread_count) noexcept
+{
+    std::size_t version_size = align_forward(alignof(std::size_t), records.size() * sizeof(std::uint32_t));
+    std::size_t order_size = records.size() * sizeof(std::size_t);
+    std::size_t begin_size = (thread_count + 1) * sizeof(std::size_t);
+    std::size_t fill_size = thread_count * sizeof(std::size_t);
+    std::size_t counter_size = object_count * sizeof(std::uint32_t);
+    auto exp_memory = mmap_buffer::create(
+        std::max(version_size + order_size + begin_size + fill_size + counter_size, page_size()));
+    if (!exp_memory.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_memory).error());
+    }
+    mmap_buffer memory = std::move(exp_memory).value();
+    std::byte* data = memory.buffer().data();
+    std::uint32_t* version = std::launder(reinterpret_cast<std::uint32_t*>(data));
+    data += version_size;
+    std::size_t* order = std::launder(reinterpret_cast<std::size_t*>(data));
+    data += order_size;
+    std::size_t* thread_begin = std::launder(reinterpret_cast<std::size_t*>(data));
+    data += begin_size;
+    std::size_t* fill = std::launder(reinterpret_cast<std::size_t*>(data));
+    data += fill_size;
+    std::uint32_t* counter = std::launder(reinterpret_cast<std::uint32_t*>(data));
+
+    // The mapping is zeroed, so the counts start at zero
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        version[i] = counter[records[i].object]++;
+        thread_begin[records[i].thread + 1] += 1;
+    }
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        thread_begin[t + 1] += thread_begin[t];
+    }
+    // Counting sort by thread, each thread keeps its recorded order
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        std::size_t thread = records[i].thread;
+        order[thread_begin[thread] + fill[thread]] = i;
+        fill[thread] += 1;
+    }
+    return replay_schedule{
+        .memory = std::move(memory),
+        .version = std::span<const std::uint32_t>(version, records.size()),
+        .order = std::span<const std::size_t>(order, records.size()),
+        .thread_begin = std::span<const std::size_t>(thread_begin, thread_count + 1),
+    };
+}
+
+std::expected<std::chrono::nanoseconds, std::string> run_replay_threads(
+    std::size_t thread_count, void (*fn)(void*, std::size_t), void* context, std::size_t& peak_rss) noexcept
+{
+    if (thread_count == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    auto exp_args = aligned_alloc(alignof(replay_thread_arg), thread_count * (sizeof(replay_thread_arg) + sizeof(pthread_t)));
+    if (!exp_args.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_args).error());
+    }
+    replay_thread_arg* args = static_cast<replay_thread_arg*>(exp_args.value());
+    pthread_t* threads = reinterpret_cast<pthread_t*>(args + thread_count);
+    replay_run_state state{.start = 0, .running_count = 0, .end = {}};
+    std::size_t started_count = 0;
+    int status = 0;
+    for (; started_count < thread_count; ++started_count) {
+        std::construct_at(args + started_count, replay_thread_arg{fn, context, started_count, &state});
+        status = pthread_create(threads + started_count, nullptr, replay_thread_main, args + started_count);
+        if (status != 0) [[unlikely]] {
+            break;
+        }
+    }
+    // Threads only finish after start is set
+    state.running_count.store(started_count, std::memory_order_relaxed);
+    auto begin = std::chrono::steady_clock::now();
+    state.start.store(status == 0 ? replay_run : replay_abort, std::memory_order_release);
+    state.start.notify_all();
+    // The resident set may peak and shrink again long before the last thread
+    // finishes, so it is sampled for the whole replay
+    while (status == 0 && state.running_count.load(std::memory_order_acquire) > 0) {
+        peak_rss = std::max(peak_rss, resident_size());
+        timespec pause{.tv_sec = 0, .tv_nsec = replay_sample_period_ns};
+        nanosleep(&pause, nullptr);
+    }
+    for (std::size_t i = 0; i < started_count; ++i) {
+        pthread_join(threads[i], nullptr);
+    }
+    std::chrono::steady_clock::time_point end = started_count > 0 ? state.end : begin;
+    aligned_free(args);
+    if (status != 0) [[unlikely]] {
+        auto&& exp_msg = mica::format("pthread_create failed, error: {}", std::strerror(status));
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling pthread_create error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+}
+
+} // namespace amber::internal
+
+trace_writer::trace_writer(trace_writer&& other) noexcept
+    : control_(std::exchange(other.control_, nullptr))
+{}
+
+trace_writer& trace_writer::operator=(trace_writer&& other) noexcept
+{
+    if (this != &other) {
+        if (control_ != nullptr) {
+            release_control(control_);
+        }
+        control_ = std::exchange(other.control_, nullptr);
+    }
+    return *this;
+}
+
+trace_writer::~trace_writer() noexcept
+{
+    if (control_ != nullptr) {
+        release_control(control_);
+    }
+    control_ = nullptr;
+}
+
+std::expected<trace_writer, std::string> trace_writer::create(const std::string& path) noexcept
+{
+    std::string file_path;
+    std::string tmp_path;
+    try {
+        file_path = path;
+        tmp_path = path + ".tmp";
+    } catch (...) {
+        return std::unexpected("out of memory");
+    }
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) [[unlikely]] {
+        return std::unexpected(trace_error("open", errno, tmp_path));
+    }
+    // The header is written by finish once the counts are known
+    std::array<std::byte, sizeof(trace_header)> header_bytes{};
+    if (!write_all(fd, header_bytes.data(), header_bytes.size())) [[unlikely]] {
+        int error = errno;
+        close(fd);
+        unlink(tmp_path.c_str());
+        return std::unexpected(trace_error("write", error, tmp_path));
+    }
+    auto exp_memory = aligned_alloc(alignof(internal::trace_writer_control), sizeof(internal::trace_writer_control));
+    if (!exp_memory.has_value()) [[unlikely]] {
+        close(fd);
+        unlink(tmp_path.c_str());
+        return std::unexpected(std::move(exp_memory).error());
+    }
+    internal::trace_writer_control* control = std::construct_at(
+        static_cast<internal::trace_writer_control*>(exp_memory.value()),
+        fd, std::move(file_path), std::move(tmp_path),
+        next_trace_serial.fetch_add(1, std::memory_order_relaxed));
+    auto exp_addresses = aligned_alloc(
+        alignof(internal::trace_address), initial_address_capacity * sizeof(internal::trace_address));
+    auto exp_objects = aligned_alloc(alignof(std::uint32_t), initial_free_object_capacity * sizeof(std::uint32_t));
+    if (exp_addresses.has_value()) {
+        control->addresses = static_cast<internal::trace_address*>(exp_addresses.value());
+        control->address_capacity = initial_address_capacity;
+        std::memset(static_cast<void*>(control->addresses), 0,
+            initial_address_capacity * sizeof(internal::trace_address));
+    }
+    if (exp_objects.has_value()) {
+        control->free_objects = static_cast<std::uint32_t*>(exp_objects.value());
+        control->free_object_capacity = initial_free_object_capacity;
+    }
+    if (!exp_addresses.has_value() || !exp_objects.has_value()) [[unlikely]] {
+        std::string error = !exp_addresses.has_value()
+            ? std::move(exp_addresses).error()
+            : std::move(exp_objects).error();
+        release_control(control);
+        return std::unexpected(std::move(error));
+    }
+    return trace_writer(control);
+}
+
+void trace_writer::allocate(const void* ptr, std::size_t alignment, std::size_t size) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::lock_guard lock(control_->mutex);
+    if (control_->fd == -1) [[unlikely]] {
+        return;
+    }
+    record_allocate(control_, ptr, alignment_shift(alignment), size);
+}
+
+void trace_writer::reallocate(
+    const void* old_ptr, const void* new_ptr, std::size_t alignment, std::size_t size) noexcept
+{
+    if (new_ptr == nullptr) {
+        return;
+    }
+    std::lock_guard lock(control_->mutex);
+    if (control_->fd == -1) [[unlikely]] {
+        return;
+    }
+    std::uintptr_t old_address = reinterpret_cast<std::uintptr_t>(old_ptr);
+    std::uintptr_t new_address = reinterpret_cast<std::uintptr_t>(new_ptr);
+    std::size_t index = old_ptr == nullptr ? npos : find_address(control_, old_address);
+    if (index == npos) {
+        record_allocate(control_, new_ptr, alignment_shift(alignment), size);
+        return;
+    }
+    std::optional<std::uint16_t> thread = thread_index(control_);
+    if (!thread.has_value()) [[unlikely]] {
+        return;
+    }
+    internal::trace_address entry = control_->addresses[index];
+    if (alignment != 0) {
+        entry.alignment_shift = alignment_shift(alignment);
+    }
+    if (new_address != old_address) {
+        erase_address(control_, index);
+        std::size_t stale = find_address(control_, new_address);
+        if (stale != npos) [[unlikely]] {
+            retire_address(control_, stale, thread.value());
+        }
+        entry.address = new_address;
+        if (!insert_address(control_, entry)) [[unlikely]] {
+            return;
+        }
+    } else {
+        control_->addresses[index] = entry;
+    }
+    append_record(control_, trace_record{
+        .size = size,
+        .object = entry.object,
+        .thread = thread.value(),
+        .op = trace_op::reallocate,
+        .alignment_shift = entry.alignment_shift,
+    });
+}
+
+void trace_writer::free(const void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::lock_guard lock(control_->mutex);
+    if (control_->fd == -1) [[unlikely]] {
+        return;
+    }
+    std::size_t index = find_address(control_, reinterpret_cast<std::uintptr_t>(ptr));
+    if (index == npos) {
+        return;
+    }
+    std::optional<std::uint16_t> thread = thread_index(control_);
+    if (!thread.has_value()) [[unlikely]] {
+        return;
+    }
+    retire_address(control_, index, thread.value());
+}
+
+std::expected<void, std::string> trace_writer::finish() noexcept
+{
+    std::lock_guard lock(control_->mutex);
+    if (control_->fd == -1) [[unlikely]] {
+        return std::unexpected("trace already finished");
+    }
+    flush_records(control_);
+    trace_header header{};
+    header.magic = trace_magic;
+    header.version = trace_version;
+    header.thread_count = control_->thread_count;
+    header.record_count = control_->record_count;
+    header.object_count = control_->object_count;
+    header.data_offset = sizeof(trace_header);
+    bool ok = pwrite(control_->fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+        && fsync(control_->fd) == 0;
+    int error = errno;
+    close(control_->fd);
+    control_->fd = -1;
+    if (!ok) [[unlikely]] {
+        set_error(control_, trace_error("write", error, control_->tmp_path));
+    }
+    if (!control_->error.empty()) [[unlikely]] {
+        unlink(control_->tmp_path.c_str());
+        return std::unexpected(control_->error);
+    }
+    if (rename(control_->tmp_path.c_str(), control_->path.c_str()) == -1) [[unlikely]] {
+        error = errno;
+        unlink(control_->tmp_path.c_str());
+        return std::unexpected(trace_error("rename", error, control_->path));
+    }
+    return {};
+}
+
+std::size_t trace_writer::record_count() const noexcept
+{
+    std::lock_guard lock(control_->mutex);
+    return control_->record_count;
+}
+
+trace_writer::trace_writer(internal::trace_writer_control* control) noexcept
+    : control_(control)
+{}
+
+trace_file::trace_file(trace_file&& other) noexcept
+    : mapping_(std::exchange(other.mapping_, nullptr)),
+    mapping_size_(std::exchange(other.mapping_size_, 0)),
+    header_(other.header_),
+    peak_live_size_(std::exchange(other.peak_live_size_, 0))
+{}
+
+trace_file& trace_file::operator=(trace_file&& other) noexcept
+{
+    if (this != &other) {
+        if (mapping_ != nullptr) {
+            munmap(mapping_, mapping_size_);
+            mapping_ = nullptr;
+        }
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        mapping_size_ = std::exchange(other.mapping_size_, 0);
+        header_ = other.header_;
+        peak_live_size_ = std::exchange(other.peak_live_size_, 0);
+    }
+    return *this;
+}
+
+trace_file::~trace_file() noexcept
+{
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_size_);
+    }
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+}
+
+std::expected<trace_file, std::string> trace_file::create(const std::string& path) noexcept
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) [[unlikely]] {
+        return std::unexpected(trace_error("open", errno, path));
+    }
+    struct stat file_stat{};
+    trace_header header{};
+    if (fstat(fd, &file_stat) == -1
+        || pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) [[unlikely]]
+    {
+        int error = errno;
+        close(fd);
+        return std::unexpected(trace_error("read", error, path));
+    }
+    std::size_t file_size = static_cast<std::size_t>(file_stat.st_size);
+    if (header.magic != trace_magic
+        || header.version != trace_version
+        || header.data_offset != sizeof(trace_header)
+        || header.thread_count > max_thread_count
+        || header.object_count > max_object_count
+        || header.record_count > (file_size - sizeof(trace_header)) / sizeof(trace_record)
+        || header.data_offset + (header.record_count * sizeof(trace_record)) != file_size) [[unlikely]]
+    {
+        close(fd);
+        return std::unexpected("invalid trace header");
+    }
+    void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int error = errno;
+    close(fd);
+    if (mapping == MAP_FAILED) [[unlikely]] {
+        return std::unexpected(trace_error("mmap", error, path));
+    }
+    std::span<const trace_record> records(
+        std::launder(reinterpret_cast<const trace_record*>(static_cast<std::byte*>(mapping) + header.data_offset)),
+        header.record_count);
+
+    // Check every record once here so replays can index by object and thread
+    // without bounds checks, and find the peak of the live size on the way
+    auto exp_sizes = mmap_buffer::create_lazy(std::max(header.object_count * sizeof(std::size_t), page_size()));
+    if (!exp_sizes.has_value()) [[unlikely]] {
+        munmap(mapping, file_size);
+        return std::unexpected(std::move(exp_sizes).error());
+    }
+    mmap_buffer size_buffer = std::move(exp_sizes).value();
+    std::size_t* sizes = std::launder(reinterpret_cast<std::size_t*>(size_buffer.buffer().data()));
+    std::size_t live_size = 0;
+    std::size_t peak_live_size = 0;
+    for (const trace_record& record : records) {
+        if (record.op < trace_op::allocate || record.op > trace_op::free
+            || record.object >= header.object_count
+            || record.thread >= header.thread_count
+            || record.alignment_shift >= std::numeric_limits<std::size_t>::digits) [[unlikely]]
+        {
+            munmap(mapping, file_size);
+            return std::unexpected("invalid trace record");
+        }
+        std::size_t size = record.op == trace_op::free ? 0 : record.size;
+        live_size = live_size - sizes[record.object] + size;
+        sizes[record.object] = size;
+        peak_live_size = std::max(peak_live_size, live_size);
+    }
+    return trace_file(static_cast<std::byte*>(mapping), file_size, header, peak_live_size);
+}
+
+const trace_header& trace_file::header() const noexcept
+{
+    return header_;
+}
+
+std::span<const trace_record> trace_file::records() const noexcept
+{
+    return std::span(
+        std::launder(reinterpret_cast<const trace_record*>(mapping_ + header_.data_offset)),
+        header_.record_count);
+}
+
+std::size_t trace_file::peak_live_size() const noexcept
+{
+    return peak_live_size_;
+}
+
+trace_file::trace_file(
+    std::byte* mapping,
+    std::size_t mapping_size,
+    const trace_header& header,
+    std::size_t peak_live_size
+) noexcept
+    : mapping_(mapping),
+    mapping_size_(mapping_size),
+    header_(header),
+    peak_live_size_(peak_live_size)
+{}
+
+} // namespace amber
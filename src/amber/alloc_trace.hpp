@@ -0,0 +1,288 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <amber/mmap_buffer.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <mutex>
+#include <span>
+#include <string>
+
+namespace amber {
+
+inline constexpr std::uint32_t trace_version = 1;
+
+enum class trace_op : std::uint8_t {
+    allocate = 1,
+    reallocate = 2,
+    free = 3,
+};
+
+// One operation of an allocation trace. Allocations are named by dense object
+// ids that are reused once freed, so a replay keeps its pointers in a flat
+// table indexed by object.
+struct trace_record {
+public:
+    // Requested size, zero for frees
+    std::uint64_t size;
+    std::uint32_t object;
+    std::uint16_t thread;
+    trace_op op;
+    // Requested alignment is 1 << alignment_shift
+    std::uint8_t alignment_shift;
+};
+
+// First bytes of a trace file, the records follow at data_offset
+struct trace_header {
+public:
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t thread_count;
+    std::uint64_t record_count;
+    std::uint64_t object_count;
+    std::uint64_t data_offset;
+};
+
+namespace internal {
+
+inline constexpr std::size_t trace_batch_size = 4096;
+
+// Address of a live allocation and its object id, address zero when unused
+struct trace_address {
+public:
+    std::uintptr_t address;
+    std::uint32_t object;
+    std::uint8_t alignment_shift;
+};
+
+struct trace_writer_control {
+public:
+    trace_writer_control(int fd, std::string&& path, std::string&& tmp_path, std::uint64_t serial) noexcept;
+
+    std::mutex mutex;
+    int fd;
+    std::string path;
+    std::string tmp_path;
+    // Distinguishes writers in the per thread index cache
+    std::uint64_t serial;
+    std::uint32_t thread_count;
+    std::uint64_t record_count;
+    std::uint32_t object_count;
+    // Open addressing table from live address to object id
+    trace_address* addresses;
+    std::size_t address_capacity;
+    std::size_t address_count;
+    // Stack of freed object ids
+    std::uint32_t* free_objects;
+    std::size_t free_object_capacity;
+    std::size_t free_object_count;
+    // First error, reported by finish
+    std::string error;
+    std::size_t pending_count;
+    trace_record pending[trace_batch_size];
+};
+
+// Pointer of one object during a replay
+struct replay_slot {
+public:
+    // Number of operations on the object replayed so far
+    std::atomic<std::uint32_t> version;
+    void* ptr;
+    std::size_t size;
+};
+
+// Order in which the threads of a threaded replay run the records. The
+// records of thread t are order[thread_begin[t]] to order[thread_begin[t + 1]],
+// and version[i] is the number of operations on the object of record i that
+// come before it.
+struct replay_schedule {
+public:
+    mmap_buffer memory;
+    std::span<const std::uint32_t> version;
+    std::span<const std::size_t> order;
+    std::span<const std::size_t> thread_begin;
+};
+
+// Resident set size of the process in bytes
+std::size_t resident_size() noexcept;
+
+// Resets the peak resident set size, false when the kernel does not allow it
+bool reset_peak_resident_size() noexcept;
+
+std::size_t peak_resident_size() noexcept;
+
+// Touches every page of an allocation, as the program that was traced would
+void touch_pages(void* ptr, std::size_t size) noexcept;
+
+std::expected<mmap_buffer, std::string> create_replay_slots(std::size_t object_count) noexcept;
+
+std::expected<replay_schedule, std::string> create_replay_schedule(
+    std::span<const trace_record> records, std::size_t object_count, std::size_t thread_count) noexcept;
+
+// Runs fn(context, thread) for every thread index on its own thread, all
+// starting together, and returns the time until the last one finished.
+// peak_rss is raised to the largest resident set size sampled meanwhile.
+std::expected<std::chrono::nanoseconds, std::string> run_replay_threads(
+    std::size_t thread_count, void (*fn)(void*, std::size_t), void* context, std::size_t& peak_rss) noexcept;
+
+} // namespace amber::internal
+
+// Captures allocation operations into a trace file. Recording is safe from
+// any number of threads, each thread is recorded as its own trace thread, a
+// thread alternating between writers gets a new one whenever it switches.
+// The file is written next to path and renamed into place by finish.
+class trace_writer {
+public:
+    trace_writer() = delete;
+
+    trace_writer(const trace_writer&) = delete;
+
+    trace_writer(trace_writer&& other) noexcept;
+
+    trace_writer& operator=(const trace_writer&) = delete;
+
+    trace_writer& operator=(trace_writer&& other) noexcept;
+
+    // Discards the trace unless finish was called
+    ~trace_writer() noexcept;
+
+    static
+    std::expected<trace_writer, std::string> create(const std::string& path) noexcept;
+
+    void allocate(const void* ptr, std::size_t alignment, std::size_t size) noexcept;
+
+    // old_ptr and new_ptr may be equal when the allocation was resized in
+    // place, an alignment of zero keeps the alignment of the allocation
+    void reallocate(const void* old_ptr, const void* new_ptr, std::size_t alignment, std::size_t size) noexcept;
+
+    // Frees of addresses the writer did not see allocated are not recorded
+    void free(const void* ptr) noexcept;
+
+    // Writes the header and moves the trace to its path. Returns the first
+    // error hit while recording, if any.
+    std::expected<void, std::string> finish() noexcept;
+
+    std::size_t record_count() const noexcept;
+
+private:
+    trace_writer(internal::trace_writer_control* control) noexcept;
+
+    internal::trace_writer_control* control_;
+};
+
+// Read only mapping of a trace file
+class trace_file {
+public:
+    trace_file() = delete;
+
+    trace_file(const trace_file&) = delete;
+
+    trace_file(trace_file&& other) noexcept;
+
+    trace_file& operator=(const trace_file&) = delete;
+
+    trace_file& operator=(trace_file&& other) noexcept;
+
+    ~trace_file() noexcept;
+
+    // Maps path and checks that every record is in range for the header
+    static
+    std::expected<trace_file, std::string> create(const std::string& path) noexcept;
+
+    const trace_header& header() const noexcept;
+
+    std::span<const trace_record> records() const noexcept;
+
+    // Most bytes the traced program had allocated at once
+    std::size_t peak_live_size() const noexcept;
+
+private:
+    trace_file(
+        std::byte* mapping,
+        std::size_t mapping_size,
+        const trace_header& header,
+        std::size_t peak_live_size
+    ) noexcept;
+
+    std::byte* mapping_;
+    std::size_t mapping_size_;
+    trace_header header_;
+    std::size_t peak_live_size_;
+};
+
+struct replay_result {
+public:
+    std::chrono::nanoseconds elapsed;
+    std::size_t operation_count;
+    // Allocations and reallocations the allocator refused
+    std::size_t failed_count;
+    std::size_t peak_live_size;
+    // Resident set size before the replay and at its peak
+    std::size_t baseline_rss;
+    std::size_t peak_rss;
+    // Share of the memory the replay added to the resident set that was not
+    // requested by the trace at its peak
+    double fragmentation;
+};
+
+// Replays every record of trace in order on the calling thread. Allocations
+// still live at the end are freed afterwards when A can free.
+template<Allocator A>
+std::expected<replay_result, std::string> replay_trace(const trace_file& trace, A& allocator) noexcept;
+
+// Replays the records of each trace thread on its own thread, all sharing
+// allocator, which must be thread safe. Operations on the same object keep
+// their recorded order, so frees from another thread wait for the allocation.
+template<Allocator A>
+std::expected<replay_result, std::string> replay_trace_threaded(const trace_file& trace, A& allocator) noexcept;
+
+// Wraps Parent and records its allocations, reallocations and frees into a
+// trace_writer
+template<Allocator Parent>
+class tracing_allocator {
+public:
+    tracing_allocator() = delete;
+
+    tracing_allocator(const tracing_allocator&) = delete;
+
+    tracing_allocator(tracing_allocator&& other) noexcept = default;
+
+    tracing_allocator& operator=(const tracing_allocator&) = delete;
+
+    tracing_allocator& operator=(tracing_allocator&& other) noexcept = default;
+
+    ~tracing_allocator() noexcept = default;
+
+    static
+    std::expected<tracing_allocator, std::string> create(Parent&& parent, trace_writer& writer) noexcept;
+
+    std::expected<void*, std::string> allocate(std::size_t alignment, std::size_t size) noexcept;
+
+    bool try_extend(void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+    requires ResizableAllocator<Parent>;
+
+    std::expected<void*, std::string> reallocate(
+        void* ptr, std::size_t old_size, std::size_t alignment, std::size_t new_size) noexcept
+    requires ResizableAllocator<Parent>;
+
+    void free(void* ptr) noexcept
+    requires DeallocatingAllocator<Parent>;
+
+    Parent& parent() noexcept;
+
+    const Parent& parent() const noexcept;
+
+private:
+    tracing_allocator(Parent&& parent, trace_writer& writer) noexcept;
+
+    Parent parent_;
+    trace_writer* writer_;
+};
+
+} // namespace amber
+
+#include <amber/alloc_trace.inl>
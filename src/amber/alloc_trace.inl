@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace amber {
+
+namespace internal {
+
+template<Allocator A>
+void replay_record(A& allocator, replay_slot& slot, const trace_record& record, std::size_t& failed_count) noexcept
+{
+    std::size_t alignment = std::size_t(1) << record.alignment_shift;
+    if (record.op == trace_op::free) {
+        if constexpr (DeallocatingAllocator<A>) {
+            if (slot.ptr != nullptr) {
+                allocator.free(slot.ptr);
+            }
+        }
+        slot.ptr = nullptr;
+        return;
+    }
+    if (record.op == trace_op::reallocate && slot.ptr != nullptr) {
+        std::expected<void*, std::string> exp_ptr;
+        if constexpr (ResizableAllocator<A>) {
+            exp_ptr = allocator.reallocate(slot.ptr, slot.size, alignment, record.size);
+        } else {
+            exp_ptr = allocator.allocate(alignment, record.size);
+            if (exp_ptr.has_value()) {
+                std::memcpy(exp_ptr.value(), slot.ptr, std::min(slot.size, record.size));
+                if constexpr (DeallocatingAllocator<A>) {
+                    allocator.free(slot.ptr);
+                }
+            }
+        }
+        if (!exp_ptr.has_value()) [[unlikely]] {
+            failed_count += 1;
+            return;
+        }
+        if (record.size > slot.size) {
+            touch_pages(static_cast<std::byte*>(exp_ptr.value()) + slot.size, record.size - slot.size);
+        }
+        slot.ptr = exp_ptr.value();
+        slot.size = record.size;
+        return;
+    }
+    auto exp_ptr = allocator.allocate(alignment, record.size);
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        failed_count += 1;
+        slot.ptr = nullptr;
+        return;
+    }
+    touch_pages(exp_ptr.value(), record.size);
+    slot.ptr = exp_ptr.value();
+    slot.size = record.size;
+}
+
+template<Allocator A>
+void release_replay_slots(A& allocator, std::span<replay_slot> slots) noexcept
+{
+    if constexpr (DeallocatingAllocator<A>) {
+        for (replay_slot& slot : slots) {
+            if (slot.ptr != nullptr) {
+                allocator.free(slot.ptr);
+                slot.ptr = nullptr;
+            }
+        }
+    }
+}
+
+inline void finish_replay_result(replay_result& result, std::size_t peak_rss) noexcept
+{
+    result.peak_rss = std::max(peak_rss, result.baseline_rss);
+    std::size_t added = result.peak_rss - result.baseline_rss;
+    if (added > result.peak_live_size) {
+        result.fragmentation = 1.0 - (static_cast<double>(result.peak_live_size) / static_cast<double>(added));
+    } else {
+        result.fragmentation = 0.0;
+    }
+}
+
+template<Allocator A>
+struct replay_thread_context {
+public:
+    const trace_record* records;
+    const replay_schedule* schedule;
+    replay_slot* slots;
+    A* allocator;
+    std::atomic<std::size_t> failed_count;
+};
+
+template<Allocator A>
+void replay_thread(void* arg, std::size_t thread) noexcept
+{
+    replay_thread_context<A>* context = static_cast<replay_thread_context<A>*>(arg);
+    const replay_schedule& schedule = *context->schedule;
+    std::size_t failed_count = 0;
+    for (std::size_t i = schedule.thread_begin[thread]; i < schedule.thread_begin[thread + 1]; ++i) {
+        std::size_t index = schedule.order[i];
+        const trace_record& record = context->records[index];
+        replay_slot& slot = context->slots[record.object];
+        std::uint32_t version = schedule.version[index];
+        std::uint32_t current = slot.version.load(std::memory_order_acquire);
+        while (current != version) {
+            slot.version.wait(current, std::memory_order_acquire);
+            current = slot.version.load(std::memory_order_acquire);
+        }
+        replay_record(*context->allocator, slot, record, failed_count);
+        slot.version.store(version + 1, std::memory_order_release);
+        slot.version.notify_all();
+    }
+    context->failed_count.fetch_add(failed_count, std::memory_order_relaxed);
+}
+
+} // namespace amber::internal
+
+template<Allocator A>
+std::expected<replay_result, std::string> replay_trace(const trace_file& trace, A& allocator) noexcept
+{
+    std::span<const trace_record> records = trace.records();
+    auto exp_slots = internal::create_replay_slots(trace.header().object_count);
+    if (!exp_slots.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_slots).error());
+    }
+    mmap_buffer slot_buffer = std::move(exp_slots).value();
+    std::span<internal::replay_slot> slots(
+        std::launder(reinterpret_cast<internal::replay_slot*>(slot_buffer.buffer().data())),
+        trace.header().object_count);
+
+    replay_result result{};
+    result.operation_count = records.size();
+    result.peak_live_size = trace.peak_live_size();
+    bool peak_reset = internal::reset_peak_resident_size();
+    result.baseline_rss = internal::resident_size();
+    // Without a resettable peak the resident set is sampled during the replay
+    constexpr std::size_t sample_interval = 4096;
+    std::size_t sampled_rss = result.baseline_rss;
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const trace_record& record = records[i];
+        internal::replay_record(allocator, slots[record.object], record, result.failed_count);
+        if (!peak_reset && (i % sample_interval) == sample_interval - 1) {
+            sampled_rss = std::max(sampled_rss, internal::resident_size());
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+    sampled_rss = std::max(sampled_rss, internal::resident_size());
+    internal::finish_replay_result(result, peak_reset ? internal::peak_resident_size() : sampled_rss);
+    internal::release_replay_slots(allocator, slots);
+    return result;
+}
+
+template<Allocator A>
+std::expected<replay_result, std::string> replay_trace_threaded(const trace_file& trace, A& allocator) noexcept
+{
+    std::span<const trace_record> records = trace.records();
+    const trace_header& header = trace.header();
+    auto exp_slots = internal::create_replay_slots(header.object_count);
+    if (!exp_slots.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_slots).error());
+    }
+    mmap_buffer slot_buffer = std::move(exp_slots).value();
+    std::span<internal::replay_slot> slots(
+        std::launder(reinterpret_cast<internal::replay_slot*>(slot_buffer.buffer().data())),
+        header.object_count);
+    auto exp_schedule = internal::create_replay_schedule(records, header.object_count, header.thread_count);
+    if (!exp_schedule.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_schedule).error());
+    }
+    internal::replay_schedule schedule = std::move(exp_schedule).value();
+    internal::replay_thread_context<A> context{
+        .records = records.data(),
+        .schedule = &schedule,
+        .slots = slots.data(),
+        .allocator = &allocator,
+        .failed_count = 0,
+    };
+
+    replay_result result{};
+    result.operation_count = records.size();
+    result.peak_live_size = trace.peak_live_size();
+    bool peak_reset = internal::reset_peak_resident_size();
+    result.baseline_rss = internal::resident_size();
+    // Without a resettable peak the resident set is sampled during the replay
+    std::size_t sampled_rss = result.baseline_rss;
+    auto exp_elapsed = internal::run_replay_threads(
+        header.thread_count, internal::replay_thread<A>, &context, sampled_rss);
+    if (!exp_elapsed.has_value()) [[unlikely]] {
+        internal::release_replay_slots(allocator, slots);
+        return std::unexpected(std::move(exp_elapsed).error());
+    }
+    result.elapsed = exp_elapsed.value();
+    result.failed_count = context.failed_count.load(std::memory_order_relaxed);
+    sampled_rss = std::max(sampled_rss, internal::resident_size());
+    internal::finish_replay_result(result, peak_reset ? internal::peak_resident_size() : sampled_rss);
+    internal::release_replay_slots(allocator, slots);
+    return result;
+}
+
+template<Allocator Parent>
+std::expected<tracing_allocator<Parent>, std::string> tracing_allocator<Parent>::create(
+    Parent&& parent, trace_writer& writer) noexcept
+{
+    static_assert(std::is_nothrow_move_constructible_v<Parent>);
+    return tracing_allocator(std::move(parent), writer);
+}
+
+template<Allocator Parent>
+std::expected<void*, std::string> tracing_allocator<Parent>::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    auto exp_ptr = parent_.allocate(alignment, size);
+    if (exp_ptr.has_value()) [[likely]] {
+        writer_->allocate(exp_ptr.value(), alignment, size);
+    }
+    return exp_ptr;
+}
+
+template<Allocator Parent>
+bool tracing_allocator<Parent>::try_extend(void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+requires ResizableAllocator<Parent>
+{
+    if (!parent_.try_extend(ptr, old_size, new_size)) {
+        return false;
+    }
+    writer_->reallocate(ptr, ptr, 0, new_size);
+    return true;
+}
+
+template<Allocator Parent>
+std::expected<void*, std::string> tracing_allocator<Parent>::reallocate(
+    void* ptr, std::size_t old_size, std::size_t alignment, std::size_t new_size) noexcept
+requires ResizableAllocator<Parent>
+{
+    auto exp_ptr = parent_.reallocate(ptr, old_size, alignment, new_size);
+    if (exp_ptr.has_value()) [[likely]] {
+        writer_->reallocate(ptr, exp_ptr.value(), alignment, new_size);
+    }
+    return exp_ptr;
+}
+
+template<Allocator Parent>
+void tracing_allocator<Parent>::free(void* ptr) noexcept
+requires DeallocatingAllocator<Parent>
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    writer_->free(ptr);
+    parent_.free(ptr);
+}
+
+template<Allocator Parent>
+Parent& tracing_allocator<Parent>::parent() noexcept
+{
+    return parent_;
+}
+
+template<Allocator Parent>
+const Parent& tracing_allocator<Parent>::parent() const noexcept
+{
+    return parent_;
+}
+
+template<Allocator Parent>
+tracing_allocator<Parent>::tracing_allocator(Parent&& parent, trace_writer& writer) noexcept
+    : parent_(std::move(parent)),
+    writer_(&writer)
+{}
+
+} // namespace amber
@@ -1,6 +1,34 @@
+#include <amber/affix_allocator.hpp>
 #include <amber/aligned_buffer.hpp>
+#include <amber/alloc_trace.hpp>
+#include <amber/arena_hash_map.hpp>
+#include <amber/arena_scope.hpp>
+#include <amber/arena_string.hpp>
+#include <amber/arena_vector.hpp>
+#include <amber/bucketizer.hpp>
+#include <amber/compact_pool_allocator.hpp>
+#include <amber/coroutine_frame.hpp>
+#include <amber/double_stack_allocator.hpp>
+#include <amber/epoch_domain.hpp>
+#include <amber/fallback_allocator.hpp>
+#include <amber/fiber_stack_pool.hpp>
+#include <amber/frame_allocator.hpp>
+#include <amber/heap_profiler.hpp>
+#include <amber/lifetime_analyzer.hpp>
+#include <amber/lifetime_recorder.hpp>
 #include <amber/linear_allocator.hpp>
+#include <amber/malloc_allocator.hpp>
 #include <amber/malloc_buffer.hpp>
+#include <amber/mirrored_buffer.hpp>
 #include <amber/mmap_buffer.hpp>
+#include <amber/owned_pool_allocator.hpp>
 #include <amber/pool_allocator.hpp>
+#include <amber/prefault.hpp>
+#include <amber/purge.hpp>
+#include <amber/segregator.hpp>
+#include <amber/shared_buffer.hpp>
+#include <amber/shared_pool_allocator.hpp>
+#include <amber/snapshot.hpp>
+#include <amber/span_buffer.hpp>
+#include <amber/spsc_ring_allocator.hpp>
 #include <amber/stack_allocator.hpp>
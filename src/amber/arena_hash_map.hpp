@@ -0,0 +1,153 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+extern "C" {
+#include <emmintrin.h>
+}
+#endif
+
+namespace amber {
+
+namespace internal {
+
+inline constexpr std::int8_t hash_ctrl_empty = -128;
+inline constexpr std::int8_t hash_ctrl_deleted = -2;
+
+// Control bytes of a group of slots, matched in parallel with SSE2 when
+// available and with 64-bit SWAR otherwise. Full slots hold the low 7 bits of
+// the key hash, empty and deleted slots have the sign bit set.
+class hash_group {
+public:
+#if defined(__SSE2__)
+    static constexpr std::size_t width = 16;
+    // Bit position of slot i within a match mask is i << index_shift
+    static constexpr unsigned index_shift = 0;
+#else
+    static constexpr std::size_t width = 8;
+    static constexpr unsigned index_shift = 3;
+#endif
+
+    explicit hash_group(const std::int8_t* ctrl) noexcept;
+
+    // May report false positives on the SWAR path, callers confirm the control byte
+    std::uint64_t match(std::int8_t h2) const noexcept;
+
+    std::uint64_t match_empty() const noexcept;
+
+    std::uint64_t match_empty_or_deleted() const noexcept;
+
+private:
+#if defined(__SSE2__)
+    __m128i ctrl_;
+#else
+    std::uint64_t ctrl_;
+#endif
+};
+
+template<typename K, typename V>
+struct hash_map_slot {
+public:
+    K key;
+    V value;
+};
+
+} // namespace amber::internal
+
+// Flat open addressing hash map (swiss table layout) whose control bytes and
+// slots live in an amber allocator. Keys and values must be trivially copyable
+// and trivially destructible so the map never needs to be destroyed. Storage
+// abandoned by a rehash is reclaimed when the allocator is reset.
+template<
+    typename K,
+    typename V,
+    Allocator A,
+    typename Hash = std::hash<K>,
+    typename KeyEqual = std::equal_to<K>
+>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+class arena_hash_map {
+public:
+    using key_type = K;
+    using mapped_type = V;
+
+    arena_hash_map() = delete;
+
+    arena_hash_map(const arena_hash_map&) = delete;
+
+    arena_hash_map(arena_hash_map&& other) noexcept;
+
+    arena_hash_map& operator=(const arena_hash_map&) = delete;
+
+    arena_hash_map& operator=(arena_hash_map&& other) noexcept;
+
+    static
+    std::expected<arena_hash_map, std::string> create(A& allocator) noexcept;
+
+    static
+    std::expected<arena_hash_map, std::string> create(A& allocator, std::size_t capacity) noexcept;
+
+    // Returns true when key was inserted, false when key was already present
+    std::expected<bool, std::string> insert(const K& key, const V& value) noexcept;
+
+    // Returns true when key was inserted, false when an existing value was replaced
+    std::expected<bool, std::string> insert_or_assign(const K& key, const V& value) noexcept;
+
+    V* find(const K& key) noexcept;
+
+    const V* find(const K& key) const noexcept;
+
+    bool contains(const K& key) const noexcept;
+
+    bool erase(const K& key) noexcept;
+
+    void clear() noexcept;
+
+    template<typename F>
+    void for_each(F&& f) const;
+
+    bool empty() const noexcept;
+
+    std::size_t size() const noexcept;
+
+    std::size_t capacity() const noexcept;
+
+private:
+    using slot_type = internal::hash_map_slot<K, V>;
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    arena_hash_map(A* allocator) noexcept;
+
+    static
+    std::size_t hash_mix(std::size_t hash) noexcept;
+
+    std::size_t find_index(const K& key, std::size_t hash) const noexcept;
+
+    std::size_t find_insert_index(std::size_t hash) const noexcept;
+
+    std::expected<std::pair<std::size_t, bool>, std::string> find_or_prepare_insert(const K& key) noexcept;
+
+    std::expected<void, std::string> rehash(std::size_t capacity) noexcept;
+
+    A* allocator_;
+    std::int8_t* ctrl_;
+    slot_type* slots_;
+    std::size_t capacity_;
+    std::size_t size_;
+    std::size_t growth_left_;
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] KeyEqual key_equal_;
+};
+
+} // namespace amber
+
+#include <amber/arena_hash_map.inl>
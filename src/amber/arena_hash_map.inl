@@ -0,0 +1,394 @@
+#include <amber/util.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <new>
+
+namespace amber {
+
+namespace internal {
+
+#if defined(__SSE2__)
+
+inline hash_group::hash_group(const std::int8_t* ctrl) noexcept
+    : ctrl_(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl)))
+{}
+
+inline std::uint64_t hash_group::match(std::int8_t h2) const noexcept
+{
+    __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_);
+    return static_cast<std::uint16_t>(_mm_movemask_epi8(cmp));
+}
+
+inline std::uint64_t hash_group::match_empty() const noexcept
+{
+    __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(hash_ctrl_empty), ctrl_);
+    return static_cast<std::uint16_t>(_mm_movemask_epi8(cmp));
+}
+
+inline std::uint64_t hash_group::match_empty_or_deleted() const noexcept
+{
+    return static_cast<std::uint16_t>(_mm_movemask_epi8(ctrl_));
+}
+
+#else
+
+inline constexpr std::uint64_t hash_group_lsbs = 0x0101010101010101ull;
+inline constexpr std::uint64_t hash_group_msbs = 0x8080808080808080ull;
+
+inline hash_group::hash_group(const std::int8_t* ctrl) noexcept
+    : ctrl_(0)
+{
+    std::memcpy(&ctrl_, ctrl, sizeof(ctrl_));
+    if constexpr (std::endian::native == std::endian::big) {
+        ctrl_ = std::byteswap(ctrl_);
+    }
+}
+
+inline std::uint64_t hash_group::match(std::int8_t h2) const noexcept
+{
+    std::uint64_t x = ctrl_ ^ (hash_group_lsbs * static_cast<std::uint8_t>(h2));
+    return (x - hash_group_lsbs) & ~x & hash_group_msbs;
+}
+
+inline std::uint64_t hash_group::match_empty() const noexcept
+{
+    // empty is the only control value with the sign bit set and bit 1 clear
+    return ctrl_ & (~ctrl_ << 6) & hash_group_msbs;
+}
+
+inline std::uint64_t hash_group::match_empty_or_deleted() const noexcept
+{
+    return ctrl_ & hash_group_msbs;
+}
+
+#endif
+
+} // namespace amber::internal
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+arena_hash_map<K, V, A, Hash, KeyEqual>::arena_hash_map(arena_hash_map&& other) noexcept
+    : allocator_(std::exchange(other.allocator_, nullptr)),
+    ctrl_(std::exchange(other.ctrl_, nullptr)),
+    slots_(std::exchange(other.slots_, nullptr)),
+    capacity_(std::exchange(other.capacity_, 0)),
+    size_(std::exchange(other.size_, 0)),
+    growth_left_(std::exchange(other.growth_left_, 0)),
+    hash_(std::move(other.hash_)),
+    key_equal_(std::move(other.key_equal_))
+{}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+arena_hash_map<K, V, A, Hash, KeyEqual>& arena_hash_map<K, V, A, Hash, KeyEqual>::operator=(arena_hash_map&& other) noexcept
+{
+    if (this != &other) {
+        allocator_ = std::exchange(other.allocator_, nullptr);
+        ctrl_ = std::exchange(other.ctrl_, nullptr);
+        slots_ = std::exchange(other.slots_, nullptr);
+        capacity_ = std::exchange(other.capacity_, 0);
+        size_ = std::exchange(other.size_, 0);
+        growth_left_ = std::exchange(other.growth_left_, 0);
+        hash_ = std::move(other.hash_);
+        key_equal_ = std::move(other.key_equal_);
+    }
+    return *this;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::expected<arena_hash_map<K, V, A, Hash, KeyEqual>, std::string> arena_hash_map<K, V, A, Hash, KeyEqual>::create(A& allocator) noexcept
+{
+    return arena_hash_map(&allocator);
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::expected<arena_hash_map<K, V, A, Hash, KeyEqual>, std::string> arena_hash_map<K, V, A, Hash, KeyEqual>::create(
+    A& allocator, std::size_t capacity) noexcept
+{
+    arena_hash_map map(&allocator);
+    if (capacity > 0) {
+        // keep the load factor at or below 7/8
+        std::size_t slot_count = std::bit_ceil(std::max(capacity + capacity / 7, internal::hash_group::width));
+        auto exp_rehash = map.rehash(slot_count);
+        if (!exp_rehash.has_value()) [[unlikely]] {
+            return std::unexpected(std::move(exp_rehash).error());
+        }
+    }
+    return map;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::expected<bool, std::string> arena_hash_map<K, V, A, Hash, KeyEqual>::insert(const K& key, const V& value) noexcept
+{
+    auto exp_index = find_or_prepare_insert(key);
+    if (!exp_index.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_index).error());
+    }
+    auto [index, inserted] = exp_index.value();
+    if (inserted) {
+        std::construct_at(&slots_[index], slot_type{key, value});
+    }
+    return inserted;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::expected<bool, std::string> arena_hash_map<K, V, A, Hash, KeyEqual>::insert_or_assign(const K& key, const V& value) noexcept
+{
+    auto exp_index = find_or_prepare_insert(key);
+    if (!exp_index.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_index).error());
+    }
+    auto [index, inserted] = exp_index.value();
+    if (inserted) {
+        std::construct_at(&slots_[index], slot_type{key, value});
+    } else {
+        slots_[index].value = value;
+    }
+    return inserted;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+V* arena_hash_map<K, V, A, Hash, KeyEqual>::find(const K& key) noexcept
+{
+    std::size_t index = find_index(key, hash_mix(hash_(key)));
+    if (index == npos) {
+        return nullptr;
+    }
+    return &slots_[index].value;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+const V* arena_hash_map<K, V, A, Hash, KeyEqual>::find(const K& key) const noexcept
+{
+    std::size_t index = find_index(key, hash_mix(hash_(key)));
+    if (index == npos) {
+        return nullptr;
+    }
+    return &slots_[index].value;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+bool arena_hash_map<K, V, A, Hash, KeyEqual>::contains(const K& key) const noexcept
+{
+    return find_index(key, hash_mix(hash_(key))) != npos;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+bool arena_hash_map<K, V, A, Hash, KeyEqual>::erase(const K& key) noexcept
+{
+    std::size_t index = find_index(key, hash_mix(hash_(key)));
+    if (index == npos) {
+        return false;
+    }
+    // the slot may be part of a probe chain, mark it deleted rather than empty
+    ctrl_[index] = internal::hash_ctrl_deleted;
+    size_ -= 1;
+    return true;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+void arena_hash_map<K, V, A, Hash, KeyEqual>::clear() noexcept
+{
+    if (capacity_ == 0) {
+        return;
+    }
+    std::memset(ctrl_, static_cast<std::uint8_t>(internal::hash_ctrl_empty), capacity_);
+    size_ = 0;
+    growth_left_ = capacity_ - capacity_ / 8;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+template<typename F>
+void arena_hash_map<K, V, A, Hash, KeyEqual>::for_each(F&& f) const
+{
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        if (ctrl_[i] >= 0) {
+            f(slots_[i].key, slots_[i].value);
+        }
+    }
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+bool arena_hash_map<K, V, A, Hash, KeyEqual>::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::size_t arena_hash_map<K, V, A, Hash, KeyEqual>::size() const noexcept
+{
+    return size_;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::size_t arena_hash_map<K, V, A, Hash, KeyEqual>::capacity() const noexcept
+{
+    return capacity_;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+arena_hash_map<K, V, A, Hash, KeyEqual>::arena_hash_map(A* allocator) noexcept
+    : allocator_(allocator),
+    ctrl_(nullptr),
+    slots_(nullptr),
+    capacity_(0),
+    size_(0),
+    growth_left_(0),
+    hash_(),
+    key_equal_()
+{}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::size_t arena_hash_map<K, V, A, Hash, KeyEqual>::hash_mix(std::size_t hash) noexcept
+{
+    // std::hash is the identity for integers, spread the entropy to all bits
+    std::uint64_t h = static_cast<std::uint64_t>(hash) * 0x9e3779b97f4a7c15ull;
+    return static_cast<std::size_t>(h ^ (h >> 32));
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::size_t arena_hash_map<K, V, A, Hash, KeyEqual>::find_index(const K& key, std::size_t hash) const noexcept
+{
+    if (capacity_ == 0) {
+        return npos;
+    }
+    constexpr std::size_t width = internal::hash_group::width;
+    std::int8_t h2 = static_cast<std::int8_t>(hash & 0x7f);
+    std::size_t group_mask = (capacity_ / width) - 1;
+    std::size_t group = (hash >> 7) & group_mask;
+    // triangular probing visits every group since the group count is a power of two
+    for (std::size_t step = 1; step <= group_mask + 1; ++step) {
+        internal::hash_group g(ctrl_ + (group * width));
+        for (std::uint64_t mask = g.match(h2); mask != 0; mask &= mask - 1) {
+            std::size_t index = (group * width) + (std::countr_zero(mask) >> internal::hash_group::index_shift);
+            if (ctrl_[index] == h2 && key_equal_(slots_[index].key, key)) [[likely]] {
+                return index;
+            }
+        }
+        if (g.match_empty() != 0) [[likely]] {
+            return npos;
+        }
+        group = (group + step) & group_mask;
+    }
+    return npos;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::size_t arena_hash_map<K, V, A, Hash, KeyEqual>::find_insert_index(std::size_t hash) const noexcept
+{
+    constexpr std::size_t width = internal::hash_group::width;
+    std::size_t group_mask = (capacity_ / width) - 1;
+    std::size_t group = (hash >> 7) & group_mask;
+    for (std::size_t step = 1; step <= group_mask + 1; ++step) {
+        internal::hash_group g(ctrl_ + (group * width));
+        std::uint64_t mask = g.match_empty_or_deleted();
+        if (mask != 0) [[likely]] {
+            return (group * width) + (std::countr_zero(mask) >> internal::hash_group::index_shift);
+        }
+        group = (group + step) & group_mask;
+    }
+    return npos;
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::expected<std::pair<std::size_t, bool>, std::string> arena_hash_map<K, V, A, Hash, KeyEqual>::find_or_prepare_insert(
+    const K& key) noexcept
+{
+    std::size_t hash = hash_mix(hash_(key));
+    std::size_t index = find_index(key, hash);
+    if (index != npos) {
+        return std::pair(index, false);
+    }
+    if (growth_left_ == 0) [[unlikely]] {
+        // reclaim deleted slots in place of growing when the map is sparse
+        std::size_t capacity = capacity_ == 0 ? internal::hash_group::width : capacity_;
+        if (size_ >= capacity / 2) {
+            capacity *= 2;
+        }
+        auto exp_rehash = rehash(capacity);
+        if (!exp_rehash.has_value()) [[unlikely]] {
+            return std::unexpected(std::move(exp_rehash).error());
+        }
+    }
+    index = find_insert_index(hash);
+    if (ctrl_[index] == internal::hash_ctrl_empty) {
+        growth_left_ -= 1;
+    }
+    ctrl_[index] = static_cast<std::int8_t>(hash & 0x7f);
+    size_ += 1;
+    return std::pair(index, true);
+}
+
+template<typename K, typename V, Allocator A, typename Hash, typename KeyEqual>
+requires std::is_trivially_copyable_v<K> && std::is_trivially_destructible_v<K>
+    && std::is_trivially_copyable_v<V> && std::is_trivially_destructible_v<V>
+std::expected<void, std::string> arena_hash_map<K, V, A, Hash, KeyEqual>::rehash(std::size_t capacity) noexcept
+{
+    constexpr std::size_t ctrl_alignment = std::max<std::size_t>(internal::hash_group::width, alignof(slot_type));
+    std::size_t slots_offset = align_forward(alignof(slot_type), capacity);
+    auto exp_ptr = allocator_->allocate(ctrl_alignment, slots_offset + (capacity * sizeof(slot_type)));
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    std::byte* ptr = static_cast<std::byte*>(exp_ptr.value());
+    std::int8_t* ctrl = reinterpret_cast<std::int8_t*>(ptr);
+    slot_type* slots = std::assume_aligned<alignof(slot_type)>(reinterpret_cast<slot_type*>(ptr + slots_offset));
+    std::memset(ctrl, static_cast<std::uint8_t>(internal::hash_ctrl_empty), capacity);
+
+    std::int8_t* old_ctrl = std::exchange(ctrl_, ctrl);
+    slot_type* old_slots = std::exchange(slots_, slots);
+    std::size_t old_capacity = std::exchange(capacity_, capacity);
+    for (std::size_t i = 0; i < old_capacity; ++i) {
+        if (old_ctrl[i] < 0) {
+            continue;
+        }
+        std::size_t hash = hash_mix(hash_(old_slots[i].key));
+        std::size_t index = find_insert_index(hash);
+        ctrl_[index] = static_cast<std::int8_t>(hash & 0x7f);
+        std::memcpy(static_cast<void*>(&slots_[index]), static_cast<const void*>(&old_slots[i]), sizeof(slot_type));
+    }
+    growth_left_ = capacity_ - (capacity_ / 8) - size_;
+    return {};
+}
+
+} // namespace amber
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <amber/arena_scope.hpp>
+#include <cstddef>
+#include <new>
+
+// Replaces the global operator new and delete so that allocations made while
+// an arena_scope is active on the thread come from its allocator, falling
+// back to the heap when it is out of space. Deleting arena memory does
+// nothing, even once its scope has ended: every block carries a small header
+// saying where it came from. Include in exactly one source file of the program, it defines the
+// operators rather than declaring them.
+
+namespace amber::internal {
+
+inline void* throwing_arena_new(std::size_t alignment, std::size_t size)
+{
+    while (true) {
+        void* ptr = arena_operator_new(alignment, size);
+        if (ptr != nullptr) [[likely]] {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+inline void* nothrow_arena_new(std::size_t alignment, std::size_t size) noexcept
+{
+    try {
+        return throwing_arena_new(alignment, size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+} // namespace amber::internal
+
+void* operator new(std::size_t size)
+{
+    return amber::internal::throwing_arena_new(__STDCPP_DEFAULT_NEW_ALIGNMENT__, size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return amber::internal::throwing_arena_new(__STDCPP_DEFAULT_NEW_ALIGNMENT__, size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return amber::internal::throwing_arena_new(static_cast<std::size_t>(alignment), size);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return amber::internal::throwing_arena_new(static_cast<std::size_t>(alignment), size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return amber::internal::nothrow_arena_new(__STDCPP_DEFAULT_NEW_ALIGNMENT__, size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return amber::internal::nothrow_arena_new(__STDCPP_DEFAULT_NEW_ALIGNMENT__, size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return amber::internal::nothrow_arena_new(static_cast<std::size_t>(alignment), size);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return amber::internal::nothrow_arena_new(static_cast<std::size_t>(alignment), size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    amber::internal::arena_operator_delete(ptr);
+}
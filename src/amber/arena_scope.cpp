@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <amber/arena_scope.hpp>
+#include <amber/util.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+
+namespace amber {
+
+namespace {
+
+// In front of every block from arena_operator_new, so that delete tells arena
+// memory from heap memory without asking the scopes, which may have ended
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) block_header {
+public:
+    // Distance from the start of the underlying allocation to the block
+    std::size_t offset;
+    bool in_arena;
+};
+
+internal::arena_slot arena_slots[internal::arena_slot_count];
+// Slots at or above this index have never been claimed
+std::atomic<std::size_t> arena_slot_end(0);
+std::atomic<std::size_t> active_scope_count(0);
+
+thread_local internal::arena_slot* current_arena = nullptr;
+// Set while the current arena allocates, an error message it builds must not
+// come back into the arena
+thread_local bool arena_busy = false;
+
+bool slot_owns(internal::arena_slot& slot, const void* ptr) noexcept
+{
+    // Unpublished slots are skipped without writing to their cache line
+    if (slot.allocator.load(std::memory_order_acquire) == nullptr) {
+        return false;
+    }
+    slot.reader_count.fetch_add(1, std::memory_order_seq_cst);
+    void* allocator = slot.allocator.load(std::memory_order_seq_cst);
+    bool owned = allocator != nullptr && slot.owns(allocator, ptr);
+    slot.reader_count.fetch_sub(1, std::memory_order_release);
+    return owned;
+}
+
+void* heap_allocate(std::size_t alignment, std::size_t size) noexcept
+{
+    size = std::max(size, std::size_t(1));
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) [[likely]] {
+        return std::malloc(size);
+    }
+    return std::aligned_alloc(alignment, align_forward(alignment, size));
+}
+
+} // unnamed namespace
+
+namespace internal {
+
+std::expected<arena_slot*, std::string> acquire_arena_slot(
+    void* allocator,
+    void* (*allocate)(void*, std::size_t, std::size_t) noexcept,
+    bool (*owns)(const void*, const void*) noexcept
+) noexcept
+{
+    for (std::size_t i = 0; i < arena_slot_count; ++i) {
+        arena_slot& slot = arena_slots[i];
+        if (slot.claimed.load(std::memory_order_relaxed)
+            || slot.claimed.exchange(true, std::memory_order_acquire))
+        {
+            continue;
+        }
+        std::size_t end = arena_slot_end.load(std::memory_order_relaxed);
+        while (end <= i && !arena_slot_end.compare_exchange_weak(end, i + 1, std::memory_order_relaxed)) {}
+        slot.allocate = allocate;
+        slot.owns = owns;
+        slot.prev = current_arena;
+        slot.allocator.store(allocator, std::memory_order_seq_cst);
+        active_scope_count.fetch_add(1, std::memory_order_release);
+        current_arena = &slot;
+        return &slot;
+    }
+    return std::unexpected("too many active arena scopes");
+}
+
+void release_arena_slot(arena_slot* slot) noexcept
+{
+    if (current_arena == slot) {
+        current_arena = slot->prev;
+    }
+    active_scope_count.fetch_sub(1, std::memory_order_release);
+    slot->allocator.store(nullptr, std::memory_order_seq_cst);
+    // A thread that saw the allocator may still be asking it about a pointer
+    while (slot->reader_count.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+    slot->claimed.store(false, std::memory_order_release);
+}
+
+void* arena_operator_new(std::size_t alignment, std::size_t size) noexcept
+{
+    // The header takes the space before the block, a whole alignment step
+    // for over-aligned blocks so the block itself stays aligned
+    std::size_t offset = std::max(alignment, sizeof(block_header));
+    if (size > SIZE_MAX - offset) [[unlikely]] {
+        return nullptr;
+    }
+    std::size_t base_alignment = std::max(alignment, alignof(block_header));
+    bool in_arena = true;
+    void* base = arena_allocate(base_alignment, offset + size);
+    if (base == nullptr) {
+        in_arena = false;
+        base = heap_allocate(base_alignment, offset + size);
+        if (base == nullptr) [[unlikely]] {
+            return nullptr;
+        }
+    }
+    std::byte* block = static_cast<std::byte*>(base) + offset;
+    std::construct_at(reinterpret_cast<block_header*>(block - sizeof(block_header)), offset, in_arena);
+    return block;
+}
+
+void arena_operator_delete(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::byte* block = static_cast<std::byte*>(ptr);
+    block_header* header = std::launder(reinterpret_cast<block_header*>(block - sizeof(block_header)));
+    if (header->in_arena) {
+        return;
+    }
+    std::free(block - header->offset);
+}
+
+} // namespace amber::internal
+
+void* arena_allocate(std::size_t alignment, std::size_t size) noexcept
+{
+    internal::arena_slot* slot = current_arena;
+    if (slot == nullptr || arena_busy) {
+        return nullptr;
+    }
+    arena_busy = true;
+    // A zero size allocation at the end of a full arena would sit one past
+    // it, where owns is false and delete would pass it to free
+    size = std::max(size, std::size_t(1));
+    void* ptr = slot->allocate(slot->allocator.load(std::memory_order_relaxed), alignment, size);
+    arena_busy = false;
+    return ptr;
+}
+
+bool arena_owns(const void* ptr) noexcept
+{
+    if (active_scope_count.load(std::memory_order_acquire) == 0) [[likely]] {
+        return false;
+    }
+    // The thread's own scopes cannot end concurrently, no need to register
+    for (internal::arena_slot* slot = current_arena; slot != nullptr; slot = slot->prev) {
+        if (slot->owns(slot->allocator.load(std::memory_order_relaxed), ptr)) {
+            return true;
+        }
+    }
+    std::size_t end = arena_slot_end.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < end; ++i) {
+        if (slot_owns(arena_slots[i], ptr)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace amber
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <amber/util.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string>
+
+namespace amber {
+
+namespace internal {
+
+inline constexpr std::size_t arena_slot_count = 64;
+
+// Registration of an active arena_scope, visible to every thread so that
+// arena_owns can ask it from any thread. One per cache line, owns scans touch
+// every published slot.
+struct alignas(cache_line_size) arena_slot {
+public:
+    std::atomic<bool> claimed;
+    // Threads inside owns, the slot is not reused until they leave
+    std::atomic<std::uint32_t> reader_count;
+    // Null while the slot is not published
+    std::atomic<void*> allocator;
+    void* (*allocate)(void* allocator, std::size_t alignment, std::size_t size) noexcept;
+    bool (*owns)(const void* allocator, const void* ptr) noexcept;
+    // Scope that was current on the thread before this one
+    arena_slot* prev;
+};
+
+std::expected<arena_slot*, std::string> acquire_arena_slot(
+    void* allocator,
+    void* (*allocate)(void*, std::size_t, std::size_t) noexcept,
+    bool (*owns)(const void*, const void*) noexcept
+) noexcept;
+
+void release_arena_slot(arena_slot* slot) noexcept;
+
+// Backs the replacement operator new of arena_new_delete.hpp, tries the
+// current arena and then the heap. Each block has a header in front of it
+// recording where it came from. Returns nullptr when both fail.
+void* arena_operator_new(std::size_t alignment, std::size_t size) noexcept;
+
+// Backs the replacement operator delete, reads the block's header and leaves
+// arena memory alone, whether or not its scope is still active
+void arena_operator_delete(void* ptr) noexcept;
+
+} // namespace amber::internal
+
+// Allocates from the arena of the innermost scope active on the calling
+// thread, nullptr when there is none or it is out of space
+void* arena_allocate(std::size_t alignment, std::size_t size) noexcept;
+
+// Whether ptr came from the allocator of a scope active on any thread
+bool arena_owns(const void* ptr) noexcept;
+
+// Makes allocator the current arena of the calling thread for the lifetime of
+// the scope. Scopes nest and must end in reverse order on the thread that
+// created them. The allocator must stay in place until the scope ends. Memory
+// it handed out may still be deleted after that, which does nothing, but
+// arena_owns no longer knows it; reset the allocator to reclaim it.
+template<OwningAllocator A>
+class arena_scope {
+public:
+    arena_scope() = delete;
+
+    arena_scope(const arena_scope&) = delete;
+
+    arena_scope(arena_scope&& other) noexcept;
+
+    arena_scope& operator=(const arena_scope&) = delete;
+
+    arena_scope& operator=(arena_scope&& other) noexcept;
+
+    ~arena_scope() noexcept;
+
+    // Fails when internal::arena_slot_count scopes are already active
+    static
+    std::expected<arena_scope, std::string> create(A& allocator) noexcept;
+
+private:
+    arena_scope(internal::arena_slot* slot) noexcept;
+
+    static
+    void* allocate_thunk(void* allocator, std::size_t alignment, std::size_t size) noexcept;
+
+    static
+    bool owns_thunk(const void* allocator, const void* ptr) noexcept;
+
+    internal::arena_slot* slot_;
+};
+
+} // namespace amber
+
+#include <amber/arena_scope.inl>
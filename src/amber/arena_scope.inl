@@ -0,0 +1,62 @@
+#include <utility>
+
+namespace amber {
+
+template<OwningAllocator A>
+arena_scope<A>::arena_scope(arena_scope&& other) noexcept
+    : slot_(std::exchange(other.slot_, nullptr))
+{}
+
+template<OwningAllocator A>
+arena_scope<A>& arena_scope<A>::operator=(arena_scope&& other) noexcept
+{
+    if (this != &other) {
+        if (slot_ != nullptr) {
+            internal::release_arena_slot(slot_);
+        }
+        slot_ = std::exchange(other.slot_, nullptr);
+    }
+    return *this;
+}
+
+template<OwningAllocator A>
+arena_scope<A>::~arena_scope() noexcept
+{
+    if (slot_ != nullptr) {
+        internal::release_arena_slot(slot_);
+    }
+    slot_ = nullptr;
+}
+
+template<OwningAllocator A>
+std::expected<arena_scope<A>, std::string> arena_scope<A>::create(A& allocator) noexcept
+{
+    auto exp_slot = internal::acquire_arena_slot(&allocator, allocate_thunk, owns_thunk);
+    if (!exp_slot.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_slot).error());
+    }
+    return arena_scope(exp_slot.value());
+}
+
+template<OwningAllocator A>
+arena_scope<A>::arena_scope(internal::arena_slot* slot) noexcept
+    : slot_(slot)
+{}
+
+template<OwningAllocator A>
+void* arena_scope<A>::allocate_thunk(void* allocator, std::size_t alignment, std::size_t size) noexcept
+{
+    auto exp_ptr = static_cast<A*>(allocator)->allocate(alignment, size);
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return nullptr;
+    }
+    return exp_ptr.value();
+}
+
+template<OwningAllocator A>
+bool arena_scope<A>::owns_thunk(const void* allocator, const void* ptr) noexcept
+{
+    return static_cast<const A*>(allocator)->owns(ptr);
+}
+
+} // namespace amber
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <amber/arena_vector.hpp>
+#include <amber/concept.hpp>
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <string_view>
+
+namespace amber {
+
+// String builder whose characters live in an amber allocator, the contents are
+// always null terminated so c_str() never allocates
+template<Allocator A>
+class arena_string {
+public:
+    arena_string() = delete;
+
+    arena_string(const arena_string&) = delete;
+
+    arena_string(arena_string&& other) noexcept = default;
+
+    arena_string& operator=(const arena_string&) = delete;
+
+    arena_string& operator=(arena_string&& other) noexcept = default;
+
+    static
+    std::expected<arena_string, std::string> create(A& allocator) noexcept;
+
+    static
+    std::expected<arena_string, std::string> create(A& allocator, std::string_view str) noexcept;
+
+    std::expected<void, std::string> reserve(std::size_t capacity) noexcept;
+
+    std::expected<void, std::string> append(std::string_view str) noexcept;
+
+    std::expected<void, std::string> push_back(char c) noexcept;
+
+    void clear() noexcept;
+
+    char& operator[](std::size_t index) noexcept;
+
+    char operator[](std::size_t index) const noexcept;
+
+    const char* c_str() const noexcept;
+
+    const char* data() const noexcept;
+
+    std::string_view view() const noexcept;
+
+    operator std::string_view() const noexcept;
+
+    bool empty() const noexcept;
+
+    std::size_t size() const noexcept;
+
+    std::size_t capacity() const noexcept;
+
+private:
+    arena_string(arena_vector<char, A>&& chars) noexcept;
+
+    // Holds size() characters followed by a null terminator
+    arena_vector<char, A> chars_;
+};
+
+} // namespace amber
+
+#include <amber/arena_string.inl>
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <span>
+#include <utility>
+
+namespace amber {
+
+template<Allocator A>
+std::expected<arena_string<A>, std::string> arena_string<A>::create(A& allocator) noexcept
+{
+    return create(allocator, std::string_view());
+}
+
+template<Allocator A>
+std::expected<arena_string<A>, std::string> arena_string<A>::create(
+    A& allocator, std::string_view str) noexcept
+{
+    auto exp_chars = arena_vector<char, A>::create(allocator, str.size() + 1);
+    if (!exp_chars.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_chars).error());
+    }
+    arena_vector<char, A> chars = std::move(exp_chars).value();
+    // capacity is reserved, these cannot fail
+    (void)chars.append(std::span<const char>(str.data(), str.size()));
+    (void)chars.push_back('\0');
+    return arena_string(std::move(chars));
+}
+
+template<Allocator A>
+std::expected<void, std::string> arena_string<A>::reserve(std::size_t capacity) noexcept
+{
+    return chars_.reserve(capacity + 1);
+}
+
+template<Allocator A>
+std::expected<void, std::string> arena_string<A>::append(std::string_view str) noexcept
+{
+    std::size_t required = chars_.size() + str.size();
+    if (required > chars_.capacity()) {
+        auto exp_reserve = chars_.reserve(std::max(required, 2 * chars_.capacity()));
+        if (!exp_reserve.has_value()) [[unlikely]] {
+            exp_reserve = chars_.reserve(required);
+        }
+        if (!exp_reserve.has_value()) [[unlikely]] {
+            return exp_reserve;
+        }
+    }
+    chars_.pop_back();
+    (void)chars_.append(std::span<const char>(str.data(), str.size()));
+    (void)chars_.push_back('\0');
+    return {};
+}
+
+template<Allocator A>
+std::expected<void, std::string> arena_string<A>::push_back(char c) noexcept
+{
+    return append(std::string_view(&c, 1));
+}
+
+template<Allocator A>
+void arena_string<A>::clear() noexcept
+{
+    chars_.clear();
+    (void)chars_.push_back('\0');
+}
+
+template<Allocator A>
+char& arena_string<A>::operator[](std::size_t index) noexcept
+{
+    return chars_[index];
+}
+
+template<Allocator A>
+char arena_string<A>::operator[](std::size_t index) const noexcept
+{
+    return chars_[index];
+}
+
+template<Allocator A>
+const char* arena_string<A>::c_str() const noexcept
+{
+    return chars_.data();
+}
+
+template<Allocator A>
+const char* arena_string<A>::data() const noexcept
+{
+    return chars_.data();
+}
+
+template<Allocator A>
+std::string_view arena_string<A>::view() const noexcept
+{
+    return std::string_view(chars_.data(), size());
+}
+
+template<Allocator A>
+arena_string<A>::operator std::string_view() const noexcept
+{
+    return view();
+}
+
+template<Allocator A>
+bool arena_string<A>::empty() const noexcept
+{
+    return size() == 0;
+}
+
+template<Allocator A>
+std::size_t arena_string<A>::size() const noexcept
+{
+    return chars_.empty() ? 0 : chars_.size() - 1;
+}
+
+template<Allocator A>
+std::size_t arena_string<A>::capacity() const noexcept
+{
+    return chars_.capacity() == 0 ? 0 : chars_.capacity() - 1;
+}
+
+template<Allocator A>
+arena_string<A>::arena_string(arena_vector<char, A>&& chars) noexcept
+    : chars_(std::move(chars))
+{}
+
+} // namespace amber
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+// Vector whose storage lives in an amber allocator. Growth is done in place
+// when the storage is the allocator's most recent allocation. Elements must be
+// trivially copyable and trivially destructible so the vector never needs to
+// be destroyed, releasing the allocator releases everything.
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+class arena_vector {
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    arena_vector() = delete;
+
+    arena_vector(const arena_vector&) = delete;
+
+    arena_vector(arena_vector&& other) noexcept;
+
+    arena_vector& operator=(const arena_vector&) = delete;
+
+    arena_vector& operator=(arena_vector&& other) noexcept;
+
+    static
+    std::expected<arena_vector, std::string> create(A& allocator) noexcept;
+
+    static
+    std::expected<arena_vector, std::string> create(A& allocator, std::size_t capacity) noexcept;
+
+    std::expected<void, std::string> reserve(std::size_t capacity) noexcept;
+
+    std::expected<void, std::string> resize(std::size_t size) noexcept;
+
+    std::expected<void, std::string> push_back(const T& value) noexcept;
+
+    template<typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> emplace_back(Args&&... args) noexcept;
+
+    std::expected<void, std::string> append(std::span<const T> values) noexcept;
+
+    void pop_back() noexcept;
+
+    void clear() noexcept;
+
+    T& operator[](std::size_t index) noexcept;
+
+    const T& operator[](std::size_t index) const noexcept;
+
+    T* data() noexcept;
+
+    const T* data() const noexcept;
+
+    iterator begin() noexcept;
+
+    iterator end() noexcept;
+
+    const_iterator begin() const noexcept;
+
+    const_iterator end() const noexcept;
+
+    std::span<T> span() noexcept;
+
+    std::span<const T> span() const noexcept;
+
+    bool empty() const noexcept;
+
+    std::size_t size() const noexcept;
+
+    std::size_t capacity() const noexcept;
+
+private:
+    arena_vector(A* allocator, T* data, std::size_t size, std::size_t capacity) noexcept;
+
+    std::expected<void, std::string> grow(std::size_t min_capacity) noexcept;
+
+    A* allocator_;
+    T* data_;
+    std::size_t size_;
+    std::size_t capacity_;
+};
+
+} // namespace amber
+
+#include <amber/arena_vector.inl>
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+arena_vector<T, A>::arena_vector(arena_vector&& other) noexcept
+    : allocator_(std::exchange(other.allocator_, nullptr)),
+    data_(std::exchange(other.data_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    capacity_(std::exchange(other.capacity_, 0))
+{}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+arena_vector<T, A>& arena_vector<T, A>::operator=(arena_vector&& other) noexcept
+{
+    if (this != &other) {
+        allocator_ = std::exchange(other.allocator_, nullptr);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+    }
+    return *this;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::expected<arena_vector<T, A>, std::string> arena_vector<T, A>::create(A& allocator) noexcept
+{
+    return arena_vector(&allocator, nullptr, 0, 0);
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::expected<arena_vector<T, A>, std::string> arena_vector<T, A>::create(
+    A& allocator, std::size_t capacity) noexcept
+{
+    arena_vector vector(&allocator, nullptr, 0, 0);
+    auto exp_reserve = vector.reserve(capacity);
+    if (!exp_reserve.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_reserve).error());
+    }
+    return vector;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::expected<void, std::string> arena_vector<T, A>::reserve(std::size_t capacity) noexcept
+{
+    if (capacity <= capacity_) {
+        return {};
+    }
+    if (capacity > std::numeric_limits<std::size_t>::max() / sizeof(T)) [[unlikely]] {
+        return std::unexpected("capacity too large");
+    }
+    if constexpr (ResizableAllocator<A>) {
+        if (data_ != nullptr
+            && allocator_->try_extend(data_, capacity_ * sizeof(T), capacity * sizeof(T)))
+        {
+            capacity_ = capacity;
+            return {};
+        }
+    }
+    auto exp_ptr = allocator_->allocate(alignof(T), capacity * sizeof(T));
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    T* data = std::assume_aligned<alignof(T)>(static_cast<T*>(exp_ptr.value()));
+    if (size_ > 0) {
+        std::memcpy(static_cast<void*>(data), static_cast<const void*>(data_), size_ * sizeof(T));
+    }
+    data_ = data;
+    capacity_ = capacity;
+    return {};
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::expected<void, std::string> arena_vector<T, A>::resize(std::size_t size) noexcept
+{
+    if (size > capacity_) {
+        auto exp_grow = grow(size);
+        if (!exp_grow.has_value()) [[unlikely]] {
+            return exp_grow;
+        }
+    }
+    if (size > size_) {
+        std::uninitialized_value_construct(data_ + size_, data_ + size);
+    }
+    size_ = size;
+    return {};
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::expected<void, std::string> arena_vector<T, A>::push_back(const T& value) noexcept
+{
+    if (size_ == capacity_) [[unlikely]] {
+        auto exp_grow = grow(size_ + 1);
+        if (!exp_grow.has_value()) [[unlikely]] {
+            return exp_grow;
+        }
+    }
+    std::construct_at(data_ + size_, value);
+    size_ += 1;
+    return {};
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+template<typename... Args>
+requires std::is_nothrow_constructible_v<T, Args...>
+std::expected<T*, std::string> arena_vector<T, A>::emplace_back(Args&&... args) noexcept
+{
+    if (size_ == capacity_) [[unlikely]] {
+        auto exp_grow = grow(size_ + 1);
+        if (!exp_grow.has_value()) [[unlikely]] {
+            return std::unexpected(std::move(exp_grow).error());
+        }
+    }
+    T* ptr = std::launder(std::construct_at(data_ + size_, std::forward<Args>(args)...));
+    size_ += 1;
+    return ptr;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::expected<void, std::string> arena_vector<T, A>::append(std::span<const T> values) noexcept
+{
+    if (size_ + values.size() > capacity_) {
+        auto exp_grow = grow(size_ + values.size());
+        if (!exp_grow.has_value()) [[unlikely]] {
+            return exp_grow;
+        }
+    }
+    if (!values.empty()) {
+        std::memcpy(
+            static_cast<void*>(data_ + size_),
+            static_cast<const void*>(values.data()),
+            values.size() * sizeof(T)
+        );
+    }
+    size_ += values.size();
+    return {};
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+void arena_vector<T, A>::pop_back() noexcept
+{
+    size_ -= 1;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+void arena_vector<T, A>::clear() noexcept
+{
+    size_ = 0;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+T& arena_vector<T, A>::operator[](std::size_t index) noexcept
+{
+    return data_[index];
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+const T& arena_vector<T, A>::operator[](std::size_t index) const noexcept
+{
+    return data_[index];
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+T* arena_vector<T, A>::data() noexcept
+{
+    return data_;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+const T* arena_vector<T, A>::data() const noexcept
+{
+    return data_;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+typename arena_vector<T, A>::iterator arena_vector<T, A>::begin() noexcept
+{
+    return data_;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+typename arena_vector<T, A>::iterator arena_vector<T, A>::end() noexcept
+{
+    return data_ + size_;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+typename arena_vector<T, A>::const_iterator arena_vector<T, A>::begin() const noexcept
+{
+    return data_;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+typename arena_vector<T, A>::const_iterator arena_vector<T, A>::end() const noexcept
+{
+    return data_ + size_;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::span<T> arena_vector<T, A>::span() noexcept
+{
+    return std::span(data_, size_);
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::span<const T> arena_vector<T, A>::span() const noexcept
+{
+    return std::span<const T>(data_, size_);
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+bool arena_vector<T, A>::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::size_t arena_vector<T, A>::size() const noexcept
+{
+    return size_;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::size_t arena_vector<T, A>::capacity() const noexcept
+{
+    return capacity_;
+}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+arena_vector<T, A>::arena_vector(A* allocator, T* data, std::size_t size, std::size_t capacity) noexcept
+    : allocator_(allocator),
+    data_(data),
+    size_(size),
+    capacity_(capacity)
+{}
+
+template<typename T, Allocator A>
+requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+std::expected<void, std::string> arena_vector<T, A>::grow(std::size_t min_capacity) noexcept
+{
+    std::size_t capacity = std::max(min_capacity, std::max<std::size_t>(2 * capacity_, 8));
+    auto exp_reserve = reserve(capacity);
+    if (exp_reserve.has_value()) [[likely]] {
+        return exp_reserve;
+    }
+    // Doubling may not fit near the end of the allocator, retry with the exact size
+    return reserve(min_capacity);
+}
+
+} // namespace amber
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <array>
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+// Splits the sizes (Min, Max] into buckets of Step bytes, each served by its
+// own A, e.g. a pool_allocator whose entry size is the bucket's upper bound.
+// Bucket i serves sizes in (Min + i * Step, Min + (i + 1) * Step].
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+class bucketizer {
+public:
+    static constexpr std::size_t bucket_count = (Max - Min) / Step;
+
+    bucketizer() = delete;
+
+    bucketizer(const bucketizer&) = delete;
+
+    bucketizer(bucketizer&& other) noexcept = default;
+
+    bucketizer& operator=(const bucketizer&) = delete;
+
+    bucketizer& operator=(bucketizer&& other) noexcept = default;
+
+    ~bucketizer() noexcept = default;
+
+    static
+    std::expected<bucketizer, std::string> create(std::array<A, bucket_count>&& buckets) noexcept;
+
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    // Asks every bucket whether it owns ptr, prefer the sized overload
+    void free(void* ptr) noexcept;
+
+    // Goes straight to the bucket serving size, the size passed to allocate
+    void free(void* ptr, std::size_t size) noexcept;
+
+    // Frees through the bucket of sizeof(T)
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T>
+    void free(T* ptr) noexcept;
+
+    // Asks every bucket whether it owns ptr
+    bool owns(const void* ptr) const noexcept;
+
+    A& bucket(std::size_t index) noexcept;
+
+    const A& bucket(std::size_t index) const noexcept;
+
+    // Largest size served by the bucket at index
+    static constexpr std::size_t bucket_size(std::size_t index) noexcept;
+
+private:
+    bucketizer(std::array<A, bucket_count>&& buckets) noexcept;
+
+    static constexpr std::size_t bucket_index(std::size_t size) noexcept;
+
+    std::array<A, bucket_count> buckets_;
+};
+
+} // namespace amber
+
+#include <amber/bucketizer.inl>
@@ -0,0 +1,129 @@
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+std::expected<bucketizer<A, Min, Max, Step>, std::string>
+bucketizer<A, Min, Max, Step>::create(std::array<A, bucket_count>&& buckets) noexcept
+{
+    static_assert(std::is_nothrow_move_constructible_v<A>);
+    return bucketizer(std::move(buckets));
+}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+std::expected<void*, std::string> bucketizer<A, Min, Max, Step>::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    if (size <= Min || size > Max) [[unlikely]] {
+        return std::unexpected("size out of bucket range");
+    }
+    return buckets_[bucket_index(size)].allocate(alignment, size);
+}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+template<typename T, typename... Args>
+requires std::is_nothrow_constructible_v<T, Args...>
+std::expected<T*, std::string> bucketizer<A, Min, Max, Step>::allocate(Args&&... args) noexcept
+{
+    auto exp_ptr = allocate(alignof(T), sizeof(T));
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    T* ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(std::move(exp_ptr).value()));
+    return std::launder(std::construct_at(ptr, std::forward<Args>(args)...));
+}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+void bucketizer<A, Min, Max, Step>::free(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    for (A& bucket : buckets_) {
+        if (bucket.owns(ptr)) {
+            if constexpr (DeallocatingAllocator<A>) {
+                bucket.free(ptr);
+            }
+            return;
+        }
+    }
+}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+void bucketizer<A, Min, Max, Step>::free(void* ptr, std::size_t size) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    if constexpr (DeallocatingAllocator<A>) {
+        buckets_[bucket_index(size)].free(ptr);
+    }
+}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+template<typename T>
+requires std::is_nothrow_destructible_v<T>
+void bucketizer<A, Min, Max, Step>::free(T* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::destroy_at(ptr);
+    free(static_cast<void*>(ptr), sizeof(T));
+}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+bool bucketizer<A, Min, Max, Step>::owns(const void* ptr) const noexcept
+{
+    for (const A& bucket : buckets_) {
+        if (bucket.owns(ptr)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+A& bucketizer<A, Min, Max, Step>::bucket(std::size_t index) noexcept
+{
+    return buckets_[index];
+}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+const A& bucketizer<A, Min, Max, Step>::bucket(std::size_t index) const noexcept
+{
+    return buckets_[index];
+}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+constexpr std::size_t bucketizer<A, Min, Max, Step>::bucket_size(std::size_t index) noexcept
+{
+    return Min + ((index + 1) * Step);
+}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+bucketizer<A, Min, Max, Step>::bucketizer(std::array<A, bucket_count>&& buckets) noexcept
+    : buckets_(std::move(buckets))
+{}
+
+template<OwningAllocator A, std::size_t Min, std::size_t Max, std::size_t Step>
+requires (Step > 0) && (Min < Max) && ((Max - Min) % Step == 0)
+constexpr std::size_t bucketizer<A, Min, Max, Step>::bucket_index(std::size_t size) noexcept
+{
+    return (size - Min - 1) / Step;
+}
+
+} // namespace amber
@@ -0,0 +1,174 @@
+#include <amber/compact_pool_allocator.hpp>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+namespace internal {
+
+compact_pool_entry::compact_pool_entry(std::uint32_t next) noexcept
+    : next(next)
+{}
+
+} // namespace amber::internal
+
+compact_pool_allocator::compact_pool_allocator(compact_pool_allocator&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, std::span<std::byte>())),
+    free_head_(std::exchange(other.free_head_, null_index)),
+    entry_size_(std::exchange(other.entry_size_, 0)),
+    entry_alignment_(std::exchange(other.entry_alignment_, 0)),
+    entry_count_(std::exchange(other.entry_count_, 0)),
+    entry_allocate_count_(std::exchange(other.entry_allocate_count_, 0))
+{}
+
+compact_pool_allocator::~compact_pool_allocator() noexcept
+{
+    buffer_ = std::span<std::byte>();
+    free_head_ = null_index;
+    entry_size_ = 0;
+    entry_alignment_ = 0;
+    entry_count_ = 0;
+    entry_allocate_count_ = 0;
+}
+
+compact_pool_allocator& compact_pool_allocator::operator=(compact_pool_allocator&& other) noexcept
+{
+    if (this != &other) {
+        buffer_ = std::exchange(other.buffer_, std::span<std::byte>());
+        free_head_ = std::exchange(other.free_head_, null_index);
+        entry_size_ = std::exchange(other.entry_size_, 0);
+        entry_alignment_ = std::exchange(other.entry_alignment_, 0);
+        entry_count_ = std::exchange(other.entry_count_, 0);
+        entry_allocate_count_ = std::exchange(other.entry_allocate_count_, 0);
+    }
+    return *this;
+}
+
+compact_pool_allocator::state compact_pool_allocator::save_state() const noexcept
+{
+    return state{
+        .entry_size = entry_size_,
+        .entry_alignment = entry_alignment_,
+        .entry_count = entry_count_,
+        .entry_allocate_count = entry_allocate_count_,
+        .free_head = free_head_,
+    };
+}
+
+std::expected<void*, std::string> compact_pool_allocator::allocate() noexcept
+{
+    if (free_head_ == null_index) [[unlikely]] {
+        return std::unexpected("out of capacity");
+    }
+    internal::compact_pool_entry* entry_ptr = static_cast<internal::compact_pool_entry*>(
+        pointer_to(free_head_)
+    );
+    entry_ptr = std::assume_aligned<alignof(internal::compact_pool_entry)>(entry_ptr);
+    free_head_ = entry_ptr->next;
+    std::memset(reinterpret_cast<void*>(entry_ptr), 0, entry_size_);
+    entry_allocate_count_ += 1;
+    return entry_ptr;
+}
+
+std::expected<void*, std::string> compact_pool_allocator::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    if (!std::has_single_bit(alignment)) [[unlikely]] {
+        auto&& exp_msg = mica::format("invalid alignment: {}", alignment);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    if (size > entry_size_) [[unlikely]] {
+        return std::unexpected("size too large");
+    }
+    if (alignment > entry_alignment_) [[unlikely]] {
+        return std::unexpected("alignment too large");
+    }
+    return allocate();
+}
+
+void compact_pool_allocator::free(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::uint32_t index = index_of(ptr);
+    internal::compact_pool_entry* entry_ptr = std::assume_aligned<alignof(internal::compact_pool_entry)>(
+        static_cast<internal::compact_pool_entry*>(ptr)
+    );
+    entry_ptr = std::launder(std::construct_at(entry_ptr, free_head_));
+    free_head_ = index;
+    entry_allocate_count_ -= 1;
+}
+
+std::uint32_t compact_pool_allocator::index_of(const void* ptr) const noexcept
+{
+    std::size_t offset = static_cast<const std::byte*>(ptr) - buffer_.data();
+    return static_cast<std::uint32_t>(offset / entry_size_);
+}
+
+void* compact_pool_allocator::pointer_to(std::uint32_t index) const noexcept
+{
+    return static_cast<void*>(buffer_.data() + (static_cast<std::size_t>(index) * entry_size_));
+}
+
+std::size_t compact_pool_allocator::buffer_size() const noexcept
+{
+    return buffer_.size();
+}
+
+bool compact_pool_allocator::owns(const void* ptr) const noexcept
+{
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    std::uintptr_t begin_addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+    return addr >= begin_addr && addr - begin_addr < entry_count_ * entry_size_;
+}
+
+std::size_t compact_pool_allocator::entry_size() const noexcept
+{
+    return entry_size_;
+}
+
+std::size_t compact_pool_allocator::entry_alignment() const noexcept
+{
+    return entry_alignment_;
+}
+
+std::size_t compact_pool_allocator::entry_count() const noexcept
+{
+    return entry_count_;
+}
+
+std::size_t compact_pool_allocator::entry_allocate_count() const noexcept
+{
+    return entry_allocate_count_;
+}
+
+std::size_t compact_pool_allocator::entry_free_count() const noexcept
+{
+    return entry_count_ - entry_allocate_count_;
+}
+
+compact_pool_allocator::compact_pool_allocator(
+    std::span<std::byte> buffer,
+    std::uint32_t free_head,
+    std::size_t entry_size,
+    std::size_t entry_alignment,
+    std::size_t entry_count,
+    std::size_t entry_allocate_count
+) noexcept
+    : buffer_(buffer),
+    free_head_(free_head),
+    entry_size_(entry_size),
+    entry_alignment_(entry_alignment),
+    entry_count_(entry_count),
+    entry_allocate_count_(entry_allocate_count)
+{}
+
+} // namespace amber
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+namespace internal {
+
+struct compact_pool_entry {
+public:
+    compact_pool_entry(std::uint32_t next) noexcept;
+
+    std::uint32_t next;
+};
+
+} // namespace amber::internal
+
+// Pool allocator whose free list links entries by 32-bit slot index relative
+// to the start of the buffer. Entries can be as small as 4 bytes and the
+// buffer contents do not depend on the address the buffer is mapped at.
+class compact_pool_allocator {
+public:
+    static constexpr std::uint32_t null_index = UINT32_MAX;
+
+    // Description of an allocator, see snapshot.hpp
+    struct state {
+    public:
+        std::size_t entry_size;
+        std::size_t entry_alignment;
+        std::size_t entry_count;
+        std::size_t entry_allocate_count;
+        std::uint32_t free_head;
+    };
+
+    compact_pool_allocator() = delete;
+
+    compact_pool_allocator(const compact_pool_allocator&) = delete;
+
+    compact_pool_allocator(compact_pool_allocator&& other) noexcept;
+
+    compact_pool_allocator& operator=(const compact_pool_allocator&) = delete;
+
+    compact_pool_allocator& operator=(compact_pool_allocator&& other) noexcept;
+
+    ~compact_pool_allocator() noexcept;
+
+    template<Buffer B>
+    static
+    std::expected<compact_pool_allocator, std::string> create(
+        B& buffer, std::size_t entry_size) noexcept;
+
+    template<Buffer B>
+    static
+    std::expected<compact_pool_allocator, std::string> create(
+        B& buffer, std::size_t entry_size, std::size_t entry_alignment) noexcept;
+
+    // Recreates an allocator over buffer, which holds the contents of the buffer
+    // described by s. The free list holds indices so no relocation is needed.
+    template<Buffer B>
+    static
+    std::expected<compact_pool_allocator, std::string> restore(B& buffer, const state& s) noexcept;
+
+    state save_state() const noexcept;
+
+    std::expected<void*, std::string> allocate() noexcept;
+
+    // Allocator interface, fails when size or alignment exceed the entry's
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    void free(void* ptr) noexcept;
+
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T>
+    void free(T* ptr) noexcept;
+
+    // Slot index of an entry allocated from this pool
+    std::uint32_t index_of(const void* ptr) const noexcept;
+
+    // Entry at a slot index previously returned by index_of
+    void* pointer_to(std::uint32_t index) const noexcept;
+
+    std::size_t buffer_size() const noexcept;
+
+    // Whether ptr points into the pool's entries
+    bool owns(const void* ptr) const noexcept;
+
+    std::size_t entry_size() const noexcept;
+
+    std::size_t entry_alignment() const noexcept;
+
+    std::size_t entry_count() const noexcept;
+
+    std::size_t entry_allocate_count() const noexcept;
+
+    std::size_t entry_free_count() const noexcept;
+
+private:
+    compact_pool_allocator(
+        std::span<std::byte> buffer,
+        std::uint32_t free_head,
+        std::size_t entry_size,
+        std::size_t entry_alignment,
+        std::size_t entry_count,
+        std::size_t entry_allocate_count
+    ) noexcept;
+
+    std::span<std::byte> buffer_;
+    std::uint32_t free_head_;
+    std::size_t entry_size_;
+    std::size_t entry_alignment_;
+    std::size_t entry_count_;
+    std::size_t entry_allocate_count_;
+};
+
+static_assert(DeallocatingAllocator<compact_pool_allocator>);
+static_assert(OwningAllocator<compact_pool_allocator>);
+
+} // namespace amber
+
+#include <amber/compact_pool_allocator.inl>
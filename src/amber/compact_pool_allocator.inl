@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <amber/util.hpp>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+template<Buffer B>
+std::expected<compact_pool_allocator, std::string> compact_pool_allocator::create(
+    B& buffer, std::size_t entry_size) noexcept
+{
+    return create(buffer, entry_size, alignof(internal::compact_pool_entry));
+}
+
+template<Buffer B>
+std::expected<compact_pool_allocator, std::string> compact_pool_allocator::create(
+    B& buffer, std::size_t entry_size, std::size_t entry_alignment) noexcept
+{
+    if (!std::has_single_bit(entry_alignment)) [[unlikely]] {
+        auto&& exp_msg = mica::format("invalid alignment: {}", entry_alignment);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    std::span<std::byte> buffer_span = buffer.buffer();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_span.data());
+    entry_alignment = std::max(entry_alignment, alignof(internal::compact_pool_entry));
+    if (!is_aligned(static_cast<std::uintptr_t>(entry_alignment), buffer_addr)) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "invalid buffer alignment, buffer: {:#x}, target alignment: {}",
+            buffer_addr, entry_alignment
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    entry_size = std::max(entry_size, sizeof(internal::compact_pool_entry));
+    entry_size = align_forward(entry_alignment, entry_size);
+    // null_index is reserved as the end of list marker
+    std::size_t entry_count = std::min<std::size_t>(buffer_span.size() / entry_size, null_index);
+
+    std::uint32_t free_head = null_index;
+    static_assert(std::is_nothrow_constructible_v<internal::compact_pool_entry, decltype(free_head)>);
+    for (std::size_t i = 0; i < entry_count; ++i) {
+        std::byte* buffer_offset_ptr = buffer_span.data() + (i * entry_size);
+        internal::compact_pool_entry* entry_ptr = reinterpret_cast<internal::compact_pool_entry*>(buffer_offset_ptr);
+        entry_ptr = std::assume_aligned<alignof(internal::compact_pool_entry)>(entry_ptr);
+        entry_ptr = std::launder(std::construct_at(entry_ptr, free_head));
+        free_head = static_cast<std::uint32_t>(i);
+    }
+
+    return compact_pool_allocator(buffer_span, free_head, entry_size, entry_alignment, entry_count, 0);
+}
+
+template<Buffer B>
+std::expected<compact_pool_allocator, std::string> compact_pool_allocator::restore(
+    B& buffer, const state& s) noexcept
+{
+    std::span<std::byte> buffer_span = buffer.buffer();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_span.data());
+    if (s.entry_size == 0
+        || s.entry_allocate_count > s.entry_count
+        || s.entry_count > buffer_span.size() / s.entry_size
+        || (s.free_head != null_index && s.free_head >= s.entry_count)) [[unlikely]]
+    {
+        return std::unexpected("invalid pool state");
+    }
+    if (!is_aligned(static_cast<std::uintptr_t>(s.entry_alignment), buffer_addr)) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "invalid buffer alignment, buffer: {:#x}, target alignment: {}",
+            buffer_addr, s.entry_alignment
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    return compact_pool_allocator(
+        buffer_span, s.free_head, s.entry_size, s.entry_alignment, s.entry_count, s.entry_allocate_count);
+}
+
+template<typename T, typename... Args>
+requires std::is_nothrow_constructible_v<T, Args...>
+std::expected<T*, std::string> compact_pool_allocator::allocate(Args&&... args) noexcept
+{
+    if (sizeof(T) > entry_size_) [[unlikely]] {
+        return std::unexpected("type size too large");
+    }
+    if (alignof(T) > entry_alignment_) [[unlikely]] {
+        return std::unexpected("type alignment too large");
+    }
+    auto exp_ptr = allocate();
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    T* ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(std::move(exp_ptr).value()));
+    return std::launder(std::construct_at(ptr, std::forward<Args>(args)...));
+}
+
+template<typename T>
+requires std::is_nothrow_destructible_v<T>
+void compact_pool_allocator::free(T* ptr) noexcept
+{
+    std::destroy_at(ptr);
+    free(static_cast<void*>(ptr));
+}
+
+} // namespace amber
@@ -2,7 +2,9 @@
 
 #include <concepts>
 #include <cstddef>
+#include <expected>
 #include <span>
+#include <string>
 #include <type_traits>
 
 namespace amber {
@@ -20,4 +22,50 @@ concept Buffer =
     { tc.size() } noexcept -> std::same_as<std::size_t>;
 };
 
+// Buffer whose size can change after creation. Contents up to the smaller of
+// the two sizes are kept, but the buffer may move to a new address.
+template<typename T>
+concept ResizableBuffer =
+    Buffer<T>
+    && requires(T t, std::size_t size)
+{
+    { t.grow(size) } noexcept -> std::same_as<std::expected<void, std::string>>;
+    { t.shrink(size) } noexcept -> std::same_as<std::expected<void, std::string>>;
+};
+
+// Variable size allocator, e.g. linear_allocator or stack_allocator
+template<typename T>
+concept Allocator = requires(T t, std::size_t alignment, std::size_t size)
+{
+    { t.allocate(alignment, size) } noexcept -> std::same_as<std::expected<void*, std::string>>;
+};
+
+// Allocator that can resize its most recent allocation in place
+template<typename T>
+concept ResizableAllocator =
+    Allocator<T>
+    && requires(T t, void* ptr, std::size_t alignment, std::size_t size)
+{
+    { t.try_extend(ptr, size, size) } noexcept -> std::same_as<bool>;
+    { t.reallocate(ptr, size, alignment, size) } noexcept -> std::same_as<std::expected<void*, std::string>>;
+};
+
+// Allocator that returns individual allocations, e.g. pool_allocator
+template<typename T>
+concept DeallocatingAllocator =
+    Allocator<T>
+    && requires(T t, void* ptr)
+{
+    { t.free(ptr) } noexcept -> std::same_as<void>;
+};
+
+// Allocator that can tell whether it handed out a pointer
+template<typename T>
+concept OwningAllocator =
+    Allocator<T>
+    && requires(const T tc, const void* ptr)
+{
+    { tc.owns(ptr) } noexcept -> std::same_as<bool>;
+};
+
 } // namespace amber
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <amber/coroutine_frame.hpp>
+#include <amber/mmap_buffer.hpp>
+#include <amber/shared_pool_allocator.hpp>
+#include <amber/span_buffer.hpp>
+#include <amber/util.hpp>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace amber {
+
+namespace {
+
+constexpr std::size_t min_block_size = 64;
+
+constexpr std::size_t chunk_size = std::size_t(1) << 20;
+
+constexpr std::size_t header_size = sizeof(internal::coroutine_frame_header);
+
+// Placed at the start of its own mapping, followed by the pool. Chunks are
+// kept for the lifetime of the process, frames may outlive any thread.
+struct frame_chunk {
+public:
+    mmap_buffer buffer;
+    shared_pool_allocator pool;
+    std::size_t size_class;
+    frame_chunk* next;
+};
+
+struct frame_class {
+public:
+    std::mutex mutex;
+    frame_chunk* head = nullptr;
+    // Refills start here, it had free entries when last looked at
+    frame_chunk* current = nullptr;
+};
+
+constinit frame_class frame_classes[internal::coroutine_frame_class_count];
+
+struct frame_cache {
+public:
+    ~frame_cache() noexcept;
+
+    std::size_t count[internal::coroutine_frame_class_count];
+    void* blocks[internal::coroutine_frame_class_count][internal::coroutine_frame_cache_capacity];
+};
+
+thread_local frame_cache cache = {};
+
+std::size_t block_size(std::size_t size_class) noexcept
+{
+    return min_block_size << size_class;
+}
+
+std::size_t size_class_of(std::size_t size) noexcept
+{
+    return static_cast<std::size_t>(std::bit_width(std::max(size, min_block_size) - 1)) - 6;
+}
+
+void release_to_pool(void* block) noexcept
+{
+    internal::coroutine_frame_header* header = static_cast<internal::coroutine_frame_header*>(block);
+    static_cast<frame_chunk*>(header->context)->pool.free(block);
+}
+
+frame_cache::~frame_cache() noexcept
+{
+    for (std::size_t c = 0; c < internal::coroutine_frame_class_count; ++c) {
+        for (std::size_t i = 0; i < count[c]; ++i) {
+            release_to_pool(blocks[c][i]);
+        }
+        count[c] = 0;
+    }
+}
+
+void release_pooled(void* context, void* block) noexcept
+{
+    std::size_t size_class = static_cast<frame_chunk*>(context)->size_class;
+    std::size_t& count = cache.count[size_class];
+    if (count == internal::coroutine_frame_cache_capacity) [[unlikely]] {
+        constexpr std::size_t keep = internal::coroutine_frame_cache_capacity / 2;
+        for (std::size_t i = keep; i < internal::coroutine_frame_cache_capacity; ++i) {
+            release_to_pool(cache.blocks[size_class][i]);
+        }
+        count = keep;
+    }
+    cache.blocks[size_class][count] = block;
+    count += 1;
+}
+
+void release_heap(void*, void* block) noexcept
+{
+    ::operator delete(block);
+}
+
+frame_chunk* create_chunk(std::size_t size_class) noexcept
+{
+    auto exp_buffer = mmap_buffer::create_lazy(chunk_size);
+    if (!exp_buffer.has_value()) [[unlikely]] {
+        return nullptr;
+    }
+    std::span<std::byte> memory = exp_buffer.value().buffer();
+    std::size_t pool_offset = align_forward(
+        std::max(alignof(internal::shared_pool_header), header_size), sizeof(frame_chunk));
+    span_buffer pool_buffer(memory.subspan(pool_offset));
+    auto exp_pool = shared_pool_allocator::create(pool_buffer, block_size(size_class), header_size);
+    if (!exp_pool.has_value()) [[unlikely]] {
+        return nullptr;
+    }
+    return std::launder(std::construct_at(
+        reinterpret_cast<frame_chunk*>(memory.data()),
+        frame_chunk{std::move(exp_buffer).value(), std::move(exp_pool).value(), size_class, nullptr}));
+}
+
+// Moves up to half a cache of free blocks from the pools into the calling
+// thread's cache
+bool refill(std::size_t size_class) noexcept
+{
+    frame_class& fc = frame_classes[size_class];
+    std::lock_guard lock(fc.mutex);
+    std::size_t& count = cache.count[size_class];
+    frame_chunk* chunk = fc.current;
+    while (count < internal::coroutine_frame_cache_capacity / 2) {
+        if (chunk == nullptr) {
+            // Frames released to any chunk since it was passed make it usable again
+            chunk = fc.head;
+            while (chunk != nullptr && chunk->pool.entry_free_count() == 0) {
+                chunk = chunk->next;
+            }
+            if (chunk == nullptr) {
+                chunk = create_chunk(size_class);
+                if (chunk == nullptr) [[unlikely]] {
+                    break;
+                }
+                chunk->next = fc.head;
+                fc.head = chunk;
+            }
+        }
+        // Not zeroed, the header is written next and the frame overwrites the rest
+        auto exp_block = chunk->pool.allocate_uninitialized();
+        if (!exp_block.has_value()) {
+            chunk = nullptr;
+            continue;
+        }
+        void* block = exp_block.value();
+        std::construct_at(
+            static_cast<internal::coroutine_frame_header*>(block),
+            internal::coroutine_frame_header{release_pooled, chunk});
+        cache.blocks[size_class][count] = block;
+        count += 1;
+    }
+    fc.current = chunk;
+    return count > 0;
+}
+
+} // unnamed namespace
+
+namespace internal {
+
+void* allocate_pooled_frame(std::size_t size) noexcept
+{
+    if (size > coroutine_frame_max_block_size - header_size) [[unlikely]] {
+        if (size > SIZE_MAX - header_size) [[unlikely]] {
+            return nullptr;
+        }
+        void* block = ::operator new(size + header_size, std::nothrow);
+        if (block == nullptr) [[unlikely]] {
+            return nullptr;
+        }
+        coroutine_frame_header* header = std::launder(std::construct_at(
+            static_cast<coroutine_frame_header*>(block), coroutine_frame_header{release_heap, nullptr}));
+        return header + 1;
+    }
+    std::size_t size_class = size_class_of(size + header_size);
+    std::size_t& count = cache.count[size_class];
+    if (count == 0) [[unlikely]] {
+        if (!refill(size_class)) [[unlikely]] {
+            return nullptr;
+        }
+    }
+    count -= 1;
+    void* block = cache.blocks[size_class][count];
+    block = std::assume_aligned<alignof(coroutine_frame_header)>(block);
+    return std::launder(static_cast<coroutine_frame_header*>(block)) + 1;
+}
+
+void release_frame(void* frame) noexcept
+{
+    coroutine_frame_header* header = static_cast<coroutine_frame_header*>(frame) - 1;
+    header->release(header->context, header);
+}
+
+std::size_t cached_frame_count(std::size_t size_class) noexcept
+{
+    return cache.count[size_class];
+}
+
+} // namespace amber::internal
+
+void* coroutine_frame_promise::operator new(std::size_t size)
+{
+    void* frame = internal::allocate_pooled_frame(size);
+    if (frame == nullptr) [[unlikely]] {
+        throw std::bad_alloc();
+    }
+    return frame;
+}
+
+void coroutine_frame_promise::operator delete(void* frame) noexcept
+{
+    internal::release_frame(frame);
+}
+
+} // namespace amber
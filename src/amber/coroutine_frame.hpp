@@ -0,0 +1,77 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <cstddef>
+#include <memory>
+
+namespace amber {
+
+namespace internal {
+
+// Pooled blocks are 64 bytes to 4 KiB, header included, in powers of two
+inline constexpr std::size_t coroutine_frame_class_count = 7;
+
+inline constexpr std::size_t coroutine_frame_max_block_size = 4096;
+
+// Entries each thread keeps per size class before returning half to the pools
+inline constexpr std::size_t coroutine_frame_cache_capacity = 32;
+
+// Stored directly before every frame, says how to release the block
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) coroutine_frame_header {
+public:
+    void (*release)(void* context, void* block) noexcept;
+    void* context;
+};
+
+// Frame of size bytes from the size class pools, larger frames come from the
+// global operator new. Returns nullptr when out of memory.
+void* allocate_pooled_frame(std::size_t size) noexcept;
+
+void release_frame(void* frame) noexcept;
+
+// Blocks of each size class held by the calling thread's cache
+std::size_t cached_frame_count(std::size_t size_class) noexcept;
+
+} // namespace amber::internal
+
+// Base for the promise_type of a coroutine. Frames come from process wide
+// size class pools fronted by a per thread cache, so creating a coroutine
+// neither locks nor calls malloc in the common case. A frame may be destroyed
+// on any thread, it then joins that thread's cache.
+//
+// A coroutine taking std::allocator_arg_t followed by an allocator as its
+// first parameters, or right after the object for member coroutines, has its
+// frame allocated from that allocator instead, e.g. a stack_allocator per
+// task whose nested coroutines release their frames in reverse order.
+// Allocators that cannot free leave the frame in place until they are reset.
+// The allocator must outlive the frame.
+class coroutine_frame_promise {
+public:
+    // Each overload throws std::bad_alloc when out of memory
+    static
+    void* operator new(std::size_t size);
+
+    template<Allocator A, typename... Args>
+    static
+    void* operator new(std::size_t size, std::allocator_arg_t, A& allocator, Args&... args);
+
+    template<typename Object, Allocator A, typename... Args>
+    static
+    void* operator new(std::size_t size, Object& object, std::allocator_arg_t, A& allocator, Args&... args);
+
+    static
+    void operator delete(void* frame) noexcept;
+
+private:
+    template<Allocator A>
+    static
+    void* allocate_frame(std::size_t size, A& allocator);
+
+    template<Allocator A>
+    static
+    void release_to(void* context, void* block) noexcept;
+};
+
+} // namespace amber
+
+#include <amber/coroutine_frame.inl>
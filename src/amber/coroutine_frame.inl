@@ -0,0 +1,44 @@
+#include <cstdint>
+#include <new>
+
+namespace amber {
+
+template<Allocator A, typename... Args>
+void* coroutine_frame_promise::operator new(std::size_t size, std::allocator_arg_t, A& allocator, Args&...)
+{
+    return allocate_frame(size, allocator);
+}
+
+template<typename Object, Allocator A, typename... Args>
+void* coroutine_frame_promise::operator new(
+    std::size_t size, Object&, std::allocator_arg_t, A& allocator, Args&...)
+{
+    return allocate_frame(size, allocator);
+}
+
+template<Allocator A>
+void* coroutine_frame_promise::allocate_frame(std::size_t size, A& allocator)
+{
+    constexpr std::size_t header_size = sizeof(internal::coroutine_frame_header);
+    if (size > SIZE_MAX - header_size) [[unlikely]] {
+        throw std::bad_alloc();
+    }
+    auto exp_block = allocator.allocate(alignof(internal::coroutine_frame_header), size + header_size);
+    if (!exp_block.has_value()) [[unlikely]] {
+        throw std::bad_alloc();
+    }
+    internal::coroutine_frame_header* header = std::launder(std::construct_at(
+        static_cast<internal::coroutine_frame_header*>(exp_block.value()),
+        internal::coroutine_frame_header{release_to<A>, &allocator}));
+    return header + 1;
+}
+
+template<Allocator A>
+void coroutine_frame_promise::release_to(void* context, void* block) noexcept
+{
+    if constexpr (DeallocatingAllocator<A>) {
+        static_cast<A*>(context)->free(block);
+    }
+}
+
+} // namespace amber
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <amber/double_stack_allocator.hpp>
+#include <amber/util.hpp>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <string>
+#include <utility>
+
+namespace amber {
+
+double_stack_allocator::double_stack_allocator(double_stack_allocator&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, std::span<std::byte>())),
+    low_offset_(std::exchange(other.low_offset_, 0)),
+    high_offset_(std::exchange(other.high_offset_, 0))
+{}
+
+double_stack_allocator& double_stack_allocator::operator=(double_stack_allocator&& other) noexcept
+{
+    if (this != &other) {
+        buffer_ = std::exchange(other.buffer_, std::span<std::byte>());
+        low_offset_ = std::exchange(other.low_offset_, 0);
+        high_offset_ = std::exchange(other.high_offset_, 0);
+    }
+    return *this;
+}
+
+double_stack_allocator::~double_stack_allocator() noexcept
+{
+    buffer_ = std::span<std::byte>();
+    low_offset_ = 0;
+    high_offset_ = 0;
+}
+
+std::expected<void*, std::string> double_stack_allocator::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    return allocate_low(alignment, size);
+}
+
+std::expected<void*, std::string> double_stack_allocator::allocate_low(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    if (!std::has_single_bit(alignment)) [[unlikely]] {
+        auto&& exp_msg = mica::format("invalid alignment: {}", alignment);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    alignment = std::max(alignof(internal::alloc_header), alignment);
+    std::byte* offset_ptr = buffer_.data() + low_offset_;
+    std::uintptr_t offset_addr = reinterpret_cast<std::uintptr_t>(offset_ptr);
+    std::uintptr_t target_addr = offset_addr + sizeof(internal::alloc_header);
+    std::uintptr_t aligned_addr = align_forward(static_cast<std::uintptr_t>(alignment), target_addr);
+    std::uintptr_t aligned_padding = aligned_addr - offset_addr;
+    if (aligned_padding + size > high_offset_ - low_offset_) [[unlikely]] {
+        return std::unexpected("out of capacity");
+    }
+
+    internal::alloc_header* header_ptr = reinterpret_cast<internal::alloc_header*>(
+        aligned_addr - sizeof(internal::alloc_header));
+    header_ptr = std::assume_aligned<alignof(internal::alloc_header)>(header_ptr);
+    header_ptr = std::launder(std::construct_at(header_ptr, aligned_padding));
+
+    low_offset_ += aligned_padding + size;
+    return reinterpret_cast<void*>(aligned_addr);
+}
+
+std::expected<void*, std::string> double_stack_allocator::allocate_low(std::size_t size) noexcept
+{
+    return allocate_low(alignof(std::max_align_t), size);
+}
+
+std::expected<void*, std::string> double_stack_allocator::allocate_high(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    if (!std::has_single_bit(alignment)) [[unlikely]] {
+        auto&& exp_msg = mica::format("invalid alignment: {}", alignment);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    if (size > high_offset_ - low_offset_) [[unlikely]] {
+        return std::unexpected("out of capacity");
+    }
+    // The allocation is placed below the high offset and its header below it,
+    // padding then reaches from the allocation up to the previous high offset
+    alignment = std::max(alignof(internal::alloc_header), alignment);
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+    std::uintptr_t offset_addr = buffer_addr + high_offset_;
+    std::uintptr_t aligned_addr = (offset_addr - size) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+    if (aligned_addr < buffer_addr + low_offset_ + sizeof(internal::alloc_header)) [[unlikely]] {
+        return std::unexpected("out of capacity");
+    }
+    std::uintptr_t aligned_padding = offset_addr - aligned_addr;
+
+    internal::alloc_header* header_ptr = reinterpret_cast<internal::alloc_header*>(
+        aligned_addr - sizeof(internal::alloc_header));
+    header_ptr = std::assume_aligned<alignof(internal::alloc_header)>(header_ptr);
+    header_ptr = std::launder(std::construct_at(header_ptr, aligned_padding));
+
+    high_offset_ = aligned_addr - sizeof(internal::alloc_header) - buffer_addr;
+    return reinterpret_cast<void*>(aligned_addr);
+}
+
+std::expected<void*, std::string> double_stack_allocator::allocate_high(std::size_t size) noexcept
+{
+    return allocate_high(alignof(std::max_align_t), size);
+}
+
+void double_stack_allocator::free(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::size_t ptr_offset = static_cast<std::size_t>(static_cast<std::byte*>(ptr) - buffer_.data());
+    // A zero-size low allocation sits at low_offset_, while every high
+    // allocation starts past its header above high_offset_
+    if (ptr_offset <= high_offset_) {
+        free_low(ptr);
+    } else {
+        free_high(ptr);
+    }
+}
+
+void double_stack_allocator::free_low(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::uintptr_t aligned_addr = reinterpret_cast<std::uintptr_t>(ptr);
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+    internal::alloc_header* header_ptr = reinterpret_cast<internal::alloc_header*>(
+        aligned_addr - sizeof(internal::alloc_header));
+    low_offset_ = aligned_addr - header_ptr->padding - buffer_addr;
+}
+
+void double_stack_allocator::free_high(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::uintptr_t aligned_addr = reinterpret_cast<std::uintptr_t>(ptr);
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+    internal::alloc_header* header_ptr = reinterpret_cast<internal::alloc_header*>(
+        aligned_addr - sizeof(internal::alloc_header));
+    high_offset_ = aligned_addr + header_ptr->padding - buffer_addr;
+}
+
+void double_stack_allocator::rewind_low(std::size_t low_offset) noexcept
+{
+    if (low_offset >= low_offset_) {
+        return;
+    }
+    low_offset_ = low_offset;
+}
+
+void double_stack_allocator::rewind_high(std::size_t high_offset) noexcept
+{
+    if (high_offset <= high_offset_ || high_offset > buffer_.size()) {
+        return;
+    }
+    high_offset_ = high_offset;
+}
+
+void double_stack_allocator::reset() noexcept
+{
+    low_offset_ = 0;
+    high_offset_ = buffer_.size();
+}
+
+std::size_t double_stack_allocator::buffer_size() const noexcept
+{
+    return buffer_.size();
+}
+
+bool double_stack_allocator::owns(const void* ptr) const noexcept
+{
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    std::uintptr_t begin_addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+    if (addr < begin_addr) {
+        return false;
+    }
+    std::size_t offset = addr - begin_addr;
+    return offset < low_offset_ || (offset >= high_offset_ && offset < buffer_.size());
+}
+
+std::size_t double_stack_allocator::low_offset() const noexcept
+{
+    return low_offset_;
+}
+
+std::size_t double_stack_allocator::high_offset() const noexcept
+{
+    return high_offset_;
+}
+
+std::size_t double_stack_allocator::free_size() const noexcept
+{
+    return high_offset_ - low_offset_;
+}
+
+double_stack_allocator::double_stack_allocator(
+    std::span<std::byte> buffer, std::size_t low_offset, std::size_t high_offset) noexcept
+    : buffer_(buffer),
+    low_offset_(low_offset),
+    high_offset_(high_offset)
+{}
+
+} // namespace amber
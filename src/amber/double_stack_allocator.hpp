@@ -0,0 +1,109 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <amber/stack_allocator.hpp>
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+// Two stacks over one buffer growing toward each other, e.g. long-lived
+// results on the low stack and scratch on the high stack, so the two
+// lifetimes never block each other's frees. Each stack frees in LIFO order or
+// rewinds to an offset, allocations carry the same header as stack_allocator.
+class double_stack_allocator {
+public:
+    double_stack_allocator() = delete;
+
+    double_stack_allocator(const double_stack_allocator&) = delete;
+
+    double_stack_allocator(double_stack_allocator&& other) noexcept;
+
+    double_stack_allocator& operator=(const double_stack_allocator&) = delete;
+
+    double_stack_allocator& operator=(double_stack_allocator&& other) noexcept;
+
+    ~double_stack_allocator() noexcept;
+
+    template<Buffer B>
+    static
+    std::expected<double_stack_allocator, std::string> create(B& buffer) noexcept;
+
+    // Allocator interface, allocates from the low stack
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    std::expected<void*, std::string> allocate_low(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    std::expected<void*, std::string> allocate_low(std::size_t size) noexcept;
+
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate_low(Args&&... args) noexcept;
+
+    std::expected<void*, std::string> allocate_high(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    std::expected<void*, std::string> allocate_high(std::size_t size) noexcept;
+
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate_high(Args&&... args) noexcept;
+
+    // Frees the most recent allocation of the stack that ptr belongs to
+    void free(void* ptr) noexcept;
+
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T>
+    void free(T* ptr) noexcept;
+
+    void free_low(void* ptr) noexcept;
+
+    void free_high(void* ptr) noexcept;
+
+    // Releases everything allocated on the low stack after low_offset, a value
+    // previously returned by low_offset()
+    void rewind_low(std::size_t low_offset) noexcept;
+
+    // Releases everything allocated on the high stack after high_offset, a
+    // value previously returned by high_offset()
+    void rewind_high(std::size_t high_offset) noexcept;
+
+    void reset() noexcept;
+
+    std::size_t buffer_size() const noexcept;
+
+    // Whether ptr points into either stack
+    bool owns(const void* ptr) const noexcept;
+
+    // End of the low stack, it occupies [0, low_offset())
+    std::size_t low_offset() const noexcept;
+
+    // Start of the high stack, it occupies [high_offset(), buffer_size())
+    std::size_t high_offset() const noexcept;
+
+    // Bytes between the two stacks
+    std::size_t free_size() const noexcept;
+
+private:
+    double_stack_allocator(
+        std::span<std::byte> buffer,
+        std::size_t low_offset,
+        std::size_t high_offset
+    ) noexcept;
+
+    std::span<std::byte> buffer_;
+    std::size_t low_offset_;
+    std::size_t high_offset_;
+};
+
+static_assert(DeallocatingAllocator<double_stack_allocator>);
+static_assert(OwningAllocator<double_stack_allocator>);
+
+} // namespace amber
+
+#include <amber/double_stack_allocator.inl>
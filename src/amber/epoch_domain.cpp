@@ -0,0 +1,98 @@
+#include <amber/epoch_domain.hpp>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+namespace internal {
+
+epoch_slot::epoch_slot(retired_entry* entries, std::size_t batch_size) noexcept
+    : state(0),
+    in_use(false),
+    pin_depth(0),
+    bags{
+        epoch_bag{entries, 0, 0},
+        epoch_bag{entries + batch_size, 0, 0},
+        epoch_bag{entries + (2 * batch_size), 0, 0},
+    }
+{}
+
+epoch_control::epoch_control(std::size_t slot_count, std::size_t batch_size) noexcept
+    : global_epoch(0),
+    slot_count(slot_count),
+    batch_size(batch_size),
+    allocator_mutex()
+{}
+
+epoch_slot* epoch_slots(epoch_control* control) noexcept
+{
+    std::byte* slots_ptr = reinterpret_cast<std::byte*>(control) + sizeof(epoch_control);
+    return std::launder(reinterpret_cast<epoch_slot*>(slots_ptr));
+}
+
+void epoch_pin(epoch_control* control, epoch_slot* slot) noexcept
+{
+    if (slot->pin_depth++ > 0) {
+        return;
+    }
+    std::uint64_t epoch = control->global_epoch.load(std::memory_order_relaxed);
+    slot->state.store((epoch << 1) | 1, std::memory_order_relaxed);
+    // Publish the pin before any shared pointer is read
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void epoch_unpin(epoch_slot* slot) noexcept
+{
+    if (--slot->pin_depth > 0) {
+        return;
+    }
+    slot->state.store(0, std::memory_order_release);
+}
+
+bool epoch_try_advance(epoch_control* control) noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::uint64_t epoch = control->global_epoch.load(std::memory_order_relaxed);
+    epoch_slot* slots = epoch_slots(control);
+    for (std::size_t i = 0; i < control->slot_count; ++i) {
+        std::uint64_t state = slots[i].state.load(std::memory_order_acquire);
+        if ((state & 1) != 0 && (state >> 1) != epoch) {
+            return false;
+        }
+    }
+    // Losing the race means another thread advanced it, which is just as good
+    control->global_epoch.compare_exchange_strong(
+        epoch, epoch + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace amber::internal
+
+epoch_guard::epoch_guard(epoch_guard&& other) noexcept
+    : slot_(std::exchange(other.slot_, nullptr))
+{}
+
+epoch_guard& epoch_guard::operator=(epoch_guard&& other) noexcept
+{
+    if (this != &other) {
+        if (slot_ != nullptr) {
+            internal::epoch_unpin(slot_);
+        }
+        slot_ = std::exchange(other.slot_, nullptr);
+    }
+    return *this;
+}
+
+epoch_guard::~epoch_guard() noexcept
+{
+    if (slot_ != nullptr) {
+        internal::epoch_unpin(slot_);
+    }
+    slot_ = nullptr;
+}
+
+epoch_guard::epoch_guard(internal::epoch_slot* slot) noexcept
+    : slot_(slot)
+{}
+
+} // namespace amber
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <amber/util.hpp>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+namespace internal {
+
+struct retired_entry {
+public:
+    void* ptr;
+    // Runs the destructor of the retired object, null when trivial
+    void (*destroy)(void*) noexcept;
+};
+
+// Objects retired by one thread during one epoch
+struct epoch_bag {
+public:
+    retired_entry* entries;
+    std::size_t count;
+    std::uint64_t epoch;
+};
+
+struct alignas(cache_line_size) epoch_slot {
+public:
+    epoch_slot(retired_entry* entries, std::size_t batch_size) noexcept;
+
+    // (epoch << 1) | 1 while pinned, 0 otherwise
+    std::atomic<std::uint64_t> state;
+    std::atomic<bool> in_use;
+    // Owner thread only
+    std::size_t pin_depth;
+    std::array<epoch_bag, 3> bags;
+};
+
+struct alignas(cache_line_size) epoch_control {
+public:
+    epoch_control(std::size_t slot_count, std::size_t batch_size) noexcept;
+
+    std::atomic<std::uint64_t> global_epoch;
+    std::size_t slot_count;
+    std::size_t batch_size;
+    // Serializes calls into the allocator
+    alignas(cache_line_size) std::mutex allocator_mutex;
+};
+
+epoch_slot* epoch_slots(epoch_control* control) noexcept;
+
+void epoch_pin(epoch_control* control, epoch_slot* slot) noexcept;
+
+void epoch_unpin(epoch_slot* slot) noexcept;
+
+// Moves the global epoch forward when every pinned thread has observed it
+bool epoch_try_advance(epoch_control* control) noexcept;
+
+template<DeallocatingAllocator A>
+void epoch_reclaim(epoch_control* control, A* allocator, epoch_bag& bag) noexcept;
+
+} // namespace amber::internal
+
+// Keeps the calling thread pinned to an epoch, objects retired by any thread
+// stay allocated while the guard is alive
+class epoch_guard {
+public:
+    epoch_guard() = delete;
+
+    epoch_guard(const epoch_guard&) = delete;
+
+    epoch_guard(epoch_guard&& other) noexcept;
+
+    epoch_guard& operator=(const epoch_guard&) = delete;
+
+    epoch_guard& operator=(epoch_guard&& other) noexcept;
+
+    ~epoch_guard() noexcept;
+
+private:
+    template<DeallocatingAllocator A>
+    friend class epoch_handle;
+
+    epoch_guard(internal::epoch_slot* slot) noexcept;
+
+    internal::epoch_slot* slot_;
+};
+
+// Per-thread participant of an epoch_domain, must only be used by the thread
+// that attached it. Retired objects left behind when a handle is destroyed
+// are reclaimed by the next handle given the same slot, or by the domain.
+template<DeallocatingAllocator A>
+class epoch_handle {
+public:
+    epoch_handle() = delete;
+
+    epoch_handle(const epoch_handle&) = delete;
+
+    epoch_handle(epoch_handle&& other) noexcept;
+
+    epoch_handle& operator=(const epoch_handle&) = delete;
+
+    epoch_handle& operator=(epoch_handle&& other) noexcept;
+
+    ~epoch_handle() noexcept;
+
+    // Pins are cheap and may nest
+    epoch_guard pin() noexcept;
+
+    // Frees ptr once no thread can still hold it. Fails when this thread's
+    // retired objects reached the bound and the epoch cannot advance because
+    // another thread stays pinned.
+    std::expected<void, std::string> retire(void* ptr) noexcept;
+
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T>
+    std::expected<void, std::string> retire(T* ptr) noexcept;
+
+    // Tries to advance the epoch and frees this thread's reclaimable objects
+    void collect() noexcept;
+
+    // Objects retired by this thread that are not yet freed
+    std::size_t retired_count() const noexcept;
+
+private:
+    template<DeallocatingAllocator>
+    friend class epoch_domain;
+
+    epoch_handle(internal::epoch_control* control, A* allocator, internal::epoch_slot* slot) noexcept;
+
+    std::expected<void, std::string> retire(internal::retired_entry entry) noexcept;
+
+    internal::epoch_control* control_;
+    A* allocator_;
+    internal::epoch_slot* slot_;
+};
+
+// Epoch based reclamation for lock-free structures whose nodes come from A,
+// e.g. a pool_allocator. Readers pin an epoch, writers retire unlinked nodes,
+// and nodes return to A in batches once every pinned thread has moved two
+// epochs past their retirement. Each thread holds at most three batches of
+// retired nodes. A is not thread-safe, so allocations must go through the
+// domain, which takes one lock per allocation and per reclaimed batch.
+// Handles refer to the domain, it must not be moved while any are alive.
+template<DeallocatingAllocator A>
+class epoch_domain {
+public:
+    epoch_domain() = delete;
+
+    epoch_domain(const epoch_domain&) = delete;
+
+    epoch_domain(epoch_domain&& other) noexcept;
+
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    epoch_domain& operator=(epoch_domain&& other) noexcept;
+
+    // Frees every retired object, no thread may be pinned
+    ~epoch_domain() noexcept;
+
+    static
+    std::expected<epoch_domain, std::string> create(
+        A& allocator, std::size_t max_threads, std::size_t batch_size) noexcept;
+
+    // Claims a participant slot for the calling thread
+    std::expected<epoch_handle<A>, std::string> attach() noexcept;
+
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    // Immediate free, only for objects never published to other threads
+    void free(void* ptr) noexcept;
+
+    std::uint64_t epoch() const noexcept;
+
+    std::size_t max_threads() const noexcept;
+
+    std::size_t batch_size() const noexcept;
+
+private:
+    epoch_domain(internal::epoch_control* control, A* allocator) noexcept;
+
+    void destroy() noexcept;
+
+    internal::epoch_control* control_;
+    A* allocator_;
+};
+
+} // namespace amber
+
+#include <amber/epoch_domain.inl>
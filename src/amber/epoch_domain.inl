@@ -0,0 +1,291 @@
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+namespace internal {
+
+template<DeallocatingAllocator A>
+void epoch_reclaim(epoch_control* control, A* allocator, epoch_bag& bag) noexcept
+{
+    if (bag.count == 0) {
+        return;
+    }
+    for (std::size_t i = 0; i < bag.count; ++i) {
+        if (bag.entries[i].destroy != nullptr) {
+            bag.entries[i].destroy(bag.entries[i].ptr);
+        }
+    }
+    // One lock for the whole batch
+    std::lock_guard<std::mutex> lock(control->allocator_mutex);
+    for (std::size_t i = 0; i < bag.count; ++i) {
+        allocator->free(bag.entries[i].ptr);
+    }
+    bag.count = 0;
+}
+
+} // namespace amber::internal
+
+template<DeallocatingAllocator A>
+epoch_handle<A>::epoch_handle(epoch_handle&& other) noexcept
+    : control_(std::exchange(other.control_, nullptr)),
+    allocator_(std::exchange(other.allocator_, nullptr)),
+    slot_(std::exchange(other.slot_, nullptr))
+{}
+
+template<DeallocatingAllocator A>
+epoch_handle<A>& epoch_handle<A>::operator=(epoch_handle&& other) noexcept
+{
+    if (this != &other) {
+        if (slot_ != nullptr) {
+            collect();
+            slot_->in_use.store(false, std::memory_order_release);
+        }
+        control_ = std::exchange(other.control_, nullptr);
+        allocator_ = std::exchange(other.allocator_, nullptr);
+        slot_ = std::exchange(other.slot_, nullptr);
+    }
+    return *this;
+}
+
+template<DeallocatingAllocator A>
+epoch_handle<A>::~epoch_handle() noexcept
+{
+    if (slot_ != nullptr) {
+        collect();
+        slot_->in_use.store(false, std::memory_order_release);
+    }
+    control_ = nullptr;
+    allocator_ = nullptr;
+    slot_ = nullptr;
+}
+
+template<DeallocatingAllocator A>
+epoch_guard epoch_handle<A>::pin() noexcept
+{
+    internal::epoch_pin(control_, slot_);
+    return epoch_guard(slot_);
+}
+
+template<DeallocatingAllocator A>
+std::expected<void, std::string> epoch_handle<A>::retire(void* ptr) noexcept
+{
+    return retire(internal::retired_entry{ptr, nullptr});
+}
+
+template<DeallocatingAllocator A>
+template<typename T>
+requires std::is_nothrow_destructible_v<T>
+std::expected<void, std::string> epoch_handle<A>::retire(T* ptr) noexcept
+{
+    if constexpr (std::is_trivially_destructible_v<T>) {
+        return retire(internal::retired_entry{static_cast<void*>(ptr), nullptr});
+    } else {
+        return retire(internal::retired_entry{
+            static_cast<void*>(ptr),
+            [](void* p) noexcept { std::destroy_at(static_cast<T*>(p)); }
+        });
+    }
+}
+
+template<DeallocatingAllocator A>
+void epoch_handle<A>::collect() noexcept
+{
+    internal::epoch_try_advance(control_);
+    std::uint64_t epoch = control_->global_epoch.load(std::memory_order_acquire);
+    for (internal::epoch_bag& bag : slot_->bags) {
+        if (bag.count > 0 && bag.epoch + 2 <= epoch) {
+            internal::epoch_reclaim(control_, allocator_, bag);
+        }
+    }
+}
+
+template<DeallocatingAllocator A>
+std::size_t epoch_handle<A>::retired_count() const noexcept
+{
+    std::size_t count = 0;
+    for (const internal::epoch_bag& bag : slot_->bags) {
+        count += bag.count;
+    }
+    return count;
+}
+
+template<DeallocatingAllocator A>
+epoch_handle<A>::epoch_handle(
+    internal::epoch_control* control, A* allocator, internal::epoch_slot* slot) noexcept
+    : control_(control),
+    allocator_(allocator),
+    slot_(slot)
+{}
+
+template<DeallocatingAllocator A>
+std::expected<void, std::string> epoch_handle<A>::retire(internal::retired_entry entry) noexcept
+{
+    if (entry.ptr == nullptr) {
+        return {};
+    }
+    for (std::size_t attempt = 0; attempt < 2; ++attempt) {
+        std::uint64_t epoch = control_->global_epoch.load(std::memory_order_acquire);
+        internal::epoch_bag& bag = slot_->bags[epoch % 3];
+        if (bag.epoch != epoch) {
+            // The bag last held epoch - 3 or older, two epochs have passed since
+            internal::epoch_reclaim(control_, allocator_, bag);
+            bag.epoch = epoch;
+        }
+        if (bag.count < control_->batch_size) [[likely]] {
+            bag.entries[bag.count] = entry;
+            bag.count += 1;
+            return {};
+        }
+        if (!internal::epoch_try_advance(control_)) {
+            break;
+        }
+    }
+    return std::unexpected("retire list full");
+}
+
+template<DeallocatingAllocator A>
+epoch_domain<A>::epoch_domain(epoch_domain&& other) noexcept
+    : control_(std::exchange(other.control_, nullptr)),
+    allocator_(std::exchange(other.allocator_, nullptr))
+{}
+
+template<DeallocatingAllocator A>
+epoch_domain<A>& epoch_domain<A>::operator=(epoch_domain&& other) noexcept
+{
+    if (this != &other) {
+        destroy();
+        control_ = std::exchange(other.control_, nullptr);
+        allocator_ = std::exchange(other.allocator_, nullptr);
+    }
+    return *this;
+}
+
+template<DeallocatingAllocator A>
+epoch_domain<A>::~epoch_domain() noexcept
+{
+    destroy();
+    allocator_ = nullptr;
+}
+
+template<DeallocatingAllocator A>
+std::expected<epoch_domain<A>, std::string> epoch_domain<A>::create(
+    A& allocator, std::size_t max_threads, std::size_t batch_size) noexcept
+{
+    if (max_threads == 0 || batch_size == 0) [[unlikely]] {
+        return std::unexpected("max threads and batch size must be positive");
+    }
+    // Each thread has a slot and three batches of retired entries
+    constexpr std::size_t size_max = std::numeric_limits<std::size_t>::max();
+    if (batch_size > (size_max - sizeof(internal::epoch_slot)) / (3 * sizeof(internal::retired_entry))) [[unlikely]] {
+        return std::unexpected("invalid size");
+    }
+    std::size_t entry_count = 3 * batch_size;
+    std::size_t thread_size = sizeof(internal::epoch_slot) + (entry_count * sizeof(internal::retired_entry));
+    if (max_threads > (size_max - sizeof(internal::epoch_control)) / thread_size) [[unlikely]] {
+        return std::unexpected("invalid size");
+    }
+    std::size_t control_size = sizeof(internal::epoch_control) + (max_threads * thread_size);
+    auto exp_ptr = aligned_alloc(alignof(internal::epoch_control), control_size);
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    internal::epoch_control* control = static_cast<internal::epoch_control*>(exp_ptr.value());
+    control = std::launder(std::construct_at(control, max_threads, batch_size));
+    internal::epoch_slot* slots = reinterpret_cast<internal::epoch_slot*>(
+        reinterpret_cast<std::byte*>(control) + sizeof(internal::epoch_control));
+    internal::retired_entry* entries = reinterpret_cast<internal::retired_entry*>(slots + max_threads);
+    for (std::size_t i = 0; i < max_threads; ++i) {
+        std::construct_at(slots + i, entries + (i * entry_count), batch_size);
+    }
+    return epoch_domain(control, &allocator);
+}
+
+template<DeallocatingAllocator A>
+std::expected<epoch_handle<A>, std::string> epoch_domain<A>::attach() noexcept
+{
+    internal::epoch_slot* slots = internal::epoch_slots(control_);
+    for (std::size_t i = 0; i < control_->slot_count; ++i) {
+        bool expected = false;
+        if (slots[i].in_use.compare_exchange_strong(
+            expected, true, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return epoch_handle<A>(control_, allocator_, slots + i);
+        }
+    }
+    return std::unexpected("no free epoch slot");
+}
+
+template<DeallocatingAllocator A>
+std::expected<void*, std::string> epoch_domain<A>::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    std::lock_guard<std::mutex> lock(control_->allocator_mutex);
+    return allocator_->allocate(alignment, size);
+}
+
+template<DeallocatingAllocator A>
+template<typename T, typename... Args>
+requires std::is_nothrow_constructible_v<T, Args...>
+std::expected<T*, std::string> epoch_domain<A>::allocate(Args&&... args) noexcept
+{
+    auto exp_ptr = allocate(alignof(T), sizeof(T));
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    T* ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(std::move(exp_ptr).value()));
+    return std::launder(std::construct_at(ptr, std::forward<Args>(args)...));
+}
+
+template<DeallocatingAllocator A>
+void epoch_domain<A>::free(void* ptr) noexcept
+{
+    std::lock_guard<std::mutex> lock(control_->allocator_mutex);
+    allocator_->free(ptr);
+}
+
+template<DeallocatingAllocator A>
+std::uint64_t epoch_domain<A>::epoch() const noexcept
+{
+    return control_ == nullptr ? 0 : control_->global_epoch.load(std::memory_order_acquire);
+}
+
+template<DeallocatingAllocator A>
+std::size_t epoch_domain<A>::max_threads() const noexcept
+{
+    return control_ == nullptr ? 0 : control_->slot_count;
+}
+
+template<DeallocatingAllocator A>
+std::size_t epoch_domain<A>::batch_size() const noexcept
+{
+    return control_ == nullptr ? 0 : control_->batch_size;
+}
+
+template<DeallocatingAllocator A>
+epoch_domain<A>::epoch_domain(internal::epoch_control* control, A* allocator) noexcept
+    : control_(control),
+    allocator_(allocator)
+{}
+
+template<DeallocatingAllocator A>
+void epoch_domain<A>::destroy() noexcept
+{
+    if (control_ == nullptr) {
+        return;
+    }
+    internal::epoch_slot* slots = internal::epoch_slots(control_);
+    for (std::size_t i = 0; i < control_->slot_count; ++i) {
+        for (internal::epoch_bag& bag : slots[i].bags) {
+            internal::epoch_reclaim(control_, allocator_, bag);
+        }
+        std::destroy_at(slots + i);
+    }
+    std::destroy_at(control_);
+    aligned_free(control_);
+    control_ = nullptr;
+}
+
+} // namespace amber
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+// Serves allocations from Primary and falls back to Fallback once Primary
+// fails. free routes a pointer by Primary's owns, an allocator without free,
+// e.g. linear_allocator, releases its memory all at once instead.
+template<OwningAllocator Primary, Allocator Fallback>
+class fallback_allocator {
+public:
+    fallback_allocator() = delete;
+
+    fallback_allocator(const fallback_allocator&) = delete;
+
+    fallback_allocator(fallback_allocator&& other) noexcept = default;
+
+    fallback_allocator& operator=(const fallback_allocator&) = delete;
+
+    fallback_allocator& operator=(fallback_allocator&& other) noexcept = default;
+
+    ~fallback_allocator() noexcept = default;
+
+    static
+    std::expected<fallback_allocator, std::string> create(
+        Primary&& primary, Fallback&& fallback) noexcept;
+
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    void free(void* ptr) noexcept;
+
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T>
+    void free(T* ptr) noexcept;
+
+    bool owns(const void* ptr) const noexcept
+    requires OwningAllocator<Fallback>;
+
+    Primary& primary() noexcept;
+
+    const Primary& primary() const noexcept;
+
+    Fallback& fallback() noexcept;
+
+    const Fallback& fallback() const noexcept;
+
+private:
+    fallback_allocator(Primary&& primary, Fallback&& fallback) noexcept;
+
+    Primary primary_;
+    Fallback fallback_;
+};
+
+} // namespace amber
+
+#include <amber/fallback_allocator.inl>
@@ -0,0 +1,106 @@
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+template<OwningAllocator Primary, Allocator Fallback>
+std::expected<fallback_allocator<Primary, Fallback>, std::string>
+fallback_allocator<Primary, Fallback>::create(Primary&& primary, Fallback&& fallback) noexcept
+{
+    static_assert(std::is_nothrow_move_constructible_v<Primary>);
+    static_assert(std::is_nothrow_move_constructible_v<Fallback>);
+    return fallback_allocator(std::move(primary), std::move(fallback));
+}
+
+template<OwningAllocator Primary, Allocator Fallback>
+std::expected<void*, std::string> fallback_allocator<Primary, Fallback>::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    auto exp_ptr = primary_.allocate(alignment, size);
+    if (exp_ptr.has_value()) [[likely]] {
+        return exp_ptr;
+    }
+    return fallback_.allocate(alignment, size);
+}
+
+template<OwningAllocator Primary, Allocator Fallback>
+template<typename T, typename... Args>
+requires std::is_nothrow_constructible_v<T, Args...>
+std::expected<T*, std::string> fallback_allocator<Primary, Fallback>::allocate(Args&&... args) noexcept
+{
+    auto exp_ptr = allocate(alignof(T), sizeof(T));
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    T* ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(std::move(exp_ptr).value()));
+    return std::launder(std::construct_at(ptr, std::forward<Args>(args)...));
+}
+
+template<OwningAllocator Primary, Allocator Fallback>
+void fallback_allocator<Primary, Fallback>::free(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    if (primary_.owns(ptr)) {
+        if constexpr (DeallocatingAllocator<Primary>) {
+            primary_.free(ptr);
+        }
+    } else {
+        if constexpr (DeallocatingAllocator<Fallback>) {
+            fallback_.free(ptr);
+        }
+    }
+}
+
+template<OwningAllocator Primary, Allocator Fallback>
+template<typename T>
+requires std::is_nothrow_destructible_v<T>
+void fallback_allocator<Primary, Fallback>::free(T* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::destroy_at(ptr);
+    free(static_cast<void*>(ptr));
+}
+
+template<OwningAllocator Primary, Allocator Fallback>
+bool fallback_allocator<Primary, Fallback>::owns(const void* ptr) const noexcept
+requires OwningAllocator<Fallback>
+{
+    return primary_.owns(ptr) || fallback_.owns(ptr);
+}
+
+template<OwningAllocator Primary, Allocator Fallback>
+Primary& fallback_allocator<Primary, Fallback>::primary() noexcept
+{
+    return primary_;
+}
+
+template<OwningAllocator Primary, Allocator Fallback>
+const Primary& fallback_allocator<Primary, Fallback>::primary() const noexcept
+{
+    return primary_;
+}
+
+template<OwningAllocator Primary, Allocator Fallback>
+Fallback& fallback_allocator<Primary, Fallback>::fallback() noexcept
+{
+    return fallback_;
+}
+
+template<OwningAllocator Primary, Allocator Fallback>
+const Fallback& fallback_allocator<Primary, Fallback>::fallback() const noexcept
+{
+    return fallback_;
+}
+
+template<OwningAllocator Primary, Allocator Fallback>
+fallback_allocator<Primary, Fallback>::fallback_allocator(Primary&& primary, Fallback&& fallback) noexcept
+    : primary_(std::move(primary)),
+    fallback_(std::move(fallback))
+{}
+
+} // namespace amber
@@ -0,0 +1,227 @@
+extern "C" {
+#include <sys/mman.h>
+}
+#include <amber/fiber_stack_pool.hpp>
+#include <amber/util.hpp>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <mica/mica.hpp>
+#include <utility>
+
+namespace amber {
+
+namespace {
+
+std::expected<void, std::string> protect_guard(std::byte* guard, std::size_t guard_size) noexcept
+{
+    if (mprotect(guard, guard_size, PROT_NONE) == -1) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "mprotect failed, error: {}, address: {:#x}, length: {}",
+            std::strerror(errno), reinterpret_cast<std::uintptr_t>(guard), guard_size
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling mprotect error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    return {};
+}
+
+} // unnamed namespace
+
+fiber_stack_pool::fiber_stack_pool(fiber_stack_pool&& other) noexcept
+    : region_(std::move(other.region_)),
+    metadata_(std::move(other.metadata_)),
+    free_stacks_(std::exchange(other.free_stacks_, nullptr)),
+    dirty_(std::exchange(other.dirty_, nullptr)),
+    stack_size_(std::exchange(other.stack_size_, 0)),
+    guard_size_(std::exchange(other.guard_size_, 0)),
+    stack_count_(std::exchange(other.stack_count_, 0)),
+    free_count_(std::exchange(other.free_count_, 0)),
+    dirty_count_(std::exchange(other.dirty_count_, 0))
+{}
+
+fiber_stack_pool& fiber_stack_pool::operator=(fiber_stack_pool&& other) noexcept
+{
+    if (this != &other) {
+        region_ = std::move(other.region_);
+        metadata_ = std::move(other.metadata_);
+        free_stacks_ = std::exchange(other.free_stacks_, nullptr);
+        dirty_ = std::exchange(other.dirty_, nullptr);
+        stack_size_ = std::exchange(other.stack_size_, 0);
+        guard_size_ = std::exchange(other.guard_size_, 0);
+        stack_count_ = std::exchange(other.stack_count_, 0);
+        free_count_ = std::exchange(other.free_count_, 0);
+        dirty_count_ = std::exchange(other.dirty_count_, 0);
+    }
+    return *this;
+}
+
+fiber_stack_pool::~fiber_stack_pool() noexcept
+{
+    free_stacks_ = nullptr;
+    dirty_ = nullptr;
+    stack_size_ = 0;
+    guard_size_ = 0;
+    stack_count_ = 0;
+    free_count_ = 0;
+    dirty_count_ = 0;
+}
+
+std::expected<fiber_stack_pool, std::string> fiber_stack_pool::create(
+    std::size_t stack_size, std::size_t stack_count, std::size_t guard_size) noexcept
+{
+    std::size_t page = page_size();
+    if (stack_size == 0 || stack_size > std::numeric_limits<std::size_t>::max() / 2) [[unlikely]] {
+        return std::unexpected("invalid stack size");
+    }
+    if (guard_size == 0 || guard_size > std::numeric_limits<std::size_t>::max() / 2) [[unlikely]] {
+        return std::unexpected("invalid guard size");
+    }
+    stack_size = align_forward(page, stack_size);
+    guard_size = align_forward(page, guard_size);
+    std::size_t stride = stack_size + guard_size;
+    if (stack_count == 0 || stack_count > std::numeric_limits<std::uint32_t>::max()
+        || stack_count > (std::numeric_limits<std::size_t>::max() - guard_size) / stride) [[unlikely]]
+    {
+        return std::unexpected("invalid stack count");
+    }
+
+    auto exp_region = mmap_buffer::create_lazy(stack_count * stride + guard_size, mmap_flag::no_reserve);
+    if (!exp_region.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_region).error());
+    }
+    mmap_buffer region = std::move(exp_region).value();
+    for (std::size_t i = 0; i <= stack_count; ++i) {
+        auto exp_protect = protect_guard(region.buffer().data() + (i * stride), guard_size);
+        if (!exp_protect.has_value()) [[unlikely]] {
+            return std::unexpected(std::move(exp_protect).error());
+        }
+    }
+
+    std::size_t metadata_size = stack_count * (sizeof(std::uint32_t) + sizeof(std::uint8_t));
+    auto exp_metadata = mmap_buffer::create_lazy(align_forward(page, metadata_size));
+    if (!exp_metadata.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_metadata).error());
+    }
+    mmap_buffer metadata = std::move(exp_metadata).value();
+    return fiber_stack_pool(std::move(region), std::move(metadata), stack_size, guard_size, stack_count);
+}
+
+std::expected<fiber_stack_pool, std::string> fiber_stack_pool::create(
+    std::size_t stack_size, std::size_t stack_count) noexcept
+{
+    return create(stack_size, stack_count, page_size());
+}
+
+std::expected<std::span<std::byte>, std::string> fiber_stack_pool::acquire() noexcept
+{
+    if (free_count_ == 0) [[unlikely]] {
+        return std::unexpected("out of stacks");
+    }
+    free_count_ -= 1;
+    std::uint32_t index = free_stacks_[free_count_];
+    if (dirty_[index] != 0) {
+        dirty_[index] = 0;
+        dirty_count_ -= 1;
+    }
+    return std::span<std::byte>(stack_base(index), stack_size_);
+}
+
+void fiber_stack_pool::release(std::span<std::byte> stack) noexcept
+{
+    std::size_t offset = static_cast<std::size_t>(stack.data() - region_.buffer().data()) - guard_size_;
+    std::uint32_t index = static_cast<std::uint32_t>(offset / (stack_size_ + guard_size_));
+    dirty_[index] = 1;
+    dirty_count_ += 1;
+    free_stacks_[free_count_] = index;
+    free_count_ += 1;
+}
+
+bool fiber_stack_pool::owns(const void* ptr) const noexcept
+{
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    std::uintptr_t begin_addr = reinterpret_cast<std::uintptr_t>(region_.buffer().data());
+    return addr >= begin_addr && addr - begin_addr < region_.size();
+}
+
+std::size_t fiber_stack_pool::stack_size() const noexcept
+{
+    return stack_size_;
+}
+
+std::size_t fiber_stack_pool::guard_size() const noexcept
+{
+    return guard_size_;
+}
+
+std::size_t fiber_stack_pool::stack_count() const noexcept
+{
+    return stack_count_;
+}
+
+std::size_t fiber_stack_pool::free_count() const noexcept
+{
+    return free_count_;
+}
+
+std::size_t fiber_stack_pool::dirty_size() const noexcept
+{
+    return dirty_count_ * stack_size_;
+}
+
+std::expected<std::size_t, std::string> fiber_stack_pool::purge(purge_mode mode, std::size_t keep_size) noexcept
+{
+    std::size_t keep_count = keep_size / stack_size_;
+    std::size_t released = 0;
+    for (std::size_t i = 0; i < free_count_ && dirty_count_ > keep_count; ++i) {
+        std::uint32_t index = free_stacks_[i];
+        if (dirty_[index] == 0) {
+            continue;
+        }
+        auto exp_released = purge_pages(std::span<std::byte>(stack_base(index), stack_size_), mode);
+        if (!exp_released.has_value()) [[unlikely]] {
+            return std::unexpected(std::move(exp_released).error());
+        }
+        released += exp_released.value();
+        dirty_[index] = 0;
+        dirty_count_ -= 1;
+    }
+    return released;
+}
+
+std::expected<std::size_t, std::string> fiber_stack_pool::purge(purge_mode mode) noexcept
+{
+    return purge(mode, 0);
+}
+
+fiber_stack_pool::fiber_stack_pool(
+    mmap_buffer&& region,
+    mmap_buffer&& metadata,
+    std::size_t stack_size,
+    std::size_t guard_size,
+    std::size_t stack_count
+) noexcept
+    : region_(std::move(region)),
+    metadata_(std::move(metadata)),
+    free_stacks_(reinterpret_cast<std::uint32_t*>(metadata_.buffer().data())),
+    dirty_(reinterpret_cast<std::uint8_t*>(free_stacks_ + stack_count)),
+    stack_size_(stack_size),
+    guard_size_(guard_size),
+    stack_count_(stack_count),
+    free_count_(stack_count),
+    dirty_count_(0)
+{
+    // Stack 0 on top, stacks are handed out in address order at first
+    for (std::size_t i = 0; i < stack_count; ++i) {
+        free_stacks_[i] = static_cast<std::uint32_t>(stack_count - 1 - i);
+    }
+}
+
+std::byte* fiber_stack_pool::stack_base(std::size_t index) const noexcept
+{
+    return region_.buffer().data() + guard_size_ + (index * (stack_size_ + guard_size_));
+}
+
+} // namespace amber
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <amber/mmap_buffer.hpp>
+#include <amber/purge.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+
+namespace amber {
+
+// Fixed set of fiber stacks carved from one reserved mmap_buffer region, each
+// with a PROT_NONE guard below it and one more guard above the last stack, so
+// overflowing a stack faults instead of writing into its neighbour. acquire
+// and release are O(1) and make no system calls, released stacks keep their
+// pages until purge returns them. Not thread safe.
+//
+// Every guard splits the mapping, so a pool uses about two memory map entries
+// per stack of the process' limit (vm.max_map_count, 65530 by default).
+class fiber_stack_pool {
+public:
+    fiber_stack_pool() = delete;
+
+    fiber_stack_pool(const fiber_stack_pool&) = delete;
+
+    fiber_stack_pool(fiber_stack_pool&& other) noexcept;
+
+    fiber_stack_pool& operator=(const fiber_stack_pool&) = delete;
+
+    fiber_stack_pool& operator=(fiber_stack_pool&& other) noexcept;
+
+    ~fiber_stack_pool() noexcept;
+
+    // Sizes are rounded up to whole pages, the guards default to one page.
+    // The region is mapped without reserving swap, stacks only take memory
+    // for the pages their fibers touch.
+    static
+    std::expected<fiber_stack_pool, std::string> create(
+        std::size_t stack_size, std::size_t stack_count, std::size_t guard_size) noexcept;
+
+    static
+    std::expected<fiber_stack_pool, std::string> create(std::size_t stack_size, std::size_t stack_count) noexcept;
+
+    // Usable memory of a free stack, the fiber's stack pointer starts at its
+    // end. The most recently released stack is handed out first.
+    std::expected<std::span<std::byte>, std::string> acquire() noexcept;
+
+    // Takes back a stack returned by acquire
+    void release(std::span<std::byte> stack) noexcept;
+
+    // Whether ptr points into a stack or guard of the pool
+    bool owns(const void* ptr) const noexcept;
+
+    std::size_t stack_size() const noexcept;
+
+    std::size_t guard_size() const noexcept;
+
+    std::size_t stack_count() const noexcept;
+
+    std::size_t free_count() const noexcept;
+
+    // Bytes of released stacks that may still hold resident pages
+    std::size_t dirty_size() const noexcept;
+
+    // Returns the pages of released stacks to the OS, least recently released
+    // first, keeping up to keep_size bytes of stacks dirty for reuse. Stacks
+    // are advised whole, only the pages their fibers touched were resident.
+    // Returns the number of bytes released.
+    std::expected<std::size_t, std::string> purge(purge_mode mode, std::size_t keep_size) noexcept;
+
+    std::expected<std::size_t, std::string> purge(purge_mode mode) noexcept;
+
+private:
+    fiber_stack_pool(
+        mmap_buffer&& region,
+        mmap_buffer&& metadata,
+        std::size_t stack_size,
+        std::size_t guard_size,
+        std::size_t stack_count
+    ) noexcept;
+
+    std::byte* stack_base(std::size_t index) const noexcept;
+
+    mmap_buffer region_;
+    // Free stack indices followed by one dirty flag per stack
+    mmap_buffer metadata_;
+    std::uint32_t* free_stacks_;
+    std::uint8_t* dirty_;
+    std::size_t stack_size_;
+    std::size_t guard_size_;
+    std::size_t stack_count_;
+    // free_stacks_[0, free_count_) are free, the last one was released last
+    std::size_t free_count_;
+    std::size_t dirty_count_;
+};
+
+} // namespace amber
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/span_buffer.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace amber {
+
+// Splits a buffer into FrameCount linear_allocator regions used round robin.
+// Memory allocated during frame f stays valid until advance_frame() moves past
+// frame f + FrameCount - 1, at which point only that frame's region is reset.
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+class frame_allocator {
+public:
+    frame_allocator() = delete;
+
+    frame_allocator(const frame_allocator&) = delete;
+
+    frame_allocator(frame_allocator&& other) noexcept;
+
+    frame_allocator& operator=(const frame_allocator&) = delete;
+
+    frame_allocator& operator=(frame_allocator&& other) noexcept;
+
+    ~frame_allocator() noexcept = default;
+
+    template<Buffer B>
+    static
+    std::expected<frame_allocator, std::string> create(B& buffer) noexcept;
+
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    std::expected<void*, std::string> allocate(std::size_t size) noexcept;
+
+    // Accepts exactly the types linear_allocator::allocate<T> does
+    template<typename T, typename... Args>
+    requires requires(linear_allocator& region, Args&&... args) {
+        region.template allocate<T>(std::forward<Args>(args)...);
+    }
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    bool try_extend(void* ptr, std::size_t old_size, std::size_t new_size) noexcept;
+
+    bool shrink(void* ptr, std::size_t old_size, std::size_t new_size) noexcept;
+
+    std::expected<void*, std::string> reallocate(
+        void* ptr, std::size_t old_size, std::size_t alignment, std::size_t new_size) noexcept;
+
+    // Starts a new frame, releasing everything allocated FrameCount frames ago
+    void advance_frame() noexcept;
+
+    // Number of the frame new allocations are tagged with
+    std::uint64_t frame() const noexcept;
+
+    // Whether memory allocated during frame has not been released yet
+    bool is_live(std::uint64_t frame) const noexcept;
+
+    // Most recent frame whose allocations occupy the region containing ptr
+    std::expected<std::uint64_t, std::string> frame_of(const void* ptr) const noexcept;
+
+    // Debug builds abort when ptr, allocated during frame, has been released
+    void check_live(const void* ptr, std::uint64_t frame) const noexcept;
+
+    std::size_t buffer_size() const noexcept;
+
+    std::size_t frame_size() const noexcept;
+
+    std::size_t buffer_offset() const noexcept;
+
+    static constexpr std::size_t frame_count() noexcept;
+
+private:
+    frame_allocator(
+        std::span<std::byte> buffer,
+        std::size_t frame_size,
+        std::array<linear_allocator, FrameCount>&& allocators
+    ) noexcept;
+
+    template<std::size_t... I>
+    static
+    std::array<linear_allocator, FrameCount> create_allocators(
+        std::span<std::byte> buffer, std::size_t frame_size, std::index_sequence<I...>) noexcept;
+
+    static
+    linear_allocator create_allocator(std::span<std::byte> region) noexcept;
+
+    linear_allocator& current() noexcept;
+
+    std::span<std::byte> buffer_;
+    std::size_t frame_size_;
+    std::uint64_t frame_;
+    std::array<linear_allocator, FrameCount> allocators_;
+};
+
+} // namespace amber
+
+#include <amber/frame_allocator.inl>
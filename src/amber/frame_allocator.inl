@@ -0,0 +1,231 @@
+#include <amber/util.hpp>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <mica/mica.hpp>
+#include <utility>
+
+namespace amber {
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+frame_allocator<FrameCount>::frame_allocator(frame_allocator&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, std::span<std::byte>())),
+    frame_size_(std::exchange(other.frame_size_, 0)),
+    frame_(std::exchange(other.frame_, 0)),
+    allocators_(std::move(other.allocators_))
+{}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+frame_allocator<FrameCount>& frame_allocator<FrameCount>::operator=(frame_allocator&& other) noexcept
+{
+    if (this != &other) {
+        buffer_ = std::exchange(other.buffer_, std::span<std::byte>());
+        frame_size_ = std::exchange(other.frame_size_, 0);
+        frame_ = std::exchange(other.frame_, 0);
+        allocators_ = std::move(other.allocators_);
+    }
+    return *this;
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+template<Buffer B>
+std::expected<frame_allocator<FrameCount>, std::string> frame_allocator<FrameCount>::create(
+    B& buffer) noexcept
+{
+    std::span<std::byte> buffer_span = buffer.buffer();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_span.data());
+    std::uintptr_t target_alignment = static_cast<std::uintptr_t>(alignof(std::max_align_t));
+    if (!is_aligned(target_alignment, buffer_addr)) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "invalid buffer alignment, buffer: {:#x}, target alignment: {}",
+            buffer_addr, alignof(std::max_align_t)
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    // Round down so that every region starts aligned like the buffer
+    std::size_t frame_size = (buffer_span.size() / FrameCount) & ~(alignof(std::max_align_t) - 1);
+    return frame_allocator(
+        buffer_span,
+        frame_size,
+        create_allocators(buffer_span, frame_size, std::make_index_sequence<FrameCount>())
+    );
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+std::expected<void*, std::string> frame_allocator<FrameCount>::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    return current().allocate(alignment, size);
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+std::expected<void*, std::string> frame_allocator<FrameCount>::allocate(std::size_t size) noexcept
+{
+    return current().allocate(size);
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+template<typename T, typename... Args>
+requires requires(linear_allocator& region, Args&&... args) {
+    region.template allocate<T>(std::forward<Args>(args)...);
+}
+std::expected<T*, std::string> frame_allocator<FrameCount>::allocate(Args&&... args) noexcept
+{
+    return current().template allocate<T>(std::forward<Args>(args)...);
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+bool frame_allocator<FrameCount>::try_extend(
+    void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+{
+    return current().try_extend(ptr, old_size, new_size);
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+bool frame_allocator<FrameCount>::shrink(
+    void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+{
+    return current().shrink(ptr, old_size, new_size);
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+std::expected<void*, std::string> frame_allocator<FrameCount>::reallocate(
+    void* ptr, std::size_t old_size, std::size_t alignment, std::size_t new_size) noexcept
+{
+    return current().reallocate(ptr, old_size, alignment, new_size);
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+void frame_allocator<FrameCount>::advance_frame() noexcept
+{
+    frame_ += 1;
+    current().reset();
+#ifndef NDEBUG
+    // Poison the retired frame so stale reads stand out
+    std::size_t index = static_cast<std::size_t>(frame_ % FrameCount);
+    std::memset(buffer_.data() + (index * frame_size_), 0xdd, frame_size_);
+#endif
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+std::uint64_t frame_allocator<FrameCount>::frame() const noexcept
+{
+    return frame_;
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+bool frame_allocator<FrameCount>::is_live(std::uint64_t frame) const noexcept
+{
+    return frame <= frame_ && frame_ - frame < FrameCount;
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+std::expected<std::uint64_t, std::string> frame_allocator<FrameCount>::frame_of(
+    const void* ptr) const noexcept
+{
+    const std::byte* byte_ptr = static_cast<const std::byte*>(ptr);
+    if (byte_ptr < buffer_.data() || byte_ptr >= buffer_.data() + (frame_size_ * FrameCount)) [[unlikely]] {
+        return std::unexpected("pointer not owned by allocator");
+    }
+    std::uint64_t index = static_cast<std::uint64_t>(byte_ptr - buffer_.data()) / frame_size_;
+    if (index > frame_) [[unlikely]] {
+        return std::unexpected("pointer not owned by allocator");
+    }
+    return frame_ - ((frame_ - index) % FrameCount);
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+void frame_allocator<FrameCount>::check_live([[maybe_unused]] const void* ptr,
+    [[maybe_unused]] std::uint64_t frame) const noexcept
+{
+#ifndef NDEBUG
+    auto exp_frame = frame_of(ptr);
+    assert(exp_frame.has_value() && "pointer not owned by frame_allocator");
+    assert(exp_frame.value() == frame && is_live(frame) && "use of memory from a retired frame");
+#endif
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+std::size_t frame_allocator<FrameCount>::buffer_size() const noexcept
+{
+    return buffer_.size();
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+std::size_t frame_allocator<FrameCount>::frame_size() const noexcept
+{
+    return frame_size_;
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+std::size_t frame_allocator<FrameCount>::buffer_offset() const noexcept
+{
+    return allocators_[frame_ % FrameCount].buffer_offset();
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+constexpr std::size_t frame_allocator<FrameCount>::frame_count() noexcept
+{
+    return FrameCount;
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+frame_allocator<FrameCount>::frame_allocator(
+    std::span<std::byte> buffer,
+    std::size_t frame_size,
+    std::array<linear_allocator, FrameCount>&& allocators
+) noexcept
+    : buffer_(buffer),
+    frame_size_(frame_size),
+    frame_(0),
+    allocators_(std::move(allocators))
+{}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+template<std::size_t... I>
+std::array<linear_allocator, FrameCount> frame_allocator<FrameCount>::create_allocators(
+    std::span<std::byte> buffer, std::size_t frame_size, std::index_sequence<I...>) noexcept
+{
+    return {create_allocator(buffer.subspan(I * frame_size, frame_size))...};
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+linear_allocator frame_allocator<FrameCount>::create_allocator(std::span<std::byte> region) noexcept
+{
+    // Region alignment was validated by create, so this cannot fail
+    span_buffer region_buffer(region);
+    return std::move(linear_allocator::create(region_buffer)).value();
+}
+
+template<std::size_t FrameCount>
+requires (FrameCount > 0)
+linear_allocator& frame_allocator<FrameCount>::current() noexcept
+{
+    return allocators_[frame_ % FrameCount];
+}
+
+} // namespace amber
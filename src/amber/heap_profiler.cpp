@@ -0,0 +1,549 @@
+extern "C" {
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <unistd.h>
+}
+#include <amber/heap_profiler.hpp>
+#include <amber/util.hpp>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <memory>
+#include <mica/mica.hpp>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+namespace internal {
+
+std::atomic<bool> heap_profile_active(false);
+
+} // namespace amber::internal
+
+namespace {
+
+// Guards the installed profiler and its tables, only taken on the sampled path
+std::mutex profile_mutex;
+internal::heap_profile_control* profile_current = nullptr;
+// Changes whenever a profiler is installed so threads redraw their sample distance
+std::atomic<std::uint64_t> profile_generation(0);
+std::atomic<std::size_t> profile_interval(0);
+
+// Number of live samples per pointer hash, written under profile_mutex. A
+// free checks its counter without the lock and only locks when it may be
+// sampled, which almost no free is.
+constexpr std::size_t sample_filter_size = 4096;
+std::atomic<std::uint32_t> sample_filter[sample_filter_size] = {};
+
+struct sampler_state {
+public:
+    std::uint64_t generation;
+    // Bytes left to allocate before the next sample
+    std::size_t remaining;
+    std::uint64_t random;
+};
+
+thread_local sampler_state sampler = {0, 0, 0};
+
+// Exponentially distributed with mean interval, so samples form a Poisson
+// process over allocated bytes
+std::size_t next_sample_distance(sampler_state& state, std::size_t interval) noexcept
+{
+    // xorshift64*
+    state.random ^= state.random >> 12;
+    state.random ^= state.random << 25;
+    state.random ^= state.random >> 27;
+    std::uint64_t bits = state.random * 0x2545f4914f6cdd1dull;
+    // Uniform in (0, 1]
+    double uniform = (static_cast<double>(bits >> 11) + 1.0) * 0x1.0p-53;
+    return static_cast<std::size_t>(-std::log(uniform) * static_cast<double>(interval)) + 1;
+}
+
+std::uint64_t hash_frames(void* const* frames, std::size_t depth) noexcept
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (std::size_t i = 0; i < depth; ++i) {
+        hash ^= reinterpret_cast<std::uintptr_t>(frames[i]);
+        hash *= 0x100000001b3ull;
+    }
+    // Zero marks an unused stack slot
+    return hash | 1;
+}
+
+std::size_t hash_pointer(const void* ptr, std::size_t capacity) noexcept
+{
+    std::uint64_t hash = reinterpret_cast<std::uintptr_t>(ptr) * 0x9e3779b97f4a7c15ull;
+    return static_cast<std::size_t>(hash >> 32) % capacity;
+}
+
+std::atomic<std::uint32_t>& filter_count(const void* ptr) noexcept
+{
+    return sample_filter[hash_pointer(ptr, sample_filter_size)];
+}
+
+internal::heap_stack* profile_stacks(internal::heap_profile_control* control) noexcept
+{
+    return std::launder(reinterpret_cast<internal::heap_stack*>(control + 1));
+}
+
+internal::heap_sample* profile_samples(internal::heap_profile_control* control) noexcept
+{
+    return std::launder(reinterpret_cast<internal::heap_sample*>(
+        reinterpret_cast<internal::heap_stack*>(control + 1) + control->stack_capacity));
+}
+
+// Returns stack_capacity when the table is full
+std::size_t find_stack(
+    internal::heap_profile_control* control, void* const* frames, std::size_t depth) noexcept
+{
+    internal::heap_stack* stacks = profile_stacks(control);
+    std::uint64_t hash = hash_frames(frames, depth);
+    std::size_t index = static_cast<std::size_t>(hash % control->stack_capacity);
+    for (std::size_t probe = 0; probe < control->stack_capacity; ++probe) {
+        internal::heap_stack& stack = stacks[index];
+        if (stack.hash == 0) {
+            std::memcpy(stack.frames, frames, depth * sizeof(void*));
+            stack.depth = depth;
+            stack.hash = hash;
+            return index;
+        }
+        if (stack.hash == hash && stack.depth == depth
+            && std::memcmp(stack.frames, frames, depth * sizeof(void*)) == 0)
+        {
+            return index;
+        }
+        index = (index + 1) % control->stack_capacity;
+    }
+    return control->stack_capacity;
+}
+
+// Returns sample_capacity when ptr is not sampled
+std::size_t find_sample(internal::heap_profile_control* control, const void* ptr) noexcept
+{
+    internal::heap_sample* samples = profile_samples(control);
+    std::size_t index = hash_pointer(ptr, control->sample_capacity);
+    for (std::size_t probe = 0; probe < control->sample_capacity; ++probe) {
+        if (samples[index].ptr == ptr) {
+            return index;
+        }
+        if (samples[index].ptr == nullptr) {
+            break;
+        }
+        index = (index + 1) % control->sample_capacity;
+    }
+    return control->sample_capacity;
+}
+
+// Backward shift deletion, linear probing needs no tombstones
+void erase_sample(internal::heap_profile_control* control, std::size_t index) noexcept
+{
+    internal::heap_sample* samples = profile_samples(control);
+    internal::heap_stack& stack = profile_stacks(control)[samples[index].stack_index];
+    stack.live_count -= 1;
+    stack.live_size -= samples[index].size;
+    filter_count(samples[index].ptr).fetch_sub(1, std::memory_order_relaxed);
+    std::size_t capacity = control->sample_capacity;
+    std::size_t hole = index;
+    for (std::size_t i = (index + 1) % capacity; i != index && samples[i].ptr != nullptr; i = (i + 1) % capacity) {
+        std::size_t home = hash_pointer(samples[i].ptr, capacity);
+        // Move the entry into the hole unless its home lies cyclically in (hole, i]
+        bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (!stays) {
+            samples[hole] = samples[i];
+            hole = i;
+        }
+    }
+    samples[hole].ptr = nullptr;
+    control->live_count -= 1;
+}
+
+void record_sample(
+    internal::heap_profile_control* control,
+    void* const* frames,
+    std::size_t depth,
+    const void* ptr,
+    std::size_t size
+) noexcept
+{
+    std::size_t stack_index = find_stack(control, frames, depth);
+    if (stack_index == control->stack_capacity) [[unlikely]] {
+        control->dropped_count += 1;
+        return;
+    }
+    internal::heap_stack& stack = profile_stacks(control)[stack_index];
+    stack.alloc_count += 1;
+    stack.alloc_size += size;
+
+    std::size_t stale = find_sample(control, ptr);
+    if (stale != control->sample_capacity) [[unlikely]] {
+        // The allocator reused the address without reporting a free
+        erase_sample(control, stale);
+    }
+    if (control->live_count == control->sample_capacity) [[unlikely]] {
+        control->dropped_count += 1;
+        return;
+    }
+    internal::heap_sample* samples = profile_samples(control);
+    std::size_t index = hash_pointer(ptr, control->sample_capacity);
+    while (samples[index].ptr != nullptr) {
+        index = (index + 1) % control->sample_capacity;
+    }
+    samples[index] = internal::heap_sample{.ptr = ptr, .size = size, .stack_index = stack_index};
+    // Published before the allocation is returned, so before any free of it
+    filter_count(ptr).fetch_add(1, std::memory_order_release);
+    stack.live_count += 1;
+    stack.live_size += size;
+    control->live_count += 1;
+}
+
+void release_control(internal::heap_profile_control* control) noexcept
+{
+    internal::heap_profile_active.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(profile_mutex);
+        if (profile_current == control) {
+            profile_current = nullptr;
+            for (std::atomic<std::uint32_t>& count : sample_filter) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+    std::destroy_at(control);
+    aligned_free(control);
+}
+
+// Bytes allocated at a stack estimated from its samples, each sample of size
+// s stands for 1 / (1 - exp(-s / interval)) allocations of that size
+std::size_t unsample(std::size_t count, std::size_t size, std::size_t interval) noexcept
+{
+    if (count == 0) {
+        return 0;
+    }
+    double average = static_cast<double>(size) / static_cast<double>(count);
+    double probability = 1.0 - std::exp(-average / static_cast<double>(interval));
+    return static_cast<std::size_t>(static_cast<double>(size) / probability);
+}
+
+void append_frame_name(std::string& out, void* frame) noexcept
+{
+    Dl_info info;
+    if (dladdr(frame, &info) != 0 && info.dli_sname != nullptr) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        if (demangled != nullptr) {
+            out += demangled;
+            std::free(demangled);
+        } else {
+            out += info.dli_sname;
+        }
+        return;
+    }
+    auto&& exp_name = mica::format("{:#x}", reinterpret_cast<std::uintptr_t>(frame));
+    out += exp_name.has_value() ? exp_name.value() : std::string("?");
+}
+
+std::expected<void, std::string> append_mappings(std::string& out) noexcept
+{
+    int fd = open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+    if (fd == -1) [[unlikely]] {
+        auto&& exp_msg = mica::format("open failed, error: {}, path: /proc/self/maps", std::strerror(errno));
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling open error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    char chunk[4096];
+    while (true) {
+        ssize_t read_size = read(fd, chunk, sizeof(chunk));
+        if (read_size == -1 && errno == EINTR) {
+            continue;
+        }
+        if (read_size <= 0) {
+            break;
+        }
+        out.append(chunk, static_cast<std::size_t>(read_size));
+    }
+    close(fd);
+    return {};
+}
+
+} // unnamed namespace
+
+namespace internal {
+
+heap_profile_control::heap_profile_control(
+    std::size_t sample_interval, std::size_t stack_capacity, std::size_t sample_capacity) noexcept
+    : sample_interval(sample_interval),
+    stack_capacity(stack_capacity),
+    sample_capacity(sample_capacity),
+    live_count(0),
+    dropped_count(0)
+{}
+
+void heap_profile_sample(const void* ptr, std::size_t size) noexcept
+{
+    std::uint64_t generation = profile_generation.load(std::memory_order_acquire);
+    std::size_t interval = profile_interval.load(std::memory_order_relaxed);
+    if (sampler.generation != generation) {
+        sampler.generation = generation;
+        sampler.random = (reinterpret_cast<std::uintptr_t>(&sampler) ^ (generation * 0x9e3779b97f4a7c15ull)) | 1;
+        sampler.remaining = next_sample_distance(sampler, interval);
+    }
+    if (size < sampler.remaining) [[likely]] {
+        sampler.remaining -= size;
+        return;
+    }
+    sampler.remaining = next_sample_distance(sampler, interval);
+
+    void* frames[heap_profile_max_depth + 1];
+    int depth = backtrace(frames, static_cast<int>(heap_profile_max_depth + 1));
+    std::lock_guard lock(profile_mutex);
+    if (profile_current == nullptr) {
+        return;
+    }
+    // The first frame is this function
+    std::size_t frame_count = depth > 1 ? static_cast<std::size_t>(depth - 1) : 0;
+    record_sample(profile_current, frames + 1, frame_count, ptr, size);
+}
+
+void heap_profile_release(const void* ptr) noexcept
+{
+    if (filter_count(ptr).load(std::memory_order_acquire) == 0) [[likely]] {
+        return;
+    }
+    std::lock_guard lock(profile_mutex);
+    heap_profile_control* control = profile_current;
+    if (control == nullptr || control->live_count == 0) {
+        return;
+    }
+    std::size_t index = find_sample(control, ptr);
+    if (index != control->sample_capacity) {
+        erase_sample(control, index);
+    }
+}
+
+void heap_profile_update(const void* ptr, std::size_t size) noexcept
+{
+    if (filter_count(ptr).load(std::memory_order_acquire) == 0) [[likely]] {
+        return;
+    }
+    std::lock_guard lock(profile_mutex);
+    heap_profile_control* control = profile_current;
+    if (control == nullptr || control->live_count == 0) {
+        return;
+    }
+    std::size_t index = find_sample(control, ptr);
+    if (index == control->sample_capacity) {
+        return;
+    }
+    heap_sample& sample = profile_samples(control)[index];
+    heap_stack& stack = profile_stacks(control)[sample.stack_index];
+    stack.live_size = stack.live_size - sample.size + size;
+    if (size > sample.size) {
+        // Growing in place allocates the extra bytes
+        stack.alloc_size += size - sample.size;
+    }
+    sample.size = size;
+}
+
+void heap_profile_release_range(const void* begin, const void* end) noexcept
+{
+    std::lock_guard lock(profile_mutex);
+    heap_profile_control* control = profile_current;
+    if (control == nullptr || control->live_count == 0) {
+        return;
+    }
+    std::uintptr_t begin_addr = reinterpret_cast<std::uintptr_t>(begin);
+    std::uintptr_t end_addr = reinterpret_cast<std::uintptr_t>(end);
+    heap_sample* samples = profile_samples(control);
+    for (std::size_t i = 0; i < control->sample_capacity && control->live_count > 0;) {
+        std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(samples[i].ptr);
+        if (samples[i].ptr != nullptr && addr >= begin_addr && addr < end_addr) {
+            // A later entry may shift into the slot, look at it again
+            erase_sample(control, i);
+            continue;
+        }
+        ++i;
+    }
+}
+
+} // namespace amber::internal
+
+heap_profiler::heap_profiler(heap_profiler&& other) noexcept
+    : control_(std::exchange(other.control_, nullptr))
+{}
+
+heap_profiler& heap_profiler::operator=(heap_profiler&& other) noexcept
+{
+    if (this != &other) {
+        if (control_ != nullptr) {
+            release_control(control_);
+        }
+        control_ = std::exchange(other.control_, nullptr);
+    }
+    return *this;
+}
+
+heap_profiler::~heap_profiler() noexcept
+{
+    if (control_ != nullptr) {
+        release_control(control_);
+    }
+    control_ = nullptr;
+}
+
+std::expected<heap_profiler, std::string> heap_profiler::create(
+    std::size_t sample_interval, std::size_t max_stacks, std::size_t max_samples) noexcept
+{
+    if (sample_interval == 0) [[unlikely]] {
+        return std::unexpected("invalid sample interval");
+    }
+    if (max_stacks == 0 || max_samples == 0) [[unlikely]] {
+        return std::unexpected("invalid capacity");
+    }
+    auto exp_memory = aligned_alloc(
+        alignof(std::max_align_t),
+        sizeof(internal::heap_profile_control)
+            + (max_stacks * sizeof(internal::heap_stack))
+            + (max_samples * sizeof(internal::heap_sample)));
+    if (!exp_memory.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_memory).error());
+    }
+    internal::heap_profile_control* control = std::construct_at(
+        static_cast<internal::heap_profile_control*>(exp_memory.value()),
+        sample_interval, max_stacks, max_samples);
+    internal::heap_stack* stacks = reinterpret_cast<internal::heap_stack*>(control + 1);
+    for (std::size_t i = 0; i < max_stacks; ++i) {
+        std::construct_at(stacks + i);
+    }
+    internal::heap_sample* samples = reinterpret_cast<internal::heap_sample*>(stacks + max_stacks);
+    for (std::size_t i = 0; i < max_samples; ++i) {
+        std::construct_at(samples + i);
+    }
+
+    // The first backtrace loads the unwinder, which allocates
+    void* warm_frames[1];
+    backtrace(warm_frames, 1);
+
+    {
+        std::lock_guard lock(profile_mutex);
+        if (profile_current == nullptr) {
+            profile_current = control;
+            profile_interval.store(sample_interval, std::memory_order_relaxed);
+            profile_generation.fetch_add(1, std::memory_order_release);
+            internal::heap_profile_active.store(true, std::memory_order_release);
+            return heap_profiler(control);
+        }
+    }
+    std::destroy_at(control);
+    aligned_free(control);
+    return std::unexpected("heap profiler already installed");
+}
+
+std::expected<std::string, std::string> heap_profiler::folded(heap_profile kind) const noexcept
+{
+    std::lock_guard lock(profile_mutex);
+    internal::heap_stack* stacks = profile_stacks(control_);
+    std::string out;
+    for (std::size_t i = 0; i < control_->stack_capacity; ++i) {
+        const internal::heap_stack& stack = stacks[i];
+        std::size_t count = kind == heap_profile::live ? stack.live_count : stack.alloc_count;
+        std::size_t size = kind == heap_profile::live ? stack.live_size : stack.alloc_size;
+        if (stack.hash == 0 || count == 0) {
+            continue;
+        }
+        for (std::size_t frame = stack.depth; frame-- > 0;) {
+            append_frame_name(out, stack.frames[frame]);
+            if (frame != 0) {
+                out += ';';
+            }
+        }
+        auto&& exp_line = mica::format(" {}\n", unsample(count, size, control_->sample_interval));
+        if (!exp_line.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling folded profile");
+        }
+        out += exp_line.value();
+    }
+    return out;
+}
+
+std::expected<std::string, std::string> heap_profiler::pprof() const noexcept
+{
+    std::lock_guard lock(profile_mutex);
+    internal::heap_stack* stacks = profile_stacks(control_);
+    std::size_t live_count = 0;
+    std::size_t live_size = 0;
+    std::size_t alloc_count = 0;
+    std::size_t alloc_size = 0;
+    for (std::size_t i = 0; i < control_->stack_capacity; ++i) {
+        live_count += stacks[i].live_count;
+        live_size += stacks[i].live_size;
+        alloc_count += stacks[i].alloc_count;
+        alloc_size += stacks[i].alloc_size;
+    }
+    // pprof unsamples heap_v2 profiles itself from the sampling interval
+    auto&& exp_header = mica::format(
+        "heap profile: {}: {} [{}: {}] @ heap_v2/{}\n",
+        live_count, live_size, alloc_count, alloc_size, control_->sample_interval
+    );
+    if (!exp_header.has_value()) [[unlikely]] {
+        return std::unexpected("formatting failed while handling pprof profile");
+    }
+    std::string out = std::move(exp_header).value();
+    for (std::size_t i = 0; i < control_->stack_capacity; ++i) {
+        const internal::heap_stack& stack = stacks[i];
+        if (stack.hash == 0 || stack.alloc_count == 0) {
+            continue;
+        }
+        auto&& exp_line = mica::format(
+            "{}: {} [{}: {}] @",
+            stack.live_count, stack.live_size, stack.alloc_count, stack.alloc_size
+        );
+        if (!exp_line.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling pprof profile");
+        }
+        out += exp_line.value();
+        for (std::size_t frame = 0; frame < stack.depth; ++frame) {
+            auto&& exp_frame = mica::format(" {:#x}", reinterpret_cast<std::uintptr_t>(stack.frames[frame]));
+            if (!exp_frame.has_value()) [[unlikely]] {
+                return std::unexpected("formatting failed while handling pprof profile");
+            }
+            out += exp_frame.value();
+        }
+        out += '\n';
+    }
+    out += "\nMAPPED_LIBRARIES:\n";
+    auto exp_mappings = append_mappings(out);
+    if (!exp_mappings.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_mappings).error());
+    }
+    return out;
+}
+
+std::size_t heap_profiler::sample_interval() const noexcept
+{
+    return control_->sample_interval;
+}
+
+std::size_t heap_profiler::live_count() const noexcept
+{
+    std::lock_guard lock(profile_mutex);
+    return control_->live_count;
+}
+
+std::size_t heap_profiler::dropped_count() const noexcept
+{
+    std::lock_guard lock(profile_mutex);
+    return control_->dropped_count;
+}
+
+heap_profiler::heap_profiler(internal::heap_profile_control* control) noexcept
+    : control_(control)
+{}
+
+} // namespace amber
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string>
+
+namespace amber {
+
+namespace internal {
+
+inline constexpr std::size_t heap_profile_max_depth = 32;
+
+// Allocations sampled at one call stack
+struct heap_stack {
+public:
+    void* frames[heap_profile_max_depth];
+    std::size_t depth;
+    // Zero while the slot is unused
+    std::uint64_t hash;
+    std::size_t alloc_count;
+    std::size_t alloc_size;
+    std::size_t live_count;
+    std::size_t live_size;
+};
+
+// A sampled allocation that has not been freed yet
+struct heap_sample {
+public:
+    const void* ptr;
+    std::size_t size;
+    std::size_t stack_index;
+};
+
+// Followed in memory by stack_capacity stacks and sample_capacity samples
+struct heap_profile_control {
+public:
+    heap_profile_control(
+        std::size_t sample_interval, std::size_t stack_capacity, std::size_t sample_capacity) noexcept;
+
+    std::size_t sample_interval;
+    std::size_t stack_capacity;
+    std::size_t sample_capacity;
+    std::size_t live_count;
+    std::size_t dropped_count;
+};
+
+// Set while a heap_profiler is installed
+extern std::atomic<bool> heap_profile_active;
+
+void heap_profile_sample(const void* ptr, std::size_t size) noexcept;
+
+void heap_profile_release(const void* ptr) noexcept;
+
+void heap_profile_release_range(const void* begin, const void* end) noexcept;
+
+void heap_profile_update(const void* ptr, std::size_t size) noexcept;
+
+// Allocation hook for allocators, a single predictable branch while no
+// profiler is installed
+inline void heap_profile_allocate(const void* ptr, std::size_t size) noexcept
+{
+    if (heap_profile_active.load(std::memory_order_relaxed)) [[unlikely]] {
+        heap_profile_sample(ptr, size);
+    }
+}
+
+inline void heap_profile_free(const void* ptr) noexcept
+{
+    if (heap_profile_active.load(std::memory_order_relaxed)) [[unlikely]] {
+        heap_profile_release(ptr);
+    }
+}
+
+// For allocators that resize an allocation in place
+inline void heap_profile_resize(const void* ptr, std::size_t size) noexcept
+{
+    if (heap_profile_active.load(std::memory_order_relaxed)) [[unlikely]] {
+        heap_profile_update(ptr, size);
+    }
+}
+
+// For allocators that release everything in [begin, end) at once
+inline void heap_profile_free_range(const void* begin, const void* end) noexcept
+{
+    if (heap_profile_active.load(std::memory_order_relaxed)) [[unlikely]] {
+        heap_profile_release_range(begin, end);
+    }
+}
+
+} // namespace amber::internal
+
+enum class heap_profile : int {
+    // Sampled allocations that are still alive
+    live,
+    // Every sampled allocation since the profiler was installed
+    cumulative,
+};
+
+// Sampling heap profiler for linear_allocator, stack_allocator and
+// pool_allocator. Allocations are sampled once every sample_interval bytes on
+// average, the distance between samples drawn from an exponential
+// distribution as in tcmalloc, and the call stack of each sampled allocation
+// is recorded. Only one profiler can be installed at a time, it is removed
+// again when destroyed.
+class heap_profiler {
+public:
+    heap_profiler() = delete;
+
+    heap_profiler(const heap_profiler&) = delete;
+
+    heap_profiler(heap_profiler&& other) noexcept;
+
+    heap_profiler& operator=(const heap_profiler&) = delete;
+
+    heap_profiler& operator=(heap_profiler&& other) noexcept;
+
+    ~heap_profiler() noexcept;
+
+    // Installs a profiler with room for max_stacks distinct call stacks and
+    // max_samples live sampled allocations, samples that do not fit are dropped
+    static
+    std::expected<heap_profiler, std::string> create(
+        std::size_t sample_interval, std::size_t max_stacks, std::size_t max_samples) noexcept;
+
+    // One line per call stack in the folded format read by flamegraph.pl,
+    // frames from the root to the allocation site followed by the estimated
+    // number of bytes
+    std::expected<std::string, std::string> folded(heap_profile kind) const noexcept;
+
+    // Legacy text heap profile read by pprof, with the live and cumulative
+    // profile and the process mappings for symbolization
+    std::expected<std::string, std::string> pprof() const noexcept;
+
+    std::size_t sample_interval() const noexcept;
+
+    // Sampled allocations that are still alive
+    std::size_t live_count() const noexcept;
+
+    // Samples dropped since a table was full
+    std::size_t dropped_count() const noexcept;
+
+private:
+    heap_profiler(internal::heap_profile_control* control) noexcept;
+
+    internal::heap_profile_control* control_;
+};
+
+} // namespace amber
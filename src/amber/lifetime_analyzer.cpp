@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <amber/arena_hash_map.hpp>
+#include <amber/lifetime_analyzer.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/mmap_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <amber/spsc_ring_allocator.hpp>
+#include <amber/stack_allocator.hpp>
+#include <amber/util.hpp>
+#include <bit>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+namespace {
+
+constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+// Share of a site's frees that must follow a pattern for it to be reported
+constexpr double pattern_threshold = 0.9;
+
+// Chunk header and rounding of glibc malloc per allocation, approximately
+constexpr std::size_t malloc_chunk_overhead = 16;
+
+// Largest size recommended for size class pools, larger sizes stay on malloc
+constexpr std::size_t bucketizer_max_size = 4096;
+
+// Allocation event in the live list of its site, ordered by allocation
+struct live_node {
+public:
+    std::size_t prev;
+    std::size_t next;
+    std::uint64_t time;
+    std::size_t size;
+    std::uint32_t site;
+};
+
+struct site_state {
+public:
+    // Oldest and newest live allocation
+    std::size_t head;
+    std::size_t tail;
+    std::size_t live_count;
+    std::size_t live_size;
+    // Frees since the site last allocated
+    std::size_t free_run;
+    std::size_t lifo_count;
+    std::size_t fifo_count;
+    std::size_t bulk_count;
+    std::uint64_t lifetime_sum;
+    // Bytes lost rounding every allocation up to a power of two size class
+    std::size_t class_waste;
+};
+
+void classify(site_report& report, const site_state& state) noexcept
+{
+    double free_count = static_cast<double>(report.free_count);
+    if (report.free_count == 0) {
+        report.pattern = lifetime_pattern::never_freed;
+        report.recommendation = allocator_kind::linear_allocator;
+    } else if (static_cast<double>(state.bulk_count) >= pattern_threshold * free_count) {
+        report.pattern = lifetime_pattern::bulk;
+        report.recommendation = allocator_kind::linear_allocator;
+    } else if (static_cast<double>(state.lifo_count) >= pattern_threshold * free_count) {
+        report.pattern = lifetime_pattern::lifo;
+        report.recommendation = allocator_kind::stack_allocator;
+    } else if (static_cast<double>(state.fifo_count) >= pattern_threshold * free_count) {
+        report.pattern = lifetime_pattern::fifo;
+        report.recommendation = allocator_kind::spsc_ring_allocator;
+    } else {
+        report.pattern = lifetime_pattern::random;
+        if (report.min_size == report.max_size) {
+            report.recommendation = allocator_kind::pool_allocator;
+        } else if (report.max_size <= bucketizer_max_size) {
+            report.recommendation = allocator_kind::bucketizer;
+        } else {
+            report.recommendation = allocator_kind::malloc_allocator;
+        }
+    }
+
+    std::size_t peak = report.peak_live_count;
+    report.malloc_overhead = peak * malloc_chunk_overhead;
+    switch (report.recommendation) {
+    case allocator_kind::linear_allocator:
+        report.projected_overhead = 0;
+        report.free_calls_saved = report.free_count;
+        break;
+    case allocator_kind::stack_allocator:
+        report.projected_overhead = peak * sizeof(internal::alloc_header);
+        break;
+    case allocator_kind::spsc_ring_allocator:
+        report.projected_overhead = peak * sizeof(internal::ring_record);
+        break;
+    case allocator_kind::pool_allocator: {
+        std::size_t entry_size = align_forward(
+            alignof(internal::pool_entry), std::max(report.max_size, sizeof(internal::pool_entry)));
+        report.projected_overhead = peak * (entry_size - report.max_size);
+        break;
+    }
+    case allocator_kind::bucketizer:
+        report.projected_overhead = peak * (state.class_waste / report.allocate_count);
+        break;
+    case allocator_kind::malloc_allocator:
+        report.projected_overhead = report.malloc_overhead;
+        break;
+    }
+    if (report.free_count > 0) {
+        report.mean_lifetime = state.lifetime_sum / report.free_count;
+    }
+}
+
+} // unnamed namespace
+
+std::expected<void, std::string> analyze_lifetimes(
+    std::span<const lifetime_event> events,
+    std::size_t site_count,
+    std::span<site_report> reports
+) noexcept
+{
+    if (reports.size() < site_count) [[unlikely]] {
+        return std::unexpected("report span too small");
+    }
+    std::size_t allocate_count = 0;
+    for (const lifetime_event& event : events) {
+        if (event.kind == lifetime_event_kind::allocate) {
+            if (event.site >= site_count) [[unlikely]] {
+                return std::unexpected("invalid site index");
+            }
+            allocate_count += 1;
+        }
+    }
+
+    // Scratch space for the live lists and the address map, presized so the
+    // map never rehashes. Only the pages that are used get committed.
+    using address_map = arena_hash_map<std::uintptr_t, std::size_t, linear_allocator>;
+    std::size_t map_slots = 2 * (allocate_count + (allocate_count / 7)) + 64;
+    std::size_t scratch_size = (events.size() * sizeof(live_node))
+        + (site_count * sizeof(site_state))
+        + (map_slots * (1 + sizeof(internal::hash_map_slot<std::uintptr_t, std::size_t>)))
+        + page_size();
+    auto exp_buffer = mmap_buffer::create_lazy(scratch_size);
+    if (!exp_buffer.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_buffer).error());
+    }
+    mmap_buffer buffer = std::move(exp_buffer).value();
+    auto exp_scratch = linear_allocator::create(buffer);
+    if (!exp_scratch.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_scratch).error());
+    }
+    linear_allocator scratch = std::move(exp_scratch).value();
+    auto exp_nodes = scratch.allocate(alignof(live_node), events.size() * sizeof(live_node));
+    if (!exp_nodes.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_nodes).error());
+    }
+    live_node* nodes = static_cast<live_node*>(exp_nodes.value());
+    auto exp_states = scratch.allocate(alignof(site_state), site_count * sizeof(site_state));
+    if (!exp_states.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_states).error());
+    }
+    site_state* states = static_cast<site_state*>(exp_states.value());
+    auto exp_live = address_map::create(scratch, allocate_count);
+    if (!exp_live.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_live).error());
+    }
+    address_map live = std::move(exp_live).value();
+
+    for (std::size_t i = 0; i < site_count; ++i) {
+        std::construct_at(reports.data() + i, site_report{
+            .site = static_cast<std::uint32_t>(i),
+            .pattern = lifetime_pattern::never_freed,
+            .recommendation = allocator_kind::linear_allocator,
+            .allocate_count = 0,
+            .free_count = 0,
+            .total_size = 0,
+            .min_size = npos,
+            .max_size = 0,
+            .peak_live_count = 0,
+            .peak_live_size = 0,
+            .mean_lifetime = 0,
+            .malloc_overhead = 0,
+            .projected_overhead = 0,
+            .free_calls_saved = 0,
+        });
+        std::construct_at(states + i, site_state{
+            .head = npos,
+            .tail = npos,
+            .live_count = 0,
+            .live_size = 0,
+            .free_run = 0,
+            .lifo_count = 0,
+            .fifo_count = 0,
+            .bulk_count = 0,
+            .lifetime_sum = 0,
+            .class_waste = 0,
+        });
+    }
+
+    for (std::size_t index = 0; index < events.size(); ++index) {
+        const lifetime_event& event = events[index];
+        if (event.kind == lifetime_event_kind::allocate) {
+            site_report& report = reports[event.site];
+            site_state& state = states[event.site];
+            report.allocate_count += 1;
+            report.total_size += event.size;
+            report.min_size = std::min(report.min_size, event.size);
+            report.max_size = std::max(report.max_size, event.size);
+            state.class_waste += std::bit_ceil(std::max(event.size, std::size_t(1))) - event.size;
+
+            std::construct_at(nodes + index, live_node{
+                .prev = state.tail,
+                .next = npos,
+                .time = event.time,
+                .size = event.size,
+                .site = event.site,
+            });
+            if (state.tail != npos) {
+                nodes[state.tail].next = index;
+            } else {
+                state.head = index;
+            }
+            state.tail = index;
+            state.live_count += 1;
+            state.live_size += event.size;
+            state.free_run = 0;
+            report.peak_live_count = std::max(report.peak_live_count, state.live_count);
+            report.peak_live_size = std::max(report.peak_live_size, state.live_size);
+            auto exp_insert = live.insert_or_assign(event.address, index);
+            if (!exp_insert.has_value()) [[unlikely]] {
+                return std::unexpected(std::move(exp_insert).error());
+            }
+            continue;
+        }
+
+        // Frees of allocations the recorder did not see are ignored
+        std::size_t* live_index = live.find(event.address);
+        if (live_index == nullptr) {
+            continue;
+        }
+        std::size_t node_index = *live_index;
+        live.erase(event.address);
+        const live_node& node = nodes[node_index];
+        site_report& report = reports[node.site];
+        site_state& state = states[node.site];
+        report.free_count += 1;
+        if (node_index == state.tail) {
+            state.lifo_count += 1;
+        }
+        if (node_index == state.head) {
+            state.fifo_count += 1;
+        }
+        if (node.prev != npos) {
+            nodes[node.prev].next = node.next;
+        } else {
+            state.head = node.next;
+        }
+        if (node.next != npos) {
+            nodes[node.next].prev = node.prev;
+        } else {
+            state.tail = node.prev;
+        }
+        state.live_count -= 1;
+        state.live_size -= node.size;
+        state.lifetime_sum += event.time - node.time;
+        state.free_run += 1;
+        if (state.live_count == 0) {
+            if (state.free_run >= 2) {
+                state.bulk_count += state.free_run;
+            }
+            state.free_run = 0;
+        }
+    }
+
+    for (std::size_t i = 0; i < site_count; ++i) {
+        if (reports[i].allocate_count > 0) {
+            classify(reports[i], states[i]);
+        }
+    }
+    return {};
+}
+
+std::expected<std::string, std::string> format_lifetime_report(
+    std::span<const site_report> reports, std::span<const lifetime_site> sites) noexcept
+{
+    std::string out;
+    for (const site_report& report : reports) {
+        if (report.site >= sites.size()) [[unlikely]] {
+            return std::unexpected("invalid site index");
+        }
+        if (report.allocate_count == 0) {
+            continue;
+        }
+        const lifetime_site& site = sites[report.site];
+        auto&& exp_block = mica::format(
+            "{}:{} ({})\n"
+            "  pattern: {}, recommended: {}\n"
+            "  allocations: {}, frees: {}, bytes: {}, sizes: {}..{}\n"
+            "  peak live: {} allocations, {} bytes, mean lifetime: {} ns\n"
+            "  overhead at peak: {} bytes with malloc, {} bytes projected, free calls saved: {}\n",
+            site.file, site.line, site.function,
+            lifetime_pattern_name(report.pattern), allocator_kind_name(report.recommendation),
+            report.allocate_count, report.free_count, report.total_size, report.min_size, report.max_size,
+            report.peak_live_count, report.peak_live_size, report.mean_lifetime,
+            report.malloc_overhead, report.projected_overhead, report.free_calls_saved
+        );
+        if (!exp_block.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling lifetime report");
+        }
+        out += exp_block.value();
+    }
+    return out;
+}
+
+const char* lifetime_pattern_name(lifetime_pattern pattern) noexcept
+{
+    switch (pattern) {
+    case lifetime_pattern::never_freed:
+        return "never freed";
+    case lifetime_pattern::bulk:
+        return "bulk";
+    case lifetime_pattern::lifo:
+        return "lifo";
+    case lifetime_pattern::fifo:
+        return "fifo";
+    case lifetime_pattern::random:
+        return "random";
+    }
+    return "unknown";
+}
+
+const char* allocator_kind_name(allocator_kind kind) noexcept
+{
+    switch (kind) {
+    case allocator_kind::linear_allocator:
+        return "linear_allocator";
+    case allocator_kind::stack_allocator:
+        return "stack_allocator";
+    case allocator_kind::spsc_ring_allocator:
+        return "spsc_ring_allocator";
+    case allocator_kind::pool_allocator:
+        return "pool_allocator";
+    case allocator_kind::bucketizer:
+        return "bucketizer";
+    case allocator_kind::malloc_allocator:
+        return "malloc_allocator";
+    }
+    return "unknown";
+}
+
+} // namespace amber
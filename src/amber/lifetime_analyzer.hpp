@@ -0,0 +1,74 @@
+#pragma once
+
+#include <amber/lifetime_recorder.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+
+namespace amber {
+
+enum class lifetime_pattern : int {
+    // Nothing was freed, everything lives as long as the subsystem
+    never_freed,
+    // Frees come in runs that release everything the site allocated
+    bulk,
+    // Each free releases the site's most recent live allocation
+    lifo,
+    // Each free releases the site's oldest live allocation
+    fifo,
+    random,
+};
+
+enum class allocator_kind : int {
+    linear_allocator,
+    stack_allocator,
+    spsc_ring_allocator,
+    pool_allocator,
+    // Size class pools
+    bucketizer,
+    malloc_allocator,
+};
+
+// Lifetime statistics of one call site and the allocator that suits it
+struct site_report {
+public:
+    std::uint32_t site;
+    lifetime_pattern pattern;
+    allocator_kind recommendation;
+    std::size_t allocate_count;
+    std::size_t free_count;
+    std::size_t total_size;
+    std::size_t min_size;
+    std::size_t max_size;
+    std::size_t peak_live_count;
+    std::size_t peak_live_size;
+    // Mean nanoseconds between allocation and free of freed allocations
+    std::uint64_t mean_lifetime;
+    // Estimated bookkeeping and rounding bytes at the peak under malloc and
+    // under the recommended allocator
+    std::size_t malloc_overhead;
+    std::size_t projected_overhead;
+    // Free calls that become part of a single reset under the recommendation
+    std::size_t free_calls_saved;
+};
+
+// Classifies the lifetimes of the allocations of each call site in events, as
+// recorded by a lifetime_recorder with site_count sites. reports must hold
+// site_count entries, report i describes site i.
+std::expected<void, std::string> analyze_lifetimes(
+    std::span<const lifetime_event> events,
+    std::size_t site_count,
+    std::span<site_report> reports
+) noexcept;
+
+// Human readable table of reports, one row per site
+std::expected<std::string, std::string> format_lifetime_report(
+    std::span<const site_report> reports, std::span<const lifetime_site> sites) noexcept;
+
+const char* lifetime_pattern_name(lifetime_pattern pattern) noexcept;
+
+const char* allocator_kind_name(allocator_kind kind) noexcept;
+
+} // namespace amber
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <source_location>
+#include <span>
+#include <string>
+
+namespace amber {
+
+enum class lifetime_event_kind : std::uint32_t {
+    allocate,
+    free,
+};
+
+// One allocation or free seen by a lifetime_recorder
+struct lifetime_event {
+public:
+    static constexpr std::uint32_t no_site = static_cast<std::uint32_t>(-1);
+
+    lifetime_event_kind kind;
+    // Index into the recorder's sites, no_site for frees
+    std::uint32_t site;
+    std::uintptr_t address;
+    // Zero for frees
+    std::size_t size;
+    // Nanoseconds since the recorder was created
+    std::uint64_t time;
+};
+
+// Source location of the code that called allocate
+struct lifetime_site {
+public:
+    const char* file;
+    const char* function;
+    std::uint32_t line;
+    std::uint32_t column;
+};
+
+// Wraps Parent and logs every allocation and free with its size, time and call
+// site into a buffer, for analyze_lifetimes to find the allocator that suits
+// each call site. The call site is the caller of allocate, taken from a
+// defaulted std::source_location argument. Events past the capacity of the
+// buffer are dropped.
+template<Allocator Parent>
+class lifetime_recorder {
+public:
+    using clock = std::chrono::steady_clock;
+
+    lifetime_recorder() = delete;
+
+    lifetime_recorder(const lifetime_recorder&) = delete;
+
+    lifetime_recorder(lifetime_recorder&& other) noexcept = default;
+
+    lifetime_recorder& operator=(const lifetime_recorder&) = delete;
+
+    lifetime_recorder& operator=(lifetime_recorder&& other) noexcept = default;
+
+    ~lifetime_recorder() noexcept = default;
+
+    // The start of buffer holds max_sites call sites, the rest holds events
+    template<Buffer B>
+    static
+    std::expected<lifetime_recorder, std::string> create(
+        Parent&& parent, B& buffer, std::size_t max_sites) noexcept;
+
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment,
+        std::size_t size,
+        std::source_location location = std::source_location::current()
+    ) noexcept;
+
+    void free(void* ptr) noexcept
+    requires DeallocatingAllocator<Parent>;
+
+    std::span<const lifetime_event> events() const noexcept;
+
+    std::span<const lifetime_site> sites() const noexcept;
+
+    // Events lost because the buffer or the site table was full
+    std::size_t dropped_count() const noexcept;
+
+    void clear() noexcept;
+
+    Parent& parent() noexcept;
+
+    const Parent& parent() const noexcept;
+
+private:
+    lifetime_recorder(
+        Parent&& parent,
+        std::span<lifetime_site> sites,
+        std::span<lifetime_event> events
+    ) noexcept;
+
+    std::uint32_t find_site(const std::source_location& location) noexcept;
+
+    void record(lifetime_event_kind kind, std::uint32_t site, const void* ptr, std::size_t size) noexcept;
+
+    Parent parent_;
+    std::span<lifetime_site> sites_;
+    std::size_t site_count_;
+    std::span<lifetime_event> events_;
+    std::size_t event_count_;
+    std::size_t dropped_count_;
+    clock::time_point start_;
+};
+
+} // namespace amber
+
+#include <amber/lifetime_recorder.inl>
@@ -0,0 +1,161 @@
+#include <amber/util.hpp>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace amber {
+
+template<Allocator Parent>
+template<Buffer B>
+std::expected<lifetime_recorder<Parent>, std::string> lifetime_recorder<Parent>::create(
+    Parent&& parent, B& buffer, std::size_t max_sites) noexcept
+{
+    static_assert(std::is_nothrow_move_constructible_v<Parent>);
+    static_assert(std::is_trivially_copyable_v<lifetime_event>);
+    static_assert(std::is_trivially_copyable_v<lifetime_site>);
+    std::span<std::byte> buffer_span = buffer.buffer();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_span.data());
+    if (!is_aligned(static_cast<std::uintptr_t>(alignof(lifetime_event)), buffer_addr)) [[unlikely]] {
+        return std::unexpected("invalid buffer alignment");
+    }
+    std::size_t sites_size = align_forward(alignof(lifetime_event), max_sites * sizeof(lifetime_site));
+    if (sites_size > buffer_span.size()) [[unlikely]] {
+        return std::unexpected("buffer too small");
+    }
+    std::span<lifetime_site> sites(
+        std::launder(reinterpret_cast<lifetime_site*>(buffer_span.data())), max_sites);
+    std::span<lifetime_event> events(
+        std::launder(reinterpret_cast<lifetime_event*>(buffer_span.data() + sites_size)),
+        (buffer_span.size() - sites_size) / sizeof(lifetime_event));
+    return lifetime_recorder(std::move(parent), sites, events);
+}
+
+template<Allocator Parent>
+std::expected<void*, std::string> lifetime_recorder<Parent>::allocate(
+    std::size_t alignment, std::size_t size, std::source_location location) noexcept
+{
+    auto exp_ptr = parent_.allocate(alignment, size);
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return exp_ptr;
+    }
+    std::uint32_t site = find_site(location);
+    if (site == lifetime_event::no_site) [[unlikely]] {
+        dropped_count_ += 1;
+        return exp_ptr;
+    }
+    record(lifetime_event_kind::allocate, site, exp_ptr.value(), size);
+    return exp_ptr;
+}
+
+template<Allocator Parent>
+void lifetime_recorder<Parent>::free(void* ptr) noexcept
+requires DeallocatingAllocator<Parent>
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    record(lifetime_event_kind::free, lifetime_event::no_site, ptr, 0);
+    parent_.free(ptr);
+}
+
+template<Allocator Parent>
+std::span<const lifetime_event> lifetime_recorder<Parent>::events() const noexcept
+{
+    return events_.first(event_count_);
+}
+
+template<Allocator Parent>
+std::span<const lifetime_site> lifetime_recorder<Parent>::sites() const noexcept
+{
+    return sites_.first(site_count_);
+}
+
+template<Allocator Parent>
+std::size_t lifetime_recorder<Parent>::dropped_count() const noexcept
+{
+    return dropped_count_;
+}
+
+template<Allocator Parent>
+void lifetime_recorder<Parent>::clear() noexcept
+{
+    site_count_ = 0;
+    event_count_ = 0;
+    dropped_count_ = 0;
+    start_ = clock::now();
+}
+
+template<Allocator Parent>
+Parent& lifetime_recorder<Parent>::parent() noexcept
+{
+    return parent_;
+}
+
+template<Allocator Parent>
+const Parent& lifetime_recorder<Parent>::parent() const noexcept
+{
+    return parent_;
+}
+
+template<Allocator Parent>
+lifetime_recorder<Parent>::lifetime_recorder(
+    Parent&& parent,
+    std::span<lifetime_site> sites,
+    std::span<lifetime_event> events
+) noexcept
+    : parent_(std::move(parent)),
+    sites_(sites),
+    site_count_(0),
+    events_(events),
+    event_count_(0),
+    dropped_count_(0),
+    start_(clock::now())
+{}
+
+template<Allocator Parent>
+std::uint32_t lifetime_recorder<Parent>::find_site(const std::source_location& location) noexcept
+{
+    // Recording is not a fast path and call sites are few, a linear scan will do
+    for (std::size_t i = 0; i < site_count_; ++i) {
+        const lifetime_site& site = sites_[i];
+        if (site.line == location.line() && site.column == location.column()
+            && std::strcmp(site.file, location.file_name()) == 0
+            && std::strcmp(site.function, location.function_name()) == 0)
+        {
+            return static_cast<std::uint32_t>(i);
+        }
+    }
+    if (site_count_ == sites_.size()) [[unlikely]] {
+        return lifetime_event::no_site;
+    }
+    std::construct_at(sites_.data() + site_count_, lifetime_site{
+        .file = location.file_name(),
+        .function = location.function_name(),
+        .line = location.line(),
+        .column = location.column(),
+    });
+    site_count_ += 1;
+    return static_cast<std::uint32_t>(site_count_ - 1);
+}
+
+template<Allocator Parent>
+void lifetime_recorder<Parent>::record(
+    lifetime_event_kind kind, std::uint32_t site, const void* ptr, std::size_t size) noexcept
+{
+    if (event_count_ == events_.size()) [[unlikely]] {
+        dropped_count_ += 1;
+        return;
+    }
+    std::chrono::nanoseconds elapsed = clock::now() - start_;
+    std::construct_at(events_.data() + event_count_, lifetime_event{
+        .kind = kind,
+        .site = site,
+        .address = reinterpret_cast<std::uintptr_t>(ptr),
+        .size = size,
+        .time = static_cast<std::uint64_t>(elapsed.count()),
+    });
+    event_count_ += 1;
+}
+
+} // namespace amber
@@ -1,30 +1,57 @@
+#include <algorithm>
+#include <amber/heap_profiler.hpp>
 #include <amber/linear_allocator.hpp>
 #include <amber/util.hpp>
 #include <bit>
 #include <cstdint>
+#include <cstring>
 #include <mica/mica.hpp>
 #include <utility>
 
 namespace amber {
 
+namespace internal {
+
+destructor_entry::destructor_entry(void (*destroy)(destructor_entry*), destructor_entry* prev) noexcept
+    : destroy(destroy),
+    prev(prev)
+{}
+
+} // namespace amber::internal
+
 linear_allocator::linear_allocator(linear_allocator&& other) noexcept
     : buffer_(std::exchange(other.buffer_, std::span<std::byte>())),
-    buffer_offset_(std::exchange(other.buffer_offset_, 0))
+    buffer_offset_(std::exchange(other.buffer_offset_, 0)),
+    high_water_(std::exchange(other.high_water_, 0)),
+    destructor_head_(std::exchange(other.destructor_head_, nullptr))
 {}
 
 linear_allocator& linear_allocator::operator=(linear_allocator&& other) noexcept
 {
     if (this != &other) {
+        run_destructors(0);
         buffer_ = std::exchange(other.buffer_, std::span<std::byte>());
         buffer_offset_ = std::exchange(other.buffer_offset_, 0);
+        high_water_ = std::exchange(other.high_water_, 0);
+        destructor_head_ = std::exchange(other.destructor_head_, nullptr);
     }
     return *this;
 }
 
 linear_allocator::~linear_allocator() noexcept
 {
+    run_destructors(0);
     buffer_ = std::span<std::byte>();
     buffer_offset_ = 0;
+    high_water_ = 0;
+}
+
+std::expected<linear_allocator::state, std::string> linear_allocator::save_state() const noexcept
+{
+    if (destructor_head_ != nullptr) [[unlikely]] {
+        return std::unexpected("non-trivially destructible objects cannot be persisted");
+    }
+    return state{.buffer_offset = buffer_offset_};
 }
 
 std::expected<void*, std::string> linear_allocator::allocate(std::size_t alignment, std::size_t size) noexcept
@@ -36,15 +63,15 @@ std::expected<void*, std::string> linear_allocator::allocate(std::size_t alignme
         }
         return std::unexpected(std::move(exp_msg).value());
     }
-    std::byte* offset_ptr = buffer_.data() + buffer_offset_;
-    std::uintptr_t offset_addr = reinterpret_cast<std::uintptr_t>(offset_ptr);
-    std::uintptr_t aligned_addr = align_forward(static_cast<std::uintptr_t>(alignment), offset_addr);
-    std::uintptr_t aligned_padding = aligned_addr - offset_addr;
-    if (buffer_offset_ + aligned_padding + size > buffer_.size()) [[unlikely]] {
+    // A zero-size allocation still takes a byte, otherwise it could end up
+    // one past the buffer where owns() no longer recognizes it
+    size = std::max(size, std::size_t(1));
+    void* ptr = bump(alignment, size);
+    if (ptr == nullptr) [[unlikely]] {
         return std::unexpected("out of capacity");
     }
-    buffer_offset_ += aligned_padding + size;
-    return reinterpret_cast<void*>(aligned_addr);
+    internal::heap_profile_allocate(ptr, size);
+    return ptr;
 }
 
 std::expected<void*, std::string> linear_allocator::allocate(std::size_t size) noexcept
@@ -52,25 +79,154 @@ std::expected<void*, std::string> linear_allocator::allocate(std::size_t size) n
     return allocate(alignof(std::max_align_t), size);
 }
 
+bool linear_allocator::try_extend(void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+{
+    if (ptr == nullptr) {
+        return false;
+    }
+    std::byte* end_ptr = static_cast<std::byte*>(ptr) + old_size;
+    if (end_ptr != buffer_.data() + buffer_offset_) {
+        return false;
+    }
+    std::size_t ptr_offset = static_cast<std::byte*>(ptr) - buffer_.data();
+    if (ptr_offset + new_size > buffer_.size()) {
+        return false;
+    }
+    high_water_ = std::max(high_water_, buffer_offset_);
+    buffer_offset_ = ptr_offset + new_size;
+    internal::heap_profile_resize(ptr, new_size);
+    return true;
+}
+
+bool linear_allocator::shrink(void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+{
+    if (new_size > old_size) {
+        return false;
+    }
+    return try_extend(ptr, old_size, new_size);
+}
+
+std::expected<void*, std::string> linear_allocator::reallocate(
+    void* ptr, std::size_t old_size, std::size_t alignment, std::size_t new_size) noexcept
+{
+    if (ptr == nullptr) {
+        return allocate(alignment, new_size);
+    }
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    if (is_aligned(static_cast<std::uintptr_t>(alignment), addr)
+        && (try_extend(ptr, old_size, new_size) || new_size <= old_size))
+    {
+        return ptr;
+    }
+    auto exp_ptr = allocate(alignment, new_size);
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    std::memcpy(exp_ptr.value(), ptr, std::min(old_size, new_size));
+    // The old block stays in the buffer but the caller no longer holds it
+    internal::heap_profile_free(ptr);
+    return exp_ptr.value();
+}
+
+std::expected<void*, std::string> linear_allocator::reallocate(
+    void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+{
+    return reallocate(ptr, old_size, alignof(std::max_align_t), new_size);
+}
+
 void linear_allocator::reset() noexcept
 {
+    run_destructors(0);
+    internal::heap_profile_free_range(buffer_.data(), buffer_.data() + buffer_offset_);
+    high_water_ = std::max(high_water_, buffer_offset_);
     buffer_offset_ = 0;
 }
 
+void linear_allocator::rewind(std::size_t buffer_offset) noexcept
+{
+    if (buffer_offset >= buffer_offset_) {
+        return;
+    }
+    run_destructors(buffer_offset);
+    internal::heap_profile_free_range(buffer_.data() + buffer_offset, buffer_.data() + buffer_offset_);
+    high_water_ = std::max(high_water_, buffer_offset_);
+    buffer_offset_ = buffer_offset;
+}
+
 std::size_t linear_allocator::buffer_size() const noexcept
 {
     return buffer_.size();
 }
 
+bool linear_allocator::owns(const void* ptr) const noexcept
+{
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    std::uintptr_t begin_addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+    return addr >= begin_addr && addr - begin_addr < buffer_.size();
+}
+
 std::size_t linear_allocator::buffer_offset() const noexcept
 {
     return buffer_offset_;
 }
 
+std::size_t linear_allocator::dirty_size() const noexcept
+{
+    return std::max(high_water_, buffer_offset_) - buffer_offset_;
+}
+
+std::expected<std::size_t, std::string> linear_allocator::purge(purge_mode mode, std::size_t keep_size) noexcept
+{
+    std::size_t high_water = std::max(high_water_, buffer_offset_);
+    std::size_t purge_offset = buffer_offset_ + std::min(keep_size, high_water - buffer_offset_);
+    auto exp_size = internal::purge_range(buffer_, purge_offset, high_water, mode);
+    if (!exp_size.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_size).error());
+    }
+    high_water_ = purge_offset;
+    return exp_size.value();
+}
+
+std::expected<std::size_t, std::string> linear_allocator::purge(purge_mode mode) noexcept
+{
+    return purge(mode, 0);
+}
+
 linear_allocator::linear_allocator(
-    std::span<std::byte> buffer, std::size_t buffer_offset) noexcept
+    std::span<std::byte> buffer,
+    std::size_t buffer_offset,
+    internal::destructor_entry* destructor_head
+) noexcept
     : buffer_(buffer),
-    buffer_offset_(buffer_offset)
+    buffer_offset_(buffer_offset),
+    high_water_(buffer_offset),
+    destructor_head_(destructor_head)
 {}
 
+void* linear_allocator::bump(std::size_t alignment, std::size_t size) noexcept
+{
+    std::byte* offset_ptr = buffer_.data() + buffer_offset_;
+    std::uintptr_t offset_addr = reinterpret_cast<std::uintptr_t>(offset_ptr);
+    std::uintptr_t aligned_addr = align_forward(static_cast<std::uintptr_t>(alignment), offset_addr);
+    std::uintptr_t aligned_padding = aligned_addr - offset_addr;
+    if (buffer_offset_ + aligned_padding + size > buffer_.size()) [[unlikely]] {
+        return nullptr;
+    }
+    buffer_offset_ += aligned_padding + size;
+    return reinterpret_cast<void*>(aligned_addr);
+}
+
+void linear_allocator::run_destructors(std::size_t buffer_offset) noexcept
+{
+    // Entries are linked newest first, so this destroys in reverse allocation order
+    std::byte* offset_ptr = buffer_.data() + buffer_offset;
+    while (destructor_head_ != nullptr
+        && reinterpret_cast<std::byte*>(destructor_head_) >= offset_ptr)
+    {
+        internal::destructor_entry* entry_ptr = destructor_head_;
+        destructor_head_ = entry_ptr->prev;
+        entry_ptr->destroy(entry_ptr);
+    }
+}
+
 } // namespace amber
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <amber/concept.hpp>
+#include <amber/purge.hpp>
 #include <cstddef>
 #include <expected>
 #include <span>
@@ -9,8 +10,28 @@
 
 namespace amber {
 
+namespace internal {
+
+// Stored in the arena directly before each non-trivially destructible object,
+// the object is placed at the next address aligned for its type
+struct destructor_entry {
+public:
+    destructor_entry(void (*destroy)(destructor_entry*), destructor_entry* prev) noexcept;
+
+    void (*destroy)(destructor_entry*);
+    destructor_entry* prev;
+};
+
+} // namespace amber::internal
+
 class linear_allocator {
 public:
+    // Description of an allocator, see snapshot.hpp
+    struct state {
+    public:
+        std::size_t buffer_offset;
+    };
+
     linear_allocator() = delete;
 
     linear_allocator(const linear_allocator&) = delete;
@@ -27,31 +48,100 @@ public:
     static
     std::expected<linear_allocator, std::string> create(B& buffer) noexcept;
 
+    // Recreates an allocator over buffer, which holds the contents of the buffer
+    // described by s
+    template<Buffer B>
+    static
+    std::expected<linear_allocator, std::string> restore(B& buffer, const state& s) noexcept;
+
+    // Takes up the new capacity of buffer after it grew in place, fails when
+    // the buffer moved or shrank
+    template<Buffer B>
+    std::expected<void, std::string> extend(B& buffer) noexcept;
+
+    // Fails while non-trivially destructible objects are alive, they cannot be persisted
+    std::expected<state, std::string> save_state() const noexcept;
+
     std::expected<void*, std::string> allocate(
         std::size_t alignment, std::size_t size) noexcept;
 
     std::expected<void*, std::string> allocate(std::size_t size) noexcept;
 
+    // Non-trivially destructible objects are destroyed in reverse order of
+    // allocation by reset() and rewind(). A constructor that throws leaves the
+    // allocator as it was and the error is returned instead.
     template<typename T, typename... Args>
-    requires std::is_trivially_destructible_v<T>
+    requires std::is_nothrow_destructible_v<T>
     std::expected<T*, std::string> allocate(Args&&... args) noexcept;
 
+    // Resizes ptr in place, only possible when ptr is the most recent allocation
+    bool try_extend(void* ptr, std::size_t old_size, std::size_t new_size) noexcept;
+
+    // Releases the tail of ptr when it is the most recent allocation
+    bool shrink(void* ptr, std::size_t old_size, std::size_t new_size) noexcept;
+
+    // Resizes in place when possible, otherwise allocates and copies
+    std::expected<void*, std::string> reallocate(
+        void* ptr, std::size_t old_size, std::size_t alignment, std::size_t new_size) noexcept;
+
+    std::expected<void*, std::string> reallocate(
+        void* ptr, std::size_t old_size, std::size_t new_size) noexcept;
+
     void reset() noexcept;
 
+    // Releases everything allocated after buffer_offset, a value previously
+    // returned by buffer_offset()
+    void rewind(std::size_t buffer_offset) noexcept;
+
     std::size_t buffer_size() const noexcept;
 
+    // Whether ptr points into the buffer
+    bool owns(const void* ptr) const noexcept;
+
     std::size_t buffer_offset() const noexcept;
 
+    // Bytes above buffer_offset() written since the last purge
+    std::size_t dirty_size() const noexcept;
+
+    // Returns pages above buffer_offset() + keep_size that were written since
+    // the last purge to the OS, keep_size leaves headroom for reuse. Returns
+    // the number of bytes released.
+    std::expected<std::size_t, std::string> purge(purge_mode mode, std::size_t keep_size) noexcept;
+
+    std::expected<std::size_t, std::string> purge(purge_mode mode) noexcept;
+
 private:
     linear_allocator(
         std::span<std::byte> buffer,
-        std::size_t buffer_offset
+        std::size_t buffer_offset,
+        internal::destructor_entry* destructor_head
     ) noexcept;
 
+    template<typename T>
+    static
+    void destroy_entry(internal::destructor_entry* entry) noexcept;
+
+    // Constructs T at ptr, rolling the offset back to prev_offset when the
+    // constructor throws
+    template<typename T, typename... Args>
+    std::expected<T*, std::string> construct(void* ptr, std::size_t prev_offset, Args&&... args) noexcept;
+
+    // Takes size bytes at alignment without profiling them, nullptr when
+    // they do not fit
+    void* bump(std::size_t alignment, std::size_t size) noexcept;
+
+    void run_destructors(std::size_t buffer_offset) noexcept;
+
     std::span<std::byte> buffer_;
     std::size_t buffer_offset_;
+    // Highest offset reached since the last purge, updated when the offset drops
+    std::size_t high_water_;
+    internal::destructor_entry* destructor_head_;
 };
 
+static_assert(ResizableAllocator<linear_allocator>);
+static_assert(OwningAllocator<linear_allocator>);
+
 } // namespace amber
 
 #include <amber/linear_allocator.inl>
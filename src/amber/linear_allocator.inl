@@ -1,7 +1,9 @@
+#include <algorithm>
+#include <amber/heap_profiler.hpp>
 #include <amber/util.hpp>
+#include <cstdint>
 #include <format>
 #include <memory>
-#include <memory>
 #include <mica/mica.hpp>
 #include <new>
 #include <utility>
@@ -24,19 +26,101 @@ std::expected<linear_allocator, std::string> linear_allocator::create(B& buffer)
         }
         return std::unexpected(std::move(exp_msg).value());
     }
-    return linear_allocator(buffer_span, 0);
+    return linear_allocator(buffer_span, 0, nullptr);
+}
+
+template<Buffer B>
+std::expected<linear_allocator, std::string> linear_allocator::restore(B& buffer, const state& s) noexcept
+{
+    auto exp_alloc = create(buffer);
+    if (!exp_alloc.has_value()) [[unlikely]] {
+        return exp_alloc;
+    }
+    if (s.buffer_offset > exp_alloc.value().buffer_size()) [[unlikely]] {
+        return std::unexpected("invalid linear allocator state");
+    }
+    exp_alloc.value().buffer_offset_ = s.buffer_offset;
+    return exp_alloc;
+}
+
+template<Buffer B>
+std::expected<void, std::string> linear_allocator::extend(B& buffer) noexcept
+{
+    std::span<std::byte> buffer_span = buffer.buffer();
+    if (buffer_span.data() != buffer_.data()) [[unlikely]] {
+        return std::unexpected("buffer moved");
+    }
+    if (buffer_span.size() < buffer_.size()) [[unlikely]] {
+        return std::unexpected("buffer shrunk");
+    }
+    buffer_ = buffer_span;
+    return {};
 }
 
 template<typename T, typename... Args>
-requires std::is_trivially_destructible_v<T>
+requires std::is_nothrow_destructible_v<T>
 std::expected<T*, std::string> linear_allocator::allocate(Args&&... args) noexcept
 {
-    auto exp_ptr = allocate(alignof(T), sizeof(T));
-    if (!exp_ptr.has_value()) [[unlikely]] {
-        return std::unexpected(std::move(exp_ptr).error());
+    if constexpr (std::is_trivially_destructible_v<T>) {
+        std::size_t prev_offset = buffer_offset_;
+        auto exp_ptr = allocate(alignof(T), sizeof(T));
+        if (!exp_ptr.has_value()) [[unlikely]] {
+            return std::unexpected(std::move(exp_ptr).error());
+        }
+        return construct<T>(exp_ptr.value(), prev_offset, std::forward<Args>(args)...);
+    } else {
+        // The entry is bookkeeping, only the object is charged to the caller
+        std::size_t prev_offset = buffer_offset_;
+        void* entry = bump(alignof(internal::destructor_entry), sizeof(internal::destructor_entry));
+        if (entry == nullptr) [[unlikely]] {
+            return std::unexpected("out of capacity");
+        }
+        auto exp_ptr = allocate(alignof(T), sizeof(T));
+        if (!exp_ptr.has_value()) [[unlikely]] {
+            high_water_ = std::max(high_water_, buffer_offset_);
+            buffer_offset_ = prev_offset;
+            return std::unexpected(std::move(exp_ptr).error());
+        }
+        auto exp_obj = construct<T>(exp_ptr.value(), prev_offset, std::forward<Args>(args)...);
+        if (!exp_obj.has_value()) [[unlikely]] {
+            return exp_obj;
+        }
+
+        internal::destructor_entry* entry_ptr = std::assume_aligned<alignof(internal::destructor_entry)>(
+            static_cast<internal::destructor_entry*>(entry)
+        );
+        entry_ptr = std::launder(std::construct_at(entry_ptr, &destroy_entry<T>, destructor_head_));
+        destructor_head_ = entry_ptr;
+        return exp_obj;
+    }
+}
+
+template<typename T, typename... Args>
+std::expected<T*, std::string> linear_allocator::construct(
+    void* ptr, std::size_t prev_offset, Args&&... args) noexcept
+{
+    T* obj_ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(ptr));
+    if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+        (void)prev_offset;
+        return std::launder(std::construct_at(obj_ptr, std::forward<Args>(args)...));
+    } else {
+        try {
+            return std::launder(std::construct_at(obj_ptr, std::forward<Args>(args)...));
+        } catch (...) {
+            internal::heap_profile_free(ptr);
+            high_water_ = std::max(high_water_, buffer_offset_);
+            buffer_offset_ = prev_offset;
+            return std::unexpected("constructor threw");
+        }
     }
-    T* ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(exp_ptr.value()));
-    return std::launder(std::construct_at(ptr, std::forward<Args>(args)...));
+}
+
+template<typename T>
+void linear_allocator::destroy_entry(internal::destructor_entry* entry) noexcept
+{
+    std::uintptr_t entry_end = reinterpret_cast<std::uintptr_t>(entry) + sizeof(internal::destructor_entry);
+    std::uintptr_t object_addr = align_forward(static_cast<std::uintptr_t>(alignof(T)), entry_end);
+    std::destroy_at(std::launder(reinterpret_cast<T*>(object_addr)));
 }
 
 } // namespace amber
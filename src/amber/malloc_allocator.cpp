@@ -0,0 +1,22 @@
+#include <amber/malloc_allocator.hpp>
+#include <amber/util.hpp>
+
+namespace amber {
+
+std::expected<void*, std::string> malloc_allocator::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    return aligned_alloc(alignment, size);
+}
+
+std::expected<void*, std::string> malloc_allocator::allocate(std::size_t size) noexcept
+{
+    return aligned_alloc(alignof(std::max_align_t), size);
+}
+
+void malloc_allocator::free(void* ptr) noexcept
+{
+    aligned_free(ptr);
+}
+
+} // namespace amber
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+// Stateless allocator over the system heap, typically the last resort of a
+// composed allocator such as fallback_allocator
+class malloc_allocator {
+public:
+    malloc_allocator() noexcept = default;
+
+    malloc_allocator(const malloc_allocator&) = delete;
+
+    malloc_allocator(malloc_allocator&& other) noexcept = default;
+
+    malloc_allocator& operator=(const malloc_allocator&) = delete;
+
+    malloc_allocator& operator=(malloc_allocator&& other) noexcept = default;
+
+    ~malloc_allocator() noexcept = default;
+
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    std::expected<void*, std::string> allocate(std::size_t size) noexcept;
+
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    void free(void* ptr) noexcept;
+
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T>
+    void free(T* ptr) noexcept;
+};
+
+static_assert(DeallocatingAllocator<malloc_allocator>);
+
+} // namespace amber
+
+#include <amber/malloc_allocator.inl>
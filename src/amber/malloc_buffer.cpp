@@ -44,6 +44,22 @@ std::expected<malloc_buffer, std::string> malloc_buffer::create(std::size_t size
     return malloc_buffer(buffer, size);
 }
 
+std::expected<void, std::string> malloc_buffer::grow(std::size_t size) noexcept
+{
+    if (size < size_) [[unlikely]] {
+        return std::unexpected("invalid size");
+    }
+    return resize(size);
+}
+
+std::expected<void, std::string> malloc_buffer::shrink(std::size_t size) noexcept
+{
+    if (size == 0 || size > size_) [[unlikely]] {
+        return std::unexpected("invalid size");
+    }
+    return resize(size);
+}
+
 std::span<std::byte> malloc_buffer::buffer() noexcept
 {
     return std::span(buffer_, size_);
@@ -64,4 +80,22 @@ malloc_buffer::malloc_buffer(std::byte* buffer, std::size_t size) noexcept
     size_(size)
 {}
 
+std::expected<void, std::string> malloc_buffer::resize(std::size_t size) noexcept
+{
+    if (size == size_) {
+        return {};
+    }
+    std::byte* buffer = static_cast<std::byte*>(std::realloc(buffer_, size));
+    if (buffer == nullptr) [[unlikely]] {
+        auto&& exp_msg = mica::format("realloc failed, old size: {}, new size: {}", size_, size);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling realloc error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    buffer_ = buffer;
+    size_ = size;
+    return {};
+}
+
 } // namespace amber
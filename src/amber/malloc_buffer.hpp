@@ -25,6 +25,11 @@ public:
     static
     std::expected<malloc_buffer, std::string> create(std::size_t size) noexcept;
 
+    // Resizes with realloc, which may move and copy the contents
+    std::expected<void, std::string> grow(std::size_t size) noexcept;
+
+    std::expected<void, std::string> shrink(std::size_t size) noexcept;
+
     std::span<std::byte> buffer() noexcept;
 
     const std::span<std::byte> buffer() const noexcept;
@@ -34,10 +39,12 @@ public:
 private:
     malloc_buffer(std::byte* buffer, std::size_t size) noexcept;
 
+    std::expected<void, std::string> resize(std::size_t size) noexcept;
+
     std::byte* buffer_;
     std::size_t size_;
 };
 
-static_assert(Buffer<malloc_buffer>);
+static_assert(ResizableBuffer<malloc_buffer>);
 
 } // namespace amber
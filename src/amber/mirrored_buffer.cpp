@@ -0,0 +1,154 @@
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+}
+#include <amber/mirrored_buffer.hpp>
+#include <amber/util.hpp>
+#include <cerrno>
+#include <cstring>
+#include <mica/mica.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace amber {
+
+namespace {
+
+std::string mirrored_error(const char* call, int error, std::size_t size) noexcept
+{
+    auto&& exp_msg = mica::format(
+        "{} failed, error: {}, size: {}", call, std::strerror(error), size);
+    if (!exp_msg.has_value()) [[unlikely]] {
+        return "formatting failed while handling mirrored mapping error";
+    }
+    return std::move(exp_msg).value();
+}
+
+} // unnamed namespace
+
+mirrored_buffer::mirrored_buffer(mirrored_buffer&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, nullptr)),
+    size_(std::exchange(other.size_, 0))
+{}
+
+mirrored_buffer& mirrored_buffer::operator=(mirrored_buffer&& other) noexcept
+{
+    if (this != &other) {
+        if (buffer_ != nullptr) {
+            munmap(buffer_, 2 * size_);
+            buffer_ = nullptr;
+        }
+        buffer_ = std::exchange(other.buffer_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+mirrored_buffer::~mirrored_buffer() noexcept
+{
+    if (buffer_ != nullptr) {
+        munmap(buffer_, 2 * size_);
+    }
+    buffer_ = nullptr;
+    size_ = 0;
+}
+
+std::expected<mirrored_buffer, std::string> mirrored_buffer::create(
+    std::size_t size, mmap_flag flags) noexcept
+{
+    if (size == 0 || (size % page_size()) != 0) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "size must be a multiple of the page size, size: {}, page size: {}",
+            size, page_size()
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling size error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    // Both views must be shared file mappings of the same pages at the
+    // reserved addresses, flags that change the kind of mapping are refused
+    mmap_flag allowed_flags = mmap_flag::shared | mmap_flag::fixed | mmap_flag::nonblock
+        | mmap_flag::no_reserve | mmap_flag::populate;
+    if ((flags & ~allowed_flags) != mmap_flag::none) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "unsupported mirrored mapping flags: {:#x}", static_cast<int>(flags & ~allowed_flags));
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling flags error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+
+    int fd = memfd_create("amber_mirrored_buffer", MFD_CLOEXEC);
+    if (fd == -1) [[unlikely]] {
+        return std::unexpected(mirrored_error("memfd_create", errno, size));
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1) [[unlikely]] {
+        int error = errno;
+        close(fd);
+        return std::unexpected(mirrored_error("ftruncate", error, size));
+    }
+
+    // Reserve both halves first so the two views are guaranteed adjacent
+    mmap_flag reserve_flags = mmap_flag::private_map | mmap_flag::anonymous | mmap_flag::no_reserve;
+    std::byte* buffer = static_cast<std::byte*>(mmap(
+        nullptr, 2 * size, static_cast<int>(mmap_prot::none), static_cast<int>(reserve_flags), -1, 0));
+    if (buffer == MAP_FAILED) [[unlikely]] {
+        int error = errno;
+        close(fd);
+        return std::unexpected(mirrored_error("mmap", error, size));
+    }
+
+    mmap_prot prot = mmap_prot::read | mmap_prot::write;
+    flags |= mmap_flag::shared | mmap_flag::fixed;
+    for (std::byte* view : {buffer, buffer + size}) {
+        void* ptr = mmap(view, size, static_cast<int>(prot), static_cast<int>(flags), fd, 0);
+        if (ptr == MAP_FAILED) [[unlikely]] {
+            int error = errno;
+            munmap(buffer, 2 * size);
+            close(fd);
+            return std::unexpected(mirrored_error("mmap", error, size));
+        }
+    }
+    // The mappings keep the memory alive
+    close(fd);
+    return mirrored_buffer(buffer, size);
+}
+
+std::expected<mirrored_buffer, std::string> mirrored_buffer::create(std::size_t size) noexcept
+{
+    return mirrored_buffer::create(size, mmap_flag::none);
+}
+
+std::span<std::byte> mirrored_buffer::buffer() noexcept
+{
+    return std::span(buffer_, size_);
+}
+
+const std::span<std::byte> mirrored_buffer::buffer() const noexcept
+{
+    return std::span(buffer_, size_);
+}
+
+std::span<std::byte> mirrored_buffer::window(std::size_t offset, std::size_t length) noexcept
+{
+    return std::span(buffer_ + (offset % size_), length);
+}
+
+const std::span<std::byte> mirrored_buffer::window(std::size_t offset, std::size_t length) const noexcept
+{
+    return std::span(buffer_ + (offset % size_), length);
+}
+
+std::size_t mirrored_buffer::size() const noexcept
+{
+    return size_;
+}
+
+mirrored_buffer::mirrored_buffer(std::byte* buffer, std::size_t size) noexcept
+    : buffer_(buffer),
+    size_(size)
+{}
+
+} // namespace amber
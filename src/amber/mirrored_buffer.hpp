@@ -0,0 +1,60 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <amber/mmap_buffer.hpp>
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string>
+
+namespace amber {
+
+// Ring buffer memory mapped twice back to back, so any window of up to size()
+// bytes is contiguous in virtual memory regardless of where it starts.
+// size must be a multiple of the page size.
+class mirrored_buffer {
+public:
+    mirrored_buffer() = delete;
+
+    mirrored_buffer(const mirrored_buffer&) = delete;
+
+    mirrored_buffer(mirrored_buffer&& other) noexcept;
+
+    mirrored_buffer& operator=(const mirrored_buffer&) = delete;
+
+    mirrored_buffer& operator=(mirrored_buffer&& other) noexcept;
+
+    ~mirrored_buffer() noexcept;
+
+    // flags are added to the shared fixed mappings, e.g. mmap_flag::populate.
+    // Only nonblock, no_reserve and populate are accepted, flags that would
+    // make the views private, anonymous or huge page backed are an error.
+    static
+    std::expected<mirrored_buffer, std::string> create(
+        std::size_t size, mmap_flag flags) noexcept;
+
+    static
+    std::expected<mirrored_buffer, std::string> create(std::size_t size) noexcept;
+
+    std::span<std::byte> buffer() noexcept;
+
+    const std::span<std::byte> buffer() const noexcept;
+
+    // Contiguous view of length bytes starting at offset modulo size(),
+    // length must not exceed size()
+    std::span<std::byte> window(std::size_t offset, std::size_t length) noexcept;
+
+    const std::span<std::byte> window(std::size_t offset, std::size_t length) const noexcept;
+
+    std::size_t size() const noexcept;
+
+private:
+    mirrored_buffer(std::byte* buffer, std::size_t size) noexcept;
+
+    std::byte* buffer_;
+    std::size_t size_;
+};
+
+static_assert(Buffer<mirrored_buffer>);
+
+} // namespace amber
@@ -7,14 +7,6 @@
 
 namespace amber {
 
-enum class mmap_prot : int {
-    exec = PROT_EXEC,
-    read = PROT_READ,
-    write = PROT_WRITE,
-    none = PROT_NONE,
-};
-AMBER_BITWISE_ENUM(mmap_prot);
-
 mmap_buffer::mmap_buffer(mmap_buffer&& other) noexcept
     : buffer_(std::exchange(other.buffer_, nullptr)),
     size_(std::exchange(other.size_, 0))
@@ -44,9 +36,28 @@ mmap_buffer::~mmap_buffer() noexcept
 
 std::expected<mmap_buffer, std::string> mmap_buffer::create(
     std::size_t size, mmap_flag flags) noexcept
+{
+    return mmap_buffer::create_lazy(size, flags | mmap_flag::populate);
+}
+
+std::expected<mmap_buffer, std::string> mmap_buffer::create(std::size_t size) noexcept
+{
+    mmap_flag flags = mmap_flag::private_map | mmap_flag::populate | mmap_flag::anonymous;
+    return mmap_buffer::create(size, flags);
+}
+
+std::expected<mmap_buffer, std::string> mmap_buffer::create_lazy(
+    std::size_t size, mmap_flag flags) noexcept
 {
     mmap_prot prot = mmap_prot::read | mmap_prot::write;
-    flags |= mmap_flag::private_map | mmap_flag::populate | mmap_flag::anonymous;
+    // MAP_SHARED | MAP_PRIVATE is MAP_SHARED_VALIDATE, private_map is only
+    // the default when shared is not asked for
+    if ((flags & mmap_flag::shared) == mmap_flag::none) {
+        flags |= mmap_flag::private_map;
+    } else if ((flags & mmap_flag::private_map) != mmap_flag::none) [[unlikely]] {
+        return std::unexpected("shared and private_map flags are exclusive");
+    }
+    flags |= mmap_flag::anonymous;
     std::byte* buffer = static_cast<std::byte*>(mmap(
         nullptr, size, static_cast<int>(prot), static_cast<int>(flags), -1, 0));
     if (buffer == MAP_FAILED) [[unlikely]] {
@@ -63,10 +74,34 @@ std::expected<mmap_buffer, std::string> mmap_buffer::create(
     return mmap_buffer(buffer, size);
 }
 
-std::expected<mmap_buffer, std::string> mmap_buffer::create(std::size_t size) noexcept
+std::expected<mmap_buffer, std::string> mmap_buffer::create_lazy(std::size_t size) noexcept
 {
-    mmap_flag flags = mmap_flag::private_map | mmap_flag::populate | mmap_flag::anonymous;
-    return mmap_buffer::create(size, flags);
+    mmap_flag flags = mmap_flag::private_map | mmap_flag::anonymous;
+    return mmap_buffer::create_lazy(size, flags);
+}
+
+std::expected<void, std::string> mmap_buffer::grow(std::size_t size) noexcept
+{
+    if (size < size_) [[unlikely]] {
+        return std::unexpected("invalid size");
+    }
+    return resize(size, MREMAP_MAYMOVE);
+}
+
+std::expected<void, std::string> mmap_buffer::grow_in_place(std::size_t size) noexcept
+{
+    if (size < size_) [[unlikely]] {
+        return std::unexpected("invalid size");
+    }
+    return resize(size, 0);
+}
+
+std::expected<void, std::string> mmap_buffer::shrink(std::size_t size) noexcept
+{
+    if (size == 0 || size > size_) [[unlikely]] {
+        return std::unexpected("invalid size");
+    }
+    return resize(size, 0);
 }
 
 std::span<std::byte> mmap_buffer::buffer() noexcept
@@ -89,4 +124,25 @@ mmap_buffer::mmap_buffer(std::byte* buffer, std::size_t size) noexcept
     size_(size)
 {}
 
+std::expected<void, std::string> mmap_buffer::resize(std::size_t size, int flags) noexcept
+{
+    if (size == size_) {
+        return {};
+    }
+    void* buffer = mremap(buffer_, size_, size, flags);
+    if (buffer == MAP_FAILED) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "mremap failed, error: {}, old size: {}, new size: {}",
+            std::strerror(errno), size_, size
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling mremap error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    buffer_ = static_cast<std::byte*>(buffer);
+    size_ = size;
+    return {};
+}
+
 } // namespace amber
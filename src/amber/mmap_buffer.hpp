@@ -14,7 +14,10 @@ namespace amber {
 
 enum class mmap_flag : int {
     none = 0,
+    shared = MAP_SHARED,
     private_map = MAP_PRIVATE,
+    fixed = MAP_FIXED,
+    fixed_noreplace = MAP_FIXED_NOREPLACE,
     anonymous = MAP_ANONYMOUS,
     huge_table = MAP_HUGETLB,
     huge_2mb = MAP_HUGE_2MB,
@@ -25,6 +28,14 @@ enum class mmap_flag : int {
 };
 AMBER_BITWISE_ENUM(mmap_flag);
 
+enum class mmap_prot : int {
+    exec = PROT_EXEC,
+    read = PROT_READ,
+    write = PROT_WRITE,
+    none = PROT_NONE,
+};
+AMBER_BITWISE_ENUM(mmap_prot);
+
 class mmap_buffer {
 public:
     mmap_buffer() = delete;
@@ -39,6 +50,8 @@ public:
 
     ~mmap_buffer() noexcept;
 
+    // Anonymous and private unless flags has shared, which maps memory that
+    // is shared with forked children
     static
     std::expected<mmap_buffer, std::string> create(
         std::size_t size, mmap_flag flags) noexcept;
@@ -46,6 +59,25 @@ public:
     static
     std::expected<mmap_buffer, std::string> create(std::size_t size) noexcept;
 
+    // Maps without MAP_POPULATE, pages are faulted in on first touch or by
+    // prefault() / prefault_task
+    static
+    std::expected<mmap_buffer, std::string> create_lazy(
+        std::size_t size, mmap_flag flags) noexcept;
+
+    static
+    std::expected<mmap_buffer, std::string> create_lazy(std::size_t size) noexcept;
+
+    // Resizes with mremap, the mapping may move but nothing is copied
+    std::expected<void, std::string> grow(std::size_t size) noexcept;
+
+    // Fails instead of moving when the pages after the mapping are taken,
+    // allocators over the buffer can then be extended
+    std::expected<void, std::string> grow_in_place(std::size_t size) noexcept;
+
+    // Unmaps the tail, never moves
+    std::expected<void, std::string> shrink(std::size_t size) noexcept;
+
     std::span<std::byte> buffer() noexcept;
 
     const std::span<std::byte> buffer() const noexcept;
@@ -55,10 +87,12 @@ public:
 private:
     mmap_buffer(std::byte* buffer, std::size_t size) noexcept;
 
+    std::expected<void, std::string> resize(std::size_t size, int flags) noexcept;
+
     std::byte* buffer_;
     std::size_t size_;
 };
 
-static_assert(Buffer<mmap_buffer>);
+static_assert(ResizableBuffer<mmap_buffer>);
 
 } // namespace amber
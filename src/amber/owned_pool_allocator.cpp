@@ -0,0 +1,221 @@
+#include <amber/owned_pool_allocator.hpp>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+namespace internal {
+
+owned_pool_entry::owned_pool_entry(owned_pool_entry* next) noexcept
+    : next(next)
+{}
+
+} // namespace amber::internal
+
+namespace {
+
+// Marks a remote entry whose link is not yet written, the pusher is between
+// its exchange and the following store
+internal::owned_pool_entry* const link_pending = reinterpret_cast<internal::owned_pool_entry*>(
+    alignof(internal::owned_pool_entry));
+
+} // unnamed namespace
+
+owned_pool_allocator::owned_pool_allocator(owned_pool_allocator&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, std::span<std::byte>())),
+    free_head_(std::exchange(other.free_head_, nullptr)),
+    entry_size_(std::exchange(other.entry_size_, 0)),
+    entry_alignment_(std::exchange(other.entry_alignment_, 0)),
+    entry_count_(std::exchange(other.entry_count_, 0)),
+    entry_allocate_count_(std::exchange(other.entry_allocate_count_, 0)),
+    owner_(other.owner_.exchange(std::thread::id(), std::memory_order_acq_rel)),
+    remote_head_(other.remote_head_.exchange(nullptr, std::memory_order_relaxed))
+{}
+
+owned_pool_allocator& owned_pool_allocator::operator=(owned_pool_allocator&& other) noexcept
+{
+    if (this != &other) {
+        buffer_ = std::exchange(other.buffer_, std::span<std::byte>());
+        free_head_ = std::exchange(other.free_head_, nullptr);
+        entry_size_ = std::exchange(other.entry_size_, 0);
+        entry_alignment_ = std::exchange(other.entry_alignment_, 0);
+        entry_count_ = std::exchange(other.entry_count_, 0);
+        entry_allocate_count_ = std::exchange(other.entry_allocate_count_, 0);
+        owner_.store(
+            other.owner_.exchange(std::thread::id(), std::memory_order_acq_rel), std::memory_order_release);
+        remote_head_.store(
+            other.remote_head_.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    return *this;
+}
+
+owned_pool_allocator::~owned_pool_allocator() noexcept
+{
+    buffer_ = std::span<std::byte>();
+    free_head_ = nullptr;
+    entry_size_ = 0;
+    entry_alignment_ = 0;
+    entry_count_ = 0;
+    entry_allocate_count_ = 0;
+    owner_.store(std::thread::id(), std::memory_order_relaxed);
+    remote_head_.store(nullptr, std::memory_order_relaxed);
+}
+
+std::expected<void*, std::string> owned_pool_allocator::allocate() noexcept
+{
+    if (free_head_ == nullptr) [[unlikely]] {
+        if (reclaim() == 0) {
+            return std::unexpected("out of capacity");
+        }
+    }
+    internal::owned_pool_entry* entry_ptr = free_head_;
+    free_head_ = entry_ptr->next.load(std::memory_order_relaxed);
+    // Only the payload after the link is zeroed non-atomically
+    entry_ptr->next.store(nullptr, std::memory_order_relaxed);
+    std::memset(
+        reinterpret_cast<std::byte*>(entry_ptr) + sizeof(internal::owned_pool_entry), 0,
+        entry_size_ - sizeof(internal::owned_pool_entry)
+    );
+    entry_allocate_count_ += 1;
+    return entry_ptr;
+}
+
+std::expected<void*, std::string> owned_pool_allocator::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    if (!std::has_single_bit(alignment)) [[unlikely]] {
+        auto&& exp_msg = mica::format("invalid alignment: {}", alignment);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    if (size > entry_size_) [[unlikely]] {
+        return std::unexpected("size too large");
+    }
+    if (alignment > entry_alignment_) [[unlikely]] {
+        return std::unexpected("alignment too large");
+    }
+    return allocate();
+}
+
+void owned_pool_allocator::free(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    if (std::this_thread::get_id() == owner_.load(std::memory_order_acquire)) [[likely]] {
+        free_local(ptr);
+    } else {
+        free_remote(ptr);
+    }
+}
+
+void owned_pool_allocator::free_remote(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    internal::owned_pool_entry* entry_ptr = std::assume_aligned<alignof(internal::owned_pool_entry)>(
+        static_cast<internal::owned_pool_entry*>(ptr)
+    );
+    entry_ptr = std::launder(std::construct_at(entry_ptr, link_pending));
+    internal::owned_pool_entry* prev = remote_head_.exchange(entry_ptr, std::memory_order_acq_rel);
+    entry_ptr->next.store(prev, std::memory_order_release);
+}
+
+std::size_t owned_pool_allocator::reclaim() noexcept
+{
+    if (remote_head_.load(std::memory_order_relaxed) == nullptr) {
+        return 0;
+    }
+    internal::owned_pool_entry* entry_ptr = remote_head_.exchange(nullptr, std::memory_order_acquire);
+    std::size_t count = 0;
+    while (entry_ptr != nullptr) {
+        internal::owned_pool_entry* next = entry_ptr->next.load(std::memory_order_acquire);
+        while (next == link_pending) [[unlikely]] {
+            std::this_thread::yield();
+            next = entry_ptr->next.load(std::memory_order_acquire);
+        }
+        entry_ptr->next.store(free_head_, std::memory_order_relaxed);
+        free_head_ = entry_ptr;
+        entry_ptr = next;
+        count += 1;
+    }
+    entry_allocate_count_ -= count;
+    return count;
+}
+
+void owned_pool_allocator::take_ownership() noexcept
+{
+    owner_.store(std::this_thread::get_id(), std::memory_order_release);
+}
+
+bool owned_pool_allocator::owns(const void* ptr) const noexcept
+{
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    std::uintptr_t begin_addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+    return addr >= begin_addr && addr - begin_addr < entry_count_ * entry_size_;
+}
+
+std::thread::id owned_pool_allocator::owner() const noexcept
+{
+    return owner_.load(std::memory_order_acquire);
+}
+
+std::size_t owned_pool_allocator::buffer_size() const noexcept
+{
+    return buffer_.size();
+}
+
+std::size_t owned_pool_allocator::entry_size() const noexcept
+{
+    return entry_size_;
+}
+
+std::size_t owned_pool_allocator::entry_alignment() const noexcept
+{
+    return entry_alignment_;
+}
+
+std::size_t owned_pool_allocator::entry_count() const noexcept
+{
+    return entry_count_;
+}
+
+std::size_t owned_pool_allocator::entry_allocate_count() const noexcept
+{
+    return entry_allocate_count_;
+}
+
+owned_pool_allocator::owned_pool_allocator(
+    std::span<std::byte> buffer,
+    internal::owned_pool_entry* free_head,
+    std::size_t entry_size,
+    std::size_t entry_alignment,
+    std::size_t entry_count
+) noexcept
+    : buffer_(buffer),
+    free_head_(free_head),
+    entry_size_(entry_size),
+    entry_alignment_(entry_alignment),
+    entry_count_(entry_count),
+    entry_allocate_count_(0),
+    owner_(std::this_thread::get_id()),
+    remote_head_(nullptr)
+{}
+
+void owned_pool_allocator::free_local(void* ptr) noexcept
+{
+    internal::owned_pool_entry* entry_ptr = std::assume_aligned<alignof(internal::owned_pool_entry)>(
+        static_cast<internal::owned_pool_entry*>(ptr)
+    );
+    free_head_ = std::launder(std::construct_at(entry_ptr, free_head_));
+    entry_allocate_count_ -= 1;
+}
+
+} // namespace amber
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <amber/util.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace amber {
+
+namespace internal {
+
+struct owned_pool_entry {
+public:
+    owned_pool_entry(owned_pool_entry* next) noexcept;
+
+    std::atomic<owned_pool_entry*> next;
+};
+
+} // namespace amber::internal
+
+// Pool allocator owned by one thread that other threads may free into. The
+// owner allocates and frees on a plain local free list. A free from any other
+// thread is pushed onto the pool's remote list with a single atomic exchange,
+// and the owner takes the whole remote list back with one exchange once its
+// local list runs dry.
+class owned_pool_allocator {
+public:
+    owned_pool_allocator() = delete;
+
+    owned_pool_allocator(const owned_pool_allocator&) = delete;
+
+    // Moving is not thread-safe, no thread may free into either pool
+    owned_pool_allocator(owned_pool_allocator&& other) noexcept;
+
+    owned_pool_allocator& operator=(const owned_pool_allocator&) = delete;
+
+    owned_pool_allocator& operator=(owned_pool_allocator&& other) noexcept;
+
+    ~owned_pool_allocator() noexcept;
+
+    // The calling thread becomes the owner
+    template<Buffer B>
+    static
+    std::expected<owned_pool_allocator, std::string> create(
+        B& buffer, std::size_t entry_size) noexcept;
+
+    template<Buffer B>
+    static
+    std::expected<owned_pool_allocator, std::string> create(
+        B& buffer, std::size_t entry_size, std::size_t entry_alignment) noexcept;
+
+    // Owner only
+    std::expected<void*, std::string> allocate() noexcept;
+
+    // Owner only
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    // Owner only
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    // Any thread, frees locally on the owner and remotely elsewhere
+    void free(void* ptr) noexcept;
+
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T>
+    void free(T* ptr) noexcept;
+
+    // Any thread, when the caller knows it is not the owner
+    void free_remote(void* ptr) noexcept;
+
+    // Owner only, moves remotely freed entries to the local free list and
+    // returns how many were moved
+    std::size_t reclaim() noexcept;
+
+    // Hands the pool to the calling thread, the previous owner must no
+    // longer use it
+    void take_ownership() noexcept;
+
+    bool owns(const void* ptr) const noexcept;
+
+    std::thread::id owner() const noexcept;
+
+    std::size_t buffer_size() const noexcept;
+
+    std::size_t entry_size() const noexcept;
+
+    std::size_t entry_alignment() const noexcept;
+
+    std::size_t entry_count() const noexcept;
+
+    // Owner only, entries freed remotely count until they are reclaimed
+    std::size_t entry_allocate_count() const noexcept;
+
+private:
+    owned_pool_allocator(
+        std::span<std::byte> buffer,
+        internal::owned_pool_entry* free_head,
+        std::size_t entry_size,
+        std::size_t entry_alignment,
+        std::size_t entry_count
+    ) noexcept;
+
+    void free_local(void* ptr) noexcept;
+
+    std::span<std::byte> buffer_;
+    // Owner state
+    internal::owned_pool_entry* free_head_;
+    std::size_t entry_size_;
+    std::size_t entry_alignment_;
+    std::size_t entry_count_;
+    std::size_t entry_allocate_count_;
+    // Read by freeing threads to pick the local or remote path
+    std::atomic<std::thread::id> owner_;
+    // Written by other threads, kept on its own cache line
+    alignas(cache_line_size) std::atomic<internal::owned_pool_entry*> remote_head_;
+};
+
+static_assert(DeallocatingAllocator<owned_pool_allocator>);
+static_assert(OwningAllocator<owned_pool_allocator>);
+
+} // namespace amber
+
+#include <amber/owned_pool_allocator.inl>
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+template<Buffer B>
+std::expected<owned_pool_allocator, std::string> owned_pool_allocator::create(
+    B& buffer, std::size_t entry_size) noexcept
+{
+    return create(buffer, entry_size, alignof(internal::owned_pool_entry));
+}
+
+template<Buffer B>
+std::expected<owned_pool_allocator, std::string> owned_pool_allocator::create(
+    B& buffer, std::size_t entry_size, std::size_t entry_alignment) noexcept
+{
+    if (!std::has_single_bit(entry_alignment)) [[unlikely]] {
+        auto&& exp_msg = mica::format("invalid alignment: {}", entry_alignment);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    std::span<std::byte> buffer_span = buffer.buffer();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_span.data());
+    entry_alignment = std::max(entry_alignment, alignof(internal::owned_pool_entry));
+    if (!is_aligned(static_cast<std::uintptr_t>(entry_alignment), buffer_addr)) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "invalid buffer alignment, buffer: {:#x}, target alignment: {}",
+            buffer_addr, entry_alignment
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    entry_size = std::max(entry_size, sizeof(internal::owned_pool_entry));
+    entry_size = align_forward(entry_alignment, entry_size);
+    std::size_t entry_count = buffer_span.size() / entry_size;
+
+    internal::owned_pool_entry* free_head = nullptr;
+    static_assert(std::is_nothrow_constructible_v<internal::owned_pool_entry, decltype(free_head)>);
+    for (std::size_t i = entry_count; i > 0; --i) {
+        std::byte* buffer_offset_ptr = buffer_span.data() + ((i - 1) * entry_size);
+        internal::owned_pool_entry* entry_ptr = reinterpret_cast<internal::owned_pool_entry*>(buffer_offset_ptr);
+        entry_ptr = std::assume_aligned<alignof(internal::owned_pool_entry)>(entry_ptr);
+        free_head = std::launder(std::construct_at(entry_ptr, free_head));
+    }
+
+    return owned_pool_allocator(buffer_span, free_head, entry_size, entry_alignment, entry_count);
+}
+
+template<typename T, typename... Args>
+requires std::is_nothrow_constructible_v<T, Args...>
+std::expected<T*, std::string> owned_pool_allocator::allocate(Args&&... args) noexcept
+{
+    if (sizeof(T) > entry_size_) [[unlikely]] {
+        return std::unexpected("type size too large");
+    }
+    if (alignof(T) > entry_alignment_) [[unlikely]] {
+        return std::unexpected("type alignment too large");
+    }
+    auto exp_ptr = allocate();
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    T* ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(std::move(exp_ptr).value()));
+    return std::launder(std::construct_at(ptr, std::forward<Args>(args)...));
+}
+
+template<typename T>
+requires std::is_nothrow_destructible_v<T>
+void owned_pool_allocator::free(T* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::destroy_at(ptr);
+    free(static_cast<void*>(ptr));
+}
+
+} // namespace amber
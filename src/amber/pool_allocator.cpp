@@ -1,6 +1,9 @@
+#include <amber/heap_profiler.hpp>
 #include <amber/pool_allocator.hpp>
+#include <bit>
 #include <cstring>
 #include <memory>
+#include <mica/mica.hpp>
 #include <new>
 #include <utility>
 
@@ -8,7 +11,7 @@ namespace amber {
 
 namespace internal {
 
-pool_entry::pool_entry(std::byte* next) noexcept
+pool_entry::pool_entry(std::size_t next) noexcept
     : next(next)
 {}
 
@@ -16,8 +19,10 @@ pool_entry::pool_entry(std::byte* next) noexcept
 
 pool_allocator::pool_allocator(pool_allocator&& other) noexcept
     : buffer_(std::exchange(other.buffer_, std::span<std::byte>())),
-    free_head_(std::exchange(other.free_head_, nullptr)),
+    free_head_(std::exchange(other.free_head_, no_entry)),
     entry_size_(std::exchange(other.entry_size_, 0)),
+    entry_alignment_(std::exchange(other.entry_alignment_, 0)),
+    slab_offset_(std::exchange(other.slab_offset_, 0)),
     entry_count_(std::exchange(other.entry_count_, 0)),
     entry_allocate_count_(std::exchange(other.entry_allocate_count_, 0))
 {}
@@ -25,8 +30,10 @@ pool_allocator::pool_allocator(pool_allocator&& other) noexcept
 pool_allocator::~pool_allocator() noexcept
 {
     buffer_ = std::span<std::byte>();
-    free_head_ = nullptr;
+    free_head_ = no_entry;
     entry_size_ = 0;
+    entry_alignment_ = 0;
+    slab_offset_ = 0;
     entry_count_ = 0;
     entry_allocate_count_ = 0;
 }
@@ -35,50 +42,123 @@ pool_allocator& pool_allocator::operator=(pool_allocator&& other) noexcept
 {
     if (this != &other) {
         buffer_ = std::exchange(other.buffer_, std::span<std::byte>());
-        free_head_ = std::exchange(other.free_head_, nullptr);
+        free_head_ = std::exchange(other.free_head_, no_entry);
         entry_size_ = std::exchange(other.entry_size_, 0);
+        entry_alignment_ = std::exchange(other.entry_alignment_, 0);
+        slab_offset_ = std::exchange(other.slab_offset_, 0);
         entry_count_ = std::exchange(other.entry_count_, 0);
         entry_allocate_count_ = std::exchange(other.entry_allocate_count_, 0);
     }
     return *this;
 }
 
+pool_allocator::state pool_allocator::save_state() const noexcept
+{
+    return state{
+        .base_address = reinterpret_cast<std::uintptr_t>(buffer_.data()),
+        .entry_size = entry_size_,
+        .entry_alignment = entry_alignment_,
+        .slab_offset = slab_offset_,
+        .entry_count = entry_count_,
+        .entry_allocate_count = entry_allocate_count_,
+        .free_head_offset = free_head_,
+    };
+}
+
 std::expected<void*, std::string> pool_allocator::allocate() noexcept
 {
-    if (free_head_ == nullptr) [[unlikely]] {
+    if (free_head_ == no_entry) [[unlikely]] {
         return std::unexpected("out of capacity");
     }
-    internal::pool_entry* entry_ptr = reinterpret_cast<internal::pool_entry*>(free_head_);
+    internal::pool_entry* entry_ptr = reinterpret_cast<internal::pool_entry*>(buffer_.data() + free_head_);
     entry_ptr = std::assume_aligned<alignof(internal::pool_entry)>(entry_ptr);
     free_head_ = entry_ptr->next;
     std::memset(reinterpret_cast<void*>(entry_ptr), 0, entry_size_);
     entry_allocate_count_ += 1;
+    internal::heap_profile_allocate(entry_ptr, entry_size_);
     return entry_ptr;
 }
 
+std::expected<void*, std::string> pool_allocator::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    if (!std::has_single_bit(alignment)) [[unlikely]] {
+        auto&& exp_msg = mica::format("invalid alignment: {}", alignment);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    if (size > entry_size_) [[unlikely]] {
+        return std::unexpected("size too large");
+    }
+    if (alignment > entry_alignment_) [[unlikely]] {
+        return std::unexpected("alignment too large");
+    }
+    return allocate();
+}
+
 void pool_allocator::free(void* ptr) noexcept
 {
     if (ptr == nullptr) {
         return;
     }
+    internal::heap_profile_free(ptr);
     internal::pool_entry* entry_ptr = std::assume_aligned<alignof(internal::pool_entry)>(
         static_cast<internal::pool_entry*>(ptr)
     );
     entry_ptr = std::launder(std::construct_at(entry_ptr, free_head_));
-    free_head_ = reinterpret_cast<std::byte*>(entry_ptr);
+    free_head_ = static_cast<std::size_t>(static_cast<std::byte*>(ptr) - buffer_.data());
     entry_allocate_count_ -= 1;
 }
 
+std::expected<std::size_t, std::string> pool_allocator::purge(purge_mode mode) noexcept
+{
+    std::size_t purge_size = 0;
+    for (std::size_t entry_offset = free_head_; entry_offset != no_entry;) {
+        std::byte* entry = buffer_.data() + entry_offset;
+        internal::pool_entry* entry_ptr = reinterpret_cast<internal::pool_entry*>(entry);
+        entry_ptr = std::assume_aligned<alignof(internal::pool_entry)>(entry_ptr);
+        // Keep the free list link at the start of the entry
+        std::span<std::byte> range(
+            entry + sizeof(internal::pool_entry), entry_size_ - sizeof(internal::pool_entry));
+        auto exp_size = purge_pages(range, mode);
+        if (!exp_size.has_value()) [[unlikely]] {
+            return std::unexpected(std::move(exp_size).error());
+        }
+        purge_size += exp_size.value();
+        entry_offset = entry_ptr->next;
+    }
+    return purge_size;
+}
+
 std::size_t pool_allocator::buffer_size() const noexcept
 {
     return buffer_.size();
 }
 
+bool pool_allocator::owns(const void* ptr) const noexcept
+{
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    std::uintptr_t begin_addr = reinterpret_cast<std::uintptr_t>(buffer_.data() + slab_offset_);
+    return addr >= begin_addr && addr - begin_addr < entry_count_ * entry_size_;
+}
+
 std::size_t pool_allocator::entry_size() const noexcept
 {
     return entry_size_;
 }
 
+std::size_t pool_allocator::entry_alignment() const noexcept
+{
+    return entry_alignment_;
+}
+
+std::size_t pool_allocator::slab_offset() const noexcept
+{
+    return slab_offset_;
+}
+
 std::size_t pool_allocator::entry_count() const noexcept
 {
     return entry_count_;
@@ -96,14 +176,18 @@ std::size_t pool_allocator::entry_free_count() const noexcept
 
 pool_allocator::pool_allocator(
     std::span<std::byte> buffer,
-    std::byte* free_head,
+    std::size_t free_head,
     std::size_t entry_size,
+    std::size_t entry_alignment,
+    std::size_t slab_offset,
     std::size_t entry_count,
     std::size_t entry_allocate_count
 ) noexcept
     : buffer_(buffer),
     free_head_(free_head),
     entry_size_(entry_size),
+    entry_alignment_(entry_alignment),
+    slab_offset_(slab_offset),
     entry_count_(entry_count),
     entry_allocate_count_(entry_allocate_count)
 {}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <amber/concept.hpp>
+#include <amber/purge.hpp>
 #include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <span>
 #include <string>
@@ -11,17 +13,36 @@ namespace amber {
 
 namespace internal {
 
+inline constexpr std::size_t no_pool_entry = static_cast<std::size_t>(-1);
+
 struct pool_entry {
 public:
-    pool_entry(std::byte* next) noexcept;
+    pool_entry(std::size_t next) noexcept;
 
-    std::byte* next;
+    // Buffer offset of the next free entry, no_pool_entry for the last one.
+    // Offsets stay valid wherever the buffer is mapped.
+    std::size_t next;
 };
 
 } // namespace amber::internal
 
 class pool_allocator {
 public:
+    // Address independent description of an allocator, see snapshot.hpp
+    struct state {
+    public:
+        std::uintptr_t base_address;
+        std::size_t entry_size;
+        std::size_t entry_alignment;
+        std::size_t slab_offset;
+        std::size_t entry_count;
+        std::size_t entry_allocate_count;
+        // Buffer offset of the first free entry, no_entry when the pool is full
+        std::size_t free_head_offset;
+    };
+
+    static constexpr std::size_t no_entry = internal::no_pool_entry;
+
     pool_allocator() = delete;
 
     pool_allocator(const pool_allocator&) = delete;
@@ -39,22 +60,70 @@ public:
     std::expected<pool_allocator, std::string> create(
         B& buffer, std::size_t entry_size) noexcept;
 
+    // Entries are placed on entry_alignment boundaries (e.g. cache_line_size
+    // to avoid false sharing between entries)
+    template<Buffer B>
+    static
+    std::expected<pool_allocator, std::string> create(
+        B& buffer, std::size_t entry_size, std::size_t entry_alignment) noexcept;
+
+    // color_offset shifts the first entry into the buffer so that pools with
+    // the same entry size do not map their entries onto the same cache sets
+    template<Buffer B>
+    static
+    std::expected<pool_allocator, std::string> create(
+        B& buffer,
+        std::size_t entry_size,
+        std::size_t entry_alignment,
+        std::size_t color_offset
+    ) noexcept;
+
+    // Recreates an allocator over buffer, which holds the contents of the buffer
+    // described by s. The free list is linked by offset, so buffer may live at
+    // a different address than the original and is never written; its free
+    // list is read once to check every link lands on an entry.
+    template<Buffer B>
+    static
+    std::expected<pool_allocator, std::string> restore(B& buffer, const state& s) noexcept;
+
+    state save_state() const noexcept;
+
+    // Adds the entries that fit in the new capacity of buffer after it grew
+    // in place to the free list, fails when the buffer moved or shrank
+    template<Buffer B>
+    std::expected<void, std::string> extend(B& buffer) noexcept;
+
     std::expected<void*, std::string> allocate() noexcept;
 
+    // Allocator interface, fails when size or alignment exceed the entry's
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
     template<typename T, typename... Args>
     requires std::is_nothrow_constructible_v<T, Args...>
     std::expected<T*, std::string> allocate(Args&&... args) noexcept;
 
     void free(void* ptr) noexcept;
 
+    // Returns the whole pages inside free entries to the OS, which only helps
+    // entries larger than a page. Returns the number of bytes released.
+    std::expected<std::size_t, std::string> purge(purge_mode mode) noexcept;
+
     template<typename T>
     requires std::is_nothrow_destructible_v<T>
     void free(T* ptr) noexcept;
 
     std::size_t buffer_size() const noexcept;
 
+    // Whether ptr points into the pool's entries
+    bool owns(const void* ptr) const noexcept;
+
     std::size_t entry_size() const noexcept;
 
+    std::size_t entry_alignment() const noexcept;
+
+    std::size_t slab_offset() const noexcept;
+
     std::size_t entry_count() const noexcept;
 
     std::size_t entry_allocate_count() const noexcept;
@@ -64,19 +133,27 @@ public:
 private:
     pool_allocator(
         std::span<std::byte> buffer,
-        std::byte* free_head,
+        std::size_t free_head,
         std::size_t entry_size,
+        std::size_t entry_alignment,
+        std::size_t slab_offset,
         std::size_t entry_count,
         std::size_t entry_allocate_count
     ) noexcept;
 
     std::span<std::byte> buffer_;
-    std::byte* free_head_;
+    // Buffer offset of the first free entry, no_entry when the pool is full
+    std::size_t free_head_;
     std::size_t entry_size_;
+    std::size_t entry_alignment_;
+    std::size_t slab_offset_;
     std::size_t entry_count_;
     std::size_t entry_allocate_count_;
 };
 
+static_assert(DeallocatingAllocator<pool_allocator>);
+static_assert(OwningAllocator<pool_allocator>);
+
 } // namespace amber
 
 #include <amber/pool_allocator.inl>
@@ -1,7 +1,11 @@
-#include <amber/util.hpp>
 #include <algorithm>
+#include <amber/util.hpp>
+#include <bit>
+#include <cstdint>
 #include <memory>
+#include <mica/mica.hpp>
 #include <new>
+#include <utility>
 
 namespace amber {
 
@@ -9,24 +13,142 @@ template<Buffer B>
 std::expected<pool_allocator, std::string> pool_allocator::create(
     B& buffer, std::size_t entry_size) noexcept
 {
+    return create(buffer, entry_size, alignof(internal::pool_entry), 0);
+}
+
+template<Buffer B>
+std::expected<pool_allocator, std::string> pool_allocator::create(
+    B& buffer, std::size_t entry_size, std::size_t entry_alignment) noexcept
+{
+    return create(buffer, entry_size, entry_alignment, 0);
+}
+
+template<Buffer B>
+std::expected<pool_allocator, std::string> pool_allocator::create(
+    B& buffer,
+    std::size_t entry_size,
+    std::size_t entry_alignment,
+    std::size_t color_offset
+) noexcept
+{
+    if (!std::has_single_bit(entry_alignment)) [[unlikely]] {
+        auto&& exp_msg = mica::format("invalid alignment: {}", entry_alignment);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
     std::span<std::byte> buffer_span = buffer.buffer();
+    entry_alignment = std::max(entry_alignment, alignof(internal::pool_entry));
     entry_size = std::max(entry_size, sizeof(internal::pool_entry));
-    if ((entry_size & (alignof(internal::pool_entry) - 1)) == 0) {
-        entry_size = align_forward(alignof(internal::pool_entry), entry_size);
+    entry_size = align_forward(entry_alignment, entry_size);
+
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_span.data());
+    std::uintptr_t slab_addr = align_forward(
+        static_cast<std::uintptr_t>(entry_alignment), buffer_addr + color_offset);
+    std::size_t slab_offset = slab_addr - buffer_addr;
+    if (slab_offset > buffer_span.size()) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "color offset out of range, color offset: {}, buffer size: {}",
+            color_offset, buffer_span.size()
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling color offset error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
     }
-    std::size_t entry_count = buffer_span.size() / entry_size;
-    
-    std::byte* free_head = nullptr;
+    std::size_t entry_count = (buffer_span.size() - slab_offset) / entry_size;
+
+    std::size_t free_head = no_entry;
     static_assert(std::is_nothrow_constructible_v<internal::pool_entry, decltype(free_head)>);
     for (std::size_t i = 0; i < entry_count; ++i) {
-        std::byte* buffer_offset_ptr = buffer_span.data() + (i * entry_size);
-        internal::pool_entry* entry_ptr = reinterpret_cast<internal::pool_entry*>(buffer_offset_ptr);
+        std::size_t entry_offset = slab_offset + (i * entry_size);
+        internal::pool_entry* entry_ptr = reinterpret_cast<internal::pool_entry*>(buffer_span.data() + entry_offset);
         entry_ptr = std::assume_aligned<alignof(internal::pool_entry)>(entry_ptr);
         entry_ptr = std::launder(std::construct_at(entry_ptr, free_head));
-        free_head = buffer_offset_ptr;
+        free_head = entry_offset;
+    }
+
+    return pool_allocator(
+        buffer_span, free_head, entry_size, entry_alignment, slab_offset, entry_count, 0);
+}
+
+template<Buffer B>
+std::expected<pool_allocator, std::string> pool_allocator::restore(B& buffer, const state& s) noexcept
+{
+    std::span<std::byte> buffer_span = buffer.buffer();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_span.data());
+    if (s.entry_size == 0
+        || s.entry_allocate_count > s.entry_count
+        || s.slab_offset > buffer_span.size()
+        || s.entry_count > (buffer_span.size() - s.slab_offset) / s.entry_size) [[unlikely]]
+    {
+        return std::unexpected("invalid pool state");
+    }
+    if (!is_aligned(static_cast<std::uintptr_t>(s.entry_alignment), buffer_addr + s.slab_offset)) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "invalid buffer alignment, buffer: {:#x}, target alignment: {}",
+            buffer_addr, s.entry_alignment
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
     }
 
-    return pool_allocator(buffer_span, free_head, entry_size, entry_count, 0);
+    // Read only, a private file mapping keeps sharing its pages. The list
+    // must hold exactly the free entries, each once on the entry grid.
+    std::size_t free_count = s.entry_count - s.entry_allocate_count;
+    std::size_t entry_offset = s.free_head_offset;
+    for (std::size_t i = 0; i < free_count; ++i) {
+        std::size_t slab_position = entry_offset - s.slab_offset;
+        if (entry_offset < s.slab_offset
+            || slab_position % s.entry_size != 0
+            || slab_position / s.entry_size >= s.entry_count) [[unlikely]]
+        {
+            return std::unexpected("invalid pool free list");
+        }
+        const internal::pool_entry* entry_ptr = reinterpret_cast<const internal::pool_entry*>(
+            buffer_span.data() + entry_offset);
+        entry_offset = std::assume_aligned<alignof(internal::pool_entry)>(entry_ptr)->next;
+    }
+    if (entry_offset != no_entry) [[unlikely]] {
+        return std::unexpected("invalid pool free list");
+    }
+
+    return pool_allocator(
+        buffer_span,
+        s.free_head_offset,
+        s.entry_size,
+        s.entry_alignment,
+        s.slab_offset,
+        s.entry_count,
+        s.entry_allocate_count
+    );
+}
+
+template<Buffer B>
+std::expected<void, std::string> pool_allocator::extend(B& buffer) noexcept
+{
+    std::span<std::byte> buffer_span = buffer.buffer();
+    if (buffer_span.data() != buffer_.data()) [[unlikely]] {
+        return std::unexpected("buffer moved");
+    }
+    if (buffer_span.size() < buffer_.size()) [[unlikely]] {
+        return std::unexpected("buffer shrunk");
+    }
+    std::size_t entry_count = (buffer_span.size() - slab_offset_) / entry_size_;
+    static_assert(std::is_nothrow_constructible_v<internal::pool_entry, decltype(free_head_)>);
+    for (std::size_t i = entry_count_; i < entry_count; ++i) {
+        std::size_t entry_offset = slab_offset_ + (i * entry_size_);
+        internal::pool_entry* entry_ptr = reinterpret_cast<internal::pool_entry*>(buffer_span.data() + entry_offset);
+        entry_ptr = std::assume_aligned<alignof(internal::pool_entry)>(entry_ptr);
+        entry_ptr = std::launder(std::construct_at(entry_ptr, free_head_));
+        free_head_ = entry_offset;
+    }
+    buffer_ = buffer_span;
+    entry_count_ = entry_count;
+    return {};
 }
 
 template<typename T, typename... Args>
@@ -36,6 +158,9 @@ std::expected<T*, std::string> pool_allocator::allocate(Args&&... args) noexcept
     if (sizeof(T) > entry_size_) [[unlikely]] {
         return std::unexpected("type size too large");
     }
+    if (alignof(T) > entry_alignment_) [[unlikely]] {
+        return std::unexpected("type alignment too large");
+    }
     auto exp_ptr = allocate();
     if (!exp_ptr.has_value()) [[unlikely]] {
         return std::unexpected(std::move(exp_ptr).error());
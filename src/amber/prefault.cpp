@@ -0,0 +1,306 @@
+extern "C" {
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+}
+#include <algorithm>
+#include <amber/prefault.hpp>
+#include <amber/util.hpp>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+namespace {
+
+// Bytes populated between progress updates
+constexpr std::size_t prefault_step = std::size_t(2) << 20;
+
+std::expected<void, std::string> populate_pages(std::byte* begin, std::size_t length) noexcept
+{
+    if (madvise(begin, length, MADV_POPULATE_WRITE) == 0) {
+        return {};
+    }
+    if (errno != EINVAL) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "madvise failed, error: {}, address: {:#x}, length: {}",
+            std::strerror(errno), reinterpret_cast<std::uintptr_t>(begin), length
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling madvise error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    // Kernels before 5.14 lack MADV_POPULATE_WRITE, write fault every page
+    // without changing its contents
+    std::size_t page = page_size();
+    for (std::size_t offset = 0; offset < length; offset += page) {
+        unsigned char* byte = reinterpret_cast<unsigned char*>(begin + offset);
+        std::atomic_ref<unsigned char>(*byte).fetch_or(0, std::memory_order_relaxed);
+    }
+    return {};
+}
+
+// CPU for worker index out of worker_count, spread evenly over the allowed
+// CPUs so that workers span every NUMA node
+int worker_cpu(const cpu_set_t& allowed, std::size_t index, std::size_t worker_count) noexcept
+{
+    std::size_t cpu_count = static_cast<std::size_t>(CPU_COUNT(&allowed));
+    std::size_t target = (index * cpu_count) / worker_count;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            if (target == 0) {
+                return cpu;
+            }
+            --target;
+        }
+    }
+    return -1;
+}
+
+void join_workers(internal::prefault_control* control) noexcept
+{
+    if (control->joined) {
+        return;
+    }
+    internal::prefault_slice* slices = internal::prefault_slices(control);
+    for (std::size_t i = 0; i < control->started_count; ++i) {
+        pthread_join(slices[i].thread, nullptr);
+    }
+    control->joined = true;
+}
+
+void release_control(internal::prefault_control* control) noexcept
+{
+    control->stop.store(true, std::memory_order_relaxed);
+    join_workers(control);
+    internal::prefault_slice* slices = internal::prefault_slices(control);
+    for (std::size_t i = 0; i < control->slice_count; ++i) {
+        std::destroy_at(slices + i);
+    }
+    std::destroy_at(control);
+    aligned_free(control);
+}
+
+} // unnamed namespace
+
+namespace internal {
+
+prefault_slice::prefault_slice(prefault_control* control, std::byte* begin, std::size_t size) noexcept
+    : control(control),
+    begin(begin),
+    size(size),
+    done(0),
+    thread()
+{}
+
+prefault_control::prefault_control(
+    std::byte* begin, std::size_t head_size, std::size_t range_size, std::size_t slice_count) noexcept
+    : begin(begin),
+    head_size(head_size),
+    range_size(range_size),
+    slice_count(slice_count),
+    started_count(0),
+    joined(false),
+    stop(false),
+    error_mutex(),
+    error()
+{}
+
+prefault_slice* prefault_slices(prefault_control* control) noexcept
+{
+    return std::launder(reinterpret_cast<prefault_slice*>(control + 1));
+}
+
+const prefault_slice* prefault_slices(const prefault_control* control) noexcept
+{
+    return std::launder(reinterpret_cast<const prefault_slice*>(control + 1));
+}
+
+void* prefault_worker(void* arg) noexcept
+{
+    prefault_slice* slice = static_cast<prefault_slice*>(arg);
+    prefault_control* control = slice->control;
+    std::size_t offset = 0;
+    while (offset < slice->size && !control->stop.load(std::memory_order_relaxed)) {
+        std::size_t length = std::min(prefault_step, slice->size - offset);
+        auto exp_populate = populate_pages(slice->begin + offset, length);
+        if (!exp_populate.has_value()) [[unlikely]] {
+            std::lock_guard lock(control->error_mutex);
+            if (control->error.empty()) {
+                control->error = std::move(exp_populate).error();
+            }
+            break;
+        }
+        offset += length;
+        slice->done.store(offset, std::memory_order_release);
+        slice->done.notify_all();
+    }
+    if (offset < slice->size) {
+        slice->done.fetch_or(prefault_slice::stopped_bit, std::memory_order_release);
+        slice->done.notify_all();
+    }
+    return nullptr;
+}
+
+} // namespace amber::internal
+
+prefault_task::prefault_task(prefault_task&& other) noexcept
+    : control_(std::exchange(other.control_, nullptr))
+{}
+
+prefault_task& prefault_task::operator=(prefault_task&& other) noexcept
+{
+    if (this != &other) {
+        if (control_ != nullptr) {
+            release_control(control_);
+        }
+        control_ = std::exchange(other.control_, nullptr);
+    }
+    return *this;
+}
+
+prefault_task::~prefault_task() noexcept
+{
+    if (control_ != nullptr) {
+        release_control(control_);
+    }
+    control_ = nullptr;
+}
+
+std::expected<prefault_task, std::string> prefault_task::create(
+    std::span<std::byte> range, std::size_t thread_count) noexcept
+{
+    if (thread_count == 0) [[unlikely]] {
+        return std::unexpected("invalid thread count");
+    }
+    std::uintptr_t page = static_cast<std::uintptr_t>(page_size());
+    std::uintptr_t range_addr = reinterpret_cast<std::uintptr_t>(range.data());
+    std::uintptr_t begin_addr = range_addr & ~(page - 1);
+    std::uintptr_t end_addr = align_forward(page, range_addr + range.size());
+    std::size_t page_count = (end_addr - begin_addr) / page;
+    std::size_t slice_count = std::min(thread_count, page_count);
+
+    auto exp_memory = aligned_alloc(
+        alignof(internal::prefault_control),
+        sizeof(internal::prefault_control) + (slice_count * sizeof(internal::prefault_slice)));
+    if (!exp_memory.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_memory).error());
+    }
+    std::byte* begin = reinterpret_cast<std::byte*>(begin_addr);
+    internal::prefault_control* control = std::construct_at(
+        static_cast<internal::prefault_control*>(exp_memory.value()),
+        begin, range_addr - begin_addr, range.size(), slice_count);
+    internal::prefault_slice* slices = reinterpret_cast<internal::prefault_slice*>(control + 1);
+    std::size_t slice_offset = 0;
+    for (std::size_t i = 0; i < slice_count; ++i) {
+        std::size_t slice_pages = (page_count / slice_count) + (i < page_count % slice_count ? 1 : 0);
+        std::construct_at(slices + i, control, begin + slice_offset, slice_pages * page);
+        slice_offset += slice_pages * page;
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool pin = slice_count > 1 && sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    for (std::size_t i = 0; i < slice_count; ++i) {
+        pthread_attr_t attr;
+        int status = pthread_attr_init(&attr);
+        if (status == 0) {
+            int cpu = pin ? worker_cpu(allowed, i, slice_count) : -1;
+            if (cpu >= 0) {
+                cpu_set_t cpu_set;
+                CPU_ZERO(&cpu_set);
+                CPU_SET(cpu, &cpu_set);
+                pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set);
+            }
+            status = pthread_create(&slices[i].thread, &attr, internal::prefault_worker, slices + i);
+            pthread_attr_destroy(&attr);
+        }
+        if (status != 0) [[unlikely]] {
+            release_control(control);
+            auto&& exp_msg = mica::format("pthread_create failed, error: {}", std::strerror(status));
+            if (!exp_msg.has_value()) [[unlikely]] {
+                return std::unexpected("formatting failed while handling pthread_create error");
+            }
+            return std::unexpected(std::move(exp_msg).value());
+        }
+        ++control->started_count;
+    }
+    return prefault_task(control);
+}
+
+std::size_t prefault_task::ready_size() const noexcept
+{
+    const internal::prefault_slice* slices = internal::prefault_slices(control_);
+    std::size_t populated = 0;
+    for (std::size_t i = 0; i < control_->slice_count; ++i) {
+        std::size_t done = slices[i].done.load(std::memory_order_acquire) & ~internal::prefault_slice::stopped_bit;
+        populated += done;
+        if (done < slices[i].size) {
+            break;
+        }
+    }
+    if (populated <= control_->head_size) {
+        return 0;
+    }
+    return std::min(populated - control_->head_size, control_->range_size);
+}
+
+bool prefault_task::wait_ready(std::size_t size) const noexcept
+{
+    size = std::min(size, control_->range_size);
+    if (size == 0) {
+        return true;
+    }
+    const internal::prefault_slice* slices = internal::prefault_slices(control_);
+    std::size_t target = control_->head_size + size;
+    std::size_t slice_offset = 0;
+    for (std::size_t i = 0; i < control_->slice_count && slice_offset < target; ++i) {
+        std::size_t need = std::min(slices[i].size, target - slice_offset);
+        std::size_t done = slices[i].done.load(std::memory_order_acquire);
+        while ((done & ~internal::prefault_slice::stopped_bit) < need) {
+            if ((done & internal::prefault_slice::stopped_bit) != 0) {
+                return false;
+            }
+            slices[i].done.wait(done, std::memory_order_acquire);
+            done = slices[i].done.load(std::memory_order_acquire);
+        }
+        slice_offset += slices[i].size;
+    }
+    return true;
+}
+
+std::expected<void, std::string> prefault_task::wait() noexcept
+{
+    join_workers(control_);
+    std::lock_guard lock(control_->error_mutex);
+    if (!control_->error.empty()) [[unlikely]] {
+        return std::unexpected(control_->error);
+    }
+    return {};
+}
+
+std::size_t prefault_task::thread_count() const noexcept
+{
+    return control_->slice_count;
+}
+
+prefault_task::prefault_task(internal::prefault_control* control) noexcept
+    : control_(control)
+{}
+
+std::expected<void, std::string> prefault(std::span<std::byte> range, std::size_t thread_count) noexcept
+{
+    auto&& exp_task = prefault_task::create(range, thread_count);
+    if (!exp_task.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_task).error());
+    }
+    return exp_task.value().wait();
+}
+
+} // namespace amber
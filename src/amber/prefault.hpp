@@ -0,0 +1,110 @@
+#pragma once
+
+extern "C" {
+#include <pthread.h>
+}
+#include <amber/util.hpp>
+#include <atomic>
+#include <cstddef>
+#include <expected>
+#include <mutex>
+#include <span>
+#include <string>
+
+namespace amber {
+
+namespace internal {
+
+struct prefault_control;
+
+// Contiguous page range populated by one worker thread
+struct alignas(cache_line_size) prefault_slice {
+public:
+    // Set in done once the worker stops before the end of the slice
+    static constexpr std::size_t stopped_bit = std::size_t(1) << (sizeof(std::size_t) * 8 - 1);
+
+    prefault_slice(prefault_control* control, std::byte* begin, std::size_t size) noexcept;
+
+    prefault_control* control;
+    std::byte* begin;
+    std::size_t size;
+    // Bytes populated from begin
+    std::atomic<std::size_t> done;
+    pthread_t thread;
+};
+
+// Followed in memory by slice_count slices
+struct alignas(cache_line_size) prefault_control {
+public:
+    prefault_control(
+        std::byte* begin, std::size_t head_size, std::size_t range_size, std::size_t slice_count) noexcept;
+
+    // Page aligned start of the populated region
+    std::byte* begin;
+    // Bytes between begin and the start of the caller's range
+    std::size_t head_size;
+    std::size_t range_size;
+    std::size_t slice_count;
+    std::size_t started_count;
+    bool joined;
+    std::atomic<bool> stop;
+    std::mutex error_mutex;
+    // First worker failure, empty when none
+    std::string error;
+};
+
+prefault_slice* prefault_slices(prefault_control* control) noexcept;
+
+const prefault_slice* prefault_slices(const prefault_control* control) noexcept;
+
+void* prefault_worker(void* arg) noexcept;
+
+} // namespace amber::internal
+
+// Prefaults a range of memory in the background. The range is split into one
+// contiguous slice per worker thread, each worker being pinned to a different
+// CPU so that under the first touch policy every slice lands on the NUMA node
+// of the worker that populated it. The range stays usable while workers run,
+// ready_size() and wait_ready() report how much of its start is populated.
+// The memory must outlive the task.
+class prefault_task {
+public:
+    prefault_task() = delete;
+
+    prefault_task(const prefault_task&) = delete;
+
+    prefault_task(prefault_task&& other) noexcept;
+
+    prefault_task& operator=(const prefault_task&) = delete;
+
+    prefault_task& operator=(prefault_task&& other) noexcept;
+
+    // Stops the workers after their current step and joins them
+    ~prefault_task() noexcept;
+
+    static
+    std::expected<prefault_task, std::string> create(
+        std::span<std::byte> range, std::size_t thread_count) noexcept;
+
+    // Bytes from the start of the range that are populated
+    std::size_t ready_size() const noexcept;
+
+    // Blocks until the first size bytes of the range are populated, returns
+    // false if a worker stopped before populating them
+    bool wait_ready(std::size_t size) const noexcept;
+
+    // Blocks until every worker finished, the readiness of the whole range
+    std::expected<void, std::string> wait() noexcept;
+
+    std::size_t thread_count() const noexcept;
+
+private:
+    prefault_task(internal::prefault_control* control) noexcept;
+
+    internal::prefault_control* control_;
+};
+
+// Populates range with thread_count threads and waits for them
+std::expected<void, std::string> prefault(std::span<std::byte> range, std::size_t thread_count) noexcept;
+
+} // namespace amber
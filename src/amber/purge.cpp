@@ -0,0 +1,118 @@
+extern "C" {
+#include <sys/mman.h>
+}
+#include <algorithm>
+#include <amber/purge.hpp>
+#include <amber/util.hpp>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mica/mica.hpp>
+#include <utility>
+
+namespace amber {
+
+std::expected<std::size_t, std::string> purge_pages(std::span<std::byte> range, purge_mode mode) noexcept
+{
+    std::uintptr_t page = static_cast<std::uintptr_t>(page_size());
+    std::uintptr_t begin_addr = align_forward(page, reinterpret_cast<std::uintptr_t>(range.data()));
+    std::uintptr_t end_addr = reinterpret_cast<std::uintptr_t>(range.data() + range.size()) & ~(page - 1);
+    if (end_addr <= begin_addr) {
+        return 0;
+    }
+    std::size_t length = end_addr - begin_addr;
+    if (madvise(reinterpret_cast<void*>(begin_addr), length, static_cast<int>(mode)) == -1) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "madvise failed, error: {}, address: {:#x}, length: {}",
+            std::strerror(errno), begin_addr, length
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling madvise error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    return length;
+}
+
+namespace internal {
+
+std::expected<std::size_t, std::string> purge_range(
+    std::span<std::byte> buffer, std::size_t begin_offset, std::size_t end_offset, purge_mode mode) noexcept
+{
+    if (end_offset <= begin_offset) {
+        return 0;
+    }
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer.data());
+    std::uintptr_t end_addr = align_forward(
+        static_cast<std::uintptr_t>(page_size()), buffer_addr + end_offset);
+    end_offset = std::min<std::size_t>(end_addr - buffer_addr, buffer.size());
+    return purge_pages(buffer.subspan(begin_offset, end_offset - begin_offset), mode);
+}
+
+} // namespace amber::internal
+
+purge_decay::purge_decay(purge_decay&& other) noexcept
+    : decay_time_(std::exchange(other.decay_time_, clock::duration::zero())),
+    peak_size_(std::exchange(other.peak_size_, 0)),
+    peak_time_(std::exchange(other.peak_time_, clock::time_point())),
+    last_size_(std::exchange(other.last_size_, 0))
+{}
+
+purge_decay& purge_decay::operator=(purge_decay&& other) noexcept
+{
+    if (this != &other) {
+        decay_time_ = std::exchange(other.decay_time_, clock::duration::zero());
+        peak_size_ = std::exchange(other.peak_size_, 0);
+        peak_time_ = std::exchange(other.peak_time_, clock::time_point());
+        last_size_ = std::exchange(other.last_size_, 0);
+    }
+    return *this;
+}
+
+purge_decay::~purge_decay() noexcept
+{
+    decay_time_ = clock::duration::zero();
+    peak_size_ = 0;
+    peak_time_ = clock::time_point();
+    last_size_ = 0;
+}
+
+std::expected<purge_decay, std::string> purge_decay::create(clock::duration decay_time) noexcept
+{
+    if (decay_time < clock::duration::zero()) [[unlikely]] {
+        return std::unexpected("invalid decay time");
+    }
+    return purge_decay(decay_time);
+}
+
+std::size_t purge_decay::dirty_limit(std::size_t dirty_size, clock::time_point now) noexcept
+{
+    if (dirty_size > last_size_) {
+        // New dirty memory, give it a full decay period
+        peak_size_ = dirty_size;
+        peak_time_ = now;
+    }
+    std::size_t limit = 0;
+    clock::duration elapsed = now - peak_time_;
+    if (elapsed < decay_time_) {
+        double remaining = static_cast<double>((decay_time_ - elapsed).count());
+        limit = static_cast<std::size_t>(
+            static_cast<double>(peak_size_) * remaining / static_cast<double>(decay_time_.count()));
+    }
+    last_size_ = dirty_size;
+    return std::min(limit, dirty_size);
+}
+
+purge_decay::clock::duration purge_decay::decay_time() const noexcept
+{
+    return decay_time_;
+}
+
+purge_decay::purge_decay(clock::duration decay_time) noexcept
+    : decay_time_(decay_time),
+    peak_size_(0),
+    peak_time_(),
+    last_size_(0)
+{}
+
+} // namespace amber
@@ -0,0 +1,74 @@
+#pragma once
+
+extern "C" {
+#include <sys/mman.h>
+}
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string>
+
+namespace amber {
+
+enum class purge_mode : int {
+    // Pages are released immediately and read back as zero
+    dont_need = MADV_DONTNEED,
+    // Pages are released lazily under memory pressure, contents are undefined
+    lazy_free = MADV_FREE,
+};
+
+// Returns the whole pages inside range to the OS, partial pages at either end
+// are kept. Returns the number of bytes released.
+std::expected<std::size_t, std::string> purge_pages(std::span<std::byte> range, purge_mode mode) noexcept;
+
+namespace internal {
+
+// Purges [begin_offset, end_offset) of buffer for an allocator, the end is
+// extended to a page boundary since the bytes above it are unused
+std::expected<std::size_t, std::string> purge_range(
+    std::span<std::byte> buffer, std::size_t begin_offset, std::size_t end_offset, purge_mode mode) noexcept;
+
+} // namespace amber::internal
+
+// Time decay policy for dirty memory in the style of jemalloc's decay. Dirty
+// bytes that appear are allowed to stay resident for up to decay_time, the
+// allowance shrinking linearly from the peak, so a short lull after a spike
+// does not purge pages that are about to be reused.
+class purge_decay {
+public:
+    using clock = std::chrono::steady_clock;
+
+    purge_decay() = delete;
+
+    purge_decay(const purge_decay&) = delete;
+
+    purge_decay(purge_decay&& other) noexcept;
+
+    purge_decay& operator=(const purge_decay&) = delete;
+
+    purge_decay& operator=(purge_decay&& other) noexcept;
+
+    ~purge_decay() noexcept;
+
+    static
+    std::expected<purge_decay, std::string> create(clock::duration decay_time) noexcept;
+
+    // Bytes of dirty_size that may stay resident at now, pass it as the keep
+    // size of an allocator's purge. Growth above the dirty_size of the
+    // previous call starts a new decay period, so the limit still reaches
+    // zero when the caller does not purge down to it in between.
+    std::size_t dirty_limit(std::size_t dirty_size, clock::time_point now) noexcept;
+
+    clock::duration decay_time() const noexcept;
+
+private:
+    purge_decay(clock::duration decay_time) noexcept;
+
+    clock::duration decay_time_;
+    std::size_t peak_size_;
+    clock::time_point peak_time_;
+    std::size_t last_size_;
+};
+
+} // namespace amber
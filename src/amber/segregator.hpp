@@ -0,0 +1,67 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+// Sends allocations of at most Threshold bytes to Small and the rest to Large.
+// free routes a pointer by Small's owns since the size is not passed back.
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+class segregator {
+public:
+    static constexpr std::size_t threshold = Threshold;
+
+    segregator() = delete;
+
+    segregator(const segregator&) = delete;
+
+    segregator(segregator&& other) noexcept = default;
+
+    segregator& operator=(const segregator&) = delete;
+
+    segregator& operator=(segregator&& other) noexcept = default;
+
+    ~segregator() noexcept = default;
+
+    static
+    std::expected<segregator, std::string> create(Small&& small, Large&& large) noexcept;
+
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    void free(void* ptr) noexcept
+    requires OwningAllocator<Small>;
+
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T> && OwningAllocator<Small>
+    void free(T* ptr) noexcept;
+
+    bool owns(const void* ptr) const noexcept
+    requires OwningAllocator<Small> && OwningAllocator<Large>;
+
+    Small& small() noexcept;
+
+    const Small& small() const noexcept;
+
+    Large& large() noexcept;
+
+    const Large& large() const noexcept;
+
+private:
+    segregator(Small&& small, Large&& large) noexcept;
+
+    Small small_;
+    Large large_;
+};
+
+} // namespace amber
+
+#include <amber/segregator.inl>
@@ -0,0 +1,106 @@
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+std::expected<segregator<Threshold, Small, Large>, std::string>
+segregator<Threshold, Small, Large>::create(Small&& small, Large&& large) noexcept
+{
+    static_assert(std::is_nothrow_move_constructible_v<Small>);
+    static_assert(std::is_nothrow_move_constructible_v<Large>);
+    return segregator(std::move(small), std::move(large));
+}
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+std::expected<void*, std::string> segregator<Threshold, Small, Large>::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    if (size <= Threshold) {
+        return small_.allocate(alignment, size);
+    }
+    return large_.allocate(alignment, size);
+}
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+template<typename T, typename... Args>
+requires std::is_nothrow_constructible_v<T, Args...>
+std::expected<T*, std::string> segregator<Threshold, Small, Large>::allocate(Args&&... args) noexcept
+{
+    auto exp_ptr = allocate(alignof(T), sizeof(T));
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    T* ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(std::move(exp_ptr).value()));
+    return std::launder(std::construct_at(ptr, std::forward<Args>(args)...));
+}
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+void segregator<Threshold, Small, Large>::free(void* ptr) noexcept
+requires OwningAllocator<Small>
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    if (small_.owns(ptr)) {
+        if constexpr (DeallocatingAllocator<Small>) {
+            small_.free(ptr);
+        }
+    } else {
+        if constexpr (DeallocatingAllocator<Large>) {
+            large_.free(ptr);
+        }
+    }
+}
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+template<typename T>
+requires std::is_nothrow_destructible_v<T> && OwningAllocator<Small>
+void segregator<Threshold, Small, Large>::free(T* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::destroy_at(ptr);
+    free(static_cast<void*>(ptr));
+}
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+bool segregator<Threshold, Small, Large>::owns(const void* ptr) const noexcept
+requires OwningAllocator<Small> && OwningAllocator<Large>
+{
+    return small_.owns(ptr) || large_.owns(ptr);
+}
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+Small& segregator<Threshold, Small, Large>::small() noexcept
+{
+    return small_;
+}
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+const Small& segregator<Threshold, Small, Large>::small() const noexcept
+{
+    return small_;
+}
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+Large& segregator<Threshold, Small, Large>::large() noexcept
+{
+    return large_;
+}
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+const Large& segregator<Threshold, Small, Large>::large() const noexcept
+{
+    return large_;
+}
+
+template<std::size_t Threshold, Allocator Small, Allocator Large>
+segregator<Threshold, Small, Large>::segregator(Small&& small, Large&& large) noexcept
+    : small_(std::move(small)),
+    large_(std::move(large))
+{}
+
+} // namespace amber
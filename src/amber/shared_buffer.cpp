@@ -0,0 +1,202 @@
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+#include <amber/shared_buffer.hpp>
+#include <cerrno>
+#include <cstring>
+#include <mica/mica.hpp>
+#include <utility>
+
+namespace amber {
+
+namespace {
+
+std::string shared_error(const char* call, int error, std::size_t size) noexcept
+{
+    auto&& exp_msg = mica::format(
+        "{} failed, error: {}, size: {}", call, std::strerror(error), size);
+    if (!exp_msg.has_value()) [[unlikely]] {
+        return "formatting failed while handling shared mapping error";
+    }
+    return std::move(exp_msg).value();
+}
+
+// Takes ownership of fd, which is closed on failure
+std::expected<std::byte*, std::string> map_shared(int fd, std::size_t size, mmap_flag flags) noexcept
+{
+    mmap_prot prot = mmap_prot::read | mmap_prot::write;
+    flags |= mmap_flag::shared;
+    void* ptr = mmap(nullptr, size, static_cast<int>(prot), static_cast<int>(flags), fd, 0);
+    if (ptr == MAP_FAILED) [[unlikely]] {
+        int error = errno;
+        close(fd);
+        return std::unexpected(shared_error("mmap", error, size));
+    }
+    return static_cast<std::byte*>(ptr);
+}
+
+} // unnamed namespace
+
+shared_buffer::shared_buffer(shared_buffer&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    fd_(std::exchange(other.fd_, -1))
+{}
+
+shared_buffer& shared_buffer::operator=(shared_buffer&& other) noexcept
+{
+    if (this != &other) {
+        if (buffer_ != nullptr) {
+            munmap(buffer_, size_);
+            buffer_ = nullptr;
+        }
+        if (fd_ != -1) {
+            close(fd_);
+            fd_ = -1;
+        }
+        buffer_ = std::exchange(other.buffer_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        fd_ = std::exchange(other.fd_, -1);
+    }
+    return *this;
+}
+
+shared_buffer::~shared_buffer() noexcept
+{
+    if (buffer_ != nullptr) {
+        munmap(buffer_, size_);
+    }
+    if (fd_ != -1) {
+        close(fd_);
+    }
+    buffer_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+}
+
+std::expected<shared_buffer, std::string> shared_buffer::create(
+    std::size_t size, mmap_flag flags) noexcept
+{
+    if (size == 0) [[unlikely]] {
+        return std::unexpected("invalid size: 0");
+    }
+    int fd = memfd_create("amber_shared_buffer", MFD_CLOEXEC);
+    if (fd == -1) [[unlikely]] {
+        return std::unexpected(shared_error("memfd_create", errno, size));
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1) [[unlikely]] {
+        int error = errno;
+        close(fd);
+        return std::unexpected(shared_error("ftruncate", error, size));
+    }
+    auto exp_ptr = map_shared(fd, size, flags);
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    return shared_buffer(exp_ptr.value(), size, fd);
+}
+
+std::expected<shared_buffer, std::string> shared_buffer::create(std::size_t size) noexcept
+{
+    return shared_buffer::create(size, mmap_flag::none);
+}
+
+std::expected<shared_buffer, std::string> shared_buffer::create_named(
+    const std::string& name, std::size_t size) noexcept
+{
+    if (size == 0) [[unlikely]] {
+        return std::unexpected("invalid size: 0");
+    }
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd == -1) [[unlikely]] {
+        return std::unexpected(shared_error("shm_open", errno, size));
+    }
+    struct stat fd_stat{};
+    if (fstat(fd, &fd_stat) == -1) [[unlikely]] {
+        int error = errno;
+        close(fd);
+        return std::unexpected(shared_error("fstat", error, size));
+    }
+    std::size_t existing_size = static_cast<std::size_t>(fd_stat.st_size);
+    if (existing_size == 0) {
+        // Two processes racing to create the object both truncate to size
+        if (ftruncate(fd, static_cast<off_t>(size)) == -1) [[unlikely]] {
+            int error = errno;
+            close(fd);
+            return std::unexpected(shared_error("ftruncate", error, size));
+        }
+    } else if (existing_size != size) [[unlikely]] {
+        close(fd);
+        auto&& exp_msg = mica::format(
+            "shared memory size mismatch, size: {}, existing size: {}", size, existing_size);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling size error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    auto exp_ptr = map_shared(fd, size, mmap_flag::none);
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    return shared_buffer(exp_ptr.value(), size, fd);
+}
+
+std::expected<shared_buffer, std::string> shared_buffer::attach(int fd) noexcept
+{
+    struct stat fd_stat{};
+    if (fstat(fd, &fd_stat) == -1) [[unlikely]] {
+        return std::unexpected(shared_error("fstat", errno, 0));
+    }
+    std::size_t size = static_cast<std::size_t>(fd_stat.st_size);
+    if (size == 0) [[unlikely]] {
+        return std::unexpected("invalid size: 0");
+    }
+    int owned_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (owned_fd == -1) [[unlikely]] {
+        return std::unexpected(shared_error("fcntl", errno, size));
+    }
+    auto exp_ptr = map_shared(owned_fd, size, mmap_flag::none);
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    return shared_buffer(exp_ptr.value(), size, owned_fd);
+}
+
+std::expected<void, std::string> shared_buffer::unlink_named(const std::string& name) noexcept
+{
+    if (shm_unlink(name.c_str()) == -1) [[unlikely]] {
+        return std::unexpected(shared_error("shm_unlink", errno, 0));
+    }
+    return {};
+}
+
+std::span<std::byte> shared_buffer::buffer() noexcept
+{
+    return std::span(buffer_, size_);
+}
+
+const std::span<std::byte> shared_buffer::buffer() const noexcept
+{
+    return std::span(buffer_, size_);
+}
+
+std::size_t shared_buffer::size() const noexcept
+{
+    return size_;
+}
+
+int shared_buffer::fd() const noexcept
+{
+    return fd_;
+}
+
+shared_buffer::shared_buffer(std::byte* buffer, std::size_t size, int fd) noexcept
+    : buffer_(buffer),
+    size_(size),
+    fd_(fd)
+{}
+
+} // namespace amber
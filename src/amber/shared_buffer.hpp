@@ -0,0 +1,71 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <amber/mmap_buffer.hpp>
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string>
+
+namespace amber {
+
+// Buffer mapped MAP_SHARED from a memfd or a POSIX shared memory object.
+// Children forked after creation share the mapping, unrelated processes can
+// map the same memory through create_named or by receiving fd().
+class shared_buffer {
+public:
+    shared_buffer() = delete;
+
+    shared_buffer(const shared_buffer&) = delete;
+
+    shared_buffer(shared_buffer&& other) noexcept;
+
+    shared_buffer& operator=(const shared_buffer&) = delete;
+
+    shared_buffer& operator=(shared_buffer&& other) noexcept;
+
+    ~shared_buffer() noexcept;
+
+    // Anonymous shared memory, flags are added to MAP_SHARED
+    static
+    std::expected<shared_buffer, std::string> create(
+        std::size_t size, mmap_flag flags) noexcept;
+
+    static
+    std::expected<shared_buffer, std::string> create(std::size_t size) noexcept;
+
+    // Opens the shared memory object name, creating it with size bytes if it
+    // does not exist. An existing object must be exactly size bytes.
+    static
+    std::expected<shared_buffer, std::string> create_named(
+        const std::string& name, std::size_t size) noexcept;
+
+    // Maps the memory behind a file descriptor, e.g. one received from a peer.
+    // The descriptor is duplicated, the caller keeps ownership of fd.
+    static
+    std::expected<shared_buffer, std::string> attach(int fd) noexcept;
+
+    // Removes the name of a shared memory object, existing mappings stay valid
+    static
+    std::expected<void, std::string> unlink_named(const std::string& name) noexcept;
+
+    std::span<std::byte> buffer() noexcept;
+
+    const std::span<std::byte> buffer() const noexcept;
+
+    std::size_t size() const noexcept;
+
+    // Descriptor of the underlying memory, owned by the buffer
+    int fd() const noexcept;
+
+private:
+    shared_buffer(std::byte* buffer, std::size_t size, int fd) noexcept;
+
+    std::byte* buffer_;
+    std::size_t size_;
+    int fd_;
+};
+
+static_assert(Buffer<shared_buffer>);
+
+} // namespace amber
@@ -0,0 +1,187 @@
+#include <amber/shared_pool_allocator.hpp>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+namespace amber {
+
+namespace internal {
+
+shared_pool_header::shared_pool_header(
+    std::uint64_t free_head,
+    std::uint64_t entry_size,
+    std::uint64_t entry_alignment,
+    std::uint64_t entry_count,
+    std::uint64_t slab_offset
+) noexcept
+    : free_head(free_head),
+    entry_allocate_count(0),
+    entry_size(entry_size),
+    entry_alignment(entry_alignment),
+    entry_count(entry_count),
+    slab_offset(slab_offset),
+    magic(0)
+{}
+
+shared_pool_entry::shared_pool_entry(std::uint32_t next) noexcept
+    : next(next)
+{}
+
+} // namespace amber::internal
+
+namespace {
+
+constexpr std::uint64_t tagged_index(std::uint64_t previous, std::uint32_t index) noexcept
+{
+    std::uint64_t tag = (previous >> 32) + 1;
+    return (tag << 32) | index;
+}
+
+} // unnamed namespace
+
+shared_pool_allocator::shared_pool_allocator(shared_pool_allocator&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, std::span<std::byte>())),
+    header_(std::exchange(other.header_, nullptr)),
+    entry_size_(std::exchange(other.entry_size_, 0))
+{}
+
+shared_pool_allocator& shared_pool_allocator::operator=(shared_pool_allocator&& other) noexcept
+{
+    if (this != &other) {
+        buffer_ = std::exchange(other.buffer_, std::span<std::byte>());
+        header_ = std::exchange(other.header_, nullptr);
+        entry_size_ = std::exchange(other.entry_size_, 0);
+    }
+    return *this;
+}
+
+shared_pool_allocator::~shared_pool_allocator() noexcept
+{
+    buffer_ = std::span<std::byte>();
+    header_ = nullptr;
+    entry_size_ = 0;
+}
+
+std::expected<void*, std::string> shared_pool_allocator::allocate() noexcept
+{
+    internal::shared_pool_entry* entry_ptr = pop_entry();
+    if (entry_ptr == nullptr) [[unlikely]] {
+        return std::unexpected("out of capacity");
+    }
+    // A peer that lost the exchange may still be loading next, so it is
+    // cleared atomically and only the payload after it is zeroed
+    entry_ptr->next.store(0, std::memory_order_relaxed);
+    std::memset(
+        reinterpret_cast<std::byte*>(entry_ptr) + sizeof(internal::shared_pool_entry), 0,
+        entry_size_ - sizeof(internal::shared_pool_entry)
+    );
+    return entry_ptr;
+}
+
+std::expected<void*, std::string> shared_pool_allocator::allocate_uninitialized() noexcept
+{
+    internal::shared_pool_entry* entry_ptr = pop_entry();
+    if (entry_ptr == nullptr) [[unlikely]] {
+        return std::unexpected("out of capacity");
+    }
+    return entry_ptr;
+}
+
+void shared_pool_allocator::free(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::uint32_t index = static_cast<std::uint32_t>(
+        (offset_of(ptr) - header_->slab_offset) / entry_size_);
+    internal::shared_pool_entry* entry_ptr = std::assume_aligned<alignof(internal::shared_pool_entry)>(
+        static_cast<internal::shared_pool_entry*>(ptr)
+    );
+    std::uint64_t head = header_->free_head.load(std::memory_order_relaxed);
+    // A stale popper may be loading next right now, so it is stored
+    // atomically rather than constructed over
+    entry_ptr->next.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+    while (!header_->free_head.compare_exchange_weak(
+        head, tagged_index(head, index), std::memory_order_release, std::memory_order_relaxed))
+    {
+        entry_ptr->next.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+    }
+    header_->entry_allocate_count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::size_t shared_pool_allocator::offset_of(const void* ptr) const noexcept
+{
+    return static_cast<std::size_t>(static_cast<const std::byte*>(ptr) - buffer_.data());
+}
+
+void* shared_pool_allocator::pointer_to(std::size_t offset) const noexcept
+{
+    return static_cast<void*>(buffer_.data() + offset);
+}
+
+std::size_t shared_pool_allocator::buffer_size() const noexcept
+{
+    return buffer_.size();
+}
+
+std::size_t shared_pool_allocator::entry_size() const noexcept
+{
+    return entry_size_;
+}
+
+std::size_t shared_pool_allocator::entry_alignment() const noexcept
+{
+    return header_ == nullptr ? 0 : header_->entry_alignment;
+}
+
+std::size_t shared_pool_allocator::entry_count() const noexcept
+{
+    return header_ == nullptr ? 0 : header_->entry_count;
+}
+
+std::size_t shared_pool_allocator::entry_allocate_count() const noexcept
+{
+    return header_ == nullptr ? 0 : header_->entry_allocate_count.load(std::memory_order_relaxed);
+}
+
+std::size_t shared_pool_allocator::entry_free_count() const noexcept
+{
+    return entry_count() - entry_allocate_count();
+}
+
+shared_pool_allocator::shared_pool_allocator(
+    std::span<std::byte> buffer,
+    internal::shared_pool_header* header,
+    std::size_t entry_size
+) noexcept
+    : buffer_(buffer),
+    header_(header),
+    entry_size_(entry_size)
+{}
+
+internal::shared_pool_entry* shared_pool_allocator::pop_entry() noexcept
+{
+    std::uint64_t head = header_->free_head.load(std::memory_order_acquire);
+    internal::shared_pool_entry* entry_ptr;
+    while (true) {
+        std::uint32_t index = static_cast<std::uint32_t>(head);
+        if (index == null_index) [[unlikely]] {
+            return nullptr;
+        }
+        entry_ptr = static_cast<internal::shared_pool_entry*>(
+            pointer_to(header_->slab_offset + (static_cast<std::size_t>(index) * entry_size_))
+        );
+        entry_ptr = std::assume_aligned<alignof(internal::shared_pool_entry)>(entry_ptr);
+        // A peer may already own the entry, the tag makes the exchange fail then
+        std::uint32_t next = entry_ptr->next.load(std::memory_order_relaxed);
+        if (header_->free_head.compare_exchange_weak(
+            head, tagged_index(head, next), std::memory_order_acquire, std::memory_order_acquire))
+        {
+            break;
+        }
+    }
+    header_->entry_allocate_count.fetch_add(1, std::memory_order_relaxed);
+    return entry_ptr;
+}
+
+} // namespace amber
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <amber/util.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+namespace internal {
+
+// Lives at the start of the buffer so every process mapping it sees one pool
+struct alignas(cache_line_size) shared_pool_header {
+public:
+    shared_pool_header(
+        std::uint64_t free_head,
+        std::uint64_t entry_size,
+        std::uint64_t entry_alignment,
+        std::uint64_t entry_count,
+        std::uint64_t slab_offset
+    ) noexcept;
+
+    // Low 32 bits are the index of the first free entry, high 32 bits are a
+    // tag bumped on every update so a stale compare exchange fails
+    std::atomic<std::uint64_t> free_head;
+    std::atomic<std::uint64_t> entry_allocate_count;
+    std::uint64_t entry_size;
+    std::uint64_t entry_alignment;
+    std::uint64_t entry_count;
+    std::uint64_t slab_offset;
+    // Written last by create, attach refuses a buffer without it
+    std::atomic<std::uint64_t> magic;
+};
+
+struct shared_pool_entry {
+public:
+    shared_pool_entry(std::uint32_t next) noexcept;
+
+    std::atomic<std::uint32_t> next;
+};
+
+} // namespace amber::internal
+
+// Fixed size pool whose state is stored entirely inside the buffer and linked
+// by slot index, so any process mapping the buffer, e.g. a shared_buffer, can
+// allocate and free entries concurrently. Entries are handed to peers by
+// offset_of/pointer_to since the buffer may be mapped at different addresses.
+class shared_pool_allocator {
+public:
+    static constexpr std::uint32_t null_index = UINT32_MAX;
+
+    shared_pool_allocator() = delete;
+
+    shared_pool_allocator(const shared_pool_allocator&) = delete;
+
+    shared_pool_allocator(shared_pool_allocator&& other) noexcept;
+
+    shared_pool_allocator& operator=(const shared_pool_allocator&) = delete;
+
+    shared_pool_allocator& operator=(shared_pool_allocator&& other) noexcept;
+
+    ~shared_pool_allocator() noexcept;
+
+    // Initializes the pool, no other process may use the buffer until it returns
+    template<Buffer B>
+    static
+    std::expected<shared_pool_allocator, std::string> create(
+        B& buffer, std::size_t entry_size) noexcept;
+
+    template<Buffer B>
+    static
+    std::expected<shared_pool_allocator, std::string> create(
+        B& buffer, std::size_t entry_size, std::size_t entry_alignment) noexcept;
+
+    // Uses a pool previously created in buffer, possibly by another process
+    template<Buffer B>
+    static
+    std::expected<shared_pool_allocator, std::string> attach(B& buffer) noexcept;
+
+    std::expected<void*, std::string> allocate() noexcept;
+
+    // Like allocate, but the entry keeps whatever its last user left in it,
+    // for callers that initialize it themselves
+    std::expected<void*, std::string> allocate_uninitialized() noexcept;
+
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    void free(void* ptr) noexcept;
+
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T>
+    void free(T* ptr) noexcept;
+
+    // Offset of an entry from the start of the buffer, valid in every process
+    std::size_t offset_of(const void* ptr) const noexcept;
+
+    // Entry at an offset previously returned by offset_of
+    void* pointer_to(std::size_t offset) const noexcept;
+
+    std::size_t buffer_size() const noexcept;
+
+    std::size_t entry_size() const noexcept;
+
+    std::size_t entry_alignment() const noexcept;
+
+    std::size_t entry_count() const noexcept;
+
+    std::size_t entry_allocate_count() const noexcept;
+
+    std::size_t entry_free_count() const noexcept;
+
+private:
+    static constexpr std::uint64_t header_magic = 0x4c4f4f5052424d41; // "AMBRPOOL"
+
+    shared_pool_allocator(
+        std::span<std::byte> buffer,
+        internal::shared_pool_header* header,
+        std::size_t entry_size
+    ) noexcept;
+
+    // Takes the first free entry off the list, nullptr when there is none
+    internal::shared_pool_entry* pop_entry() noexcept;
+
+    std::span<std::byte> buffer_;
+    internal::shared_pool_header* header_;
+    std::size_t entry_size_;
+};
+
+// Peers in other processes need address-free atomics
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+} // namespace amber
+
+#include <amber/shared_pool_allocator.inl>
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+template<Buffer B>
+std::expected<shared_pool_allocator, std::string> shared_pool_allocator::create(
+    B& buffer, std::size_t entry_size) noexcept
+{
+    return create(buffer, entry_size, alignof(internal::shared_pool_entry));
+}
+
+template<Buffer B>
+std::expected<shared_pool_allocator, std::string> shared_pool_allocator::create(
+    B& buffer, std::size_t entry_size, std::size_t entry_alignment) noexcept
+{
+    if (!std::has_single_bit(entry_alignment)) [[unlikely]] {
+        auto&& exp_msg = mica::format("invalid alignment: {}", entry_alignment);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    std::span<std::byte> buffer_span = buffer.buffer();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_span.data());
+    entry_alignment = std::max(entry_alignment, alignof(internal::shared_pool_entry));
+    std::size_t buffer_alignment = std::max(entry_alignment, alignof(internal::shared_pool_header));
+    if (!is_aligned(static_cast<std::uintptr_t>(buffer_alignment), buffer_addr)) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "invalid buffer alignment, buffer: {:#x}, target alignment: {}",
+            buffer_addr, buffer_alignment
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    entry_size = std::max(entry_size, sizeof(internal::shared_pool_entry));
+    entry_size = align_forward(entry_alignment, entry_size);
+    std::size_t slab_offset = align_forward(entry_alignment, sizeof(internal::shared_pool_header));
+    if (slab_offset > buffer_span.size()) [[unlikely]] {
+        return std::unexpected("out of capacity");
+    }
+    // null_index is reserved as the end of list marker
+    std::size_t entry_count = std::min<std::size_t>(
+        (buffer_span.size() - slab_offset) / entry_size, null_index);
+
+    std::uint32_t free_head = null_index;
+    static_assert(std::is_nothrow_constructible_v<internal::shared_pool_entry, decltype(free_head)>);
+    for (std::size_t i = entry_count; i > 0; --i) {
+        std::byte* buffer_offset_ptr = buffer_span.data() + slab_offset + ((i - 1) * entry_size);
+        internal::shared_pool_entry* entry_ptr = reinterpret_cast<internal::shared_pool_entry*>(buffer_offset_ptr);
+        entry_ptr = std::assume_aligned<alignof(internal::shared_pool_entry)>(entry_ptr);
+        entry_ptr = std::launder(std::construct_at(entry_ptr, free_head));
+        free_head = static_cast<std::uint32_t>(i - 1);
+    }
+
+    internal::shared_pool_header* header = reinterpret_cast<internal::shared_pool_header*>(buffer_span.data());
+    header = std::assume_aligned<alignof(internal::shared_pool_header)>(header);
+    header = std::launder(std::construct_at(
+        header, free_head, entry_size, entry_alignment, entry_count, slab_offset));
+    header->magic.store(header_magic, std::memory_order_release);
+    return shared_pool_allocator(buffer_span, header, entry_size);
+}
+
+template<Buffer B>
+std::expected<shared_pool_allocator, std::string> shared_pool_allocator::attach(B& buffer) noexcept
+{
+    std::span<std::byte> buffer_span = buffer.buffer();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_span.data());
+    if (buffer_span.size() < sizeof(internal::shared_pool_header)
+        || !is_aligned(static_cast<std::uintptr_t>(alignof(internal::shared_pool_header)), buffer_addr)) [[unlikely]]
+    {
+        return std::unexpected("invalid shared pool buffer");
+    }
+    internal::shared_pool_header* header = std::launder(
+        reinterpret_cast<internal::shared_pool_header*>(buffer_span.data()));
+    if (header->magic.load(std::memory_order_acquire) != header_magic) [[unlikely]] {
+        return std::unexpected("shared pool not initialized");
+    }
+    if (header->entry_size == 0
+        || header->slab_offset > buffer_span.size()
+        || header->entry_count > (buffer_span.size() - header->slab_offset) / header->entry_size
+        || !is_aligned(static_cast<std::uintptr_t>(header->entry_alignment), buffer_addr + header->slab_offset)) [[unlikely]]
+    {
+        return std::unexpected("invalid shared pool buffer");
+    }
+    return shared_pool_allocator(buffer_span, header, header->entry_size);
+}
+
+template<typename T, typename... Args>
+requires std::is_nothrow_constructible_v<T, Args...>
+std::expected<T*, std::string> shared_pool_allocator::allocate(Args&&... args) noexcept
+{
+    if (sizeof(T) > entry_size_) [[unlikely]] {
+        return std::unexpected("type size too large");
+    }
+    if (alignof(T) > entry_alignment()) [[unlikely]] {
+        return std::unexpected("type alignment too large");
+    }
+    auto exp_ptr = allocate();
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    T* ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(std::move(exp_ptr).value()));
+    return std::launder(std::construct_at(ptr, std::forward<Args>(args)...));
+}
+
+template<typename T>
+requires std::is_nothrow_destructible_v<T>
+void shared_pool_allocator::free(T* ptr) noexcept
+{
+    std::destroy_at(ptr);
+    free(static_cast<void*>(ptr));
+}
+
+} // namespace amber
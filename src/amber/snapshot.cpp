@@ -0,0 +1,286 @@
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+#include <amber/mmap_buffer.hpp>
+#include <amber/snapshot.hpp>
+#include <amber/util.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mica/mica.hpp>
+#include <utility>
+
+namespace amber {
+
+namespace {
+
+constexpr std::array<char, 8> snapshot_magic{'A', 'M', 'B', 'E', 'R', 'S', 'N', 'P'};
+
+std::string snapshot_error(const char* call, int error, const std::string& path) noexcept
+{
+    auto&& exp_msg = mica::format("{} failed, error: {}, path: {}", call, std::strerror(error), path);
+    if (!exp_msg.has_value()) [[unlikely]] {
+        return "formatting failed while handling snapshot error";
+    }
+    return std::move(exp_msg).value();
+}
+
+snapshot_header make_header(snapshot_kind kind, std::span<const std::byte> buffer) noexcept
+{
+    snapshot_header header{};
+    header.magic = snapshot_magic;
+    header.version = snapshot_version;
+    header.kind = kind;
+    // Keep the buffer page aligned within the file so it can be mapped directly
+    header.data_offset = align_forward(page_size(), sizeof(snapshot_header));
+    header.base_address = reinterpret_cast<std::uintptr_t>(buffer.data());
+    header.buffer_size = buffer.size();
+    return header;
+}
+
+bool write_all(int fd, const std::byte* data, std::size_t size) noexcept
+{
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+std::expected<void, std::string> write_snapshot(
+    const std::string& path, const snapshot_header& header, std::span<const std::byte> buffer) noexcept
+{
+    std::string tmp_path;
+    try {
+        tmp_path = path + ".tmp";
+    } catch (...) {
+        return std::unexpected("out of memory");
+    }
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) [[unlikely]] {
+        return std::unexpected(snapshot_error("open", errno, tmp_path));
+    }
+    std::array<std::byte, sizeof(snapshot_header)> header_bytes;
+    std::memcpy(header_bytes.data(), &header, sizeof(header));
+    bool ok = write_all(fd, header_bytes.data(), header_bytes.size())
+        && ftruncate(fd, static_cast<off_t>(header.data_offset)) == 0
+        && lseek(fd, static_cast<off_t>(header.data_offset), SEEK_SET) != -1
+        && write_all(fd, buffer.data(), buffer.size())
+        && fsync(fd) == 0;
+    int error = errno;
+    close(fd);
+    if (!ok) [[unlikely]] {
+        unlink(tmp_path.c_str());
+        return std::unexpected(snapshot_error("write", error, tmp_path));
+    }
+    if (rename(tmp_path.c_str(), path.c_str()) == -1) [[unlikely]] {
+        error = errno;
+        unlink(tmp_path.c_str());
+        return std::unexpected(snapshot_error("rename", error, path));
+    }
+    return {};
+}
+
+} // unnamed namespace
+
+std::expected<void, std::string> save_snapshot(
+    const std::string& path, std::span<const std::byte> buffer, const pool_allocator& allocator) noexcept
+{
+    pool_allocator::state state = allocator.save_state();
+    if (state.base_address != reinterpret_cast<std::uintptr_t>(buffer.data())) [[unlikely]] {
+        return std::unexpected("buffer is not owned by allocator");
+    }
+    snapshot_header header = make_header(snapshot_kind::pool, buffer);
+    header.entry_size = state.entry_size;
+    header.entry_alignment = state.entry_alignment;
+    header.slab_offset = state.slab_offset;
+    header.entry_count = state.entry_count;
+    header.entry_allocate_count = state.entry_allocate_count;
+    header.free_head = state.free_head_offset;
+    return write_snapshot(path, header, buffer);
+}
+
+std::expected<void, std::string> save_snapshot(
+    const std::string& path, std::span<const std::byte> buffer, const compact_pool_allocator& allocator) noexcept
+{
+    compact_pool_allocator::state state = allocator.save_state();
+    snapshot_header header = make_header(snapshot_kind::compact_pool, buffer);
+    header.entry_size = state.entry_size;
+    header.entry_alignment = state.entry_alignment;
+    header.entry_count = state.entry_count;
+    header.entry_allocate_count = state.entry_allocate_count;
+    header.free_head = state.free_head;
+    return write_snapshot(path, header, buffer);
+}
+
+std::expected<void, std::string> save_snapshot(
+    const std::string& path, std::span<const std::byte> buffer, const linear_allocator& allocator) noexcept
+{
+    auto exp_state = allocator.save_state();
+    if (!exp_state.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_state).error());
+    }
+    snapshot_header header = make_header(snapshot_kind::linear, buffer);
+    header.buffer_offset = exp_state.value().buffer_offset;
+    return write_snapshot(path, header, buffer);
+}
+
+snapshot_buffer::snapshot_buffer(snapshot_buffer&& other) noexcept
+    : mapping_(std::exchange(other.mapping_, nullptr)),
+    mapping_size_(std::exchange(other.mapping_size_, 0)),
+    header_(other.header_)
+{}
+
+snapshot_buffer& snapshot_buffer::operator=(snapshot_buffer&& other) noexcept
+{
+    if (this != &other) {
+        if (mapping_ != nullptr) {
+            munmap(mapping_, mapping_size_);
+            mapping_ = nullptr;
+        }
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        mapping_size_ = std::exchange(other.mapping_size_, 0);
+        header_ = other.header_;
+    }
+    return *this;
+}
+
+snapshot_buffer::~snapshot_buffer() noexcept
+{
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_size_);
+    }
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+}
+
+std::expected<snapshot_buffer, std::string> snapshot_buffer::create(const std::string& path) noexcept
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) [[unlikely]] {
+        return std::unexpected(snapshot_error("open", errno, path));
+    }
+    struct stat file_stat{};
+    snapshot_header header{};
+    if (fstat(fd, &file_stat) == -1
+        || pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) [[unlikely]]
+    {
+        int error = errno;
+        close(fd);
+        return std::unexpected(snapshot_error("read", error, path));
+    }
+    std::size_t file_size = static_cast<std::size_t>(file_stat.st_size);
+    if (header.magic != snapshot_magic
+        || header.version != snapshot_version
+        || (header.data_offset % page_size()) != 0
+        || header.data_offset + header.buffer_size != file_size) [[unlikely]]
+    {
+        close(fd);
+        return std::unexpected("invalid snapshot header");
+    }
+
+    // Try to put the buffer back where it was so pointers into it stay valid
+    mmap_prot prot = mmap_prot::read | mmap_prot::write;
+    mmap_flag flags = mmap_flag::private_map;
+    void* hint = reinterpret_cast<void*>(header.base_address - header.data_offset);
+    void* mapping = mmap(hint, file_size, static_cast<int>(prot),
+        static_cast<int>(flags | mmap_flag::fixed_noreplace), fd, 0);
+    if (mapping == MAP_FAILED) {
+        mapping = mmap(nullptr, file_size, static_cast<int>(prot), static_cast<int>(flags), fd, 0);
+    }
+    int error = errno;
+    close(fd);
+    if (mapping == MAP_FAILED) [[unlikely]] {
+        return std::unexpected(snapshot_error("mmap", error, path));
+    }
+    return snapshot_buffer(static_cast<std::byte*>(mapping), file_size, header);
+}
+
+std::span<std::byte> snapshot_buffer::buffer() noexcept
+{
+    return std::span(mapping_ + header_.data_offset, header_.buffer_size);
+}
+
+const std::span<std::byte> snapshot_buffer::buffer() const noexcept
+{
+    return std::span(mapping_ + header_.data_offset, header_.buffer_size);
+}
+
+std::size_t snapshot_buffer::size() const noexcept
+{
+    return mapping_ == nullptr ? 0 : header_.buffer_size;
+}
+
+const snapshot_header& snapshot_buffer::header() const noexcept
+{
+    return header_;
+}
+
+bool snapshot_buffer::relocated() const noexcept
+{
+    return reinterpret_cast<std::uintptr_t>(mapping_ + header_.data_offset) != header_.base_address;
+}
+
+snapshot_buffer::snapshot_buffer(
+    std::byte* mapping,
+    std::size_t mapping_size,
+    const snapshot_header& header
+) noexcept
+    : mapping_(mapping),
+    mapping_size_(mapping_size),
+    header_(header)
+{}
+
+std::expected<pool_allocator, std::string> restore_pool_allocator(snapshot_buffer& buffer) noexcept
+{
+    const snapshot_header& header = buffer.header();
+    if (header.kind != snapshot_kind::pool) [[unlikely]] {
+        return std::unexpected("snapshot kind mismatch");
+    }
+    return pool_allocator::restore(buffer, pool_allocator::state{
+        .base_address = header.base_address,
+        .entry_size = header.entry_size,
+        .entry_alignment = header.entry_alignment,
+        .slab_offset = header.slab_offset,
+        .entry_count = header.entry_count,
+        .entry_allocate_count = header.entry_allocate_count,
+        .free_head_offset = header.free_head,
+    });
+}
+
+std::expected<compact_pool_allocator, std::string> restore_compact_pool_allocator(
+    snapshot_buffer& buffer) noexcept
+{
+    const snapshot_header& header = buffer.header();
+    if (header.kind != snapshot_kind::compact_pool) [[unlikely]] {
+        return std::unexpected("snapshot kind mismatch");
+    }
+    return compact_pool_allocator::restore(buffer, compact_pool_allocator::state{
+        .entry_size = header.entry_size,
+        .entry_alignment = header.entry_alignment,
+        .entry_count = header.entry_count,
+        .entry_allocate_count = header.entry_allocate_count,
+        .free_head = static_cast<std::uint32_t>(header.free_head),
+    });
+}
+
+std::expected<linear_allocator, std::string> restore_linear_allocator(snapshot_buffer& buffer) noexcept
+{
+    const snapshot_header& header = buffer.header();
+    if (header.kind != snapshot_kind::linear) [[unlikely]] {
+        return std::unexpected("snapshot kind mismatch");
+    }
+    return linear_allocator::restore(buffer, linear_allocator::state{.buffer_offset = header.buffer_offset});
+}
+
+} // namespace amber
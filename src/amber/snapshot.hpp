@@ -0,0 +1,106 @@
+#pragma once
+
+#include <amber/compact_pool_allocator.hpp>
+#include <amber/concept.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/pool_allocator.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+
+namespace amber {
+
+// 2: pool free lists are linked by buffer offset
+inline constexpr std::uint32_t snapshot_version = 2;
+
+enum class snapshot_kind : std::uint32_t {
+    pool = 1,
+    compact_pool = 2,
+    linear = 3,
+};
+
+// First bytes of a snapshot file, the buffer contents follow at data_offset
+struct snapshot_header {
+public:
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    snapshot_kind kind;
+    std::uint64_t data_offset;
+    std::uint64_t base_address;
+    std::uint64_t buffer_size;
+    std::uint64_t entry_size;
+    std::uint64_t entry_alignment;
+    std::uint64_t slab_offset;
+    std::uint64_t entry_count;
+    std::uint64_t entry_allocate_count;
+    std::uint64_t free_head;
+    std::uint64_t buffer_offset;
+};
+
+// Writes the allocator state and the contents of its buffer to path. The file
+// is written next to path and renamed into place, so readers never observe a
+// partial snapshot.
+std::expected<void, std::string> save_snapshot(
+    const std::string& path, std::span<const std::byte> buffer, const pool_allocator& allocator) noexcept;
+
+std::expected<void, std::string> save_snapshot(
+    const std::string& path, std::span<const std::byte> buffer, const compact_pool_allocator& allocator) noexcept;
+
+std::expected<void, std::string> save_snapshot(
+    const std::string& path, std::span<const std::byte> buffer, const linear_allocator& allocator) noexcept;
+
+// Private copy-on-write mapping of a snapshot file. Pages are read lazily, and
+// the buffer is mapped at its original address when that range is free.
+class snapshot_buffer {
+public:
+    snapshot_buffer() = delete;
+
+    snapshot_buffer(const snapshot_buffer&) = delete;
+
+    snapshot_buffer(snapshot_buffer&& other) noexcept;
+
+    snapshot_buffer& operator=(const snapshot_buffer&) = delete;
+
+    snapshot_buffer& operator=(snapshot_buffer&& other) noexcept;
+
+    ~snapshot_buffer() noexcept;
+
+    static
+    std::expected<snapshot_buffer, std::string> create(const std::string& path) noexcept;
+
+    std::span<std::byte> buffer() noexcept;
+
+    const std::span<std::byte> buffer() const noexcept;
+
+    std::size_t size() const noexcept;
+
+    const snapshot_header& header() const noexcept;
+
+    // Whether the buffer was mapped somewhere other than its original address
+    bool relocated() const noexcept;
+
+private:
+    snapshot_buffer(
+        std::byte* mapping,
+        std::size_t mapping_size,
+        const snapshot_header& header
+    ) noexcept;
+
+    std::byte* mapping_;
+    std::size_t mapping_size_;
+    snapshot_header header_;
+};
+
+static_assert(Buffer<snapshot_buffer>);
+
+std::expected<pool_allocator, std::string> restore_pool_allocator(snapshot_buffer& buffer) noexcept;
+
+std::expected<compact_pool_allocator, std::string> restore_compact_pool_allocator(
+    snapshot_buffer& buffer) noexcept;
+
+std::expected<linear_allocator, std::string> restore_linear_allocator(snapshot_buffer& buffer) noexcept;
+
+} // namespace amber
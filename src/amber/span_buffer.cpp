@@ -0,0 +1,42 @@
+#include <amber/span_buffer.hpp>
+#include <utility>
+
+namespace amber {
+
+span_buffer::span_buffer(std::span<std::byte> buffer) noexcept
+    : buffer_(buffer)
+{}
+
+span_buffer::span_buffer(span_buffer&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, std::span<std::byte>()))
+{}
+
+span_buffer& span_buffer::operator=(span_buffer&& other) noexcept
+{
+    if (this != &other) {
+        buffer_ = std::exchange(other.buffer_, std::span<std::byte>());
+    }
+    return *this;
+}
+
+span_buffer::~span_buffer() noexcept
+{
+    buffer_ = std::span<std::byte>();
+}
+
+std::span<std::byte> span_buffer::buffer() noexcept
+{
+    return buffer_;
+}
+
+const std::span<std::byte> span_buffer::buffer() const noexcept
+{
+    return buffer_;
+}
+
+std::size_t span_buffer::size() const noexcept
+{
+    return buffer_.size();
+}
+
+} // namespace amber
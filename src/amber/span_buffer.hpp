@@ -0,0 +1,50 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string>
+
+namespace amber {
+
+// Non-owning Buffer over borrowed memory, e.g. an allocation from another
+// allocator, so allocators can nest without a system allocation. The memory
+// must outlive the span_buffer and every allocator created over it.
+class span_buffer {
+public:
+    span_buffer() = delete;
+
+    span_buffer(std::span<std::byte> buffer) noexcept;
+
+    span_buffer(const span_buffer&) = delete;
+
+    span_buffer(span_buffer&& other) noexcept;
+
+    span_buffer& operator=(const span_buffer&) = delete;
+
+    span_buffer& operator=(span_buffer&& other) noexcept;
+
+    ~span_buffer() noexcept;
+
+    // Borrows size bytes allocated from allocator, which keeps ownership of them
+    template<Allocator A>
+    static
+    std::expected<span_buffer, std::string> create(
+        A& allocator, std::size_t alignment, std::size_t size) noexcept;
+
+    std::span<std::byte> buffer() noexcept;
+
+    const std::span<std::byte> buffer() const noexcept;
+
+    std::size_t size() const noexcept;
+
+private:
+    std::span<std::byte> buffer_;
+};
+
+static_assert(Buffer<span_buffer>);
+
+} // namespace amber
+
+#include <amber/span_buffer.inl>
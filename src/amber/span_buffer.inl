@@ -0,0 +1,16 @@
+#include <utility>
+
+namespace amber {
+
+template<Allocator A>
+std::expected<span_buffer, std::string> span_buffer::create(
+    A& allocator, std::size_t alignment, std::size_t size) noexcept
+{
+    auto exp_ptr = allocator.allocate(alignment, size);
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    return span_buffer(std::span<std::byte>(static_cast<std::byte*>(exp_ptr.value()), size));
+}
+
+} // namespace amber
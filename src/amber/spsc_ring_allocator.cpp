@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <amber/spsc_ring_allocator.hpp>
+#include <amber/util.hpp>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+namespace internal {
+
+ring_record::ring_record(std::uint64_t end) noexcept
+    : end(end)
+{}
+
+} // namespace amber::internal
+
+spsc_ring_allocator::spsc_ring_allocator(spsc_ring_allocator&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, std::span<std::byte>())),
+    head_(std::exchange(other.head_, 0)),
+    head_offset_(std::exchange(other.head_offset_, 0)),
+    cached_tail_(std::exchange(other.cached_tail_, 0)),
+    tail_(other.tail_.exchange(0, std::memory_order_relaxed))
+{}
+
+spsc_ring_allocator& spsc_ring_allocator::operator=(spsc_ring_allocator&& other) noexcept
+{
+    if (this != &other) {
+        buffer_ = std::exchange(other.buffer_, std::span<std::byte>());
+        head_ = std::exchange(other.head_, 0);
+        head_offset_ = std::exchange(other.head_offset_, 0);
+        cached_tail_ = std::exchange(other.cached_tail_, 0);
+        tail_.store(other.tail_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    return *this;
+}
+
+spsc_ring_allocator::~spsc_ring_allocator() noexcept
+{
+    buffer_ = std::span<std::byte>();
+    head_ = 0;
+    head_offset_ = 0;
+    cached_tail_ = 0;
+    tail_.store(0, std::memory_order_relaxed);
+}
+
+std::expected<void*, std::string> spsc_ring_allocator::allocate(
+    std::size_t alignment, std::size_t size) noexcept
+{
+    if (!std::has_single_bit(alignment)) [[unlikely]] {
+        auto&& exp_msg = mica::format("invalid alignment: {}", alignment);
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    // Larger records never fit, and the layout below would wrap around
+    if (size > buffer_.size() || alignment > buffer_.size()) [[unlikely]] {
+        return std::unexpected("record too large");
+    }
+    alignment = std::max(alignof(internal::ring_record), alignment);
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+
+    // Layout of a record starting at offset: header, alignment padding, payload,
+    // then padding so the next record's header is aligned
+    auto record_size = [&](std::size_t offset) noexcept -> std::size_t {
+        std::uintptr_t header_addr = buffer_addr + offset;
+        std::uintptr_t payload_addr = align_forward(
+            static_cast<std::uintptr_t>(alignment), header_addr + sizeof(internal::ring_record));
+        std::uintptr_t end_addr = align_forward(
+            static_cast<std::uintptr_t>(alignof(internal::ring_record)), payload_addr + size);
+        return end_addr - header_addr;
+    };
+
+    std::size_t offset = head_offset_;
+    std::size_t total = record_size(offset);
+    std::size_t wrap_padding = 0;
+    if (offset + total > buffer_.size()) {
+        // Never split a record, skip the rest of the buffer and start over
+        wrap_padding = buffer_.size() - offset;
+        offset = 0;
+        total = record_size(offset);
+        if (total > buffer_.size()) [[unlikely]] {
+            return std::unexpected("record too large");
+        }
+    }
+    std::uint64_t end = head_ + wrap_padding + total;
+    if (end - cached_tail_ > buffer_.size()) {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (end - cached_tail_ > buffer_.size()) [[unlikely]] {
+            return std::unexpected("out of capacity");
+        }
+    }
+
+    std::uintptr_t header_addr = buffer_addr + offset;
+    std::uintptr_t payload_addr = align_forward(
+        static_cast<std::uintptr_t>(alignment), header_addr + sizeof(internal::ring_record));
+    internal::ring_record* header_ptr = reinterpret_cast<internal::ring_record*>(
+        payload_addr - sizeof(internal::ring_record));
+    header_ptr = std::assume_aligned<alignof(internal::ring_record)>(header_ptr);
+    header_ptr = std::launder(std::construct_at(header_ptr, end));
+
+    head_ = end;
+    head_offset_ = offset + total;
+    if (head_offset_ == buffer_.size()) {
+        head_offset_ = 0;
+    }
+    return reinterpret_cast<void*>(payload_addr);
+}
+
+std::expected<void*, std::string> spsc_ring_allocator::allocate(std::size_t size) noexcept
+{
+    return allocate(alignof(std::max_align_t), size);
+}
+
+void spsc_ring_allocator::free(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    std::uintptr_t payload_addr = reinterpret_cast<std::uintptr_t>(ptr);
+    internal::ring_record* header_ptr = reinterpret_cast<internal::ring_record*>(
+        payload_addr - sizeof(internal::ring_record));
+    header_ptr = std::assume_aligned<alignof(internal::ring_record)>(header_ptr);
+    tail_.store(header_ptr->end, std::memory_order_release);
+}
+
+std::size_t spsc_ring_allocator::buffer_size() const noexcept
+{
+    return buffer_.size();
+}
+
+std::size_t spsc_ring_allocator::bytes_in_use() const noexcept
+{
+    return static_cast<std::size_t>(head_ - tail_.load(std::memory_order_acquire));
+}
+
+spsc_ring_allocator::spsc_ring_allocator(std::span<std::byte> buffer) noexcept
+    : buffer_(buffer),
+    head_(0),
+    head_offset_(0),
+    cached_tail_(0),
+    tail_(0)
+{}
+
+} // namespace amber
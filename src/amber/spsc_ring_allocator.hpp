@@ -0,0 +1,90 @@
+#pragma once
+
+#include <amber/concept.hpp>
+#include <amber/util.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <type_traits>
+
+namespace amber {
+
+namespace internal {
+
+// Stored directly before each record's payload
+struct ring_record {
+public:
+    ring_record(std::uint64_t end) noexcept;
+
+    // Ring position one past the end of the record, including any wrap padding
+    std::uint64_t end;
+};
+
+} // namespace amber::internal
+
+// Single producer, single consumer ring of variable size records. The producer
+// thread calls allocate, the consumer thread calls free on records in the same
+// order they were allocated. Records are never split across the end of the
+// buffer, a record that does not fit before the end starts at the beginning.
+class spsc_ring_allocator {
+public:
+    spsc_ring_allocator() = delete;
+
+    spsc_ring_allocator(const spsc_ring_allocator&) = delete;
+
+    // Moving is not thread-safe, neither side may be in use while moving
+    spsc_ring_allocator(spsc_ring_allocator&& other) noexcept;
+
+    spsc_ring_allocator& operator=(const spsc_ring_allocator&) = delete;
+
+    spsc_ring_allocator& operator=(spsc_ring_allocator&& other) noexcept;
+
+    ~spsc_ring_allocator() noexcept;
+
+    template<Buffer B>
+    static
+    std::expected<spsc_ring_allocator, std::string> create(B& buffer) noexcept;
+
+    // Producer only
+    std::expected<void*, std::string> allocate(
+        std::size_t alignment, std::size_t size) noexcept;
+
+    // Producer only
+    std::expected<void*, std::string> allocate(std::size_t size) noexcept;
+
+    // Producer only
+    template<typename T, typename... Args>
+    requires std::is_nothrow_constructible_v<T, Args...>
+    std::expected<T*, std::string> allocate(Args&&... args) noexcept;
+
+    // Consumer only, records must be freed in allocation order
+    void free(void* ptr) noexcept;
+
+    // Consumer only
+    template<typename T>
+    requires std::is_nothrow_destructible_v<T>
+    void free(T* ptr) noexcept;
+
+    std::size_t buffer_size() const noexcept;
+
+    // Producer only, bytes not yet released by the consumer
+    std::size_t bytes_in_use() const noexcept;
+
+private:
+    spsc_ring_allocator(std::span<std::byte> buffer) noexcept;
+
+    std::span<std::byte> buffer_;
+    // Producer state
+    std::uint64_t head_;
+    std::size_t head_offset_;
+    std::uint64_t cached_tail_;
+    // Consumer state, kept on its own cache line
+    alignas(cache_line_size) std::atomic<std::uint64_t> tail_;
+};
+
+} // namespace amber
+
+#include <amber/spsc_ring_allocator.inl>
@@ -0,0 +1,51 @@
+#include <amber/util.hpp>
+#include <cstdint>
+#include <memory>
+#include <mica/mica.hpp>
+#include <new>
+#include <utility>
+
+namespace amber {
+
+template<Buffer B>
+std::expected<spsc_ring_allocator, std::string> spsc_ring_allocator::create(B& buffer) noexcept
+{
+    std::span<std::byte> buffer_span = buffer.buffer();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_span.data());
+    std::uintptr_t target_alignment = static_cast<std::uintptr_t>(alignof(internal::ring_record));
+    if (!is_aligned(target_alignment, buffer_addr)) [[unlikely]] {
+        auto&& exp_msg = mica::format(
+            "invalid buffer alignment, buffer: {:#x}, target alignment: {}",
+            buffer_addr, target_alignment
+        );
+        if (!exp_msg.has_value()) [[unlikely]] {
+            return std::unexpected("formatting failed while handling alignment error");
+        }
+        return std::unexpected(std::move(exp_msg).value());
+    }
+    // Every record starts on a ring_record boundary, drop the unusable tail
+    std::size_t size = buffer_span.size() & ~(alignof(internal::ring_record) - 1);
+    return spsc_ring_allocator(buffer_span.first(size));
+}
+
+template<typename T, typename... Args>
+requires std::is_nothrow_constructible_v<T, Args...>
+std::expected<T*, std::string> spsc_ring_allocator::allocate(Args&&... args) noexcept
+{
+    auto exp_ptr = allocate(alignof(T), sizeof(T));
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    T* ptr = std::assume_aligned<alignof(T)>(static_cast<T*>(exp_ptr.value()));
+    return std::launder(std::construct_at(ptr, std::forward<Args>(args)...));
+}
+
+template<typename T>
+requires std::is_nothrow_destructible_v<T>
+void spsc_ring_allocator::free(T* ptr) noexcept
+{
+    std::destroy_at(ptr);
+    free(static_cast<void*>(ptr));
+}
+
+} // namespace amber
@@ -1,8 +1,10 @@
 #include <algorithm>
+#include <amber/heap_profiler.hpp>
 #include <amber/stack_allocator.hpp>
 #include <amber/util.hpp>
 #include <bit>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <mica/mica.hpp>
 #include <new>
@@ -11,23 +13,20 @@
 
 namespace amber {
 
-namespace {
+namespace internal {
 
-struct alloc_header {
-public:
-    alloc_header(std::size_t padding)
-        : padding(padding)
-    {}
+alloc_header::alloc_header(std::size_t padding) noexcept
+    : padding(padding)
+{}
 
-    std::size_t padding;
-};
 static_assert(std::has_single_bit(alignof(alloc_header)));
 
-} // unnamed namespace
+} // namespace amber::internal
 
 stack_allocator::stack_allocator(stack_allocator&& other) noexcept
     : buffer_(std::exchange(other.buffer_, std::span<std::byte>())),
-    buffer_offset_(std::exchange(other.buffer_offset_, 0))
+    buffer_offset_(std::exchange(other.buffer_offset_, 0)),
+    high_water_(std::exchange(other.high_water_, 0))
 {}
 
 stack_allocator& stack_allocator::operator=(stack_allocator&& other) noexcept
@@ -35,6 +34,7 @@ stack_allocator& stack_allocator::operator=(stack_allocator&& other) noexcept
     if (this != &other) {
         buffer_ = std::exchange(other.buffer_, std::span<std::byte>());
         buffer_offset_ = std::exchange(other.buffer_offset_, 0);
+        high_water_ = std::exchange(other.high_water_, 0);
     }
     return *this;
 }
@@ -43,6 +43,7 @@ stack_allocator::~stack_allocator() noexcept
 {
     buffer_ = std::span<std::byte>();
     buffer_offset_ = 0;
+    high_water_ = 0;
 }
 
 std::expected<void*, std::string> stack_allocator::allocate(
@@ -55,22 +56,14 @@ std::expected<void*, std::string> stack_allocator::allocate(
         }
         return std::unexpected(std::move(exp_msg).value());
     }
-    alignment = std::max(alignof(alloc_header), alignment);
-    std::byte* offset_ptr = buffer_.data() + buffer_offset_;
-    std::uintptr_t offset_addr = reinterpret_cast<std::uintptr_t>(offset_ptr);
-    std::uintptr_t target_addr = offset_addr + sizeof(alloc_header);
-    std::uintptr_t aligned_addr = align_forward(static_cast<std::uintptr_t>(alignment), target_addr);
-    std::uintptr_t aligned_padding = aligned_addr - offset_addr;
-    if (buffer_offset_ + aligned_padding + size > buffer_.size()) [[unlikely]] {
+    // A zero-size allocation still takes a byte, otherwise it could end up
+    // one past the buffer where owns() no longer recognizes it
+    size = std::max(size, std::size_t(1));
+    std::uintptr_t aligned_addr = place(alignment, size);
+    if (aligned_addr == 0) [[unlikely]] {
         return std::unexpected("out of capacity");
     }
-
-    alloc_header* header_ptr = reinterpret_cast<alloc_header*>(aligned_addr - sizeof(alloc_header));
-    header_ptr = std::assume_aligned<alignof(alloc_header)>(header_ptr);
-    header_ptr = std::launder(std::construct_at(header_ptr, aligned_padding));
-
-    buffer_offset_ += aligned_padding + size;
-    return reinterpret_cast<void*>(aligned_addr);
+    return push(aligned_addr, size);
 }
 
 std::expected<void*, std::string> stack_allocator::allocate(std::size_t size) noexcept
@@ -78,6 +71,83 @@ std::expected<void*, std::string> stack_allocator::allocate(std::size_t size) no
     return allocate(alignof(std::max_align_t), size);
 }
 
+bool stack_allocator::try_extend(void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+{
+    if (ptr == nullptr) {
+        return false;
+    }
+    std::byte* end_ptr = static_cast<std::byte*>(ptr) + old_size;
+    if (end_ptr != buffer_.data() + buffer_offset_) {
+        return false;
+    }
+    std::size_t ptr_offset = static_cast<std::byte*>(ptr) - buffer_.data();
+    if (ptr_offset + new_size > buffer_.size()) {
+        return false;
+    }
+    high_water_ = std::max(high_water_, buffer_offset_);
+    buffer_offset_ = ptr_offset + new_size;
+    internal::heap_profile_resize(ptr, new_size);
+    return true;
+}
+
+bool stack_allocator::shrink(void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+{
+    if (new_size > old_size) {
+        return false;
+    }
+    return try_extend(ptr, old_size, new_size);
+}
+
+std::expected<void*, std::string> stack_allocator::reallocate(
+    void* ptr, std::size_t old_size, std::size_t alignment, std::size_t new_size) noexcept
+{
+    if (ptr == nullptr) {
+        return allocate(alignment, new_size);
+    }
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    if (is_aligned(static_cast<std::uintptr_t>(alignment), addr)
+        && (try_extend(ptr, old_size, new_size) || new_size <= old_size))
+    {
+        return ptr;
+    }
+    std::byte* end_ptr = static_cast<std::byte*>(ptr) + old_size;
+    if (std::has_single_bit(alignment) && end_ptr == buffer_.data() + buffer_offset_) {
+        // ptr is the top allocation, so the new block can start where it did.
+        // Otherwise the old block would sit below the new one until a rewind.
+        internal::alloc_header* header_ptr = reinterpret_cast<internal::alloc_header*>(
+            addr - sizeof(internal::alloc_header));
+        std::size_t prev_offset = buffer_offset_;
+        buffer_offset_ = static_cast<std::size_t>(
+            static_cast<std::byte*>(ptr) - buffer_.data()) - header_ptr->padding;
+        new_size = std::max(new_size, std::size_t(1));
+        std::uintptr_t aligned_addr = place(alignment, new_size);
+        if (aligned_addr == 0) [[unlikely]] {
+            buffer_offset_ = prev_offset;
+            return std::unexpected("out of capacity");
+        }
+        high_water_ = std::max(high_water_, prev_offset);
+        // The blocks may overlap, and the new header may land inside the old
+        // data, so the data is moved before the header is written
+        std::memmove(reinterpret_cast<void*>(aligned_addr), ptr, std::min(old_size, new_size));
+        internal::heap_profile_free(ptr);
+        return push(aligned_addr, new_size);
+    }
+    auto exp_ptr = allocate(alignment, new_size);
+    if (!exp_ptr.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_ptr).error());
+    }
+    std::memcpy(exp_ptr.value(), ptr, std::min(old_size, new_size));
+    // The old block stays in the buffer until a free below it rewinds past it
+    internal::heap_profile_free(ptr);
+    return exp_ptr.value();
+}
+
+std::expected<void*, std::string> stack_allocator::reallocate(
+    void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+{
+    return reallocate(ptr, old_size, alignof(std::max_align_t), new_size);
+}
+
 void stack_allocator::free(void* ptr) noexcept
 {
     if (ptr == nullptr) {
@@ -85,9 +155,13 @@ void stack_allocator::free(void* ptr) noexcept
     }
     std::uintptr_t aligned_addr = reinterpret_cast<std::uintptr_t>(ptr);
     std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
-    alloc_header* header_ptr = reinterpret_cast<alloc_header*>(aligned_addr - sizeof(alloc_header));
+    internal::alloc_header* header_ptr = reinterpret_cast<internal::alloc_header*>(
+        aligned_addr - sizeof(internal::alloc_header));
     std::uintptr_t aligned_padding = header_ptr->padding;
     std::uintptr_t new_offset = aligned_addr - aligned_padding - buffer_addr;
+    // Blocks above ptr are released along with it
+    internal::heap_profile_free_range(ptr, buffer_.data() + buffer_offset_);
+    high_water_ = std::max(high_water_, buffer_offset_);
     buffer_offset_ = new_offset;
 }
 
@@ -96,15 +170,73 @@ std::size_t stack_allocator::buffer_size() const noexcept
     return buffer_.size();
 }
 
+bool stack_allocator::owns(const void* ptr) const noexcept
+{
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    std::uintptr_t begin_addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+    return addr >= begin_addr && addr - begin_addr < buffer_.size();
+}
+
 std::size_t stack_allocator::buffer_offset() const noexcept
 {
     return buffer_offset_;
 }
 
+std::size_t stack_allocator::dirty_size() const noexcept
+{
+    return std::max(high_water_, buffer_offset_) - buffer_offset_;
+}
+
+std::expected<std::size_t, std::string> stack_allocator::purge(purge_mode mode, std::size_t keep_size) noexcept
+{
+    std::size_t high_water = std::max(high_water_, buffer_offset_);
+    std::size_t purge_offset = buffer_offset_ + std::min(keep_size, high_water - buffer_offset_);
+    auto exp_size = internal::purge_range(buffer_, purge_offset, high_water, mode);
+    if (!exp_size.has_value()) [[unlikely]] {
+        return std::unexpected(std::move(exp_size).error());
+    }
+    high_water_ = purge_offset;
+    return exp_size.value();
+}
+
+std::expected<std::size_t, std::string> stack_allocator::purge(purge_mode mode) noexcept
+{
+    return purge(mode, 0);
+}
+
+std::uintptr_t stack_allocator::place(std::size_t alignment, std::size_t size) const noexcept
+{
+    alignment = std::max(alignof(internal::alloc_header), alignment);
+    std::byte* offset_ptr = buffer_.data() + buffer_offset_;
+    std::uintptr_t offset_addr = reinterpret_cast<std::uintptr_t>(offset_ptr);
+    std::uintptr_t target_addr = offset_addr + sizeof(internal::alloc_header);
+    std::uintptr_t aligned_addr = align_forward(static_cast<std::uintptr_t>(alignment), target_addr);
+    std::uintptr_t aligned_padding = aligned_addr - offset_addr;
+    if (buffer_offset_ + aligned_padding + size > buffer_.size()) [[unlikely]] {
+        return 0;
+    }
+    return aligned_addr;
+}
+
+void* stack_allocator::push(std::uintptr_t aligned_addr, std::size_t size) noexcept
+{
+    std::uintptr_t offset_addr = reinterpret_cast<std::uintptr_t>(buffer_.data() + buffer_offset_);
+    std::uintptr_t aligned_padding = aligned_addr - offset_addr;
+    internal::alloc_header* header_ptr = reinterpret_cast<internal::alloc_header*>(
+        aligned_addr - sizeof(internal::alloc_header));
+    header_ptr = std::assume_aligned<alignof(internal::alloc_header)>(header_ptr);
+    header_ptr = std::launder(std::construct_at(header_ptr, aligned_padding));
+
+    buffer_offset_ += aligned_padding + size;
+    internal::heap_profile_allocate(reinterpret_cast<void*>(aligned_addr), size);
+    return reinterpret_cast<void*>(aligned_addr);
+}
+
 stack_allocator::stack_allocator(
     std::span<std::byte> buffer, std::size_t buffer_offset) noexcept
     : buffer_(buffer),
-    buffer_offset_(buffer_offset)
+    buffer_offset_(buffer_offset),
+    high_water_(buffer_offset)
 {}
 
 } // namespace amber
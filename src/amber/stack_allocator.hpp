@@ -1,7 +1,9 @@
 #pragma once
 
 #include <amber/concept.hpp>
+#include <amber/purge.hpp>
 #include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <span>
 #include <string>
@@ -9,6 +11,19 @@
 
 namespace amber {
 
+namespace internal {
+
+// Stored directly before each stack allocation, padding is the distance from
+// the allocation back to the stack offset it was placed at
+struct alloc_header {
+public:
+    alloc_header(std::size_t padding) noexcept;
+
+    std::size_t padding;
+};
+
+} // namespace amber::internal
+
 class stack_allocator {
 public:
     stack_allocator() = delete;
@@ -36,6 +51,21 @@ public:
     requires std::is_nothrow_constructible_v<T, Args...>
     std::expected<T*, std::string> allocate(Args&&... args) noexcept;
 
+    // Resizes ptr in place, only possible when ptr is the most recent allocation
+    bool try_extend(void* ptr, std::size_t old_size, std::size_t new_size) noexcept;
+
+    // Releases the tail of ptr when it is the most recent allocation
+    bool shrink(void* ptr, std::size_t old_size, std::size_t new_size) noexcept;
+
+    // Resizes in place when possible, otherwise allocates and copies. When
+    // ptr is the most recent allocation the new block reuses its space, any
+    // other moved block is only released by freeing a block below it.
+    std::expected<void*, std::string> reallocate(
+        void* ptr, std::size_t old_size, std::size_t alignment, std::size_t new_size) noexcept;
+
+    std::expected<void*, std::string> reallocate(
+        void* ptr, std::size_t old_size, std::size_t new_size) noexcept;
+
     void free(void* ptr) noexcept;
 
     template<typename T>
@@ -44,18 +74,43 @@ public:
 
     std::size_t buffer_size() const noexcept;
 
+    // Whether ptr points into the buffer
+    bool owns(const void* ptr) const noexcept;
+
     std::size_t buffer_offset() const noexcept;
 
+    // Bytes above buffer_offset() written since the last purge
+    std::size_t dirty_size() const noexcept;
+
+    // Returns pages above buffer_offset() + keep_size that were written since
+    // the last purge to the OS, keep_size leaves headroom for reuse. Returns
+    // the number of bytes released.
+    std::expected<std::size_t, std::string> purge(purge_mode mode, std::size_t keep_size) noexcept;
+
+    std::expected<std::size_t, std::string> purge(purge_mode mode) noexcept;
+
 private:
     stack_allocator(
         std::span<std::byte> buffer,
         std::size_t buffer_offset
     ) noexcept;
 
+    // Address an allocation at the current offset would get, 0 when it does
+    // not fit. Nothing is written.
+    std::uintptr_t place(std::size_t alignment, std::size_t size) const noexcept;
+
+    // Writes the header for an address from place() and bumps the offset
+    void* push(std::uintptr_t aligned_addr, std::size_t size) noexcept;
+
     std::span<std::byte> buffer_;
     std::size_t buffer_offset_;
+    // Highest offset reached since the last purge, updated when the offset drops
+    std::size_t high_water_;
 };
 
+static_assert(ResizableAllocator<stack_allocator>);
+static_assert(OwningAllocator<stack_allocator>);
+
 } // namespace amber
 
 #include <amber/stack_allocator.inl>
@@ -1,3 +1,6 @@
+extern "C" {
+#include <unistd.h>
+}
 #include <amber/util.hpp>
 #include <cstdlib>
 #include <cstring>
@@ -77,4 +80,10 @@ void aligned_free(void* ptr) noexcept
 #endif
 }
 
+std::size_t page_size() noexcept
+{
+    static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
 } // namespace amber
@@ -7,10 +7,18 @@
 
 namespace amber {
 
+// Destructive interference size assumed for alignment of shared data.
+// std::hardware_destructive_interference_size is avoided since it is not
+// ABI stable across compiler flags.
+inline constexpr std::size_t cache_line_size = 64;
+
 std::expected<void*, std::string> aligned_alloc(std::size_t alignment, std::size_t size) noexcept;
 
 void aligned_free(void* ptr) noexcept;
 
+// Size of a virtual memory page on this system
+std::size_t page_size() noexcept;
+
 template<typename IntegerType>
 requires std::unsigned_integral<IntegerType>
 constexpr bool is_aligned(IntegerType alignment, IntegerType value) noexcept;
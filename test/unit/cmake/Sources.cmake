@@ -1,9 +1,37 @@
 set(AMBER_UNITTEST_SOURCES
+    affix_allocator_test.cpp
     aligned_buffer_test.cpp
+    alloc_trace_test.cpp
+    arena_hash_map_test.cpp
+    arena_scope_test.cpp
+    arena_string_test.cpp
+    arena_vector_test.cpp
+    bucketizer_test.cpp
+    compact_pool_allocator_test.cpp
+    coroutine_frame_test.cpp
+    double_stack_allocator_test.cpp
+    epoch_domain_test.cpp
+    fallback_allocator_test.cpp
+    fiber_stack_pool_test.cpp
+    frame_allocator_test.cpp
+    heap_profiler_test.cpp
+    lifetime_analyzer_test.cpp
+    lifetime_recorder_test.cpp
     linear_allocator_test.cpp
+    malloc_allocator_test.cpp
     malloc_buffer_test.cpp
+    mirrored_buffer_test.cpp
     mmap_buffer_test.cpp
+    owned_pool_allocator_test.cpp
     pool_allocator_test.cpp
+    prefault_test.cpp
+    purge_test.cpp
+    segregator_test.cpp
+    shared_buffer_test.cpp
+    shared_pool_allocator_test.cpp
+    snapshot_test.cpp
+    span_buffer_test.cpp
+    spsc_ring_allocator_test.cpp
     stack_allocator_test.cpp
     util_test.cpp
 )
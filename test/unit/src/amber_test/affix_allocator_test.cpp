@@ -0,0 +1,83 @@
+#include <amber/affix_allocator.hpp>
+#include <amber/malloc_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/stack_allocator.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace amber_test {
+
+namespace {
+
+struct size_prefix {
+public:
+    size_prefix() noexcept
+        : size(0)
+    {}
+
+    std::size_t size;
+};
+
+struct guard_suffix {
+public:
+    guard_suffix() noexcept
+        : value(0xfeedface)
+    {}
+
+    std::uint32_t value;
+};
+
+} // unnamed namespace
+
+TEST_CASE("affix_allocator prefix and suffix")
+{
+    using allocator_type = amber::affix_allocator<amber::malloc_allocator, size_prefix, guard_suffix>;
+    static_assert(allocator_type::prefix_size == alignof(std::max_align_t));
+    auto&& exp_alloc = allocator_type::create(amber::malloc_allocator());
+    REQUIRE(exp_alloc.has_value());
+    allocator_type allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate(8, 13);
+    REQUIRE(exp_a1.has_value());
+    void* ptr = exp_a1.value();
+    REQUIRE(amber::is_aligned(alignof(std::max_align_t), reinterpret_cast<std::uintptr_t>(ptr)));
+    REQUIRE(allocator.prefix(ptr)->size == 0);
+    allocator.prefix(ptr)->size = 13;
+    REQUIRE(allocator.suffix(ptr, 13)->value == 0xfeedface);
+    std::memset(ptr, 0xab, 13);
+    REQUIRE(allocator.suffix(ptr, 13)->value == 0xfeedface);
+    REQUIRE(reinterpret_cast<std::byte*>(allocator.suffix(ptr, 13)) == static_cast<std::byte*>(ptr) + 16);
+    allocator.free(ptr);
+
+    auto exp_a2 = allocator.allocate(4096, 8);
+    REQUIRE_FALSE(exp_a2.has_value());
+    REQUIRE(exp_a2.error() == "alignment too large");
+}
+
+TEST_CASE("affix_allocator suffix only")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_stack = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_stack.has_value());
+
+    using allocator_type = amber::affix_allocator<amber::stack_allocator, void, guard_suffix>;
+    static_assert(allocator_type::prefix_size == 0);
+    auto&& exp_alloc = allocator_type::create(std::move(exp_stack).value());
+    REQUIRE(exp_alloc.has_value());
+    allocator_type allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate<std::uint16_t>(7u);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(allocator.owns(exp_a1.value()));
+    REQUIRE(allocator.suffix(exp_a1.value(), sizeof(std::uint16_t))->value == 0xfeedface);
+    REQUIRE(reinterpret_cast<std::byte*>(allocator.suffix(exp_a1.value(), sizeof(std::uint16_t)))
+        == reinterpret_cast<std::byte*>(exp_a1.value()) + 4);
+    allocator.free(exp_a1.value());
+    REQUIRE(allocator.parent().buffer_offset() == 0);
+}
+
+} // namespace amber_test
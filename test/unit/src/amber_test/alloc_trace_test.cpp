@@ -0,0 +1,247 @@
+#include <amber/alloc_trace.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace amber_test {
+
+namespace {
+
+std::string trace_path(const char* name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // unnamed namespace
+
+TEST_CASE("trace_writer/trace_file round trip")
+{
+    std::string path = trace_path("amber_trace_round_trip_test.bin");
+    alignas(64) std::byte storage[256];
+    {
+        auto&& exp_writer = amber::trace_writer::create(path);
+        REQUIRE(exp_writer.has_value());
+        amber::trace_writer writer = std::move(exp_writer).value();
+        writer.allocate(storage, 64, 32);
+        writer.allocate(storage + 64, 8, 16);
+        writer.reallocate(storage + 64, storage + 128, 8, 100);
+        // Resized in place, the alignment is kept
+        writer.reallocate(storage, storage, 0, 48);
+        writer.free(storage);
+        // Not allocated through the writer
+        writer.free(storage + 192);
+        // Reuses the freed object id
+        writer.allocate(storage + 192, 16, 8);
+        writer.free(storage + 128);
+        REQUIRE(writer.record_count() == 7);
+        REQUIRE(!std::filesystem::exists(path));
+        REQUIRE(writer.finish().has_value());
+        auto&& exp_again = writer.finish();
+        REQUIRE(!exp_again.has_value());
+        REQUIRE(exp_again.error() == "trace already finished");
+    }
+
+    auto&& exp_trace = amber::trace_file::create(path);
+    REQUIRE(exp_trace.has_value());
+    amber::trace_file trace = std::move(exp_trace).value();
+    REQUIRE(trace.header().thread_count == 1);
+    REQUIRE(trace.header().object_count == 2);
+    REQUIRE(trace.header().record_count == 7);
+    auto records = trace.records();
+    REQUIRE(records.size() == 7);
+    REQUIRE(records[0].op == amber::trace_op::allocate);
+    REQUIRE(records[0].object == 0);
+    REQUIRE(records[0].size == 32);
+    REQUIRE(records[0].alignment_shift == 6);
+    REQUIRE(records[1].object == 1);
+    REQUIRE(records[2].op == amber::trace_op::reallocate);
+    REQUIRE(records[2].object == 1);
+    REQUIRE(records[2].size == 100);
+    REQUIRE(records[3].op == amber::trace_op::reallocate);
+    REQUIRE(records[3].object == 0);
+    REQUIRE(records[3].alignment_shift == 6);
+    REQUIRE(records[4].op == amber::trace_op::free);
+    REQUIRE(records[4].object == 0);
+    REQUIRE(records[5].op == amber::trace_op::allocate);
+    REQUIRE(records[5].object == 0);
+    REQUIRE(records[6].op == amber::trace_op::free);
+    REQUIRE(records[6].object == 1);
+    for (const amber::trace_record& record : records) {
+        REQUIRE(record.thread == 0);
+    }
+    // 48 + 100 bytes once both reallocations are done
+    REQUIRE(trace.peak_live_size() == 148);
+
+    amber::trace_file moved(std::move(trace));
+    REQUIRE(moved.records().size() == 7);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("trace_writer discards unfinished traces")
+{
+    std::string path = trace_path("amber_trace_unfinished_test.bin");
+    {
+        auto&& exp_writer = amber::trace_writer::create(path);
+        REQUIRE(exp_writer.has_value());
+        amber::trace_writer writer = std::move(exp_writer).value();
+        int value = 0;
+        writer.allocate(&value, alignof(int), sizeof(int));
+    }
+    REQUIRE(!std::filesystem::exists(path));
+    REQUIRE(!std::filesystem::exists(path + ".tmp"));
+}
+
+TEST_CASE("trace_writer grows its address table")
+{
+    std::string path = trace_path("amber_trace_grow_test.bin");
+    auto&& exp_writer = amber::trace_writer::create(path);
+    REQUIRE(exp_writer.has_value());
+    amber::trace_writer writer = std::move(exp_writer).value();
+    constexpr std::uintptr_t count = 5000;
+    for (std::uintptr_t i = 1; i <= count; ++i) {
+        writer.allocate(reinterpret_cast<void*>(i * 16), 16, i);
+    }
+    for (std::uintptr_t i = 1; i <= count; i += 2) {
+        writer.free(reinterpret_cast<void*>(i * 16));
+    }
+    for (std::uintptr_t i = 2; i <= count; i += 2) {
+        writer.free(reinterpret_cast<void*>(i * 16));
+    }
+    REQUIRE(writer.finish().has_value());
+
+    auto&& exp_trace = amber::trace_file::create(path);
+    REQUIRE(exp_trace.has_value());
+    amber::trace_file trace = std::move(exp_trace).value();
+    REQUIRE(trace.header().object_count == count);
+    REQUIRE(trace.records().size() == 2 * count);
+    REQUIRE(trace.records().back().op == amber::trace_op::free);
+    REQUIRE(trace.peak_live_size() == (count * (count + 1)) / 2);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("tracing_allocator records and replay_trace replays")
+{
+    std::string path = trace_path("amber_trace_replay_test.bin");
+    {
+        auto&& exp_buffer = amber::malloc_buffer::create(4096);
+        REQUIRE(exp_buffer.has_value());
+        amber::malloc_buffer buffer = std::move(exp_buffer).value();
+        auto&& exp_arena = amber::linear_allocator::create(buffer);
+        REQUIRE(exp_arena.has_value());
+        auto&& exp_writer = amber::trace_writer::create(path);
+        REQUIRE(exp_writer.has_value());
+        amber::trace_writer writer = std::move(exp_writer).value();
+        auto&& exp_tracing = amber::tracing_allocator<amber::linear_allocator>::create(
+            std::move(exp_arena).value(), writer);
+        REQUIRE(exp_tracing.has_value());
+        amber::tracing_allocator<amber::linear_allocator> tracing = std::move(exp_tracing).value();
+
+        auto&& exp_ptr1 = tracing.allocate(16, 64);
+        REQUIRE(exp_ptr1.has_value());
+        REQUIRE(tracing.try_extend(exp_ptr1.value(), 64, 128));
+        auto&& exp_ptr2 = tracing.allocate(8, 32);
+        REQUIRE(exp_ptr2.has_value());
+        auto&& exp_ptr3 = tracing.reallocate(exp_ptr1.value(), 128, 16, 256);
+        REQUIRE(exp_ptr3.has_value());
+        REQUIRE(writer.finish().has_value());
+    }
+
+    auto&& exp_trace = amber::trace_file::create(path);
+    REQUIRE(exp_trace.has_value());
+    amber::trace_file trace = std::move(exp_trace).value();
+    REQUIRE(trace.records().size() == 4);
+    REQUIRE(trace.header().object_count == 2);
+    REQUIRE(trace.peak_live_size() == 288);
+
+    amber::malloc_allocator heap;
+    auto&& exp_result = amber::replay_trace(trace, heap);
+    REQUIRE(exp_result.has_value());
+    REQUIRE(exp_result.value().operation_count == 4);
+    REQUIRE(exp_result.value().failed_count == 0);
+    REQUIRE(exp_result.value().peak_live_size == 288);
+    REQUIRE(exp_result.value().peak_rss >= exp_result.value().baseline_rss);
+    REQUIRE(exp_result.value().fragmentation >= 0.0);
+    REQUIRE(exp_result.value().fragmentation < 1.0);
+
+    // Too small for the trace, the failures are counted
+    auto&& exp_buffer = amber::malloc_buffer::create(256);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_arena = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_arena.has_value());
+    amber::linear_allocator arena = std::move(exp_arena).value();
+    auto&& exp_small = amber::replay_trace(trace, arena);
+    REQUIRE(exp_small.has_value());
+    REQUIRE(exp_small.value().failed_count == 1);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("replay_trace_threaded keeps cross thread order")
+{
+    std::string path = trace_path("amber_trace_threaded_test.bin");
+    constexpr std::size_t count = 1000;
+    {
+        auto&& exp_writer = amber::trace_writer::create(path);
+        REQUIRE(exp_writer.has_value());
+        amber::trace_writer writer = std::move(exp_writer).value();
+        amber::malloc_allocator heap;
+        void* ptrs[count];
+        // Allocated on one thread and freed on another
+        std::thread producer([&]() {
+            for (std::size_t i = 0; i < count; ++i) {
+                ptrs[i] = heap.allocate(16, 24).value_or(nullptr);
+                writer.allocate(ptrs[i], 16, 24);
+            }
+        });
+        producer.join();
+        std::thread consumer([&]() {
+            for (std::size_t i = 0; i < count; ++i) {
+                writer.free(ptrs[i]);
+                heap.free(ptrs[i]);
+            }
+        });
+        consumer.join();
+        REQUIRE(writer.finish().has_value());
+    }
+
+    auto&& exp_trace = amber::trace_file::create(path);
+    REQUIRE(exp_trace.has_value());
+    amber::trace_file trace = std::move(exp_trace).value();
+    REQUIRE(trace.header().thread_count == 2);
+    REQUIRE(trace.records().front().thread != trace.records().back().thread);
+
+    amber::malloc_allocator heap;
+    auto&& exp_result = amber::replay_trace_threaded(trace, heap);
+    REQUIRE(exp_result.has_value());
+    REQUIRE(exp_result.value().operation_count == 2 * count);
+    REQUIRE(exp_result.value().failed_count == 0);
+    REQUIRE(exp_result.value().peak_live_size == 24 * count);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("trace_file create errors")
+{
+    std::string path = trace_path("amber_trace_invalid_test.bin");
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    REQUIRE(file != nullptr);
+    const char junk[64] = "not a trace";
+    std::fwrite(junk, 1, sizeof(junk), file);
+    std::fclose(file);
+    auto&& exp_trace = amber::trace_file::create(path);
+    REQUIRE(!exp_trace.has_value());
+    REQUIRE(exp_trace.error() == "invalid trace header");
+    std::filesystem::remove(path);
+
+    auto&& exp_missing = amber::trace_file::create(path);
+    REQUIRE(!exp_missing.has_value());
+}
+
+} // namespace amber_test
@@ -0,0 +1,104 @@
+#include <amber/arena_hash_map.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/mmap_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace amber_test {
+
+using map_type = amber::arena_hash_map<std::uint64_t, std::uint32_t, amber::linear_allocator>;
+
+static_assert(std::is_trivially_destructible_v<map_type>);
+
+TEST_CASE("arena_hash_map insert/find/erase")
+{
+    auto exp_buffer = amber::mmap_buffer::create(1 << 20);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_alloc = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::linear_allocator allocator(std::move(exp_alloc).value());
+
+    auto exp_map = map_type::create(allocator);
+    REQUIRE(exp_map.has_value());
+    map_type map = std::move(exp_map).value();
+    REQUIRE(map.empty());
+    REQUIRE(map.find(1) == nullptr);
+
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        auto exp_inserted = map.insert(i * 7, static_cast<std::uint32_t>(i));
+        REQUIRE(exp_inserted.has_value());
+        REQUIRE(exp_inserted.value());
+    }
+    REQUIRE(map.size() == 1000);
+    REQUIRE(map.capacity() >= 1000);
+
+    auto exp_dup = map.insert(14, 0);
+    REQUIRE(exp_dup.has_value());
+    REQUIRE_FALSE(exp_dup.value());
+    REQUIRE(*map.find(14) == 2);
+
+    auto exp_assign = map.insert_or_assign(14, 99);
+    REQUIRE(exp_assign.has_value());
+    REQUIRE_FALSE(exp_assign.value());
+    REQUIRE(*map.find(14) == 99);
+
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        if (i == 2) {
+            continue;
+        }
+        const std::uint32_t* value = map.find(i * 7);
+        REQUIRE(value != nullptr);
+        REQUIRE(*value == i);
+        REQUIRE_FALSE(map.contains((i * 7) + 1));
+    }
+
+    for (std::uint64_t i = 0; i < 1000; i += 2) {
+        REQUIRE(map.erase(i * 7));
+    }
+    REQUIRE_FALSE(map.erase(0));
+    REQUIRE(map.size() == 500);
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        REQUIRE(map.contains(i * 7) == ((i % 2) == 1));
+    }
+
+    std::size_t count = 0;
+    map.for_each([&count](std::uint64_t key, std::uint32_t value) {
+        count += ((key / 7) == value) ? 1 : 0;
+    });
+    REQUIRE(count == 500);
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE_FALSE(map.contains(7));
+}
+
+TEST_CASE("arena_hash_map erase/insert churn reuses deleted slots")
+{
+    auto exp_buffer = amber::mmap_buffer::create(1 << 16);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_alloc = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::linear_allocator allocator(std::move(exp_alloc).value());
+
+    auto exp_map = map_type::create(allocator, 32);
+    REQUIRE(exp_map.has_value());
+    map_type map = std::move(exp_map).value();
+    std::size_t capacity = map.capacity();
+
+    for (std::uint64_t i = 0; i < 10000; ++i) {
+        REQUIRE(map.insert(i, 1).has_value());
+        if (i >= 16) {
+            REQUIRE(map.erase(i - 16));
+        }
+    }
+    REQUIRE(map.size() == 16);
+    REQUIRE(map.capacity() == capacity);
+}
+
+} // namespace amber_test
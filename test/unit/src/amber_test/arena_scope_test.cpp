@@ -0,0 +1,316 @@
+#include <amber/arena_new_delete.hpp>
+#include <amber/arena_scope.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <expected>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Assertions inside a scope could allocate into the arena memory the test
+// drops afterwards, so results are checked once the scope has ended
+
+namespace amber_test {
+
+namespace {
+
+struct alignas(64) wide {
+public:
+    std::byte bytes[64];
+};
+
+} // unnamed namespace
+
+TEST_CASE("arena_scope new without a scope uses the heap")
+{
+    REQUIRE(amber::arena_allocate(8, 16) == nullptr);
+    int* p = new int(7);
+    REQUIRE(*p == 7);
+    REQUIRE_FALSE(amber::arena_owns(p));
+    delete p;
+}
+
+TEST_CASE("arena_scope new routes to the arena and delete is a no-op")
+{
+    auto exp_buffer = amber::malloc_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_arena = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_arena.has_value());
+    amber::linear_allocator arena = std::move(exp_arena).value();
+
+    int* p = nullptr;
+    wide* w = nullptr;
+    bool owned = false;
+    bool registered = false;
+    std::size_t offset_before_delete = 0;
+    std::size_t offset_after_delete = 0;
+    {
+        auto exp_scope = amber::arena_scope<amber::linear_allocator>::create(arena);
+        REQUIRE(exp_scope.has_value());
+        amber::arena_scope<amber::linear_allocator> scope = std::move(exp_scope).value();
+        p = new int(42);
+        w = new wide();
+        owned = arena.owns(p) && arena.owns(w);
+        registered = amber::arena_owns(p) && amber::arena_owns(w);
+        offset_before_delete = arena.buffer_offset();
+        delete p;
+        delete w;
+        offset_after_delete = arena.buffer_offset();
+    }
+    REQUIRE(owned);
+    REQUIRE(registered);
+    REQUIRE(*p == 42);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(w) % 64 == 0);
+    REQUIRE(offset_before_delete > 0);
+    REQUIRE(offset_after_delete == offset_before_delete);
+    REQUIRE_FALSE(amber::arena_owns(p));
+
+    int* heap = new int(1);
+    REQUIRE_FALSE(arena.owns(heap));
+    delete heap;
+    arena.reset();
+}
+
+TEST_CASE("arena_scope containers allocate from the arena")
+{
+    auto exp_buffer = amber::malloc_buffer::create(1 << 16);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_arena = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_arena.has_value());
+    amber::linear_allocator arena = std::move(exp_arena).value();
+
+    bool owned = false;
+    std::size_t sum = 0;
+    {
+        auto exp_scope = amber::arena_scope<amber::linear_allocator>::create(arena);
+        REQUIRE(exp_scope.has_value());
+        amber::arena_scope<amber::linear_allocator> scope = std::move(exp_scope).value();
+        std::vector<std::size_t> values;
+        for (std::size_t i = 0; i < 100; ++i) {
+            values.push_back(i);
+        }
+        owned = arena.owns(values.data());
+        for (std::size_t v : values) {
+            sum += v;
+        }
+    }
+    REQUIRE(owned);
+    REQUIRE(sum == 4950);
+    arena.reset();
+    REQUIRE(arena.buffer_offset() == 0);
+}
+
+TEST_CASE("arena_scope nested scopes restore the outer arena")
+{
+    auto exp_outer_buffer = amber::malloc_buffer::create(1024);
+    REQUIRE(exp_outer_buffer.has_value());
+    amber::malloc_buffer outer_buffer = std::move(exp_outer_buffer).value();
+    auto exp_inner_buffer = amber::malloc_buffer::create(1024);
+    REQUIRE(exp_inner_buffer.has_value());
+    amber::malloc_buffer inner_buffer = std::move(exp_inner_buffer).value();
+    auto exp_outer = amber::linear_allocator::create(outer_buffer);
+    REQUIRE(exp_outer.has_value());
+    amber::linear_allocator outer = std::move(exp_outer).value();
+    auto exp_inner = amber::linear_allocator::create(inner_buffer);
+    REQUIRE(exp_inner.has_value());
+    amber::linear_allocator inner = std::move(exp_inner).value();
+
+    bool first_outer = false;
+    bool nested_inner = false;
+    bool nested_sees_outer = false;
+    bool after_outer = false;
+    {
+        auto exp_outer_scope = amber::arena_scope<amber::linear_allocator>::create(outer);
+        REQUIRE(exp_outer_scope.has_value());
+        amber::arena_scope<amber::linear_allocator> outer_scope = std::move(exp_outer_scope).value();
+        int* a = new int(1);
+        first_outer = outer.owns(a);
+        {
+            auto exp_inner_scope = amber::arena_scope<amber::linear_allocator>::create(inner);
+            REQUIRE(exp_inner_scope.has_value());
+            amber::arena_scope<amber::linear_allocator> inner_scope = std::move(exp_inner_scope).value();
+            int* b = new int(2);
+            nested_inner = inner.owns(b);
+            nested_sees_outer = amber::arena_owns(a);
+            delete b;
+        }
+        int* c = new int(3);
+        after_outer = outer.owns(c);
+        delete a;
+        delete c;
+    }
+    REQUIRE(first_outer);
+    REQUIRE(nested_inner);
+    REQUIRE(nested_sees_outer);
+    REQUIRE(after_outer);
+}
+
+TEST_CASE("arena_scope falls back to the heap when the arena is full")
+{
+    auto exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_arena = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_arena.has_value());
+    amber::linear_allocator arena = std::move(exp_arena).value();
+
+    char* big = nullptr;
+    bool in_arena = true;
+    bool registered = true;
+    {
+        auto exp_scope = amber::arena_scope<amber::linear_allocator>::create(arena);
+        REQUIRE(exp_scope.has_value());
+        amber::arena_scope<amber::linear_allocator> scope = std::move(exp_scope).value();
+        big = new char[1024];
+        big[1023] = 'x';
+        in_arena = arena.owns(big);
+        registered = amber::arena_owns(big);
+    }
+    REQUIRE_FALSE(in_arena);
+    REQUIRE_FALSE(registered);
+    REQUIRE(big[1023] == 'x');
+    delete[] big;
+}
+
+TEST_CASE("arena_scope delete after the scope ended")
+{
+    auto exp_buffer = amber::malloc_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_arena = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_arena.has_value());
+    amber::linear_allocator arena = std::move(exp_arena).value();
+
+    int* in_arena = nullptr;
+    wide* aligned = nullptr;
+    char* spilled = nullptr;
+    {
+        auto exp_scope = amber::arena_scope<amber::linear_allocator>::create(arena);
+        REQUIRE(exp_scope.has_value());
+        amber::arena_scope<amber::linear_allocator> scope = std::move(exp_scope).value();
+        in_arena = new int(3);
+        aligned = new wide();
+        // Too large for the arena, comes from the heap
+        spilled = new char[8192];
+    }
+    REQUIRE(arena.owns(in_arena));
+    REQUIRE(arena.owns(aligned));
+    REQUIRE(reinterpret_cast<std::uintptr_t>(aligned) % 64 == 0);
+    REQUIRE_FALSE(arena.owns(spilled));
+    REQUIRE_FALSE(amber::arena_owns(in_arena));
+    // No scope knows these anymore, the headers still tell them apart
+    std::size_t offset = arena.buffer_offset();
+    delete in_arena;
+    delete aligned;
+    delete[] spilled;
+    REQUIRE(arena.buffer_offset() == offset);
+    arena.reset();
+}
+
+TEST_CASE("arena_scope zero-size new at the end of a full arena")
+{
+    auto exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_arena = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_arena.has_value());
+    amber::linear_allocator arena = std::move(exp_arena).value();
+
+    void* zero = nullptr;
+    bool filled = false;
+    bool zero_owned = true;
+    bool zero_registered = true;
+    {
+        auto exp_scope = amber::arena_scope<amber::linear_allocator>::create(arena);
+        REQUIRE(exp_scope.has_value());
+        amber::arena_scope<amber::linear_allocator> scope = std::move(exp_scope).value();
+        filled = amber::arena_allocate(1, 64) != nullptr;
+        zero = ::operator new(0);
+        zero_owned = arena.owns(zero);
+        zero_registered = amber::arena_owns(zero);
+    }
+    // The full arena had no byte left, the allocation came from the heap
+    REQUIRE(filled);
+    REQUIRE_FALSE(zero_owned);
+    REQUIRE_FALSE(zero_registered);
+    REQUIRE(zero != static_cast<void*>(buffer.buffer().data() + 64));
+    ::operator delete(zero);
+}
+
+TEST_CASE("arena_scope pointers are recognized from other threads")
+{
+    auto exp_buffer = amber::malloc_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_arena = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_arena.has_value());
+    amber::linear_allocator arena = std::move(exp_arena).value();
+
+    auto exp_scope = amber::arena_scope<amber::linear_allocator>::create(arena);
+    REQUIRE(exp_scope.has_value());
+    std::optional<amber::arena_scope<amber::linear_allocator>> scope;
+    int* p = nullptr;
+    {
+        amber::arena_scope<amber::linear_allocator> local = std::move(exp_scope).value();
+        p = new int(5);
+        // The moved scope keeps the arena current
+        scope.emplace(std::move(local));
+    }
+    bool seen = false;
+    bool heap_seen = true;
+    void* heap = std::malloc(16);
+    std::thread t([&]() {
+        seen = amber::arena_owns(p);
+        heap_seen = amber::arena_owns(heap);
+        // Nothing is active on this thread, the delete still leaves the arena alone
+        delete p;
+    });
+    t.join();
+    std::free(heap);
+    std::size_t offset = arena.buffer_offset();
+    scope.reset();
+    REQUIRE(seen);
+    REQUIRE_FALSE(heap_seen);
+    REQUIRE(offset > 0);
+    REQUIRE(arena.owns(p));
+}
+
+TEST_CASE("arena_scope too many scopes")
+{
+    auto exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_arena = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_arena.has_value());
+    amber::linear_allocator arena = std::move(exp_arena).value();
+
+    std::vector<amber::arena_scope<amber::linear_allocator>> scopes;
+    scopes.reserve(amber::internal::arena_slot_count);
+    // The error message may land in the arena, it is only compared in scope
+    bool full_error = false;
+    for (std::size_t i = 0; i <= amber::internal::arena_slot_count; ++i) {
+        auto exp_scope = amber::arena_scope<amber::linear_allocator>::create(arena);
+        if (!exp_scope.has_value()) {
+            full_error = exp_scope.error() == "too many active arena scopes";
+            break;
+        }
+        scopes.push_back(std::move(exp_scope).value());
+    }
+    std::size_t count = scopes.size();
+    while (!scopes.empty()) {
+        scopes.pop_back();
+    }
+    REQUIRE(count == amber::internal::arena_slot_count);
+    REQUIRE(full_error);
+    REQUIRE(amber::arena_allocate(8, 8) == nullptr);
+}
+
+} // namespace amber_test
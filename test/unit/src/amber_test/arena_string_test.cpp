@@ -0,0 +1,49 @@
+#include <amber/arena_string.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+namespace amber_test {
+
+TEST_CASE("arena_string append/push_back")
+{
+    auto exp_buffer = amber::malloc_buffer::create(256);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_alloc = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::linear_allocator allocator(std::move(exp_alloc).value());
+
+    auto exp_str = amber::arena_string<amber::linear_allocator>::create(allocator, "hello");
+    REQUIRE(exp_str.has_value());
+    auto str = std::move(exp_str).value();
+    REQUIRE(str.size() == 5);
+    REQUIRE(str.view() == "hello");
+    REQUIRE(std::strcmp(str.c_str(), "hello") == 0);
+
+    REQUIRE(str.push_back(',').has_value());
+    REQUIRE(str.append(" world").has_value());
+    REQUIRE(str.view() == "hello, world");
+    REQUIRE(std::strlen(str.c_str()) == str.size());
+    // the string is the only allocation, so it grew in place
+    REQUIRE(allocator.buffer_offset() == str.capacity() + 1);
+
+    str[0] = 'H';
+    std::string_view view = str;
+    REQUIRE(view == "Hello, world");
+
+    str.clear();
+    REQUIRE(str.empty());
+    REQUIRE(str.c_str()[0] == '\0');
+
+    auto exp_empty = amber::arena_string<amber::linear_allocator>::create(allocator);
+    REQUIRE(exp_empty.has_value());
+    REQUIRE(exp_empty.value().empty());
+    REQUIRE(exp_empty.value().c_str()[0] == '\0');
+}
+
+} // namespace amber_test
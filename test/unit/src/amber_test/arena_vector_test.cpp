@@ -0,0 +1,104 @@
+#include <amber/arena_vector.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/stack_allocator.hpp>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace amber_test {
+
+static_assert(std::is_trivially_destructible_v<amber::arena_vector<int, amber::linear_allocator>>);
+
+TEST_CASE("arena_vector push_back grows in place")
+{
+    auto exp_buffer = amber::malloc_buffer::create(2048);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_alloc = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::linear_allocator allocator(std::move(exp_alloc).value());
+
+    auto exp_vec = amber::arena_vector<std::uint32_t, amber::linear_allocator>::create(allocator);
+    REQUIRE(exp_vec.has_value());
+    auto vec = std::move(exp_vec).value();
+    REQUIRE(vec.empty());
+    REQUIRE(vec.capacity() == 0);
+
+    for (std::uint32_t i = 0; i < 100; ++i) {
+        REQUIRE(vec.push_back(i).has_value());
+    }
+    REQUIRE(vec.size() == 100);
+    // every growth extended the top allocation, nothing was left behind
+    REQUIRE(allocator.buffer_offset() == vec.capacity() * sizeof(std::uint32_t));
+    const std::uint32_t* data = vec.data();
+    for (std::uint32_t i = 0; i < 100; ++i) {
+        REQUIRE(vec[i] == i);
+    }
+
+    auto exp_other = allocator.allocate(4, 4);
+    REQUIRE(exp_other.has_value());
+    REQUIRE(vec.reserve(vec.capacity() + 1).has_value());
+    REQUIRE(vec.data() != data);
+    std::uint32_t sum = 0;
+    for (std::uint32_t value : vec) {
+        sum += value;
+    }
+    REQUIRE(sum == 4950);
+
+    vec.pop_back();
+    REQUIRE(vec.size() == 99);
+    vec.clear();
+    REQUIRE(vec.empty());
+}
+
+TEST_CASE("arena_vector resize/append/emplace_back")
+{
+    auto exp_buffer = amber::malloc_buffer::create(256);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_alloc = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::stack_allocator allocator(std::move(exp_alloc).value());
+
+    auto exp_vec = amber::arena_vector<int, amber::stack_allocator>::create(allocator, 4);
+    REQUIRE(exp_vec.has_value());
+    auto vec = std::move(exp_vec).value();
+    REQUIRE(vec.capacity() == 4);
+
+    REQUIRE(vec.resize(3).has_value());
+    REQUIRE(vec.size() == 3);
+    REQUIRE(vec[0] == 0);
+    REQUIRE(vec[2] == 0);
+
+    std::array<int, 3> values{1, 2, 3};
+    REQUIRE(vec.append(values).has_value());
+    REQUIRE(vec.size() == 6);
+    REQUIRE(vec[5] == 3);
+
+    auto exp_ptr = vec.emplace_back(7);
+    REQUIRE(exp_ptr.has_value());
+    REQUIRE(*exp_ptr.value() == 7);
+    REQUIRE(vec.span().size() == 7);
+
+    auto exp_big = vec.resize(1024);
+    REQUIRE_FALSE(exp_big.has_value());
+    REQUIRE(exp_big.error() == "out of capacity");
+    REQUIRE(vec.size() == 7);
+
+    // capacity * sizeof(T) would wrap around to a small allocation
+    auto exp_wrap = vec.reserve(SIZE_MAX / sizeof(int) + 1);
+    REQUIRE_FALSE(exp_wrap.has_value());
+    REQUIRE(exp_wrap.error() == "capacity too large");
+    REQUIRE(vec.size() == 7);
+
+    auto moved = std::move(vec);
+    REQUIRE(moved.size() == 7);
+    REQUIRE(vec.size() == 0);
+}
+
+} // namespace amber_test
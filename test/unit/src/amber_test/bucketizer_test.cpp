@@ -0,0 +1,83 @@
+#include <amber/bucketizer.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <utility>
+
+namespace amber_test {
+
+namespace {
+
+struct block {
+public:
+    std::uint64_t values[8];
+};
+
+} // unnamed namespace
+
+TEST_CASE("bucketizer allocate(alignment, size)/free(ptr)")
+{
+    using allocator_type = amber::bucketizer<amber::pool_allocator, 0, 64, 16>;
+    static_assert(allocator_type::bucket_count == 4);
+    static_assert(allocator_type::bucket_size(0) == 16);
+    static_assert(allocator_type::bucket_size(3) == 64);
+
+    auto&& exp_b0 = amber::malloc_buffer::create(256);
+    auto&& exp_b1 = amber::malloc_buffer::create(256);
+    auto&& exp_b2 = amber::malloc_buffer::create(256);
+    auto&& exp_b3 = amber::malloc_buffer::create(256);
+    REQUIRE(exp_b0.has_value());
+    REQUIRE(exp_b1.has_value());
+    REQUIRE(exp_b2.has_value());
+    REQUIRE(exp_b3.has_value());
+    amber::malloc_buffer b0 = std::move(exp_b0).value();
+    amber::malloc_buffer b1 = std::move(exp_b1).value();
+    amber::malloc_buffer b2 = std::move(exp_b2).value();
+    amber::malloc_buffer b3 = std::move(exp_b3).value();
+    auto&& exp_p0 = amber::pool_allocator::create(b0, 16);
+    auto&& exp_p1 = amber::pool_allocator::create(b1, 32);
+    auto&& exp_p2 = amber::pool_allocator::create(b2, 48);
+    auto&& exp_p3 = amber::pool_allocator::create(b3, 64);
+    REQUIRE(exp_p0.has_value());
+    REQUIRE(exp_p1.has_value());
+    REQUIRE(exp_p2.has_value());
+    REQUIRE(exp_p3.has_value());
+    auto&& exp_alloc = allocator_type::create({
+        std::move(exp_p0).value(), std::move(exp_p1).value(),
+        std::move(exp_p2).value(), std::move(exp_p3).value()});
+    REQUIRE(exp_alloc.has_value());
+    allocator_type allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate(8, 1);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(allocator.bucket(0).owns(exp_a1.value()));
+    auto exp_a2 = allocator.allocate(8, 17);
+    REQUIRE(exp_a2.has_value());
+    REQUIRE(allocator.bucket(1).owns(exp_a2.value()));
+    auto exp_a3 = allocator.allocate<block>();
+    REQUIRE(exp_a3.has_value());
+    REQUIRE(allocator.bucket(3).owns(exp_a3.value()));
+    REQUIRE(allocator.owns(exp_a3.value()));
+
+    auto exp_a4 = allocator.allocate(8, 65);
+    REQUIRE_FALSE(exp_a4.has_value());
+    REQUIRE(exp_a4.error() == "size out of bucket range");
+    auto exp_a5 = allocator.allocate(8, 0);
+    REQUIRE_FALSE(exp_a5.has_value());
+    auto exp_a6 = allocator.allocate(24, 8);
+    REQUIRE_FALSE(exp_a6.has_value());
+    REQUIRE(exp_a6.error() == "invalid alignment: 24");
+
+    allocator.free(exp_a1.value());
+    REQUIRE(allocator.bucket(0).entry_allocate_count() == 0);
+    // The sized free picks the bucket without asking the others
+    allocator.free(exp_a2.value(), 17);
+    REQUIRE(allocator.bucket(1).entry_allocate_count() == 0);
+    allocator.free(exp_a3.value());
+    for (std::size_t i = 0; i < allocator_type::bucket_count; ++i) {
+        REQUIRE(allocator.bucket(i).entry_allocate_count() == 0);
+    }
+}
+
+} // namespace amber_test
@@ -0,0 +1,126 @@
+#include <amber/compact_pool_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace amber_test {
+
+TEST_CASE("compact_pool_allocator move constructor/assignment")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto&& exp_alloc = amber::compact_pool_allocator::create(buffer, 4);
+    REQUIRE(exp_alloc.has_value());
+    amber::compact_pool_allocator a1(std::move(exp_alloc).value());
+    REQUIRE(a1.buffer_size() == 64);
+    REQUIRE(a1.entry_size() == 4);
+    REQUIRE(a1.entry_count() == 16);
+    REQUIRE(a1.entry_allocate_count() == 0);
+
+    amber::compact_pool_allocator a2(std::move(a1));
+    REQUIRE(a1.buffer_size() == 0);
+    REQUIRE(a1.entry_size() == 0);
+    REQUIRE(a1.entry_count() == 0);
+    REQUIRE(a2.buffer_size() == 64);
+    REQUIRE(a2.entry_size() == 4);
+    REQUIRE(a2.entry_count() == 16);
+
+    a1 = std::move(a2);
+    REQUIRE(a1.buffer_size() == 64);
+    REQUIRE(a1.entry_size() == 4);
+    REQUIRE(a1.entry_count() == 16);
+    REQUIRE(a2.buffer_size() == 0);
+    REQUIRE(a2.entry_size() == 0);
+    REQUIRE(a2.entry_count() == 0);
+}
+
+TEST_CASE("compact_pool_allocator allocate()/free(ptr)")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(16);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto&& exp_alloc = amber::compact_pool_allocator::create(buffer, 1);
+    REQUIRE(exp_alloc.has_value());
+    amber::compact_pool_allocator allocator(std::move(exp_alloc).value());
+    REQUIRE(allocator.entry_size() == 4);
+    REQUIRE(allocator.entry_count() == 4);
+
+    void* ptrs[4] = {};
+    for (std::size_t i = 0; i < 4; ++i) {
+        auto exp_ptr = allocator.allocate();
+        REQUIRE(exp_ptr.has_value());
+        ptrs[i] = exp_ptr.value();
+        REQUIRE(allocator.entry_allocate_count() == i + 1);
+        REQUIRE(allocator.pointer_to(allocator.index_of(ptrs[i])) == ptrs[i]);
+    }
+
+    auto exp_a5 = allocator.allocate();
+    REQUIRE_FALSE(exp_a5.has_value());
+    REQUIRE(exp_a5.error() == "out of capacity");
+
+    allocator.free(ptrs[1]);
+    allocator.free(ptrs[3]);
+    REQUIRE(allocator.entry_free_count() == 2);
+
+    auto exp_a6 = allocator.allocate();
+    REQUIRE(exp_a6.has_value());
+    REQUIRE(exp_a6.value() == ptrs[3]);
+    auto exp_a7 = allocator.allocate();
+    REQUIRE(exp_a7.has_value());
+    REQUIRE(exp_a7.value() == ptrs[1]);
+    REQUIRE(allocator.entry_free_count() == 0);
+}
+
+TEST_CASE("compact_pool_allocator allocate<T>()/free<T>(ptr)")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(32);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto&& exp_alloc = amber::compact_pool_allocator::create(buffer, sizeof(std::uint32_t));
+    REQUIRE(exp_alloc.has_value());
+    amber::compact_pool_allocator allocator(std::move(exp_alloc).value());
+    REQUIRE(allocator.entry_count() == 8);
+
+    auto exp_a1 = allocator.allocate<std::uint32_t>(42u);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(*exp_a1.value() == 42);
+    allocator.free<std::uint32_t>(exp_a1.value());
+    REQUIRE(allocator.entry_allocate_count() == 0);
+
+    auto exp_a2 = allocator.allocate<std::uint64_t>(0u);
+    REQUIRE_FALSE(exp_a2.has_value());
+    REQUIRE(exp_a2.error() == "type size too large");
+}
+
+TEST_CASE("compact_pool_allocator position independent free list")
+{
+    auto&& exp_b1 = amber::malloc_buffer::create(32);
+    REQUIRE(exp_b1.has_value());
+    amber::malloc_buffer b1 = std::move(exp_b1).value();
+    auto&& exp_b2 = amber::malloc_buffer::create(32);
+    REQUIRE(exp_b2.has_value());
+    amber::malloc_buffer b2 = std::move(exp_b2).value();
+
+    auto&& exp_alloc = amber::compact_pool_allocator::create(b1, 4);
+    REQUIRE(exp_alloc.has_value());
+    amber::compact_pool_allocator allocator(std::move(exp_alloc).value());
+    auto exp_a1 = allocator.allocate();
+    REQUIRE(exp_a1.has_value());
+    allocator.free(exp_a1.value());
+
+    // The free list only holds indices, so copied contents are valid at any address
+    std::memcpy(b2.buffer().data(), b1.buffer().data(), 32);
+    for (std::size_t i = 0; i < 8; ++i) {
+        std::uint32_t next = 0;
+        std::memcpy(&next, b2.buffer().data() + (i * 4), sizeof(next));
+        REQUIRE(next == (i == 0 ? amber::compact_pool_allocator::null_index : i - 1));
+    }
+}
+
+} // namespace amber_test
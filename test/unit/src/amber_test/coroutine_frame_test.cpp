@@ -0,0 +1,300 @@
+#include <amber/coroutine_frame.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/stack_allocator.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace amber_test {
+
+namespace {
+
+// Lazily started coroutine returning an int, awaiting one resumes it and
+// transfers back to the awaiter when it finishes
+class task {
+public:
+    struct promise_type : amber::coroutine_frame_promise {
+    public:
+        task get_return_object() noexcept
+        {
+            return task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        auto final_suspend() noexcept
+        {
+            struct final_awaiter {
+            public:
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    std::coroutine_handle<> continuation = handle.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+
+                void await_resume() noexcept
+                {}
+            };
+            return final_awaiter{};
+        }
+
+        void return_value(int v) noexcept
+        {
+            value = v;
+        }
+
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+
+        int value = 0;
+        std::coroutine_handle<> continuation;
+    };
+
+    task(const task&) = delete;
+
+    task(task&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr))
+    {}
+
+    task& operator=(const task&) = delete;
+
+    task& operator=(task&&) = delete;
+
+    ~task() noexcept
+    {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+
+    int await_resume() noexcept
+    {
+        return handle_.promise().value;
+    }
+
+    // Runs the coroutine to completion from outside any coroutine
+    int run() noexcept
+    {
+        handle_.resume();
+        return handle_.promise().value;
+    }
+
+    void* frame() const noexcept
+    {
+        return handle_.address();
+    }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept
+        : handle_(handle)
+    {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+task add(int a, int b)
+{
+    co_return a + b;
+}
+
+task large_frame(int seed)
+{
+    volatile std::byte scratch[8192];
+    scratch[0] = std::byte(seed);
+    scratch[8191] = std::byte(seed);
+    co_await std::suspend_never{};
+    co_return static_cast<int>(scratch[0]) + static_cast<int>(scratch[8191]);
+}
+
+template<typename A>
+task nested_sum(std::allocator_arg_t, A& allocator, int depth)
+{
+    if (depth == 0) {
+        co_return 0;
+    }
+    int inner = co_await nested_sum(std::allocator_arg, allocator, depth - 1);
+    co_return inner + depth;
+}
+
+struct adder {
+public:
+    template<typename A>
+    task add_to(std::allocator_arg_t, A&, int v)
+    {
+        co_return base + v;
+    }
+
+    int base;
+};
+
+} // unnamed namespace
+
+TEST_CASE("coroutine_frame pooled frames")
+{
+    task t = add(2, 3);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(t.frame()) % __STDCPP_DEFAULT_NEW_ALIGNMENT__ == 0);
+    REQUIRE(t.run() == 5);
+}
+
+TEST_CASE("coroutine_frame freed frames are reused from the thread cache")
+{
+    void* first = nullptr;
+    {
+        task t = add(1, 1);
+        first = t.frame();
+        REQUIRE(t.run() == 2);
+    }
+    void* second = nullptr;
+    {
+        task t = add(2, 2);
+        second = t.frame();
+        REQUIRE(t.run() == 4);
+    }
+    REQUIRE(first == second);
+}
+
+TEST_CASE("coroutine_frame allocate_pooled_frame size classes")
+{
+    void* small = amber::internal::allocate_pooled_frame(16);
+    REQUIRE(small != nullptr);
+    std::size_t cached = amber::internal::cached_frame_count(0);
+    amber::internal::release_frame(small);
+    REQUIRE(amber::internal::cached_frame_count(0) == cached + 1);
+
+    void* largest = amber::internal::allocate_pooled_frame(
+        amber::internal::coroutine_frame_max_block_size - sizeof(amber::internal::coroutine_frame_header));
+    REQUIRE(largest != nullptr);
+    std::size_t last_class = amber::internal::coroutine_frame_class_count - 1;
+    cached = amber::internal::cached_frame_count(last_class);
+    amber::internal::release_frame(largest);
+    REQUIRE(amber::internal::cached_frame_count(last_class) == cached + 1);
+
+    // Too large for the pools, comes from operator new and is not cached
+    void* huge = amber::internal::allocate_pooled_frame(amber::internal::coroutine_frame_max_block_size);
+    REQUIRE(huge != nullptr);
+    cached = amber::internal::cached_frame_count(last_class);
+    amber::internal::release_frame(huge);
+    REQUIRE(amber::internal::cached_frame_count(last_class) == cached);
+}
+
+TEST_CASE("coroutine_frame refills past a full cache")
+{
+    constexpr std::size_t count = amber::internal::coroutine_frame_cache_capacity * 4;
+    void* frames[count];
+    for (std::size_t i = 0; i < count; ++i) {
+        frames[i] = amber::internal::allocate_pooled_frame(100);
+        REQUIRE(frames[i] != nullptr);
+        static_cast<std::byte*>(frames[i])[99] = std::byte(i);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(static_cast<std::byte*>(frames[i])[99] == std::byte(i));
+        amber::internal::release_frame(frames[i]);
+    }
+    REQUIRE(amber::internal::cached_frame_count(1) <= amber::internal::coroutine_frame_cache_capacity);
+}
+
+TEST_CASE("coroutine_frame large frames")
+{
+    task t = large_frame(3);
+    REQUIRE(t.run() == 6);
+}
+
+TEST_CASE("coroutine_frame frames destroyed on another thread")
+{
+    task t = add(4, 5);
+    REQUIRE(t.run() == 9);
+    std::thread other([moved = std::move(t)]() mutable {
+        task local = std::move(moved);
+    });
+    other.join();
+    task u = add(1, 2);
+    REQUIRE(u.run() == 3);
+}
+
+TEST_CASE("coroutine_frame allocator_arg with stack_allocator")
+{
+    auto exp_buffer = amber::malloc_buffer::create(1 << 16);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_stack = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_stack.has_value());
+    amber::stack_allocator stack = std::move(exp_stack).value();
+
+    {
+        task t = nested_sum(std::allocator_arg, stack, 8);
+        REQUIRE(stack.owns(t.frame()));
+        REQUIRE(stack.buffer_offset() > 0);
+        REQUIRE(t.run() == 36);
+    }
+    // Nested frames were released in reverse order
+    REQUIRE(stack.buffer_offset() == 0);
+}
+
+TEST_CASE("coroutine_frame allocator_arg with linear_allocator")
+{
+    auto exp_buffer = amber::malloc_buffer::create(1 << 16);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_arena = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_arena.has_value());
+    amber::linear_allocator arena = std::move(exp_arena).value();
+
+    std::size_t offset = 0;
+    {
+        task t = nested_sum(std::allocator_arg, arena, 3);
+        REQUIRE(arena.owns(t.frame()));
+        REQUIRE(t.run() == 6);
+        offset = arena.buffer_offset();
+    }
+    // The arena cannot free, frames stay until reset
+    REQUIRE(arena.buffer_offset() == offset);
+    arena.reset();
+    REQUIRE(arena.buffer_offset() == 0);
+}
+
+TEST_CASE("coroutine_frame allocator_arg on a member coroutine")
+{
+    auto exp_buffer = amber::malloc_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_stack = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_stack.has_value());
+    amber::stack_allocator stack = std::move(exp_stack).value();
+
+    adder a{10};
+    {
+        task t = a.add_to(std::allocator_arg, stack, 5);
+        REQUIRE(stack.owns(t.frame()));
+        REQUIRE(t.run() == 15);
+    }
+    REQUIRE(stack.buffer_offset() == 0);
+}
+
+} // namespace amber_test
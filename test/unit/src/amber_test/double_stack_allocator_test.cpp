@@ -0,0 +1,171 @@
+#include <amber/double_stack_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <utility>
+
+namespace amber_test {
+
+TEST_CASE("double_stack_allocator move constructor/assignment")
+{
+    auto exp_buffer = amber::malloc_buffer::create(128);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_alloc = amber::double_stack_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::double_stack_allocator a1(std::move(exp_alloc).value());
+    REQUIRE(a1.buffer_size() == 128);
+    REQUIRE(a1.low_offset() == 0);
+    REQUIRE(a1.high_offset() == 128);
+
+    amber::double_stack_allocator a2(std::move(a1));
+    REQUIRE(a1.buffer_size() == 0);
+    REQUIRE(a1.high_offset() == 0);
+    REQUIRE(a2.buffer_size() == 128);
+    REQUIRE(a2.high_offset() == 128);
+
+    a1 = std::move(a2);
+    REQUIRE(a1.buffer_size() == 128);
+    REQUIRE(a1.high_offset() == 128);
+    REQUIRE(a2.buffer_size() == 0);
+}
+
+TEST_CASE("double_stack_allocator allocate_low/allocate_high/free")
+{
+    auto exp_buffer = amber::malloc_buffer::create(256);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer.buffer().data());
+
+    auto exp_alloc = amber::double_stack_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::double_stack_allocator allocator(std::move(exp_alloc).value());
+
+    auto exp_low1 = allocator.allocate_low(8);
+    REQUIRE(exp_low1.has_value());
+    REQUIRE(reinterpret_cast<std::uintptr_t>(exp_low1.value()) == buffer_addr + 16);
+    REQUIRE(allocator.low_offset() == 24);
+
+    auto exp_high1 = allocator.allocate_high(8);
+    REQUIRE(exp_high1.has_value());
+    REQUIRE(reinterpret_cast<std::uintptr_t>(exp_high1.value()) == buffer_addr + 240);
+    REQUIRE(allocator.high_offset() == 232);
+    auto exp_high2 = allocator.allocate_high(4, 4);
+    REQUIRE(exp_high2.has_value());
+    REQUIRE(reinterpret_cast<std::uintptr_t>(exp_high2.value()) == buffer_addr + 224);
+    REQUIRE(allocator.high_offset() == 216);
+
+    auto exp_low2 = allocator.allocate_low(8);
+    REQUIRE(exp_low2.has_value());
+    REQUIRE(allocator.owns(exp_low2.value()));
+    REQUIRE(allocator.owns(exp_high2.value()));
+    REQUIRE_FALSE(allocator.owns(buffer.buffer().data() + 100));
+    REQUIRE(allocator.low_offset() == 40);
+    REQUIRE(allocator.free_size() == 216 - 40);
+
+    // Each stack frees independently of the other
+    allocator.free(exp_low2.value());
+    REQUIRE(allocator.low_offset() == 24);
+    allocator.free(exp_high2.value());
+    REQUIRE(allocator.high_offset() == 232);
+    allocator.free_high(exp_high1.value());
+    REQUIRE(allocator.high_offset() == 256);
+    REQUIRE(allocator.low_offset() == 24);
+    allocator.free_low(exp_low1.value());
+    REQUIRE(allocator.low_offset() == 0);
+}
+
+TEST_CASE("double_stack_allocator free zero-size allocations")
+{
+    auto exp_buffer = amber::malloc_buffer::create(128);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_alloc = amber::double_stack_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::double_stack_allocator allocator(std::move(exp_alloc).value());
+
+    auto exp_high = allocator.allocate_high(8);
+    REQUIRE(exp_high.has_value());
+    REQUIRE(allocator.high_offset() == 104);
+
+    // The pointer equals the new low offset, free must still pick the low stack
+    auto exp_low1 = allocator.allocate_low(0);
+    REQUIRE(exp_low1.has_value());
+    REQUIRE(allocator.low_offset() == 16);
+    allocator.free(exp_low1.value());
+    REQUIRE(allocator.low_offset() == 0);
+    REQUIRE(allocator.high_offset() == 104);
+
+    // Zero-size high allocations still start past their header
+    auto exp_high0 = allocator.allocate_high(0);
+    REQUIRE(exp_high0.has_value());
+    allocator.free(exp_high0.value());
+    REQUIRE(allocator.high_offset() == 104);
+    REQUIRE(allocator.low_offset() == 0);
+
+    // Same when the low stack has grown up to the high stack
+    REQUIRE(allocator.allocate_low(80).has_value());
+    auto exp_low2 = allocator.allocate_low(8, 0);
+    REQUIRE(exp_low2.has_value());
+    REQUIRE(allocator.low_offset() == 104);
+    REQUIRE(allocator.free_size() == 0);
+    allocator.free(exp_low2.value());
+    REQUIRE(allocator.low_offset() == 96);
+    REQUIRE(allocator.high_offset() == 104);
+    allocator.free(exp_high.value());
+    REQUIRE(allocator.high_offset() == 128);
+}
+
+TEST_CASE("double_stack_allocator out of capacity")
+{
+    auto exp_buffer = amber::malloc_buffer::create(128);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_alloc = amber::double_stack_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::double_stack_allocator allocator(std::move(exp_alloc).value());
+
+    REQUIRE(allocator.allocate_low(48).has_value());
+    REQUIRE(allocator.allocate_high(48).has_value());
+    REQUIRE(allocator.low_offset() == 64);
+    REQUIRE(allocator.high_offset() == 72);
+    auto exp_low = allocator.allocate_low(1);
+    REQUIRE_FALSE(exp_low.has_value());
+    REQUIRE(exp_low.error() == "out of capacity");
+    auto exp_high = allocator.allocate_high(1);
+    REQUIRE_FALSE(exp_high.has_value());
+    REQUIRE(exp_high.error() == "out of capacity");
+    REQUIRE(allocator.allocate_high(1, 1).error() == "out of capacity");
+    REQUIRE(allocator.allocate_high(1000).error() == "out of capacity");
+}
+
+TEST_CASE("double_stack_allocator rewind_low/rewind_high/allocate<T>")
+{
+    auto exp_buffer = amber::malloc_buffer::create(256);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_alloc = amber::double_stack_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::double_stack_allocator allocator(std::move(exp_alloc).value());
+
+    auto exp_result = allocator.allocate_low<std::uint64_t>(42u);
+    REQUIRE(exp_result.has_value());
+    std::size_t low_marker = allocator.low_offset();
+    std::size_t high_marker = allocator.high_offset();
+    for (std::uint32_t i = 0; i < 4; ++i) {
+        REQUIRE(allocator.allocate_high<std::uint32_t>(i).has_value());
+        REQUIRE(allocator.allocate_low<std::uint32_t>(i).has_value());
+    }
+    allocator.rewind_high(high_marker);
+    REQUIRE(allocator.high_offset() == 256);
+    allocator.rewind_low(low_marker);
+    REQUIRE(allocator.low_offset() == low_marker);
+    REQUIRE(*exp_result.value() == 42);
+
+    allocator.reset();
+    REQUIRE(allocator.low_offset() == 0);
+    REQUIRE(allocator.high_offset() == 256);
+}
+
+} // namespace amber_test
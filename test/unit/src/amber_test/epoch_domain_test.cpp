@@ -0,0 +1,200 @@
+#include <amber/epoch_domain.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace amber_test {
+
+namespace {
+
+struct node {
+public:
+    node(std::uint64_t value) noexcept
+        : magic(node_magic),
+        value(value)
+    {}
+
+    ~node() noexcept
+    {
+        magic = 0;
+    }
+
+    static constexpr std::uint64_t node_magic = 0x6e6f64656e6f6465;
+
+    std::uint64_t magic;
+    std::uint64_t value;
+};
+
+} // unnamed namespace
+
+TEST_CASE("epoch_domain create(...) invalid sizes")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(16 * sizeof(node));
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_pool = amber::pool_allocator::create(buffer, sizeof(node));
+    REQUIRE(exp_pool.has_value());
+    amber::pool_allocator pool = std::move(exp_pool).value();
+
+    using domain = amber::epoch_domain<amber::pool_allocator>;
+    REQUIRE(domain::create(pool, 0, 4).error() == "max threads and batch size must be positive");
+    // The control block size would wrap around
+    REQUIRE(domain::create(pool, 1, SIZE_MAX / 3 + 1).error() == "invalid size");
+    REQUIRE(domain::create(pool, SIZE_MAX / 64, 4).error() == "invalid size");
+    REQUIRE(domain::create(pool, 2, SIZE_MAX / 96).error() == "invalid size");
+}
+
+TEST_CASE("epoch_domain retire(ptr)/collect()")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(16 * sizeof(node));
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_pool = amber::pool_allocator::create(buffer, sizeof(node));
+    REQUIRE(exp_pool.has_value());
+    amber::pool_allocator pool = std::move(exp_pool).value();
+
+    auto&& exp_domain = amber::epoch_domain<amber::pool_allocator>::create(pool, 2, 4);
+    REQUIRE(exp_domain.has_value());
+    amber::epoch_domain<amber::pool_allocator> domain = std::move(exp_domain).value();
+    auto&& exp_handle = domain.attach();
+    REQUIRE(exp_handle.has_value());
+    amber::epoch_handle<amber::pool_allocator> handle = std::move(exp_handle).value();
+
+    auto exp_n1 = domain.allocate<node>(1u);
+    REQUIRE(exp_n1.has_value());
+    {
+        amber::epoch_guard guard = handle.pin();
+        REQUIRE(handle.retire(exp_n1.value()).has_value());
+        handle.collect();
+        // Still pinned, the node cannot be reclaimed yet
+        REQUIRE(handle.retired_count() == 1);
+        REQUIRE(exp_n1.value()->magic == node::node_magic);
+    }
+    handle.collect();
+    handle.collect();
+    REQUIRE(handle.retired_count() == 0);
+    REQUIRE(pool.entry_allocate_count() == 0);
+}
+
+TEST_CASE("epoch_domain bounded retire list")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(16 * sizeof(node));
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_pool = amber::pool_allocator::create(buffer, sizeof(node));
+    REQUIRE(exp_pool.has_value());
+    amber::pool_allocator pool = std::move(exp_pool).value();
+
+    auto&& exp_domain = amber::epoch_domain<amber::pool_allocator>::create(pool, 2, 2);
+    REQUIRE(exp_domain.has_value());
+    amber::epoch_domain<amber::pool_allocator> domain = std::move(exp_domain).value();
+    auto&& exp_writer = domain.attach();
+    REQUIRE(exp_writer.has_value());
+    amber::epoch_handle<amber::pool_allocator> writer = std::move(exp_writer).value();
+    auto&& exp_reader = domain.attach();
+    REQUIRE(exp_reader.has_value());
+    amber::epoch_handle<amber::pool_allocator> reader = std::move(exp_reader).value();
+    auto&& exp_extra = domain.attach();
+    REQUIRE_FALSE(exp_extra.has_value());
+    REQUIRE(exp_extra.error() == "no free epoch slot");
+
+    // A reader that stays pinned blocks the epoch one step ahead of it
+    amber::epoch_guard reader_guard = reader.pin();
+    std::size_t retired = 0;
+    while (true) {
+        auto exp_node = domain.allocate<node>(retired);
+        REQUIRE(exp_node.has_value());
+        if (!writer.retire(exp_node.value()).has_value()) {
+            domain.free(exp_node.value());
+            break;
+        }
+        ++retired;
+    }
+    REQUIRE(retired == 4);
+    REQUIRE(writer.retired_count() == 4);
+
+    {
+        amber::epoch_guard released = std::move(reader_guard);
+    }
+    writer.collect();
+    writer.collect();
+    REQUIRE(writer.retired_count() == 0);
+    REQUIRE(pool.entry_allocate_count() == 0);
+}
+
+TEST_CASE("epoch_domain concurrent readers and writers")
+{
+    constexpr std::size_t slot_count = 8;
+    auto&& exp_buffer = amber::malloc_buffer::create(1024 * sizeof(node));
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_pool = amber::pool_allocator::create(buffer, sizeof(node));
+    REQUIRE(exp_pool.has_value());
+    amber::pool_allocator pool = std::move(exp_pool).value();
+    auto&& exp_domain = amber::epoch_domain<amber::pool_allocator>::create(pool, 4, 32);
+    REQUIRE(exp_domain.has_value());
+    amber::epoch_domain<amber::pool_allocator> domain = std::move(exp_domain).value();
+
+    std::atomic<node*> slots[slot_count];
+    for (std::atomic<node*>& slot : slots) {
+        auto exp_node = domain.allocate<node>(0u);
+        REQUIRE(exp_node.has_value());
+        slot.store(exp_node.value());
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<std::size_t> corrupt(0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < 2; ++t) {
+        threads.emplace_back([&]() {
+            auto exp_handle = domain.attach();
+            if (!exp_handle.has_value()) {
+                corrupt.fetch_add(1);
+                return;
+            }
+            amber::epoch_handle<amber::pool_allocator> handle = std::move(exp_handle).value();
+            while (!stop.load(std::memory_order_relaxed)) {
+                amber::epoch_guard guard = handle.pin();
+                for (std::atomic<node*>& slot : slots) {
+                    if (slot.load(std::memory_order_acquire)->magic != node::node_magic) {
+                        corrupt.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+    threads.emplace_back([&]() {
+        auto exp_handle = domain.attach();
+        if (!exp_handle.has_value()) {
+            corrupt.fetch_add(1);
+            return;
+        }
+        amber::epoch_handle<amber::pool_allocator> handle = std::move(exp_handle).value();
+        for (std::uint64_t i = 0; i < 20000; ++i) {
+            auto exp_node = domain.allocate<node>(i);
+            if (!exp_node.has_value()) {
+                handle.collect();
+                continue;
+            }
+            node* old = slots[i % slot_count].exchange(exp_node.value(), std::memory_order_acq_rel);
+            while (!handle.retire(old).has_value()) {
+                handle.collect();
+            }
+        }
+        stop.store(true);
+    });
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    REQUIRE(corrupt.load() == 0);
+    for (std::atomic<node*>& slot : slots) {
+        domain.free(slot.load());
+    }
+}
+
+} // namespace amber_test
@@ -0,0 +1,155 @@
+#include <amber/fallback_allocator.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <amber/stack_allocator.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <utility>
+
+namespace amber_test {
+
+namespace {
+
+struct block {
+public:
+    std::uint64_t values[6];
+};
+
+} // unnamed namespace
+
+TEST_CASE("fallback_allocator allocate(alignment, size)/free(ptr)")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_stack = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_stack.has_value());
+
+    using allocator_type = amber::fallback_allocator<amber::stack_allocator, amber::malloc_allocator>;
+    auto&& exp_alloc = allocator_type::create(std::move(exp_stack).value(), amber::malloc_allocator());
+    REQUIRE(exp_alloc.has_value());
+    allocator_type allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate(8, 16);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(allocator.primary().owns(exp_a1.value()));
+    auto exp_a2 = allocator.allocate(8, 128);
+    REQUIRE(exp_a2.has_value());
+    REQUIRE_FALSE(allocator.primary().owns(exp_a2.value()));
+
+    allocator.free(exp_a2.value());
+    allocator.free(exp_a1.value());
+    REQUIRE(allocator.primary().buffer_offset() == 0);
+}
+
+TEST_CASE("fallback_allocator zero-size allocation at the end of the primary")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_stack = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_stack.has_value());
+
+    using allocator_type = amber::fallback_allocator<amber::stack_allocator, amber::malloc_allocator>;
+    auto&& exp_alloc = allocator_type::create(std::move(exp_stack).value(), amber::malloc_allocator());
+    REQUIRE(exp_alloc.has_value());
+    allocator_type allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate(8, 48);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(allocator.primary().buffer_offset() == 56);
+    // Would fit in the primary only as the address one past its buffer, which
+    // free could not route back
+    auto exp_a2 = allocator.allocate(8, 0);
+    REQUIRE(exp_a2.has_value());
+    REQUIRE_FALSE(allocator.primary().owns(exp_a2.value()));
+    REQUIRE(allocator.primary().buffer_offset() == 56);
+    allocator.free(exp_a2.value());
+
+    auto exp_a3 = allocator.allocate(8, 0);
+    REQUIRE(exp_a3.has_value());
+    allocator.free(exp_a3.value());
+    allocator.free(exp_a1.value());
+    REQUIRE(allocator.primary().buffer_offset() == 0);
+
+    // Zero-size allocations that fit stay in the primary
+    auto exp_a4 = allocator.allocate(8, 0);
+    REQUIRE(exp_a4.has_value());
+    REQUIRE(allocator.primary().owns(exp_a4.value()));
+    allocator.free(exp_a4.value());
+    REQUIRE(allocator.primary().buffer_offset() == 0);
+}
+
+TEST_CASE("fallback_allocator chained stack, pool and malloc")
+{
+    auto&& exp_b1 = amber::malloc_buffer::create(64);
+    REQUIRE(exp_b1.has_value());
+    amber::malloc_buffer b1 = std::move(exp_b1).value();
+    auto&& exp_b2 = amber::malloc_buffer::create(64);
+    REQUIRE(exp_b2.has_value());
+    amber::malloc_buffer b2 = std::move(exp_b2).value();
+    auto&& exp_stack = amber::stack_allocator::create(b1);
+    REQUIRE(exp_stack.has_value());
+    auto&& exp_pool = amber::pool_allocator::create(b2, 32);
+    REQUIRE(exp_pool.has_value());
+
+    using tail_type = amber::fallback_allocator<amber::pool_allocator, amber::malloc_allocator>;
+    using allocator_type = amber::fallback_allocator<amber::stack_allocator, tail_type>;
+    auto&& exp_tail = tail_type::create(std::move(exp_pool).value(), amber::malloc_allocator());
+    REQUIRE(exp_tail.has_value());
+    auto&& exp_alloc = allocator_type::create(std::move(exp_stack).value(), std::move(exp_tail).value());
+    REQUIRE(exp_alloc.has_value());
+    allocator_type allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate<block>();
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(allocator.primary().owns(exp_a1.value()));
+    auto exp_a2 = allocator.allocate(8, 32);
+    REQUIRE(exp_a2.has_value());
+    REQUIRE(allocator.fallback().primary().owns(exp_a2.value()));
+    REQUIRE(allocator.fallback().primary().entry_allocate_count() == 1);
+    auto exp_a3 = allocator.allocate(8, 40);
+    REQUIRE(exp_a3.has_value());
+    REQUIRE_FALSE(allocator.fallback().primary().owns(exp_a3.value()));
+
+    allocator.free(exp_a3.value());
+    allocator.free(exp_a2.value());
+    REQUIRE(allocator.fallback().primary().entry_allocate_count() == 0);
+}
+
+TEST_CASE("fallback_allocator owns(ptr)")
+{
+    auto&& exp_b1 = amber::malloc_buffer::create(32);
+    REQUIRE(exp_b1.has_value());
+    amber::malloc_buffer b1 = std::move(exp_b1).value();
+    auto&& exp_b2 = amber::malloc_buffer::create(64);
+    REQUIRE(exp_b2.has_value());
+    amber::malloc_buffer b2 = std::move(exp_b2).value();
+    auto&& exp_l1 = amber::linear_allocator::create(b1);
+    REQUIRE(exp_l1.has_value());
+    auto&& exp_l2 = amber::linear_allocator::create(b2);
+    REQUIRE(exp_l2.has_value());
+
+    using allocator_type = amber::fallback_allocator<amber::linear_allocator, amber::linear_allocator>;
+    auto&& exp_alloc = allocator_type::create(std::move(exp_l1).value(), std::move(exp_l2).value());
+    REQUIRE(exp_alloc.has_value());
+    allocator_type allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate(8, 48);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(allocator.owns(exp_a1.value()));
+    REQUIRE(allocator.fallback().owns(exp_a1.value()));
+    auto exp_a2 = allocator.allocate(8, 48);
+    REQUIRE_FALSE(exp_a2.has_value());
+    REQUIRE(exp_a2.error() == "out of capacity");
+    // Linear allocators release everything at once, free is a no-op
+    allocator.free(exp_a1.value());
+    REQUIRE(allocator.fallback().buffer_offset() == 48);
+
+    std::uint64_t local = 0;
+    REQUIRE_FALSE(allocator.owns(&local));
+}
+
+} // namespace amber_test
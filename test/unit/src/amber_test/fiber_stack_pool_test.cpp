@@ -0,0 +1,217 @@
+#include <amber/fiber_stack_pool.hpp>
+#include <amber/purge.hpp>
+#include <amber/util.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <sys/mman.h>
+#include <unistd.h>
+}
+
+namespace amber_test {
+
+namespace {
+
+// Whether the kernel refuses to read ptr, write() reports EFAULT for a
+// PROT_NONE page instead of faulting the process
+bool is_guarded(const void* ptr)
+{
+    int fds[2];
+    if (pipe(fds) == -1) {
+        return false;
+    }
+    ssize_t written = write(fds[1], ptr, 1);
+    bool fault = written == -1 && errno == EFAULT;
+    close(fds[0]);
+    close(fds[1]);
+    return fault;
+}
+
+std::size_t resident_pages(std::span<std::byte> range)
+{
+    std::vector<unsigned char> residency(range.size() / amber::page_size());
+    if (mincore(range.data(), range.size(), residency.data()) == -1) {
+        return SIZE_MAX;
+    }
+    std::size_t count = 0;
+    for (unsigned char page : residency) {
+        count += page & 1;
+    }
+    return count;
+}
+
+} // unnamed namespace
+
+TEST_CASE("fiber_stack_pool move constructor/assignment")
+{
+    auto exp_p1 = amber::fiber_stack_pool::create(64 * 1024, 4);
+    REQUIRE(exp_p1.has_value());
+    amber::fiber_stack_pool p1 = std::move(exp_p1).value();
+    REQUIRE(p1.stack_count() == 4);
+    REQUIRE(p1.free_count() == 4);
+    amber::fiber_stack_pool p2(std::move(p1));
+    REQUIRE(p1.stack_count() == 0);
+    REQUIRE(p1.free_count() == 0);
+    REQUIRE(p2.stack_count() == 4);
+    REQUIRE(p2.free_count() == 4);
+    p1 = std::move(p2);
+    REQUIRE(p1.stack_count() == 4);
+    REQUIRE(p2.stack_count() == 0);
+}
+
+TEST_CASE("fiber_stack_pool create")
+{
+    std::size_t page = amber::page_size();
+    auto exp_pool = amber::fiber_stack_pool::create(100 * 1024 + 1, 3);
+    REQUIRE(exp_pool.has_value());
+    REQUIRE(exp_pool.value().stack_size() == amber::align_forward(page, std::size_t(100 * 1024 + 1)));
+    REQUIRE(exp_pool.value().guard_size() == page);
+
+    auto exp_guarded = amber::fiber_stack_pool::create(64 * 1024, 2, 3 * page);
+    REQUIRE(exp_guarded.has_value());
+    REQUIRE(exp_guarded.value().guard_size() == 3 * page);
+
+    auto exp_zero_size = amber::fiber_stack_pool::create(0, 4);
+    REQUIRE_FALSE(exp_zero_size.has_value());
+    REQUIRE(exp_zero_size.error() == "invalid stack size");
+
+    auto exp_zero_count = amber::fiber_stack_pool::create(64 * 1024, 0);
+    REQUIRE_FALSE(exp_zero_count.has_value());
+    REQUIRE(exp_zero_count.error() == "invalid stack count");
+
+    auto exp_zero_guard = amber::fiber_stack_pool::create(64 * 1024, 4, 0);
+    REQUIRE_FALSE(exp_zero_guard.has_value());
+    REQUIRE(exp_zero_guard.error() == "invalid guard size");
+}
+
+TEST_CASE("fiber_stack_pool acquire and release")
+{
+    std::size_t page = amber::page_size();
+    auto exp_pool = amber::fiber_stack_pool::create(64 * 1024, 4);
+    REQUIRE(exp_pool.has_value());
+    amber::fiber_stack_pool pool = std::move(exp_pool).value();
+
+    std::vector<std::span<std::byte>> stacks;
+    for (std::size_t i = 0; i < 4; ++i) {
+        auto exp_stack = pool.acquire();
+        REQUIRE(exp_stack.has_value());
+        std::span<std::byte> stack = exp_stack.value();
+        REQUIRE(stack.size() == 64 * 1024);
+        REQUIRE(amber::is_aligned(page, reinterpret_cast<std::uintptr_t>(stack.data())));
+        REQUIRE(pool.owns(stack.data()));
+        std::memset(stack.data(), static_cast<int>(i + 1), stack.size());
+        stacks.push_back(stack);
+    }
+    // Handed out in address order at first, separated by a guard
+    for (std::size_t i = 1; i < 4; ++i) {
+        REQUIRE(stacks[i].data() == stacks[i - 1].data() + 64 * 1024 + page);
+    }
+    REQUIRE(pool.free_count() == 0);
+    auto exp_empty = pool.acquire();
+    REQUIRE_FALSE(exp_empty.has_value());
+    REQUIRE(exp_empty.error() == "out of stacks");
+    for (std::size_t i = 0; i < 4; ++i) {
+        REQUIRE(stacks[i][0] == std::byte(i + 1));
+        REQUIRE(stacks[i][stacks[i].size() - 1] == std::byte(i + 1));
+    }
+
+    pool.release(stacks[1]);
+    pool.release(stacks[3]);
+    REQUIRE(pool.free_count() == 2);
+    REQUIRE(pool.dirty_size() == 2 * 64 * 1024);
+    // Most recently released first, its contents are kept
+    auto exp_reused = pool.acquire();
+    REQUIRE(exp_reused.has_value());
+    REQUIRE(exp_reused.value().data() == stacks[3].data());
+    REQUIRE(exp_reused.value()[0] == std::byte(4));
+    REQUIRE(pool.dirty_size() == 64 * 1024);
+    REQUIRE_FALSE(pool.owns(stacks[0].data() + (8 * 64 * 1024)));
+}
+
+TEST_CASE("fiber_stack_pool guard pages")
+{
+    std::size_t page = amber::page_size();
+    auto exp_pool = amber::fiber_stack_pool::create(64 * 1024, 2);
+    REQUIRE(exp_pool.has_value());
+    amber::fiber_stack_pool pool = std::move(exp_pool).value();
+    auto exp_first = pool.acquire();
+    REQUIRE(exp_first.has_value());
+    auto exp_second = pool.acquire();
+    REQUIRE(exp_second.has_value());
+    std::span<std::byte> first = exp_first.value();
+    std::span<std::byte> second = exp_second.value();
+    first[0] = std::byte(1);
+    second[0] = std::byte(1);
+
+    REQUIRE_FALSE(is_guarded(first.data()));
+    REQUIRE_FALSE(is_guarded(second.data()));
+    REQUIRE(is_guarded(first.data() - 1));
+    REQUIRE(is_guarded(first.data() - page));
+    REQUIRE(is_guarded(first.data() + first.size()));
+    REQUIRE(is_guarded(second.data() - 1));
+    REQUIRE(is_guarded(second.data() + second.size()));
+    REQUIRE(is_guarded(second.data() + second.size() + page - 1));
+}
+
+TEST_CASE("fiber_stack_pool purge")
+{
+    std::size_t stack_size = 64 * 1024;
+    auto exp_pool = amber::fiber_stack_pool::create(stack_size, 4);
+    REQUIRE(exp_pool.has_value());
+    amber::fiber_stack_pool pool = std::move(exp_pool).value();
+
+    std::vector<std::span<std::byte>> stacks;
+    for (std::size_t i = 0; i < 4; ++i) {
+        auto exp_stack = pool.acquire();
+        REQUIRE(exp_stack.has_value());
+        // Fibers only touch the top of their stack
+        std::memset(exp_stack.value().data() + stack_size / 2, 0xab, stack_size / 2);
+        stacks.push_back(exp_stack.value());
+    }
+    REQUIRE(pool.dirty_size() == 0);
+    auto exp_nothing = pool.purge(amber::purge_mode::dont_need);
+    REQUIRE(exp_nothing.has_value());
+    REQUIRE(exp_nothing.value() == 0);
+
+    for (std::span<std::byte> stack : stacks) {
+        pool.release(stack);
+    }
+    REQUIRE(pool.dirty_size() == 4 * stack_size);
+
+    // The most recently released stack stays dirty
+    auto exp_purged = pool.purge(amber::purge_mode::dont_need, stack_size);
+    REQUIRE(exp_purged.has_value());
+    REQUIRE(exp_purged.value() == 3 * stack_size);
+    REQUIRE(pool.dirty_size() == stack_size);
+    for (std::size_t i = 0; i < 3; ++i) {
+        REQUIRE(resident_pages(stacks[i]) == 0);
+    }
+    REQUIRE(resident_pages(stacks[3]) == (stack_size / 2) / amber::page_size());
+
+    // Purging again only has the kept stack left
+    auto exp_again = pool.purge(amber::purge_mode::dont_need, stack_size);
+    REQUIRE(exp_again.has_value());
+    REQUIRE(exp_again.value() == 0);
+    auto exp_all = pool.purge(amber::purge_mode::dont_need);
+    REQUIRE(exp_all.has_value());
+    REQUIRE(exp_all.value() == stack_size);
+    REQUIRE(pool.dirty_size() == 0);
+
+    // Purged stacks read back as zero
+    for (std::size_t i = 0; i < 4; ++i) {
+        auto exp_stack = pool.acquire();
+        REQUIRE(exp_stack.has_value());
+        REQUIRE(exp_stack.value()[stack_size - 1] == std::byte(0));
+    }
+}
+
+} // namespace amber_test
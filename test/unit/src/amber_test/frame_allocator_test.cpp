@@ -0,0 +1,121 @@
+#include <amber/concept.hpp>
+#include <amber/frame_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace amber_test {
+
+namespace {
+
+struct throwing_destructor {
+public:
+    ~throwing_destructor() noexcept(false)
+    {}
+};
+
+template<typename T>
+concept frame_allocatable = requires(amber::frame_allocator<2>& allocator) {
+    allocator.template allocate<T>();
+};
+
+} // unnamed namespace
+
+static_assert(amber::ResizableAllocator<amber::frame_allocator<2>>);
+static_assert(frame_allocatable<std::string>);
+static_assert(!frame_allocatable<throwing_destructor>);
+
+TEST_CASE("frame_allocator create")
+{
+    auto exp_buffer = amber::malloc_buffer::create(1000);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_alloc = amber::frame_allocator<3>::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::frame_allocator<3> a1 = std::move(exp_alloc).value();
+    REQUIRE(a1.buffer_size() == 1000);
+    REQUIRE(a1.frame_size() == 320);
+    REQUIRE(a1.frame_count() == 3);
+    REQUIRE(a1.frame() == 0);
+    REQUIRE(a1.buffer_offset() == 0);
+
+    auto exp_ptr = a1.allocate(16);
+    REQUIRE(exp_ptr.has_value());
+    amber::frame_allocator<3> a2(std::move(a1));
+    REQUIRE(a1.buffer_size() == 0);
+    REQUIRE(a2.buffer_size() == 1000);
+    REQUIRE(a2.buffer_offset() == 16);
+}
+
+TEST_CASE("frame_allocator allocate<T> non-trivial objects")
+{
+    auto exp_buffer = amber::malloc_buffer::create(2 * 256);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_alloc = amber::frame_allocator<2>::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::frame_allocator<2> allocator = std::move(exp_alloc).value();
+
+    auto exp_str = allocator.allocate<std::string>("kept alive for two frames, then destroyed");
+    REQUIRE(exp_str.has_value());
+    allocator.advance_frame();
+    REQUIRE(*exp_str.value() == "kept alive for two frames, then destroyed");
+    // Destroys the string along with its frame's region
+    allocator.advance_frame();
+    REQUIRE(allocator.buffer_offset() == 0);
+}
+
+TEST_CASE("frame_allocator advance_frame")
+{
+    auto exp_buffer = amber::malloc_buffer::create(3 * 64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    std::byte* buffer_ptr = buffer.buffer().data();
+
+    auto exp_alloc = amber::frame_allocator<3>::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::frame_allocator<3> allocator = std::move(exp_alloc).value();
+
+    auto exp_f0 = allocator.allocate<std::uint64_t>(10u);
+    REQUIRE(exp_f0.has_value());
+    std::uint64_t* f0 = exp_f0.value();
+    REQUIRE(reinterpret_cast<std::byte*>(f0) == buffer_ptr);
+    REQUIRE(allocator.frame_of(f0).value() == 0);
+    allocator.check_live(f0, 0);
+
+    auto exp_full = allocator.allocate(64);
+    REQUIRE_FALSE(exp_full.has_value());
+    REQUIRE(exp_full.error() == "out of capacity");
+
+    allocator.advance_frame();
+    REQUIRE(allocator.frame() == 1);
+    REQUIRE(allocator.buffer_offset() == 0);
+    auto exp_f1 = allocator.allocate<std::uint64_t>(11u);
+    REQUIRE(exp_f1.has_value());
+    REQUIRE(reinterpret_cast<std::byte*>(exp_f1.value()) == buffer_ptr + 64);
+
+    allocator.advance_frame();
+    REQUIRE(allocator.is_live(0));
+    REQUIRE(*f0 == 10);
+    REQUIRE(*exp_f1.value() == 11);
+
+    allocator.advance_frame();
+    REQUIRE(allocator.frame() == 3);
+    REQUIRE_FALSE(allocator.is_live(0));
+    REQUIRE(allocator.is_live(1));
+    REQUIRE(allocator.frame_of(f0).value() == 3);
+    auto exp_f3 = allocator.allocate<std::uint64_t>(13u);
+    REQUIRE(exp_f3.has_value());
+    REQUIRE(exp_f3.value() == f0);
+    REQUIRE(allocator.frame_of(exp_f1.value()).value() == 1);
+
+    std::uint64_t outside = 0;
+    auto exp_outside = allocator.frame_of(&outside);
+    REQUIRE_FALSE(exp_outside.has_value());
+    REQUIRE(exp_outside.error() == "pointer not owned by allocator");
+}
+
+} // namespace amber_test
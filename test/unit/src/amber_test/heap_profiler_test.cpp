@@ -0,0 +1,287 @@
+#include <amber/heap_profiler.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <amber/stack_allocator.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+namespace amber_test {
+
+namespace {
+
+// Sum of the byte counts of a folded profile
+std::size_t folded_size(const std::string& profile)
+{
+    std::size_t total = 0;
+    std::size_t line_begin = 0;
+    while (line_begin < profile.size()) {
+        std::size_t line_end = profile.find('\n', line_begin);
+        std::size_t count_begin = profile.rfind(' ', line_end) + 1;
+        total += std::strtoull(profile.c_str() + count_begin, nullptr, 10);
+        line_begin = line_end + 1;
+    }
+    return total;
+}
+
+// Non-trivially destructible, so linear_allocator records its destructor
+struct tracked {
+public:
+    explicit tracked(int v) noexcept
+        : value(v)
+    {}
+
+    ~tracked() noexcept
+    {
+        value = 0;
+    }
+
+    int value;
+    std::byte padding[60];
+};
+
+} // unnamed namespace
+
+TEST_CASE("heap_profiler create(...)")
+{
+    REQUIRE(amber::heap_profiler::create(0, 8, 8).error() == "invalid sample interval");
+    REQUIRE(amber::heap_profiler::create(1, 0, 8).error() == "invalid capacity");
+
+    auto&& exp_profiler = amber::heap_profiler::create(1, 8, 8);
+    REQUIRE(exp_profiler.has_value());
+    amber::heap_profiler profiler = std::move(exp_profiler).value();
+    REQUIRE(profiler.sample_interval() == 1);
+    auto&& exp_second = amber::heap_profiler::create(1, 8, 8);
+    REQUIRE_FALSE(exp_second.has_value());
+    REQUIRE(exp_second.error() == "heap profiler already installed");
+
+    amber::heap_profiler moved(std::move(profiler));
+    REQUIRE(moved.sample_interval() == 1);
+}
+
+TEST_CASE("heap_profiler live profile")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_pool_buffer = amber::malloc_buffer::create(1024);
+    REQUIRE(exp_pool_buffer.has_value());
+    amber::malloc_buffer pool_buffer = std::move(exp_pool_buffer).value();
+    auto&& exp_stack_buffer = amber::malloc_buffer::create(1024);
+    REQUIRE(exp_stack_buffer.has_value());
+    amber::malloc_buffer stack_buffer = std::move(exp_stack_buffer).value();
+
+    auto&& exp_linear = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_linear.has_value());
+    amber::linear_allocator linear = std::move(exp_linear).value();
+    auto&& exp_pool = amber::pool_allocator::create(pool_buffer, 64);
+    REQUIRE(exp_pool.has_value());
+    amber::pool_allocator pool = std::move(exp_pool).value();
+    auto&& exp_stack = amber::stack_allocator::create(stack_buffer);
+    REQUIRE(exp_stack.has_value());
+    amber::stack_allocator stack = std::move(exp_stack).value();
+
+    // Not recorded, no profiler is installed yet
+    REQUIRE(linear.allocate(64).has_value());
+
+    // An interval of one byte samples every allocation of 64 bytes
+    auto&& exp_profiler = amber::heap_profiler::create(1, 64, 64);
+    REQUIRE(exp_profiler.has_value());
+    amber::heap_profiler profiler = std::move(exp_profiler).value();
+
+    void* entries[4] = {};
+    for (std::size_t i = 0; i < 4; ++i) {
+        auto exp_ptr = pool.allocate();
+        REQUIRE(exp_ptr.has_value());
+        entries[i] = exp_ptr.value();
+    }
+    REQUIRE(profiler.live_count() == 4);
+    pool.free(entries[2]);
+    REQUIRE(profiler.live_count() == 3);
+
+    std::size_t marker = linear.buffer_offset();
+    for (std::size_t i = 0; i < 3; ++i) {
+        REQUIRE(linear.allocate(64).has_value());
+    }
+    REQUIRE(profiler.live_count() == 6);
+    linear.rewind(marker);
+    REQUIRE(profiler.live_count() == 3);
+
+    auto exp_s1 = stack.allocate(64);
+    REQUIRE(exp_s1.has_value());
+    auto exp_s2 = stack.allocate(64);
+    REQUIRE(exp_s2.has_value());
+    stack.free(exp_s2.value());
+    REQUIRE(profiler.live_count() == 4);
+    REQUIRE(profiler.dropped_count() == 0);
+
+    auto exp_live = profiler.folded(amber::heap_profile::live);
+    REQUIRE(exp_live.has_value());
+    REQUIRE(folded_size(exp_live.value()) >= 4 * 64);
+    auto exp_cumulative = profiler.folded(amber::heap_profile::cumulative);
+    REQUIRE(exp_cumulative.has_value());
+    REQUIRE(folded_size(exp_cumulative.value()) >= 9 * 64);
+
+    auto exp_pprof = profiler.pprof();
+    REQUIRE(exp_pprof.has_value());
+    REQUIRE(exp_pprof.value().starts_with("heap profile: 4: 256 [9: 576] @ heap_v2/1\n"));
+    REQUIRE(exp_pprof.value().find("\nMAPPED_LIBRARIES:\n") != std::string::npos);
+}
+
+TEST_CASE("heap_profiler resized allocations")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_linear = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_linear.has_value());
+    amber::linear_allocator linear = std::move(exp_linear).value();
+
+    auto&& exp_profiler = amber::heap_profiler::create(1, 64, 64);
+    REQUIRE(exp_profiler.has_value());
+    amber::heap_profiler profiler = std::move(exp_profiler).value();
+
+    auto exp_a1 = linear.allocate(64);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(linear.try_extend(exp_a1.value(), 64, 256));
+    auto exp_grown = profiler.pprof();
+    REQUIRE(exp_grown.has_value());
+    REQUIRE(exp_grown.value().starts_with("heap profile: 1: 256 [1: 256] @ heap_v2/1\n"));
+    REQUIRE(linear.shrink(exp_a1.value(), 256, 32));
+    auto exp_shrunk = profiler.pprof();
+    REQUIRE(exp_shrunk.has_value());
+    REQUIRE(exp_shrunk.value().starts_with("heap profile: 1: 32 [1: 256] @ heap_v2/1\n"));
+
+    // Moving releases the old block and samples the new one
+    REQUIRE(linear.allocate(64).has_value());
+    auto exp_moved = linear.reallocate(exp_a1.value(), 32, 512);
+    REQUIRE(exp_moved.has_value());
+    REQUIRE(exp_moved.value() != exp_a1.value());
+    auto exp_after = profiler.pprof();
+    REQUIRE(exp_after.has_value());
+    REQUIRE(exp_after.value().starts_with("heap profile: 2: 576 [3: 832] @ heap_v2/1\n"));
+}
+
+TEST_CASE("heap_profiler sample table churn")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(1 << 16);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_stack = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_stack.has_value());
+    amber::stack_allocator stack = std::move(exp_stack).value();
+
+    // Freed samples leave no tombstones behind, the small table never fills up
+    auto&& exp_profiler = amber::heap_profiler::create(1, 64, 4);
+    REQUIRE(exp_profiler.has_value());
+    amber::heap_profiler profiler = std::move(exp_profiler).value();
+    auto exp_kept = stack.allocate(64);
+    REQUIRE(exp_kept.has_value());
+    for (std::size_t i = 0; i < 1000; ++i) {
+        std::size_t marker = stack.buffer_offset();
+        // Varying the first size moves the others to new addresses
+        auto exp_a1 = stack.allocate(64 + (i % 7) * 16);
+        REQUIRE(exp_a1.has_value());
+        auto exp_a2 = stack.allocate(64);
+        REQUIRE(exp_a2.has_value());
+        auto exp_a3 = stack.allocate(64);
+        REQUIRE(exp_a3.has_value());
+        REQUIRE(profiler.live_count() == 4);
+        stack.free(exp_a3.value());
+        stack.free(exp_a2.value());
+        stack.free(exp_a1.value());
+        REQUIRE(stack.buffer_offset() == marker);
+    }
+    REQUIRE(profiler.live_count() == 1);
+    REQUIRE(profiler.dropped_count() == 0);
+}
+
+TEST_CASE("heap_profiler stack free below the top")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_stack = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_stack.has_value());
+    amber::stack_allocator stack = std::move(exp_stack).value();
+
+    auto&& exp_profiler = amber::heap_profiler::create(1, 64, 64);
+    REQUIRE(exp_profiler.has_value());
+    amber::heap_profiler profiler = std::move(exp_profiler).value();
+    auto exp_s1 = stack.allocate(64);
+    REQUIRE(exp_s1.has_value());
+    auto exp_s2 = stack.allocate(64);
+    REQUIRE(exp_s2.has_value());
+    auto exp_s3 = stack.allocate(64);
+    REQUIRE(exp_s3.has_value());
+    REQUIRE(profiler.live_count() == 3);
+    // Releases s3 as well, its sample goes with it
+    stack.free(exp_s2.value());
+    REQUIRE(profiler.live_count() == 1);
+}
+
+TEST_CASE("heap_profiler linear_allocator destructor entries")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_linear = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_linear.has_value());
+    amber::linear_allocator linear = std::move(exp_linear).value();
+
+    auto&& exp_profiler = amber::heap_profiler::create(1, 64, 64);
+    REQUIRE(exp_profiler.has_value());
+    amber::heap_profiler profiler = std::move(exp_profiler).value();
+    // Only the object is sampled, not the entry recording its destructor
+    auto exp_obj = linear.allocate<tracked>(5);
+    REQUIRE(exp_obj.has_value());
+    REQUIRE(profiler.live_count() == 1);
+    auto exp_pprof = profiler.pprof();
+    REQUIRE(exp_pprof.has_value());
+    REQUIRE(exp_pprof.value().starts_with("heap profile: 1: 64 [1: 64] @ heap_v2/1\n"));
+
+    // The entry fits but the object does not, nothing is left behind
+    std::size_t offset = linear.buffer_offset();
+    REQUIRE(linear.allocate(1, linear.buffer_size() - offset - 24).has_value());
+    REQUIRE(profiler.live_count() == 2);
+    std::size_t full_offset = linear.buffer_offset();
+    auto exp_failed = linear.allocate<tracked>(6);
+    REQUIRE_FALSE(exp_failed.has_value());
+    REQUIRE(linear.buffer_offset() == full_offset);
+    REQUIRE(profiler.live_count() == 2);
+    linear.reset();
+    REQUIRE(profiler.live_count() == 0);
+}
+
+TEST_CASE("heap_profiler sampled estimate")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(1 << 20);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_linear = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_linear.has_value());
+    amber::linear_allocator linear = std::move(exp_linear).value();
+
+    auto&& exp_profiler = amber::heap_profiler::create(4096, 64, 4096);
+    REQUIRE(exp_profiler.has_value());
+    amber::heap_profiler profiler = std::move(exp_profiler).value();
+
+    constexpr std::size_t allocation_count = 1 << 20;
+    for (std::size_t i = 0; i < allocation_count; ++i) {
+        if (!linear.allocate(64).has_value()) {
+            linear.reset();
+            REQUIRE(linear.allocate(64).has_value());
+        }
+    }
+    auto exp_cumulative = profiler.folded(amber::heap_profile::cumulative);
+    REQUIRE(exp_cumulative.has_value());
+    std::size_t estimate = folded_size(exp_cumulative.value());
+    std::size_t actual = allocation_count * 64;
+    REQUIRE(estimate > actual - (actual / 10));
+    REQUIRE(estimate < actual + (actual / 10));
+}
+
+} // namespace amber_test
@@ -0,0 +1,189 @@
+#include <amber/lifetime_analyzer.hpp>
+#include <amber/lifetime_recorder.hpp>
+#include <amber/malloc_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace amber_test {
+
+namespace {
+
+using recorder_type = amber::lifetime_recorder<amber::malloc_allocator>;
+
+// Failed allocations are not recorded and show up in the site counts
+void* must_allocate(std::expected<void*, std::string>&& exp_ptr)
+{
+    return std::move(exp_ptr).value_or(nullptr);
+}
+
+} // unnamed namespace
+
+TEST_CASE("analyze_lifetimes classifies call sites")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(1 << 16);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_recorder = recorder_type::create(amber::malloc_allocator(), buffer, 8);
+    REQUIRE(exp_recorder.has_value());
+    recorder_type recorder = std::move(exp_recorder).value();
+
+    // Site 0, never freed through the recorder
+    std::vector<void*> leaked;
+    for (std::size_t i = 0; i < 4; ++i) {
+        leaked.push_back(must_allocate(recorder.allocate(8, 64)));
+    }
+
+    // Site 1, everything released together
+    for (std::size_t round = 0; round < 5; ++round) {
+        void* batch[8];
+        for (std::size_t i = 0; i < 8; ++i) {
+            batch[i] = must_allocate(recorder.allocate(8, 24 + i));
+        }
+        for (std::size_t i = 0; i < 8; ++i) {
+            recorder.free(batch[i]);
+        }
+    }
+
+    // Site 2, pushed and popped over an allocation that outlives them
+    for (std::size_t i = 0; i < 21; ++i) {
+        void* top = must_allocate(recorder.allocate(8, 48));
+        if (i == 0) {
+            leaked.push_back(top);
+        } else {
+            recorder.free(top);
+        }
+    }
+
+    // Site 3, a queue
+    std::vector<void*> queue;
+    for (std::size_t i = 0; i < 24; ++i) {
+        queue.push_back(must_allocate(recorder.allocate(8, 16 + i)));
+        if (queue.size() > 3) {
+            recorder.free(queue.front());
+            queue.erase(queue.begin());
+        }
+    }
+    leaked.insert(leaked.end(), queue.begin(), queue.end());
+
+    // Sites 4, 5 and 6, freed in no particular order
+    void* fixed[10];
+    for (std::size_t i = 0; i < 10; ++i) {
+        fixed[i] = must_allocate(recorder.allocate(8, 32));
+    }
+    void* varied[10];
+    for (std::size_t i = 0; i < 10; ++i) {
+        varied[i] = must_allocate(recorder.allocate(8, 16 * (i + 1)));
+    }
+    void* large[10];
+    for (std::size_t i = 0; i < 10; ++i) {
+        large[i] = must_allocate(recorder.allocate(8, 8192 * (i + 1)));
+    }
+    for (std::size_t i = 1; i < 9; i += 2) {
+        recorder.free(fixed[i]);
+        recorder.free(varied[i]);
+        recorder.free(large[i]);
+    }
+    for (std::size_t i = 0; i < 10; i += 2) {
+        leaked.push_back(fixed[i]);
+        leaked.push_back(varied[i]);
+        leaked.push_back(large[i]);
+    }
+    leaked.push_back(fixed[9]);
+    leaked.push_back(varied[9]);
+    leaked.push_back(large[9]);
+
+    REQUIRE(recorder.dropped_count() == 0);
+    REQUIRE(recorder.sites().size() == 7);
+    std::vector<amber::site_report> reports(recorder.sites().size());
+    auto&& exp_analyze = amber::analyze_lifetimes(recorder.events(), recorder.sites().size(), reports);
+    REQUIRE(exp_analyze.has_value());
+
+    REQUIRE(reports[0].pattern == amber::lifetime_pattern::never_freed);
+    REQUIRE(reports[0].recommendation == amber::allocator_kind::linear_allocator);
+    REQUIRE(reports[0].allocate_count == 4);
+    REQUIRE(reports[0].free_count == 0);
+    REQUIRE(reports[0].peak_live_count == 4);
+    REQUIRE(reports[0].peak_live_size == 256);
+
+    REQUIRE(reports[1].pattern == amber::lifetime_pattern::bulk);
+    REQUIRE(reports[1].recommendation == amber::allocator_kind::linear_allocator);
+    REQUIRE(reports[1].allocate_count == 40);
+    REQUIRE(reports[1].free_count == 40);
+    REQUIRE(reports[1].free_calls_saved == 40);
+    REQUIRE(reports[1].min_size == 24);
+    REQUIRE(reports[1].max_size == 31);
+    REQUIRE(reports[1].peak_live_count == 8);
+    REQUIRE(reports[1].projected_overhead == 0);
+
+    REQUIRE(reports[2].pattern == amber::lifetime_pattern::lifo);
+    REQUIRE(reports[2].recommendation == amber::allocator_kind::stack_allocator);
+    REQUIRE(reports[2].free_count == 20);
+    REQUIRE(reports[2].peak_live_count == 2);
+
+    REQUIRE(reports[3].pattern == amber::lifetime_pattern::fifo);
+    REQUIRE(reports[3].recommendation == amber::allocator_kind::spsc_ring_allocator);
+    REQUIRE(reports[3].free_count == 21);
+    REQUIRE(reports[3].peak_live_count == 4);
+
+    REQUIRE(reports[4].pattern == amber::lifetime_pattern::random);
+    REQUIRE(reports[4].recommendation == amber::allocator_kind::pool_allocator);
+    REQUIRE(reports[4].free_count == 4);
+    REQUIRE(reports[4].projected_overhead == 0);
+    REQUIRE(reports[4].malloc_overhead == 160);
+
+    REQUIRE(reports[5].pattern == amber::lifetime_pattern::random);
+    REQUIRE(reports[5].recommendation == amber::allocator_kind::bucketizer);
+
+    REQUIRE(reports[6].pattern == amber::lifetime_pattern::random);
+    REQUIRE(reports[6].recommendation == amber::allocator_kind::malloc_allocator);
+    REQUIRE(reports[6].projected_overhead == reports[6].malloc_overhead);
+
+    auto&& exp_text = amber::format_lifetime_report(reports, recorder.sites());
+    REQUIRE(exp_text.has_value());
+    const std::string& text = exp_text.value();
+    REQUIRE(text.find("lifetime_analyzer_test.cpp") != std::string::npos);
+    REQUIRE(text.find("recommended: stack_allocator") != std::string::npos);
+    REQUIRE(text.find("recommended: spsc_ring_allocator") != std::string::npos);
+
+    for (void* ptr : leaked) {
+        recorder.parent().free(ptr);
+    }
+}
+
+TEST_CASE("analyze_lifetimes ignores frees of unknown allocations")
+{
+    const amber::lifetime_event events[] = {
+        {amber::lifetime_event_kind::allocate, 0, 0x1000, 16, 0},
+        {amber::lifetime_event_kind::free, amber::lifetime_event::no_site, 0x2000, 0, 5},
+        {amber::lifetime_event_kind::free, amber::lifetime_event::no_site, 0x1000, 0, 10},
+    };
+    amber::site_report reports[1];
+    auto&& exp_analyze = amber::analyze_lifetimes(events, 1, reports);
+    REQUIRE(exp_analyze.has_value());
+    REQUIRE(reports[0].allocate_count == 1);
+    REQUIRE(reports[0].free_count == 1);
+    REQUIRE(reports[0].mean_lifetime == 10);
+}
+
+TEST_CASE("analyze_lifetimes errors")
+{
+    const amber::lifetime_event events[] = {
+        {amber::lifetime_event_kind::allocate, 3, 0x1000, 16, 0},
+    };
+    amber::site_report reports[2];
+    auto&& exp_small = amber::analyze_lifetimes(events, 3, std::span<amber::site_report>(reports, 1));
+    REQUIRE(!exp_small.has_value());
+    REQUIRE(exp_small.error() == "report span too small");
+    auto&& exp_site = amber::analyze_lifetimes(events, 2, reports);
+    REQUIRE(!exp_site.has_value());
+    REQUIRE(exp_site.error() == "invalid site index");
+}
+
+} // namespace amber_test
@@ -0,0 +1,98 @@
+#include <amber/lifetime_recorder.hpp>
+#include <amber/malloc_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace amber_test {
+
+TEST_CASE("lifetime_recorder records allocations and frees")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_recorder = amber::lifetime_recorder<amber::malloc_allocator>::create(
+        amber::malloc_allocator(), buffer, 4);
+    REQUIRE(exp_recorder.has_value());
+    amber::lifetime_recorder<amber::malloc_allocator> recorder = std::move(exp_recorder).value();
+
+    void* ptrs[3];
+    for (std::size_t i = 0; i < 3; ++i) {
+        auto&& exp_ptr = recorder.allocate(8, 32);
+        REQUIRE(exp_ptr.has_value());
+        ptrs[i] = exp_ptr.value();
+    }
+    auto&& exp_other = recorder.allocate(16, 100);
+    REQUIRE(exp_other.has_value());
+    recorder.free(ptrs[1]);
+    recorder.free(exp_other.value());
+    recorder.free(nullptr);
+
+    // One site for the loop and one for the single allocation
+    REQUIRE(recorder.sites().size() == 2);
+    REQUIRE(recorder.sites()[0].line != recorder.sites()[1].line);
+    REQUIRE(std::strstr(recorder.sites()[0].file, "lifetime_recorder_test.cpp") != nullptr);
+    REQUIRE(recorder.events().size() == 6);
+    REQUIRE(recorder.dropped_count() == 0);
+    const auto& events = recorder.events();
+    for (std::size_t i = 0; i < 3; ++i) {
+        REQUIRE(events[i].kind == amber::lifetime_event_kind::allocate);
+        REQUIRE(events[i].site == 0);
+        REQUIRE(events[i].size == 32);
+        REQUIRE(events[i].address == reinterpret_cast<std::uintptr_t>(ptrs[i]));
+    }
+    REQUIRE(events[3].site == 1);
+    REQUIRE(events[3].size == 100);
+    REQUIRE(events[4].kind == amber::lifetime_event_kind::free);
+    REQUIRE(events[4].site == amber::lifetime_event::no_site);
+    REQUIRE(events[4].address == reinterpret_cast<std::uintptr_t>(ptrs[1]));
+    REQUIRE(events[5].address == reinterpret_cast<std::uintptr_t>(exp_other.value()));
+    for (std::size_t i = 1; i < events.size(); ++i) {
+        REQUIRE(events[i].time >= events[i - 1].time);
+    }
+
+    recorder.free(ptrs[0]);
+    recorder.free(ptrs[2]);
+    recorder.clear();
+    REQUIRE(recorder.events().empty());
+    REQUIRE(recorder.sites().empty());
+}
+
+TEST_CASE("lifetime_recorder drops events past capacity")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(
+        sizeof(amber::lifetime_site) + (2 * sizeof(amber::lifetime_event)));
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_recorder = amber::lifetime_recorder<amber::malloc_allocator>::create(
+        amber::malloc_allocator(), buffer, 1);
+    REQUIRE(exp_recorder.has_value());
+    amber::lifetime_recorder<amber::malloc_allocator> recorder = std::move(exp_recorder).value();
+
+    auto&& exp_ptr1 = recorder.allocate(8, 8);
+    REQUIRE(exp_ptr1.has_value());
+    // The site table is full, the allocation still succeeds
+    auto&& exp_ptr2 = recorder.allocate(8, 8);
+    REQUIRE(exp_ptr2.has_value());
+    REQUIRE(recorder.dropped_count() == 1);
+    recorder.free(exp_ptr1.value());
+    recorder.free(exp_ptr2.value());
+    REQUIRE(recorder.events().size() == 2);
+    REQUIRE(recorder.dropped_count() == 2);
+}
+
+TEST_CASE("lifetime_recorder create errors")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_recorder = amber::lifetime_recorder<amber::malloc_allocator>::create(
+        amber::malloc_allocator(), buffer, 16);
+    REQUIRE(!exp_recorder.has_value());
+    REQUIRE(exp_recorder.error() == "buffer too small");
+}
+
+} // namespace amber_test
@@ -1,12 +1,56 @@
 #include <amber/linear_allocator.hpp>
 #include <amber/malloc_buffer.hpp>
+#include <amber/mmap_buffer.hpp>
+#include <amber/util.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <cstdint>
+#include <cstring>
 #include <expected>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace amber_test {
 
+namespace {
+
+struct destroy_recorder {
+public:
+    destroy_recorder(std::vector<int>& order, int id) noexcept
+        : order(order),
+        id(id)
+    {}
+
+    ~destroy_recorder() noexcept
+    {
+        order.push_back(id);
+    }
+
+    std::vector<int>& order;
+    int id;
+};
+
+struct throws_on_zero {
+public:
+    explicit throws_on_zero(int v)
+        : value(v)
+    {
+        if (v == 0) {
+            throw std::invalid_argument("zero");
+        }
+    }
+
+    ~throws_on_zero() noexcept
+    {
+        value = -1;
+    }
+
+    int value;
+};
+
+} // unnamed namespace
+
 TEST_CASE("linear_allocator move constructor/assignment")
 {
     auto exp_buffer = amber::malloc_buffer::create(64);
@@ -161,4 +205,177 @@ TEST_CASE("linear_allocator reset")
     REQUIRE(a1.buffer_offset() == 0);
 }
 
+TEST_CASE("linear_allocator allocate<T>(...) non-trivial destructor")
+{
+    auto exp_buffer = amber::malloc_buffer::create(256);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    std::vector<int> order;
+    order.reserve(8);
+    auto exp_a1 = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_a1.has_value());
+    amber::linear_allocator a1(std::move(exp_a1.value()));
+
+    auto exp_r1 = a1.allocate<destroy_recorder>(order, 1);
+    REQUIRE(exp_r1.has_value());
+    REQUIRE(exp_r1.value()->id == 1);
+    std::size_t marker = a1.buffer_offset();
+    auto exp_r2 = a1.allocate<destroy_recorder>(order, 2);
+    REQUIRE(exp_r2.has_value());
+    auto exp_int = a1.allocate<int>(5);
+    REQUIRE(exp_int.has_value());
+    auto exp_r3 = a1.allocate<destroy_recorder>(order, 3);
+    REQUIRE(exp_r3.has_value());
+    REQUIRE(order.empty());
+
+    a1.rewind(marker);
+    REQUIRE(a1.buffer_offset() == marker);
+    REQUIRE(order == std::vector<int>{3, 2});
+
+    auto exp_r4 = a1.allocate<destroy_recorder>(order, 4);
+    REQUIRE(exp_r4.has_value());
+    a1.reset();
+    REQUIRE(a1.buffer_offset() == 0);
+    REQUIRE(order == std::vector<int>{3, 2, 4, 1});
+
+    a1.reset();
+    REQUIRE(order.size() == 4);
+
+    auto exp_r5 = a1.allocate<destroy_recorder>(order, 5);
+    REQUIRE(exp_r5.has_value());
+    auto exp_r6 = a1.allocate<destroy_recorder>(order, 6);
+    REQUIRE(exp_r6.has_value());
+    {
+        amber::linear_allocator a2(std::move(a1));
+        REQUIRE(order.size() == 4);
+    }
+    REQUIRE(order == std::vector<int>{3, 2, 4, 1, 6, 5});
+}
+
+TEST_CASE("linear_allocator allocate<T>(...) non-trivial destructor out of capacity")
+{
+    auto exp_buffer = amber::malloc_buffer::create(48);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    std::vector<int> order;
+    auto exp_a1 = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_a1.has_value());
+    amber::linear_allocator a1(std::move(exp_a1.value()));
+
+    auto exp_r1 = a1.allocate<destroy_recorder>(order, 1);
+    REQUIRE(exp_r1.has_value());
+    std::size_t offset = a1.buffer_offset();
+    auto exp_r2 = a1.allocate<destroy_recorder>(order, 2);
+    REQUIRE_FALSE(exp_r2.has_value());
+    REQUIRE(exp_r2.error() == "out of capacity");
+    REQUIRE(a1.buffer_offset() == offset);
+
+    a1.reset();
+    REQUIRE(order == std::vector<int>{1});
+}
+
+TEST_CASE("linear_allocator allocate<T>(...) throwing constructors")
+{
+    auto exp_buffer = amber::malloc_buffer::create(1024);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto exp_a1 = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_a1.has_value());
+    amber::linear_allocator a1(std::move(exp_a1.value()));
+
+    auto exp_str = a1.allocate<std::string>("a string long enough to leave the small buffer");
+    REQUIRE(exp_str.has_value());
+    REQUIRE(*exp_str.value() == "a string long enough to leave the small buffer");
+    auto exp_ok = a1.allocate<throws_on_zero>(1);
+    REQUIRE(exp_ok.has_value());
+    REQUIRE(exp_ok.value()->value == 1);
+
+    std::size_t offset = a1.buffer_offset();
+    auto exp_thrown = a1.allocate<throws_on_zero>(0);
+    REQUIRE_FALSE(exp_thrown.has_value());
+    REQUIRE(exp_thrown.error() == "constructor threw");
+    REQUIRE(a1.buffer_offset() == offset);
+    // The failed object left no destructor behind
+    a1.reset();
+    REQUIRE(a1.buffer_offset() == 0);
+}
+
+TEST_CASE("linear_allocator try_extend/shrink/reallocate")
+{
+    auto exp_buffer = amber::malloc_buffer::create(128);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_a1 = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_a1.has_value());
+    amber::linear_allocator a1(std::move(exp_a1.value()));
+
+    auto exp_p1 = a1.allocate(16);
+    REQUIRE(exp_p1.has_value());
+    void* p1 = exp_p1.value();
+    REQUIRE(a1.try_extend(p1, 16, 32));
+    REQUIRE(a1.buffer_offset() == 32);
+    REQUIRE_FALSE(a1.try_extend(p1, 32, 129));
+    REQUIRE(a1.buffer_offset() == 32);
+    REQUIRE(a1.shrink(p1, 32, 8));
+    REQUIRE(a1.buffer_offset() == 8);
+    REQUIRE_FALSE(a1.shrink(p1, 8, 16));
+
+    auto exp_p2 = a1.allocate(8);
+    REQUIRE(exp_p2.has_value());
+    void* p2 = exp_p2.value();
+    REQUIRE(a1.buffer_offset() == 24);
+    REQUIRE_FALSE(a1.try_extend(p1, 8, 16));
+    REQUIRE_FALSE(a1.shrink(p1, 8, 4));
+    REQUIRE(a1.buffer_offset() == 24);
+
+    std::memset(p1, 0x5a, 8);
+    auto exp_p3 = a1.reallocate(p1, 8, 16);
+    REQUIRE(exp_p3.has_value());
+    REQUIRE(exp_p3.value() != p1);
+    REQUIRE(a1.buffer_offset() == 48);
+    REQUIRE(std::memcmp(exp_p3.value(), p1, 8) == 0);
+
+    auto exp_p4 = a1.reallocate(exp_p3.value(), 16, 64);
+    REQUIRE(exp_p4.has_value());
+    REQUIRE(exp_p4.value() == exp_p3.value());
+    REQUIRE(a1.buffer_offset() == 96);
+
+    auto exp_p5 = a1.reallocate(p2, 8, 4);
+    REQUIRE(exp_p5.has_value());
+    REQUIRE(exp_p5.value() == p2);
+    REQUIRE(a1.buffer_offset() == 96);
+
+    auto exp_p6 = a1.reallocate(p2, 8, 64);
+    REQUIRE_FALSE(exp_p6.has_value());
+    REQUIRE(exp_p6.error() == "out of capacity");
+}
+
+TEST_CASE("linear_allocator extend(buffer)")
+{
+    std::size_t page = amber::page_size();
+    auto&& exp_buffer = amber::mmap_buffer::create_lazy(4 * page);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+    REQUIRE(buffer.shrink(page).has_value());
+    auto&& exp_alloc = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::linear_allocator allocator = std::move(exp_alloc).value();
+
+    REQUIRE(allocator.allocate(page).has_value());
+    REQUIRE_FALSE(allocator.allocate(1).has_value());
+    REQUIRE(buffer.grow_in_place(4 * page).has_value());
+    REQUIRE(allocator.extend(buffer).has_value());
+    REQUIRE(allocator.buffer_size() == 4 * page);
+    REQUIRE(allocator.allocate(3 * page).has_value());
+
+    auto&& exp_other = amber::mmap_buffer::create_lazy(8 * page);
+    REQUIRE(exp_other.has_value());
+    REQUIRE(allocator.extend(exp_other.value()).error() == "buffer moved");
+    REQUIRE(buffer.shrink(2 * page).has_value());
+    REQUIRE(allocator.extend(buffer).error() == "buffer shrunk");
+}
+
 } // namespace amber_test
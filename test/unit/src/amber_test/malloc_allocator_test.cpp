@@ -0,0 +1,26 @@
+#include <amber/malloc_allocator.hpp>
+#include <amber/util.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+
+namespace amber_test {
+
+TEST_CASE("malloc_allocator allocate(alignment, size)/free(ptr)")
+{
+    amber::malloc_allocator allocator;
+    auto exp_a1 = allocator.allocate(256, 100);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(amber::is_aligned(std::uintptr_t{256}, reinterpret_cast<std::uintptr_t>(exp_a1.value())));
+    allocator.free(exp_a1.value());
+
+    auto exp_a2 = allocator.allocate<std::uint64_t>(3u);
+    REQUIRE(exp_a2.has_value());
+    REQUIRE(*exp_a2.value() == 3);
+    allocator.free(exp_a2.value());
+
+    auto exp_a3 = allocator.allocate(3, 8);
+    REQUIRE_FALSE(exp_a3.has_value());
+    REQUIRE(exp_a3.error() == "invalid alignment: 3");
+}
+
+} // namespace amber_test
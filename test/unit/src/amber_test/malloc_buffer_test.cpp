@@ -1,6 +1,8 @@
 #include <amber/malloc_buffer.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <cstddef>
+#include <cstring>
+#include <utility>
 
 namespace amber_test {
 
@@ -16,4 +18,23 @@ TEST_CASE("malloc_buffer test")
     REQUIRE(buffer.size() == buffer_size);
 }
 
+TEST_CASE("malloc_buffer grow(size)/shrink(size)")
+{
+    auto exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer(std::move(exp_buffer).value());
+    std::memset(buffer.buffer().data(), 7, 64);
+
+    REQUIRE(buffer.grow(4096).has_value());
+    REQUIRE(buffer.size() == 4096);
+    REQUIRE(buffer.buffer()[63] == std::byte{7});
+    REQUIRE(buffer.shrink(32).has_value());
+    REQUIRE(buffer.size() == 32);
+    REQUIRE(buffer.buffer()[31] == std::byte{7});
+
+    REQUIRE(buffer.grow(16).error() == "invalid size");
+    REQUIRE(buffer.shrink(64).error() == "invalid size");
+    REQUIRE(buffer.shrink(0).error() == "invalid size");
+}
+
 } // namespace amber_test
@@ -0,0 +1,54 @@
+#include <amber/mirrored_buffer.hpp>
+#include <amber/util.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+namespace amber_test {
+
+TEST_CASE("mirrored_buffer test")
+{
+    std::size_t buffer_size = amber::page_size();
+    auto exp_buffer = amber::mirrored_buffer::create(buffer_size);
+    if (!exp_buffer.has_value()) {
+        UNSCOPED_INFO("mirrored_buffer::create error: " << exp_buffer.error());
+    }
+    REQUIRE(exp_buffer.has_value());
+    amber::mirrored_buffer buffer(std::move(exp_buffer).value());
+    REQUIRE(buffer.size() == buffer_size);
+    REQUIRE(buffer.buffer().size() == buffer_size);
+
+    // A write that runs past the end continues at the start
+    std::span<std::byte> window = buffer.window(buffer_size - 4, 8);
+    std::memcpy(window.data(), "abcdefgh", 8);
+    REQUIRE(std::memcmp(buffer.buffer().data(), "efgh", 4) == 0);
+    REQUIRE(std::memcmp(buffer.buffer().data() + buffer_size - 4, "abcd", 4) == 0);
+    REQUIRE(std::memcmp(buffer.window(buffer_size * 3 - 4, 8).data(), "abcdefgh", 8) == 0);
+
+    amber::mirrored_buffer moved(std::move(buffer));
+    REQUIRE(buffer.size() == 0);
+    REQUIRE(moved.size() == buffer_size);
+}
+
+TEST_CASE("mirrored_buffer size error")
+{
+    auto exp_buffer = amber::mirrored_buffer::create(amber::page_size() + 1);
+    REQUIRE_FALSE(exp_buffer.has_value());
+}
+
+TEST_CASE("mirrored_buffer flags")
+{
+    auto exp_populated = amber::mirrored_buffer::create(amber::page_size(), amber::mmap_flag::populate);
+    REQUIRE(exp_populated.has_value());
+
+    for (amber::mmap_flag flags : {amber::mmap_flag::private_map, amber::mmap_flag::anonymous,
+        amber::mmap_flag::huge_table | amber::mmap_flag::huge_2mb})
+    {
+        auto exp_buffer = amber::mirrored_buffer::create(amber::page_size(), flags);
+        REQUIRE_FALSE(exp_buffer.has_value());
+    }
+}
+
+} // namespace amber_test
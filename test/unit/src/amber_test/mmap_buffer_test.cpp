@@ -1,6 +1,13 @@
 #include <amber/mmap_buffer.hpp>
+#include <amber/util.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <cstddef>
+#include <utility>
+
+extern "C" {
+#include <sys/wait.h>
+#include <unistd.h>
+}
 
 namespace amber_test {
 
@@ -16,4 +23,61 @@ TEST_CASE("mmap_buffer test")
     REQUIRE(buffer.size() == buffer_size);
 }
 
+TEST_CASE("mmap_buffer create_lazy(size)")
+{
+    auto exp_buffer = amber::mmap_buffer::create_lazy(5200);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer(std::move(exp_buffer).value());
+    REQUIRE(buffer.size() == 5200);
+    buffer.buffer()[5199] = std::byte{1};
+    REQUIRE(buffer.buffer()[5199] == std::byte{1});
+}
+
+TEST_CASE("mmap_buffer create(size, shared)")
+{
+    auto exp_buffer = amber::mmap_buffer::create(4096, amber::mmap_flag::shared);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer(std::move(exp_buffer).value());
+
+    pid_t pid = fork();
+    REQUIRE(pid != -1);
+    if (pid == 0) {
+        buffer.buffer()[100] = std::byte{7};
+        _exit(0);
+    }
+    int status = 0;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(buffer.buffer()[100] == std::byte{7});
+
+    auto exp_both = amber::mmap_buffer::create(4096, amber::mmap_flag::shared | amber::mmap_flag::private_map);
+    REQUIRE_FALSE(exp_both.has_value());
+}
+
+TEST_CASE("mmap_buffer grow(size)/grow_in_place(size)/shrink(size)")
+{
+    std::size_t page = amber::page_size();
+    auto exp_buffer = amber::mmap_buffer::create_lazy(8 * page);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer(std::move(exp_buffer).value());
+    std::byte* data = buffer.buffer().data();
+    buffer.buffer()[page] = std::byte{7};
+
+    // Shrinking frees the pages after the mapping so it can grow back in place
+    REQUIRE(buffer.shrink(2 * page).has_value());
+    REQUIRE(buffer.size() == 2 * page);
+    REQUIRE(buffer.grow_in_place(6 * page).has_value());
+    REQUIRE(buffer.size() == 6 * page);
+    REQUIRE(buffer.buffer().data() == data);
+    REQUIRE(buffer.buffer()[page] == std::byte{7});
+
+    REQUIRE(buffer.grow(1024 * page).has_value());
+    REQUIRE(buffer.size() == 1024 * page);
+    REQUIRE(buffer.buffer()[page] == std::byte{7});
+    buffer.buffer()[1023 * page] = std::byte{1};
+
+    REQUIRE(buffer.grow(page).error() == "invalid size");
+    REQUIRE(buffer.shrink(2048 * page).error() == "invalid size");
+}
+
 } // namespace amber_test
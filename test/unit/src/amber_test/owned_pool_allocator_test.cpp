@@ -0,0 +1,138 @@
+#include <amber/malloc_buffer.hpp>
+#include <amber/owned_pool_allocator.hpp>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace amber_test {
+
+TEST_CASE("owned_pool_allocator move constructor/assignment")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto&& exp_alloc = amber::owned_pool_allocator::create(buffer, 16);
+    REQUIRE(exp_alloc.has_value());
+    amber::owned_pool_allocator a1(std::move(exp_alloc).value());
+    REQUIRE(a1.entry_count() == 4);
+    REQUIRE(a1.owner() == std::this_thread::get_id());
+
+    amber::owned_pool_allocator a2(std::move(a1));
+    REQUIRE(a1.entry_count() == 0);
+    REQUIRE(a1.owner() == std::thread::id());
+    REQUIRE(a2.entry_count() == 4);
+
+    a1 = std::move(a2);
+    REQUIRE(a1.entry_count() == 4);
+    REQUIRE(a2.entry_count() == 0);
+}
+
+TEST_CASE("owned_pool_allocator free_remote(ptr)/reclaim()")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_alloc = amber::owned_pool_allocator::create(buffer, 16);
+    REQUIRE(exp_alloc.has_value());
+    amber::owned_pool_allocator allocator = std::move(exp_alloc).value();
+
+    void* ptrs[4] = {};
+    for (void*& ptr : ptrs) {
+        auto exp_ptr = allocator.allocate();
+        REQUIRE(exp_ptr.has_value());
+        ptr = exp_ptr.value();
+        REQUIRE(allocator.owns(ptr));
+    }
+    REQUIRE(ptrs[0] == buffer.buffer().data());
+
+    allocator.free_remote(ptrs[1]);
+    allocator.free_remote(ptrs[2]);
+    REQUIRE(allocator.entry_allocate_count() == 4);
+
+    // The local list is empty, so allocate takes the remote list back
+    auto exp_a5 = allocator.allocate();
+    REQUIRE(exp_a5.has_value());
+    REQUIRE(allocator.entry_allocate_count() == 3);
+    allocator.free(ptrs[0]);
+    allocator.free(exp_a5.value());
+    allocator.free(ptrs[3]);
+    REQUIRE(allocator.entry_allocate_count() == 0);
+    REQUIRE(allocator.reclaim() == 0);
+
+    auto exp_a6 = allocator.allocate(8, 32);
+    REQUIRE_FALSE(exp_a6.has_value());
+    REQUIRE(exp_a6.error() == "size too large");
+}
+
+TEST_CASE("owned_pool_allocator cross-thread free")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(256 * 64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_alloc = amber::owned_pool_allocator::create(buffer, 64);
+    REQUIRE(exp_alloc.has_value());
+    amber::owned_pool_allocator allocator = std::move(exp_alloc).value();
+
+    // Owner produces messages, several consumers free them
+    constexpr std::size_t consumer_count = 3;
+    constexpr std::size_t message_count = 20000;
+    std::atomic<std::uint64_t*> mailboxes[consumer_count] = {};
+    std::atomic<bool> done(false);
+    std::atomic<std::size_t> bad(0);
+    std::vector<std::thread> consumers;
+    for (std::size_t c = 0; c < consumer_count; ++c) {
+        consumers.emplace_back([&, c]() {
+            while (true) {
+                std::uint64_t* message = mailboxes[c].exchange(nullptr, std::memory_order_acquire);
+                if (message == nullptr) {
+                    if (done.load(std::memory_order_acquire)
+                        && mailboxes[c].load(std::memory_order_acquire) == nullptr)
+                    {
+                        return;
+                    }
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (*message % consumer_count != c) {
+                    bad.fetch_add(1);
+                }
+                allocator.free(message);
+            }
+        });
+    }
+    for (std::size_t i = 0; i < message_count; ++i) {
+        auto exp_message = allocator.allocate<std::uint64_t>(i);
+        while (!exp_message.has_value()) {
+            std::this_thread::yield();
+            exp_message = allocator.allocate<std::uint64_t>(i);
+        }
+        std::atomic<std::uint64_t*>& mailbox = mailboxes[i % consumer_count];
+        std::uint64_t* expected = nullptr;
+        while (!mailbox.compare_exchange_weak(expected, exp_message.value(), std::memory_order_release)) {
+            expected = nullptr;
+            std::this_thread::yield();
+        }
+    }
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : consumers) {
+        t.join();
+    }
+    REQUIRE(bad.load() == 0);
+    allocator.reclaim();
+    REQUIRE(allocator.entry_allocate_count() == 0);
+
+    std::set<void*> ptrs;
+    for (std::size_t i = 0; i < allocator.entry_count(); ++i) {
+        auto exp_ptr = allocator.allocate();
+        REQUIRE(exp_ptr.has_value());
+        REQUIRE(ptrs.insert(exp_ptr.value()).second);
+    }
+    REQUIRE_FALSE(allocator.allocate().has_value());
+}
+
+} // namespace amber_test
@@ -1,6 +1,10 @@
+#include <amber/aligned_buffer.hpp>
 #include <amber/malloc_buffer.hpp>
+#include <amber/mmap_buffer.hpp>
 #include <amber/pool_allocator.hpp>
+#include <amber/util.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <cstdint>
 #include <utility>
 
 namespace amber_test {
@@ -168,4 +172,118 @@ TEST_CASE("pool_allocator allocate<T>()/free<T>(ptr)")
     REQUIRE(exp_a6.error() == "type size too large");
 }
 
+TEST_CASE("pool_allocator create(buffer, entry_size, entry_alignment)")
+{
+    auto&& exp_buffer = amber::aligned_buffer::create(4096, 1024);
+    REQUIRE(exp_buffer.has_value());
+    amber::aligned_buffer buffer = std::move(exp_buffer).value();
+
+    auto&& exp_alloc = amber::pool_allocator::create(buffer, 12, amber::cache_line_size);
+    REQUIRE(exp_alloc.has_value());
+    amber::pool_allocator allocator(std::move(exp_alloc).value());
+    REQUIRE(allocator.entry_size() == amber::cache_line_size);
+    REQUIRE(allocator.entry_alignment() == amber::cache_line_size);
+    REQUIRE(allocator.slab_offset() == 0);
+    REQUIRE(allocator.entry_count() == 1024 / amber::cache_line_size);
+
+    for (std::size_t i = 0; i < allocator.entry_count(); ++i) {
+        auto exp_ptr = allocator.allocate();
+        REQUIRE(exp_ptr.has_value());
+        std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(exp_ptr.value());
+        REQUIRE((addr % amber::cache_line_size) == 0);
+    }
+    REQUIRE(allocator.entry_free_count() == 0);
+
+    auto&& exp_alloc2 = amber::pool_allocator::create(buffer, 12);
+    REQUIRE(exp_alloc2.has_value());
+    REQUIRE(exp_alloc2.value().entry_size() == 16);
+
+    auto&& exp_alloc3 = amber::pool_allocator::create(buffer, 8, 24);
+    REQUIRE_FALSE(exp_alloc3.has_value());
+    REQUIRE(exp_alloc3.error() == "invalid alignment: 24");
+}
+
+TEST_CASE("pool_allocator create(buffer, entry_size, entry_alignment, color_offset)")
+{
+    auto&& exp_buffer = amber::aligned_buffer::create(4096, 1024);
+    REQUIRE(exp_buffer.has_value());
+    amber::aligned_buffer buffer = std::move(exp_buffer).value();
+    std::uintptr_t buffer_addr = reinterpret_cast<std::uintptr_t>(buffer.buffer().data());
+
+    auto&& exp_alloc = amber::pool_allocator::create(buffer, 128, 64, 100);
+    REQUIRE(exp_alloc.has_value());
+    amber::pool_allocator allocator(std::move(exp_alloc).value());
+    REQUIRE(allocator.entry_size() == 128);
+    REQUIRE(allocator.slab_offset() == 128);
+    REQUIRE(allocator.entry_count() == 7);
+
+    for (std::size_t i = 0; i < allocator.entry_count(); ++i) {
+        auto exp_ptr = allocator.allocate();
+        REQUIRE(exp_ptr.has_value());
+        std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(exp_ptr.value());
+        REQUIRE(addr - buffer_addr >= allocator.slab_offset());
+        REQUIRE(((addr - buffer_addr - allocator.slab_offset()) % 128) == 0);
+    }
+
+    auto&& exp_alloc2 = amber::pool_allocator::create(buffer, 8, 8, 2048);
+    REQUIRE_FALSE(exp_alloc2.has_value());
+    REQUIRE(exp_alloc2.error() == "color offset out of range, color offset: 2048, buffer size: 1024");
+}
+
+TEST_CASE("pool_allocator allocate<T>() alignment")
+{
+    struct alignas(32) foo {
+    public:
+        int a;
+    };
+
+    auto&& exp_buffer = amber::aligned_buffer::create(4096, 256);
+    REQUIRE(exp_buffer.has_value());
+    amber::aligned_buffer buffer = std::move(exp_buffer).value();
+
+    auto&& exp_alloc = amber::pool_allocator::create(buffer, sizeof(foo));
+    REQUIRE(exp_alloc.has_value());
+    amber::pool_allocator a1(std::move(exp_alloc).value());
+    auto exp_a1 = a1.allocate<foo>();
+    REQUIRE_FALSE(exp_a1.has_value());
+    REQUIRE(exp_a1.error() == "type alignment too large");
+
+    auto&& exp_alloc2 = amber::pool_allocator::create(buffer, sizeof(foo), alignof(foo));
+    REQUIRE(exp_alloc2.has_value());
+    amber::pool_allocator a2(std::move(exp_alloc2).value());
+    auto exp_a2 = a2.allocate<foo>();
+    REQUIRE(exp_a2.has_value());
+    REQUIRE((reinterpret_cast<std::uintptr_t>(exp_a2.value()) % alignof(foo)) == 0);
+}
+
+TEST_CASE("pool_allocator extend(buffer)")
+{
+    std::size_t page = amber::page_size();
+    auto&& exp_buffer = amber::mmap_buffer::create_lazy(4 * page);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+    REQUIRE(buffer.shrink(page).has_value());
+    auto&& exp_alloc = amber::pool_allocator::create(buffer, page / 4);
+    REQUIRE(exp_alloc.has_value());
+    amber::pool_allocator allocator = std::move(exp_alloc).value();
+    REQUIRE(allocator.entry_count() == 4);
+
+    auto exp_a1 = allocator.allocate();
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(buffer.grow_in_place(4 * page).has_value());
+    REQUIRE(allocator.extend(buffer).has_value());
+    REQUIRE(allocator.entry_count() == 16);
+    REQUIRE(allocator.entry_free_count() == 15);
+    for (std::size_t i = 0; i < 15; ++i) {
+        auto exp_ptr = allocator.allocate();
+        REQUIRE(exp_ptr.has_value());
+        REQUIRE(allocator.owns(exp_ptr.value()));
+    }
+    REQUIRE_FALSE(allocator.allocate().has_value());
+
+    auto&& exp_other = amber::malloc_buffer::create(8 * page);
+    REQUIRE(exp_other.has_value());
+    REQUIRE(allocator.extend(exp_other.value()).error() == "buffer moved");
+}
+
 } // namespace amber_test
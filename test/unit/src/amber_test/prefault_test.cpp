@@ -0,0 +1,97 @@
+#include <amber/mmap_buffer.hpp>
+#include <amber/prefault.hpp>
+#include <amber/util.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <sys/mman.h>
+}
+
+namespace amber_test {
+
+namespace {
+
+std::size_t resident_pages(std::span<std::byte> range)
+{
+    std::vector<unsigned char> residency(range.size() / amber::page_size());
+    if (mincore(range.data(), range.size(), residency.data()) == -1) {
+        return SIZE_MAX;
+    }
+    std::size_t count = 0;
+    for (unsigned char page : residency) {
+        count += page & 1;
+    }
+    return count;
+}
+
+} // unnamed namespace
+
+TEST_CASE("prefault(range, thread_count)")
+{
+    std::size_t page = amber::page_size();
+    auto&& exp_buffer = amber::mmap_buffer::create_lazy(64 * page);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+    buffer.buffer()[3 * page + 5] = std::byte{0xab};
+
+    auto exp_prefault = amber::prefault(buffer.buffer(), 4);
+    REQUIRE(exp_prefault.has_value());
+    REQUIRE(resident_pages(buffer.buffer()) == 64);
+    // Contents are left untouched
+    REQUIRE(buffer.buffer()[3 * page + 5] == std::byte{0xab});
+    REQUIRE(buffer.buffer()[3 * page + 6] == std::byte{0});
+
+    auto exp_invalid = amber::prefault(buffer.buffer(), 0);
+    REQUIRE_FALSE(exp_invalid.has_value());
+    REQUIRE(exp_invalid.error() == "invalid thread count");
+}
+
+TEST_CASE("prefault_task ready_size()/wait_ready(size)/wait()")
+{
+    std::size_t page = amber::page_size();
+    auto&& exp_buffer = amber::mmap_buffer::create_lazy(256 * page);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+
+    // Unaligned ranges populate the pages they touch
+    std::span<std::byte> range = buffer.buffer().subspan(100, 200 * page);
+    auto&& exp_task = amber::prefault_task::create(range, 3);
+    REQUIRE(exp_task.has_value());
+    amber::prefault_task task = std::move(exp_task).value();
+    REQUIRE(task.thread_count() == 3);
+
+    REQUIRE(task.wait_ready(10 * page));
+    REQUIRE(task.ready_size() >= 10 * page);
+    REQUIRE(resident_pages(buffer.buffer().subspan(0, 11 * page)) == 11);
+
+    amber::prefault_task moved(std::move(task));
+    REQUIRE(moved.wait().has_value());
+    REQUIRE(moved.ready_size() == range.size());
+    REQUIRE(moved.wait_ready(SIZE_MAX));
+    REQUIRE(resident_pages(buffer.buffer().subspan(0, 201 * page)) == 201);
+}
+
+TEST_CASE("prefault_task more threads than pages")
+{
+    std::size_t page = amber::page_size();
+    auto&& exp_buffer = amber::mmap_buffer::create_lazy(2 * page);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+
+    auto&& exp_task = amber::prefault_task::create(buffer.buffer(), 8);
+    REQUIRE(exp_task.has_value());
+    REQUIRE(exp_task.value().thread_count() == 2);
+    REQUIRE(exp_task.value().wait().has_value());
+    REQUIRE(exp_task.value().ready_size() == 2 * page);
+
+    auto&& exp_empty = amber::prefault_task::create(buffer.buffer().subspan(0, 0), 2);
+    REQUIRE(exp_empty.has_value());
+    REQUIRE(exp_empty.value().thread_count() == 0);
+    REQUIRE(exp_empty.value().wait().has_value());
+}
+
+} // namespace amber_test
@@ -0,0 +1,186 @@
+#include <amber/linear_allocator.hpp>
+#include <amber/mmap_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <amber/purge.hpp>
+#include <amber/stack_allocator.hpp>
+#include <amber/util.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstring>
+#include <span>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <sys/mman.h>
+}
+
+namespace amber_test {
+
+namespace {
+
+std::size_t resident_pages(std::span<std::byte> range)
+{
+    std::vector<unsigned char> residency(range.size() / amber::page_size());
+    if (mincore(range.data(), range.size(), residency.data()) == -1) {
+        return SIZE_MAX;
+    }
+    std::size_t count = 0;
+    for (unsigned char page : residency) {
+        count += page & 1;
+    }
+    return count;
+}
+
+} // unnamed namespace
+
+TEST_CASE("purge_pages(range, mode)")
+{
+    std::size_t page = amber::page_size();
+    auto&& exp_buffer = amber::mmap_buffer::create(8 * page);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+    std::memset(buffer.buffer().data(), 0xab, 8 * page);
+
+    // Only the whole pages inside the range are released
+    auto exp_size = amber::purge_pages(buffer.buffer().subspan(page / 2, 4 * page), amber::purge_mode::dont_need);
+    REQUIRE(exp_size.has_value());
+    REQUIRE(exp_size.value() == 3 * page);
+    REQUIRE(resident_pages(buffer.buffer().subspan(page, 3 * page)) == 0);
+    REQUIRE(buffer.buffer()[page] == std::byte{0});
+    REQUIRE(buffer.buffer()[page - 1] == std::byte{0xab});
+    REQUIRE(buffer.buffer()[4 * page] == std::byte{0xab});
+
+    auto exp_empty = amber::purge_pages(buffer.buffer().subspan(1, page), amber::purge_mode::dont_need);
+    REQUIRE(exp_empty.has_value());
+    REQUIRE(exp_empty.value() == 0);
+}
+
+TEST_CASE("linear_allocator dirty_size()/purge(mode, keep_size)")
+{
+    std::size_t page = amber::page_size();
+    auto&& exp_buffer = amber::mmap_buffer::create(16 * page);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_alloc = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::linear_allocator allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate(12 * page);
+    REQUIRE(exp_a1.has_value());
+    std::memset(exp_a1.value(), 1, 12 * page);
+    REQUIRE(allocator.dirty_size() == 0);
+    allocator.reset();
+    REQUIRE(allocator.dirty_size() == 12 * page);
+    auto exp_a2 = allocator.allocate(page);
+    REQUIRE(exp_a2.has_value());
+    REQUIRE(allocator.dirty_size() == 11 * page);
+
+    auto exp_size = allocator.purge(amber::purge_mode::dont_need, 3 * page);
+    REQUIRE(exp_size.has_value());
+    REQUIRE(exp_size.value() == 8 * page);
+    REQUIRE(allocator.dirty_size() == 3 * page);
+    REQUIRE(resident_pages(buffer.buffer().subspan(page, 3 * page)) == 3);
+    REQUIRE(resident_pages(buffer.buffer().subspan(4 * page, 8 * page)) == 0);
+
+    exp_size = allocator.purge(amber::purge_mode::dont_need);
+    REQUIRE(exp_size.has_value());
+    REQUIRE(exp_size.value() == 3 * page);
+    REQUIRE(allocator.dirty_size() == 0);
+    REQUIRE(resident_pages(buffer.buffer().subspan(page, 11 * page)) == 0);
+}
+
+TEST_CASE("stack_allocator dirty_size()/purge(mode)")
+{
+    std::size_t page = amber::page_size();
+    auto&& exp_buffer = amber::mmap_buffer::create(8 * page);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_alloc = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::stack_allocator allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate(6 * page);
+    REQUIRE(exp_a1.has_value());
+    std::memset(exp_a1.value(), 1, 6 * page);
+    allocator.free(exp_a1.value());
+    REQUIRE(allocator.dirty_size() > 6 * page);
+    auto exp_size = allocator.purge(amber::purge_mode::lazy_free);
+    REQUIRE(exp_size.has_value());
+    REQUIRE(exp_size.value() == 7 * page);
+    REQUIRE(allocator.dirty_size() == 0);
+}
+
+TEST_CASE("pool_allocator purge(mode)")
+{
+    std::size_t page = amber::page_size();
+    auto&& exp_buffer = amber::mmap_buffer::create(8 * page);
+    REQUIRE(exp_buffer.has_value());
+    amber::mmap_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_alloc = amber::pool_allocator::create(buffer, 2 * page);
+    REQUIRE(exp_alloc.has_value());
+    amber::pool_allocator allocator = std::move(exp_alloc).value();
+
+    void* ptrs[4] = {};
+    for (std::size_t i = 0; i < 4; ++i) {
+        auto exp_ptr = allocator.allocate();
+        REQUIRE(exp_ptr.has_value());
+        ptrs[i] = exp_ptr.value();
+        std::memset(ptrs[i], 1, 2 * page);
+    }
+    for (std::size_t i = 1; i < 4; ++i) {
+        allocator.free(ptrs[i]);
+    }
+
+    // The first page of each free entry holds the free list link
+    auto exp_size = allocator.purge(amber::purge_mode::dont_need);
+    REQUIRE(exp_size.has_value());
+    REQUIRE(exp_size.value() == 3 * page);
+    for (std::size_t i = 1; i < 4; ++i) {
+        std::span<std::byte> entry(static_cast<std::byte*>(ptrs[i]), 2 * page);
+        REQUIRE(resident_pages(entry.subspan(page, page)) == 0);
+    }
+    REQUIRE(allocator.entry_free_count() == 3);
+    for (std::size_t i = 0; i < 3; ++i) {
+        REQUIRE(allocator.allocate().has_value());
+    }
+}
+
+TEST_CASE("purge_decay dirty_limit(dirty_size, now)")
+{
+    using namespace std::chrono_literals;
+    auto&& exp_decay = amber::purge_decay::create(10s);
+    REQUIRE(exp_decay.has_value());
+    amber::purge_decay decay = std::move(exp_decay).value();
+    amber::purge_decay::clock::time_point t0 = amber::purge_decay::clock::now();
+
+    // A spike is kept at first and released linearly over the decay time
+    REQUIRE(decay.dirty_limit(1000, t0) == 1000);
+    REQUIRE(decay.dirty_limit(1000, t0 + 5s) == 500);
+    REQUIRE(decay.dirty_limit(500, t0 + 8s) == 200);
+    REQUIRE(decay.dirty_limit(200, t0 + 10s) == 0);
+
+    // New dirty memory restarts the decay
+    REQUIRE(decay.dirty_limit(400, t0 + 20s) == 400);
+    REQUIRE(decay.dirty_limit(100, t0 + 21s) == 100);
+    REQUIRE(decay.dirty_limit(100, t0 + 25s) == 100);
+    REQUIRE(decay.dirty_limit(100, t0 + 29s) == 40);
+
+    // A caller that does not purge to the limit still sees it decay
+    auto&& exp_unpurged = amber::purge_decay::create(10s);
+    REQUIRE(exp_unpurged.has_value());
+    amber::purge_decay unpurged = std::move(exp_unpurged).value();
+    REQUIRE(unpurged.dirty_limit(1000, t0) == 1000);
+    REQUIRE(unpurged.dirty_limit(1000, t0 + 5s) == 500);
+    REQUIRE(unpurged.dirty_limit(1000, t0 + 8s) == 200);
+    REQUIRE(unpurged.dirty_limit(1000, t0 + 10s) == 0);
+    // Only growth past the previous size restarts it
+    REQUIRE(unpurged.dirty_limit(1200, t0 + 11s) == 1200);
+
+    auto&& exp_immediate = amber::purge_decay::create(0s);
+    REQUIRE(exp_immediate.has_value());
+    REQUIRE(exp_immediate.value().dirty_limit(1000, t0) == 0);
+    REQUIRE_FALSE(amber::purge_decay::create(-1s).has_value());
+}
+
+} // namespace amber_test
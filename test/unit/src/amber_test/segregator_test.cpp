@@ -0,0 +1,98 @@
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <amber/segregator.hpp>
+#include <amber/stack_allocator.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <utility>
+
+namespace amber_test {
+
+TEST_CASE("segregator allocate(alignment, size)/free(ptr)")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(128);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_pool = amber::pool_allocator::create(buffer, 16);
+    REQUIRE(exp_pool.has_value());
+
+    using allocator_type = amber::segregator<16, amber::pool_allocator, amber::malloc_allocator>;
+    auto&& exp_alloc = allocator_type::create(std::move(exp_pool).value(), amber::malloc_allocator());
+    REQUIRE(exp_alloc.has_value());
+    allocator_type allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate(8, 16);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(allocator.small().owns(exp_a1.value()));
+    auto exp_a2 = allocator.allocate(8, 17);
+    REQUIRE(exp_a2.has_value());
+    REQUIRE_FALSE(allocator.small().owns(exp_a2.value()));
+    auto exp_a3 = allocator.allocate<std::uint64_t>(8u);
+    REQUIRE(exp_a3.has_value());
+    REQUIRE(allocator.small().entry_allocate_count() == 2);
+
+    allocator.free(exp_a1.value());
+    allocator.free(exp_a2.value());
+    allocator.free(exp_a3.value());
+    REQUIRE(allocator.small().entry_allocate_count() == 0);
+}
+
+TEST_CASE("segregator zero-size allocation at the end of a linear_allocator")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(32);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_linear = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_linear.has_value());
+
+    using allocator_type = amber::segregator<32, amber::linear_allocator, amber::malloc_allocator>;
+    auto&& exp_alloc = allocator_type::create(std::move(exp_linear).value(), amber::malloc_allocator());
+    REQUIRE(exp_alloc.has_value());
+    allocator_type allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate(1, 0);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(allocator.small().owns(exp_a1.value()));
+    auto exp_a2 = allocator.allocate(1, 31);
+    REQUIRE(exp_a2.has_value());
+    // Returning the end of the buffer would send the pointer to malloc's free
+    auto exp_a3 = allocator.allocate(1, 0);
+    REQUIRE_FALSE(exp_a3.has_value());
+    REQUIRE(exp_a3.error() == "out of capacity");
+    allocator.free(exp_a1.value());
+    allocator.free(exp_a2.value());
+    REQUIRE(allocator.small().buffer_offset() == 32);
+}
+
+TEST_CASE("segregator owns(ptr)")
+{
+    auto&& exp_b1 = amber::malloc_buffer::create(64);
+    REQUIRE(exp_b1.has_value());
+    amber::malloc_buffer b1 = std::move(exp_b1).value();
+    auto&& exp_b2 = amber::malloc_buffer::create(256);
+    REQUIRE(exp_b2.has_value());
+    amber::malloc_buffer b2 = std::move(exp_b2).value();
+    auto&& exp_pool = amber::pool_allocator::create(b1, 8);
+    REQUIRE(exp_pool.has_value());
+    auto&& exp_stack = amber::stack_allocator::create(b2);
+    REQUIRE(exp_stack.has_value());
+
+    using allocator_type = amber::segregator<8, amber::pool_allocator, amber::stack_allocator>;
+    auto&& exp_alloc = allocator_type::create(std::move(exp_pool).value(), std::move(exp_stack).value());
+    REQUIRE(exp_alloc.has_value());
+    allocator_type allocator = std::move(exp_alloc).value();
+
+    auto exp_a1 = allocator.allocate(8, 64);
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(allocator.owns(exp_a1.value()));
+    REQUIRE(allocator.large().owns(exp_a1.value()));
+    allocator.free(exp_a1.value());
+    REQUIRE(allocator.large().buffer_offset() == 0);
+
+    std::uint64_t local = 0;
+    REQUIRE_FALSE(allocator.owns(&local));
+}
+
+} // namespace amber_test
@@ -0,0 +1,70 @@
+#include <amber/shared_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <string>
+#include <utility>
+
+extern "C" {
+#include <unistd.h>
+}
+
+namespace amber_test {
+
+TEST_CASE("shared_buffer move constructor/assignment")
+{
+    auto&& exp_buffer = amber::shared_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::shared_buffer b1(std::move(exp_buffer).value());
+    REQUIRE(b1.size() == 4096);
+    REQUIRE(b1.fd() != -1);
+
+    amber::shared_buffer b2(std::move(b1));
+    REQUIRE(b1.size() == 0);
+    REQUIRE(b1.fd() == -1);
+    REQUIRE(b2.size() == 4096);
+
+    b1 = std::move(b2);
+    REQUIRE(b1.size() == 4096);
+    REQUIRE(b2.size() == 0);
+    REQUIRE(b2.fd() == -1);
+}
+
+TEST_CASE("shared_buffer attach(fd)")
+{
+    auto&& exp_b1 = amber::shared_buffer::create(4096);
+    REQUIRE(exp_b1.has_value());
+    amber::shared_buffer b1 = std::move(exp_b1).value();
+    auto&& exp_b2 = amber::shared_buffer::attach(b1.fd());
+    REQUIRE(exp_b2.has_value());
+    amber::shared_buffer b2 = std::move(exp_b2).value();
+    REQUIRE(b2.size() == 4096);
+    REQUIRE(b2.buffer().data() != b1.buffer().data());
+
+    std::memcpy(b1.buffer().data() + 100, "amber", 5);
+    REQUIRE(std::memcmp(b2.buffer().data() + 100, "amber", 5) == 0);
+
+    auto&& exp_b3 = amber::shared_buffer::attach(-1);
+    REQUIRE_FALSE(exp_b3.has_value());
+}
+
+TEST_CASE("shared_buffer create_named(name, size)")
+{
+    std::string name = "/amber_shared_buffer_test_" + std::to_string(getpid());
+    auto&& exp_b1 = amber::shared_buffer::create_named(name, 8192);
+    REQUIRE(exp_b1.has_value());
+    amber::shared_buffer b1 = std::move(exp_b1).value();
+    auto&& exp_b2 = amber::shared_buffer::create_named(name, 8192);
+    REQUIRE(exp_b2.has_value());
+    amber::shared_buffer b2 = std::move(exp_b2).value();
+
+    b1.buffer()[8191] = std::byte{0x5a};
+    REQUIRE(b2.buffer()[8191] == std::byte{0x5a});
+
+    auto&& exp_b3 = amber::shared_buffer::create_named(name, 4096);
+    REQUIRE_FALSE(exp_b3.has_value());
+    REQUIRE(exp_b3.error() == "shared memory size mismatch, size: 4096, existing size: 8192");
+    REQUIRE(amber::shared_buffer::unlink_named(name).has_value());
+    REQUIRE_FALSE(amber::shared_buffer::unlink_named(name).has_value());
+}
+
+} // namespace amber_test
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <amber/malloc_buffer.hpp>
+#include <amber/shared_buffer.hpp>
+#include <amber/shared_pool_allocator.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <sys/wait.h>
+#include <unistd.h>
+}
+
+namespace amber_test {
+
+TEST_CASE("shared_pool_allocator move constructor/assignment")
+{
+    auto&& exp_buffer = amber::shared_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::shared_buffer buffer = std::move(exp_buffer).value();
+
+    auto&& exp_alloc = amber::shared_pool_allocator::create(buffer, 64);
+    REQUIRE(exp_alloc.has_value());
+    amber::shared_pool_allocator a1(std::move(exp_alloc).value());
+    REQUIRE(a1.buffer_size() == 4096);
+    REQUIRE(a1.entry_size() == 64);
+    REQUIRE(a1.entry_count() == 63);
+
+    amber::shared_pool_allocator a2(std::move(a1));
+    REQUIRE(a1.buffer_size() == 0);
+    REQUIRE(a1.entry_count() == 0);
+    REQUIRE(a2.entry_count() == 63);
+
+    a1 = std::move(a2);
+    REQUIRE(a1.entry_count() == 63);
+    REQUIRE(a2.entry_count() == 0);
+}
+
+TEST_CASE("shared_pool_allocator allocate()/free(ptr)")
+{
+    auto&& exp_buffer = amber::shared_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::shared_buffer buffer = std::move(exp_buffer).value();
+
+    auto&& exp_alloc = amber::shared_pool_allocator::create(buffer, 1024, alignof(std::uint64_t));
+    REQUIRE(exp_alloc.has_value());
+    amber::shared_pool_allocator allocator(std::move(exp_alloc).value());
+    REQUIRE(allocator.entry_count() == 3);
+
+    void* ptrs[3] = {};
+    for (std::size_t i = 0; i < 3; ++i) {
+        auto exp_ptr = allocator.allocate();
+        REQUIRE(exp_ptr.has_value());
+        ptrs[i] = exp_ptr.value();
+        REQUIRE(allocator.offset_of(ptrs[i]) == 64 + (i * 1024));
+        REQUIRE(allocator.pointer_to(allocator.offset_of(ptrs[i])) == ptrs[i]);
+    }
+    auto exp_a4 = allocator.allocate();
+    REQUIRE_FALSE(exp_a4.has_value());
+    REQUIRE(exp_a4.error() == "out of capacity");
+
+    std::memset(ptrs[2], 0xab, 1024);
+    allocator.free(ptrs[0]);
+    allocator.free(ptrs[2]);
+    REQUIRE(allocator.entry_free_count() == 2);
+    auto exp_a5 = allocator.allocate();
+    REQUIRE(exp_a5.has_value());
+    REQUIRE(exp_a5.value() == ptrs[2]);
+    // Reused entries come back zeroed, including the free list link
+    const std::byte* reused = static_cast<const std::byte*>(exp_a5.value());
+    REQUIRE(std::all_of(reused, reused + 1024, [](std::byte b) { return b == std::byte(0); }));
+
+    // The uninitialized entry keeps its payload
+    std::memset(ptrs[1], 0xcd, 1024);
+    allocator.free(ptrs[1]);
+    auto exp_raw = allocator.allocate_uninitialized();
+    REQUIRE(exp_raw.has_value());
+    REQUIRE(exp_raw.value() == ptrs[1]);
+    REQUIRE(static_cast<const std::byte*>(exp_raw.value())[1023] == std::byte(0xcd));
+    allocator.free(exp_raw.value());
+
+    auto exp_a6 = allocator.allocate<std::uint64_t>(5u);
+    REQUIRE(exp_a6.has_value());
+    REQUIRE(*exp_a6.value() == 5);
+    allocator.free(exp_a6.value());
+}
+
+TEST_CASE("shared_pool_allocator attach(buffer)")
+{
+    auto&& exp_b1 = amber::shared_buffer::create(4096);
+    REQUIRE(exp_b1.has_value());
+    amber::shared_buffer b1 = std::move(exp_b1).value();
+
+    auto&& exp_none = amber::shared_pool_allocator::attach(b1);
+    REQUIRE_FALSE(exp_none.has_value());
+    REQUIRE(exp_none.error() == "shared pool not initialized");
+
+    auto&& exp_a1 = amber::shared_pool_allocator::create(b1, sizeof(std::uint64_t), alignof(std::uint64_t));
+    REQUIRE(exp_a1.has_value());
+    amber::shared_pool_allocator a1 = std::move(exp_a1).value();
+
+    // A second mapping of the same memory sees the same pool
+    auto&& exp_b2 = amber::shared_buffer::attach(b1.fd());
+    REQUIRE(exp_b2.has_value());
+    amber::shared_buffer b2 = std::move(exp_b2).value();
+    auto&& exp_a2 = amber::shared_pool_allocator::attach(b2);
+    REQUIRE(exp_a2.has_value());
+    amber::shared_pool_allocator a2 = std::move(exp_a2).value();
+    REQUIRE(a2.entry_count() == a1.entry_count());
+
+    auto exp_value = a2.allocate<std::uint64_t>(99u);
+    REQUIRE(exp_value.has_value());
+    REQUIRE(a1.entry_allocate_count() == 1);
+    std::size_t offset = a2.offset_of(exp_value.value());
+    REQUIRE(*static_cast<std::uint64_t*>(a1.pointer_to(offset)) == 99);
+    a1.free(a1.pointer_to(offset));
+    REQUIRE(a2.entry_allocate_count() == 0);
+}
+
+TEST_CASE("shared_pool_allocator across fork")
+{
+    auto&& exp_buffer = amber::shared_buffer::create(4096);
+    REQUIRE(exp_buffer.has_value());
+    amber::shared_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_alloc = amber::shared_pool_allocator::create(buffer, sizeof(std::uint64_t), alignof(std::uint64_t));
+    REQUIRE(exp_alloc.has_value());
+    amber::shared_pool_allocator allocator = std::move(exp_alloc).value();
+
+    pid_t pid = fork();
+    REQUIRE(pid != -1);
+    if (pid == 0) {
+        auto exp_value = allocator.allocate<std::uint64_t>(1234u);
+        _exit(exp_value.has_value() ? static_cast<int>(allocator.offset_of(exp_value.value()) / 8) : 255);
+    }
+    int status = 0;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) != 255);
+    std::size_t offset = static_cast<std::size_t>(WEXITSTATUS(status)) * 8;
+    REQUIRE(allocator.entry_allocate_count() == 1);
+    REQUIRE(*static_cast<std::uint64_t*>(allocator.pointer_to(offset)) == 1234);
+}
+
+TEST_CASE("shared_pool_allocator concurrent allocate/free")
+{
+    auto&& exp_buffer = amber::shared_buffer::create(64 * 1024);
+    REQUIRE(exp_buffer.has_value());
+    amber::shared_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_alloc = amber::shared_pool_allocator::create(buffer, 64);
+    REQUIRE(exp_alloc.has_value());
+    amber::shared_pool_allocator allocator = std::move(exp_alloc).value();
+
+    constexpr std::size_t thread_count = 4;
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&allocator]() {
+            std::vector<void*> held;
+            for (std::size_t i = 0; i < 20000; ++i) {
+                auto exp_ptr = allocator.allocate();
+                if (exp_ptr.has_value()) {
+                    held.push_back(exp_ptr.value());
+                }
+                if (held.size() > 8 || !exp_ptr.has_value()) {
+                    for (void* ptr : held) {
+                        allocator.free(ptr);
+                    }
+                    held.clear();
+                }
+            }
+            for (void* ptr : held) {
+                allocator.free(ptr);
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    REQUIRE(allocator.entry_allocate_count() == 0);
+
+    std::set<void*> ptrs;
+    while (true) {
+        auto exp_ptr = allocator.allocate();
+        if (!exp_ptr.has_value()) {
+            break;
+        }
+        REQUIRE(ptrs.insert(exp_ptr.value()).second);
+    }
+    REQUIRE(ptrs.size() == allocator.entry_count());
+}
+
+} // namespace amber_test
@@ -0,0 +1,207 @@
+#include <amber/compact_pool_allocator.hpp>
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <amber/snapshot.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+namespace amber_test {
+
+namespace {
+
+std::string snapshot_path(const char* name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // unnamed namespace
+
+TEST_CASE("pool_allocator save_state()/restore(buffer, state)")
+{
+    auto&& exp_b1 = amber::malloc_buffer::create(64);
+    REQUIRE(exp_b1.has_value());
+    amber::malloc_buffer b1 = std::move(exp_b1).value();
+    auto&& exp_b2 = amber::malloc_buffer::create(64);
+    REQUIRE(exp_b2.has_value());
+    amber::malloc_buffer b2 = std::move(exp_b2).value();
+
+    auto&& exp_alloc = amber::pool_allocator::create(b1, 8);
+    REQUIRE(exp_alloc.has_value());
+    amber::pool_allocator a1 = std::move(exp_alloc).value();
+    void* ptrs[3] = {};
+    for (void*& ptr : ptrs) {
+        auto exp_ptr = a1.allocate();
+        REQUIRE(exp_ptr.has_value());
+        ptr = exp_ptr.value();
+    }
+    a1.free(ptrs[1]);
+    amber::pool_allocator::state state = a1.save_state();
+    REQUIRE(state.entry_allocate_count == 2);
+
+    // Restoring into a copy at another address leaves the copy untouched,
+    // the free list is linked by offset
+    std::memcpy(b2.buffer().data(), b1.buffer().data(), 64);
+    auto&& exp_a2 = amber::pool_allocator::restore(b2, state);
+    REQUIRE(exp_a2.has_value());
+    REQUIRE(std::memcmp(b2.buffer().data(), b1.buffer().data(), 64) == 0);
+    amber::pool_allocator a2 = std::move(exp_a2).value();
+    REQUIRE(a2.entry_allocate_count() == 2);
+    auto exp_p1 = a2.allocate();
+    REQUIRE(exp_p1.has_value());
+    REQUIRE(exp_p1.value() == b2.buffer().data() + 48);
+    std::size_t remaining = 0;
+    while (a2.allocate().has_value()) {
+        ++remaining;
+    }
+    REQUIRE(remaining == 5);
+
+    state.entry_size = 0;
+    auto&& exp_a3 = amber::pool_allocator::restore(b2, state);
+    REQUIRE_FALSE(exp_a3.has_value());
+    REQUIRE(exp_a3.error() == "invalid pool state");
+}
+
+TEST_CASE("pool_allocator restore(buffer, state) invalid free list")
+{
+    auto&& exp_b1 = amber::malloc_buffer::create(64);
+    REQUIRE(exp_b1.has_value());
+    amber::malloc_buffer b1 = std::move(exp_b1).value();
+    auto&& exp_b2 = amber::malloc_buffer::create(64);
+    REQUIRE(exp_b2.has_value());
+    amber::malloc_buffer b2 = std::move(exp_b2).value();
+
+    auto&& exp_alloc = amber::pool_allocator::create(b1, 8);
+    REQUIRE(exp_alloc.has_value());
+    amber::pool_allocator a1 = std::move(exp_alloc).value();
+    amber::pool_allocator::state state = a1.save_state();
+    REQUIRE(state.free_head_offset == 56);
+
+    auto restore_with = [&](std::size_t head, std::size_t link) {
+        std::memcpy(b2.buffer().data(), b1.buffer().data(), 64);
+        // Link of the entry at offset 48
+        std::memcpy(b2.buffer().data() + 48, &link, sizeof(link));
+        amber::pool_allocator::state corrupt = state;
+        corrupt.free_head_offset = head;
+        return amber::pool_allocator::restore(b2, corrupt);
+    };
+    REQUIRE(restore_with(56, 40).has_value());
+    // Head and links must land on an entry
+    REQUIRE(restore_with(52, 40).error() == "invalid pool free list");
+    REQUIRE(restore_with(56, 44).error() == "invalid pool free list");
+    REQUIRE(restore_with(56, 64).error() == "invalid pool free list");
+    // Ending early or looping back fails too
+    REQUIRE(restore_with(56, amber::pool_allocator::no_entry).error() == "invalid pool free list");
+    REQUIRE(restore_with(56, 56).error() == "invalid pool free list");
+}
+
+TEST_CASE("pool_allocator snapshot round trip")
+{
+    std::string path = snapshot_path("amber_pool_snapshot_test.bin");
+    auto&& exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    {
+        auto&& exp_alloc = amber::pool_allocator::create(buffer, sizeof(std::uint64_t));
+        REQUIRE(exp_alloc.has_value());
+        amber::pool_allocator allocator = std::move(exp_alloc).value();
+        auto exp_a1 = allocator.allocate<std::uint64_t>(7u);
+        REQUIRE(exp_a1.has_value());
+        auto exp_a2 = allocator.allocate<std::uint64_t>(11u);
+        REQUIRE(exp_a2.has_value());
+        allocator.free(exp_a1.value());
+        REQUIRE(amber::save_snapshot(path, buffer.buffer(), allocator).has_value());
+    }
+
+    auto&& exp_snapshot = amber::snapshot_buffer::create(path);
+    REQUIRE(exp_snapshot.has_value());
+    amber::snapshot_buffer snapshot = std::move(exp_snapshot).value();
+    REQUIRE(snapshot.size() == 64);
+    REQUIRE(snapshot.header().kind == amber::snapshot_kind::pool);
+    auto&& exp_alloc = amber::restore_pool_allocator(snapshot);
+    REQUIRE(exp_alloc.has_value());
+    amber::pool_allocator allocator = std::move(exp_alloc).value();
+    REQUIRE(allocator.entry_allocate_count() == 1);
+
+    std::uint64_t value = 0;
+    std::memcpy(&value, snapshot.buffer().data() + 48, sizeof(value));
+    REQUIRE(value == 11);
+    auto exp_a3 = allocator.allocate();
+    REQUIRE(exp_a3.has_value());
+    REQUIRE(exp_a3.value() == snapshot.buffer().data() + 56);
+
+    auto&& exp_wrong = amber::restore_linear_allocator(snapshot);
+    REQUIRE_FALSE(exp_wrong.has_value());
+    REQUIRE(exp_wrong.error() == "snapshot kind mismatch");
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("compact_pool_allocator snapshot round trip")
+{
+    std::string path = snapshot_path("amber_compact_pool_snapshot_test.bin");
+    auto&& exp_buffer = amber::malloc_buffer::create(32);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    {
+        auto&& exp_alloc = amber::compact_pool_allocator::create(buffer, 4);
+        REQUIRE(exp_alloc.has_value());
+        amber::compact_pool_allocator allocator = std::move(exp_alloc).value();
+        REQUIRE(allocator.allocate().has_value());
+        REQUIRE(allocator.allocate().has_value());
+        REQUIRE(amber::save_snapshot(path, buffer.buffer(), allocator).has_value());
+    }
+
+    auto&& exp_snapshot = amber::snapshot_buffer::create(path);
+    REQUIRE(exp_snapshot.has_value());
+    amber::snapshot_buffer snapshot = std::move(exp_snapshot).value();
+    auto&& exp_alloc = amber::restore_compact_pool_allocator(snapshot);
+    REQUIRE(exp_alloc.has_value());
+    amber::compact_pool_allocator allocator = std::move(exp_alloc).value();
+    REQUIRE(allocator.entry_count() == 8);
+    REQUIRE(allocator.entry_allocate_count() == 2);
+    auto exp_a1 = allocator.allocate();
+    REQUIRE(exp_a1.has_value());
+    REQUIRE(allocator.index_of(exp_a1.value()) == 5);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("linear_allocator snapshot round trip")
+{
+    std::string path = snapshot_path("amber_linear_snapshot_test.bin");
+    auto&& exp_buffer = amber::malloc_buffer::create(64);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    {
+        auto&& exp_alloc = amber::linear_allocator::create(buffer);
+        REQUIRE(exp_alloc.has_value());
+        amber::linear_allocator allocator = std::move(exp_alloc).value();
+        auto exp_a1 = allocator.allocate<std::uint32_t>(0x12345678u);
+        REQUIRE(exp_a1.has_value());
+        REQUIRE(amber::save_snapshot(path, buffer.buffer(), allocator).has_value());
+    }
+
+    auto&& exp_snapshot = amber::snapshot_buffer::create(path);
+    REQUIRE(exp_snapshot.has_value());
+    amber::snapshot_buffer snapshot = std::move(exp_snapshot).value();
+    auto&& exp_alloc = amber::restore_linear_allocator(snapshot);
+    REQUIRE(exp_alloc.has_value());
+    amber::linear_allocator allocator = std::move(exp_alloc).value();
+    REQUIRE(allocator.buffer_offset() == 4);
+    std::uint32_t value = 0;
+    std::memcpy(&value, snapshot.buffer().data(), sizeof(value));
+    REQUIRE(value == 0x12345678u);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("snapshot_buffer invalid file")
+{
+    std::string path = snapshot_path("amber_invalid_snapshot_test.bin");
+    auto&& exp_missing = amber::snapshot_buffer::create(path);
+    REQUIRE_FALSE(exp_missing.has_value());
+}
+
+} // namespace amber_test
@@ -0,0 +1,61 @@
+#include <amber/linear_allocator.hpp>
+#include <amber/malloc_buffer.hpp>
+#include <amber/pool_allocator.hpp>
+#include <amber/span_buffer.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <span>
+#include <utility>
+
+namespace amber_test {
+
+TEST_CASE("span_buffer move constructor/assignment")
+{
+    std::byte storage[64] = {};
+    amber::span_buffer b1{std::span<std::byte>(storage)};
+    REQUIRE(b1.buffer().data() == storage);
+    REQUIRE(b1.size() == 64);
+
+    amber::span_buffer b2(std::move(b1));
+    REQUIRE(b1.size() == 0);
+    REQUIRE(b2.buffer().data() == storage);
+    REQUIRE(b2.size() == 64);
+
+    b1 = std::move(b2);
+    REQUIRE(b1.buffer().data() == storage);
+    REQUIRE(b1.size() == 64);
+    REQUIRE(b2.size() == 0);
+}
+
+TEST_CASE("span_buffer create(allocator, alignment, size)")
+{
+    auto&& exp_buffer = amber::malloc_buffer::create(1024);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    auto&& exp_arena = amber::linear_allocator::create(buffer);
+    REQUIRE(exp_arena.has_value());
+    amber::linear_allocator arena = std::move(exp_arena).value();
+
+    // A pool nested in an allocation of the arena
+    auto&& exp_region = amber::span_buffer::create(arena, alignof(std::max_align_t), 256);
+    REQUIRE(exp_region.has_value());
+    amber::span_buffer region = std::move(exp_region).value();
+    REQUIRE(region.size() == 256);
+    REQUIRE(arena.owns(region.buffer().data()));
+    REQUIRE(arena.buffer_offset() == 256);
+
+    auto&& exp_pool = amber::pool_allocator::create(region, 32);
+    REQUIRE(exp_pool.has_value());
+    amber::pool_allocator pool = std::move(exp_pool).value();
+    REQUIRE(pool.entry_count() == 8);
+    for (std::size_t i = 0; i < 8; ++i) {
+        auto exp_ptr = pool.allocate();
+        REQUIRE(exp_ptr.has_value());
+        REQUIRE(arena.owns(exp_ptr.value()));
+    }
+
+    auto&& exp_large = amber::span_buffer::create(arena, 8, 1024);
+    REQUIRE_FALSE(exp_large.has_value());
+}
+
+} // namespace amber_test
@@ -0,0 +1,135 @@
+#include <amber/malloc_buffer.hpp>
+#include <amber/spsc_ring_allocator.hpp>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace amber_test {
+
+TEST_CASE("spsc_ring_allocator allocate/free")
+{
+    auto exp_buffer = amber::malloc_buffer::create(128);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+    std::byte* buffer_ptr = buffer.buffer().data();
+
+    auto exp_alloc = amber::spsc_ring_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::spsc_ring_allocator allocator(std::move(exp_alloc).value());
+    REQUIRE(allocator.buffer_size() == 128);
+
+    auto exp_r1 = allocator.allocate(8, 40);
+    REQUIRE(exp_r1.has_value());
+    REQUIRE(static_cast<std::byte*>(exp_r1.value()) == buffer_ptr + 8);
+    REQUIRE(allocator.bytes_in_use() == 48);
+
+    auto exp_r2 = allocator.allocate(8, 40);
+    REQUIRE(exp_r2.has_value());
+    REQUIRE(static_cast<std::byte*>(exp_r2.value()) == buffer_ptr + 56);
+    REQUIRE(allocator.bytes_in_use() == 96);
+
+    // 32 bytes remain before the end, a 40 byte record must not be split
+    auto exp_r3 = allocator.allocate(8, 40);
+    REQUIRE_FALSE(exp_r3.has_value());
+    REQUIRE(exp_r3.error() == "out of capacity");
+
+    allocator.free(exp_r1.value());
+    REQUIRE(allocator.bytes_in_use() == 48);
+    exp_r3 = allocator.allocate(8, 40);
+    REQUIRE(exp_r3.has_value());
+    REQUIRE(static_cast<std::byte*>(exp_r3.value()) == buffer_ptr + 8);
+    // includes the 32 bytes skipped at the end of the buffer
+    REQUIRE(allocator.bytes_in_use() == 128);
+
+    allocator.free(exp_r2.value());
+    allocator.free(exp_r3.value());
+    REQUIRE(allocator.bytes_in_use() == 0);
+
+    auto exp_big = allocator.allocate(8, 128);
+    REQUIRE_FALSE(exp_big.has_value());
+    REQUIRE(exp_big.error() == "record too large");
+    // Would wrap the record's end address around
+    auto exp_huge = allocator.allocate(8, SIZE_MAX - 8);
+    REQUIRE_FALSE(exp_huge.has_value());
+    REQUIRE(exp_huge.error() == "record too large");
+    REQUIRE(allocator.bytes_in_use() == 0);
+
+    auto exp_align = allocator.allocate(64, 8);
+    REQUIRE(exp_align.has_value());
+    REQUIRE((reinterpret_cast<std::uintptr_t>(exp_align.value()) % 64) == 0);
+
+    auto exp_bad = allocator.allocate(3, 8);
+    REQUIRE_FALSE(exp_bad.has_value());
+    REQUIRE(exp_bad.error() == "invalid alignment: 3");
+}
+
+TEST_CASE("spsc_ring_allocator producer/consumer threads")
+{
+    auto exp_buffer = amber::malloc_buffer::create(1024);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_alloc = amber::spsc_ring_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::spsc_ring_allocator allocator(std::move(exp_alloc).value());
+
+    constexpr std::uint32_t message_count = 100000;
+    std::mutex queue_mutex;
+    std::deque<std::pair<std::byte*, std::uint32_t>> queue;
+    std::atomic<bool> corrupt(false);
+
+    std::thread consumer([&]() {
+        std::uint32_t received = 0;
+        while (received < message_count) {
+            std::pair<std::byte*, std::uint32_t> message(nullptr, 0);
+            {
+                std::lock_guard lock(queue_mutex);
+                if (queue.empty()) {
+                    continue;
+                }
+                message = queue.front();
+                queue.pop_front();
+            }
+            std::uint32_t id = 0;
+            std::memcpy(&id, message.first, sizeof(id));
+            std::size_t size = 4 + (id % 61);
+            for (std::size_t i = sizeof(id); i < size; ++i) {
+                if (message.first[i] != static_cast<std::byte>(id)) {
+                    corrupt.store(true);
+                }
+            }
+            if (id != received) {
+                corrupt.store(true);
+            }
+            allocator.free(message.first);
+            received += 1;
+        }
+    });
+
+    for (std::uint32_t id = 0; id < message_count;) {
+        std::size_t size = 4 + (id % 61);
+        auto exp_ptr = allocator.allocate(4, size);
+        if (!exp_ptr.has_value()) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::byte* ptr = static_cast<std::byte*>(exp_ptr.value());
+        std::memcpy(ptr, &id, sizeof(id));
+        std::memset(ptr + sizeof(id), static_cast<int>(id & 0xff), size - sizeof(id));
+        {
+            std::lock_guard lock(queue_mutex);
+            queue.emplace_back(ptr, id);
+        }
+        id += 1;
+    }
+    consumer.join();
+    REQUIRE_FALSE(corrupt.load());
+    REQUIRE(allocator.bytes_in_use() == 0);
+}
+
+} // namespace amber_test
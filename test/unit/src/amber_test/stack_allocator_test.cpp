@@ -1,7 +1,9 @@
 #include <amber/malloc_buffer.hpp>
 #include <amber/stack_allocator.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <utility>
 
 namespace amber_test {
@@ -122,4 +124,87 @@ TEST_CASE("stack_allocator allocate<T>()/free<T>(ptr)")
     REQUIRE(exp_a4.error() == "out of capacity");
 }
 
+TEST_CASE("stack_allocator try_extend/shrink/reallocate")
+{
+    auto exp_buffer = amber::malloc_buffer::create(128);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_alloc = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::stack_allocator allocator(std::move(exp_alloc).value());
+
+    auto exp_a1 = allocator.allocate(8, 16);
+    REQUIRE(exp_a1.has_value());
+    void* a1 = exp_a1.value();
+    REQUIRE(allocator.buffer_offset() == 24);
+    REQUIRE(allocator.try_extend(a1, 16, 40));
+    REQUIRE(allocator.buffer_offset() == 48);
+    REQUIRE(allocator.shrink(a1, 40, 8));
+    REQUIRE(allocator.buffer_offset() == 16);
+
+    auto exp_a2 = allocator.allocate(8, 8);
+    REQUIRE(exp_a2.has_value());
+    REQUIRE(allocator.buffer_offset() == 32);
+    REQUIRE_FALSE(allocator.try_extend(a1, 8, 16));
+
+    std::memset(a1, 0x5a, 8);
+    auto exp_a3 = allocator.reallocate(a1, 8, 8, 16);
+    REQUIRE(exp_a3.has_value());
+    REQUIRE(exp_a3.value() != a1);
+    REQUIRE(std::memcmp(exp_a3.value(), a1, 8) == 0);
+    REQUIRE(allocator.buffer_offset() == 56);
+
+    auto exp_a4 = allocator.reallocate(exp_a3.value(), 16, 8, 32);
+    REQUIRE(exp_a4.has_value());
+    REQUIRE(exp_a4.value() == exp_a3.value());
+    REQUIRE(allocator.buffer_offset() == 72);
+
+    allocator.free(exp_a4.value());
+    REQUIRE(allocator.buffer_offset() == 32);
+    allocator.free(exp_a2.value());
+    allocator.free(a1);
+    REQUIRE(allocator.buffer_offset() == 0);
+}
+
+TEST_CASE("stack_allocator reallocate(...) moving the top allocation")
+{
+    auto exp_buffer = amber::malloc_buffer::create(256);
+    REQUIRE(exp_buffer.has_value());
+    amber::malloc_buffer buffer = std::move(exp_buffer).value();
+
+    auto exp_alloc = amber::stack_allocator::create(buffer);
+    REQUIRE(exp_alloc.has_value());
+    amber::stack_allocator allocator(std::move(exp_alloc).value());
+
+    auto exp_a1 = allocator.allocate(8, 32);
+    REQUIRE(exp_a1.has_value());
+    void* a1 = exp_a1.value();
+    for (std::size_t i = 0; i < 32; ++i) {
+        static_cast<unsigned char*>(a1)[i] = static_cast<unsigned char>(i);
+    }
+
+    // A stricter alignment forces a move, the new block reuses the old space
+    auto exp_a2 = allocator.reallocate(a1, 32, 64, 48);
+    REQUIRE(exp_a2.has_value());
+    void* a2 = exp_a2.value();
+    REQUIRE(reinterpret_cast<std::uintptr_t>(a2) % 64 == 0);
+    for (std::size_t i = 0; i < 32; ++i) {
+        REQUIRE(static_cast<unsigned char*>(a2)[i] == static_cast<unsigned char>(i));
+    }
+    std::size_t a2_offset = static_cast<std::size_t>(static_cast<std::byte*>(a2) - buffer.buffer().data());
+    REQUIRE(a2_offset < 8 + 64);
+    REQUIRE(allocator.buffer_offset() == a2_offset + 48);
+
+    allocator.free(a2);
+    REQUIRE(allocator.buffer_offset() == 0);
+
+    // Too large even after releasing the old block leaves the stack unchanged
+    auto exp_a3 = allocator.allocate(8, 32);
+    REQUIRE(exp_a3.has_value());
+    REQUIRE(allocator.buffer_offset() == 40);
+    REQUIRE_FALSE(allocator.reallocate(exp_a3.value(), 32, 64, 256).has_value());
+    REQUIRE(allocator.buffer_offset() == 40);
+}
+
 } // namespace amber_test
@@ -194,4 +194,10 @@ TEST_CASE("align_forward alignment_error")
     }
 }
 
+TEST_CASE("page_size")
+{
+    REQUIRE(std::has_single_bit(amber::page_size()));
+    REQUIRE(amber::page_size() >= 4096);
+}
+
 } // namespace amber_test